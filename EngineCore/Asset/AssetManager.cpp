@@ -1,4 +1,5 @@
 #include "Asset/AssetManager.h"
+#include <charconv>
 
 namespace kbs
 {
@@ -34,4 +35,80 @@ namespace kbs
 	{
 		return m_ModelManager;
 	}
+
+	std::string AssetSceneResolver::GetAssetName(SceneAssetType type, UUID id)
+	{
+		switch (type)
+		{
+		case SceneAssetType::Mesh:
+		{
+			ptr<ModelManager> models = m_Assets->GetModelManager();
+			for (auto& [path, modelID] : models->GetModelPaths())
+			{
+				opt<ptr<Model>> model = models->GetModel(modelID);
+				if (!model.has_value()) continue;
+				const std::vector<Model::Primitive>& primitives = model.value()->GetPrimitives();
+				for (uint32_t i = 0; i < primitives.size(); i++)
+				{
+					if (primitives[i].mesh == id)
+					{
+						return path + "#" + std::to_string(i);
+					}
+				}
+			}
+			return "";
+		}
+		case SceneAssetType::Material:
+		{
+			opt<ptr<Material>> material = m_Assets->GetMaterialManager()->GetMaterialByID(id);
+			return material.has_value() ? material.value()->GetName() : "";
+		}
+		case SceneAssetType::RTMaterial:
+		{
+			opt<ptr<RTMaterial>> material = m_Assets->GetMaterialManager()->GetRTMaterialByID(id);
+			return material.has_value() ? material.value()->GetName() : "";
+		}
+		default:
+			return "";
+		}
+	}
+
+	opt<UUID> AssetSceneResolver::FindAsset(SceneAssetType type, std::string_view name)
+	{
+		switch (type)
+		{
+		case SceneAssetType::Mesh:
+		{
+			size_t separator = name.rfind('#');
+			uint32_t index = 0;
+			if (separator == std::string_view::npos ||
+				std::from_chars(name.data() + separator + 1, name.data() + name.size(), index).ec != std::errc())
+			{
+				return std::nullopt;
+			}
+			ptr<ModelManager> models = m_Assets->GetModelManager();
+			opt<ModelID> modelID = models->GetModelByPath(std::string(name.substr(0, separator)));
+			opt<ptr<Model>> model = modelID.has_value() ? models->GetModel(modelID.value()) : std::nullopt;
+			if (!model.has_value() || index >= model.value()->GetPrimitives().size())
+			{
+				return std::nullopt;
+			}
+			return model.value()->GetPrimitives()[index].mesh;
+		}
+		case SceneAssetType::Material:
+			for (auto& material : m_Assets->GetMaterialManager()->GetMaterials())
+			{
+				if (material->GetName() == name) return material->GetID();
+			}
+			return std::nullopt;
+		case SceneAssetType::RTMaterial:
+			for (auto& material : m_Assets->GetMaterialManager()->GetRTMaterials())
+			{
+				if (material->GetName() == name) return material->GetID();
+			}
+			return std::nullopt;
+		default:
+			return std::nullopt;
+		}
+	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Asset/TextureManager.h"
 #include "Core/Singleton.h"
 #include "Asset/Model.h"
+#include "Scene/SceneSerializer.h"
 
 
 namespace kbs
@@ -29,4 +30,18 @@ namespace kbs
 		ptr<TextureManager>		m_TextureManager;
 		ptr<ModelManager>		m_ModelManager;
 	};
+
+	// names meshes by the path of their model and the index of their primitive, "path#index", and materials by
+	// their name. the models and materials a scene refers to must be loaded before the scene is
+	class AssetSceneResolver : public SceneAssetResolver
+	{
+	public:
+		AssetSceneResolver(AssetManager* assets) : m_Assets(assets) {}
+
+		std::string GetAssetName(SceneAssetType type, UUID id) override;
+		opt<UUID>	FindAsset(SceneAssetType type, std::string_view name) override;
+
+	private:
+		AssetManager* m_Assets;
+	};
 }
\ No newline at end of file
@@ -11,7 +11,16 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 
+#include "Core/MemoryTracker.h"
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+	// decoded pixels are charged to the memory tag of the loading code
+	#define STBI_MALLOC(size) ::kbs::MemoryTracker::Malloc(size)
+	#define STBI_REALLOC(p, size) ::kbs::MemoryTracker::Realloc(p, size)
+	#define STBI_FREE(p) ::kbs::MemoryTracker::Free(p)
+#endif
+
 #include "Asset/AssetManager.h"
+#include "Core/VirtualFileSystem.h"
 #include "GLTFLoader.h"
 #include "vkrg/common.h"
 #include "gvk.h"
@@ -78,12 +87,53 @@ void vkglTF::Texture::destroy()
 	// TODO destroy textures from texture manager
 }
 
-static bool fileExists(const std::string& filename)
+static kbs::opt<kbs::FileBlob> openFile(const std::string& filename)
 {
-	std::ifstream f(filename.c_str());
-	return !f.fail();
+	return kbs::Singleton::GetInstance<kbs::VirtualFileSystem>()->Open(filename);
 }
 
+/*
+	tinygltf file callbacks, external buffers and images are read from mounted packs or memory mapped files
+*/
+static bool vfsFileExists(const std::string& absFilename, void*)
+{
+	return kbs::Singleton::GetInstance<kbs::VirtualFileSystem>()->Contains(absFilename) || tinygltf::FileExists(absFilename, nullptr);
+}
+
+static bool vfsReadWholeFile(std::vector<unsigned char>* out, std::string* err, const std::string& filepath, void*)
+{
+	auto content = openFile(filepath);
+	if (!content.has_value())
+	{
+		if (err) (*err) += "File open error : " + filepath + "\n";
+		return false;
+	}
+	out->assign(content.value().data, content.value().data + content.value().size);
+	return true;
+}
+
+static bool vfsGetFileSizeInBytes(size_t* filesize_out, std::string* err, const std::string& filepath, void*)
+{
+	auto content = openFile(filepath);
+	if (!content.has_value())
+	{
+		if (err) (*err) += "File open error : " + filepath + "\n";
+		return false;
+	}
+	*filesize_out = (size_t)content.value().size;
+	return true;
+}
+
+// GetFileSizeInBytes only exists in newer tinygltf versions
+template<typename Callbacks>
+static auto setFileSizeCallback(Callbacks& callbacks, int) -> decltype(callbacks.GetFileSizeInBytes = &vfsGetFileSizeInBytes, void())
+{
+	callbacks.GetFileSizeInBytes = &vfsGetFileSizeInBytes;
+}
+
+template<typename Callbacks>
+static void setFileSizeCallback(Callbacks& callbacks, long) {}
+
 void exitFatal(const std::string& message, int32_t exitCode)
 {
 #if defined(_WIN32)
@@ -199,10 +249,11 @@ void vkglTF::Texture::fromglTfImage(tinygltf::Image& gltfimage, std::string path
 
 		ktxResult result = KTX_SUCCESS;
 
-		if (!fileExists(filename)) {
+		auto content = openFile(filename);
+		if (!content.has_value()) {
 			exitFatal("Could not load texture from " + filename + "\n\nThe file may be part of the additional asset pack.\n\nRun \"download_assets.py\" in the repository root to download the latest version.", -1);
 		}
-		result = ktxTexture_CreateFromNamedFile(filename.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTexture);
+		result = ktxTexture_CreateFromMemory(content.value().data, content.value().size, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTexture);
 		assert(result == KTX_SUCCESS);
 
 		width = ktxTexture->baseWidth;
@@ -874,6 +925,15 @@ void vkglTF::Model::loadFromFile(std::string filename, uint32_t fileLoadingFlags
 		gltfContext.SetImageLoader(loadImageDataFunc, nullptr);
 	}
 
+	tinygltf::FsCallbacks fsCallbacks{};
+	fsCallbacks.FileExists = &vfsFileExists;
+	fsCallbacks.ExpandFilePath = &tinygltf::ExpandFilePath;
+	fsCallbacks.ReadWholeFile = &vfsReadWholeFile;
+	fsCallbacks.WriteWholeFile = &tinygltf::WriteWholeFile;
+	fsCallbacks.user_data = nullptr;
+	setFileSizeCallback(fsCallbacks, 0);
+	gltfContext.SetFsCallbacks(fsCallbacks);
+
 #if defined(__ANDROID__)
 	// On Android all assets are packed with the apk in a compressed form, so we need to open them using the asset manager
 	// We let tinygltf handle this, by passing the asset manager of our app
@@ -890,7 +950,23 @@ void vkglTF::Model::loadFromFile(std::string filename, uint32_t fileLoadingFlags
 	// We let tinygltf handle this, by passing the asset manager of our app
 	tinygltf::asset_manager = androidApp->activity->assetManager;
 #endif
-	bool fileLoaded = gltfContext.LoadASCIIFromFile(&gltfModel, &error, &warning, filename);
+	bool fileLoaded = false;
+	if (auto content = openFile(filename); content.has_value())
+	{
+		const kbs::FileBlob& blob = content.value();
+		if (filename.size() >= 4 && strToLower(filename.substr(filename.size() - 4).c_str()) == ".glb")
+		{
+			fileLoaded = gltfContext.LoadBinaryFromMemory(&gltfModel, &error, &warning, blob.data, (unsigned int)blob.size, path);
+		}
+		else
+		{
+			fileLoaded = gltfContext.LoadASCIIFromString(&gltfModel, &error, &warning, (const char*)blob.data, (unsigned int)blob.size, path);
+		}
+	}
+	else
+	{
+		error = "fail to open file " + filename;
+	}
 
 	std::vector<Vertex> vertexBuffer;
 
@@ -3,6 +3,7 @@
 #include "Asset/GLTFLoader.h"
 #include "Asset/AssetManager.h"
 #include "Scene/Entity.h"
+#include "Core/MemoryTracker.h"
 
 namespace kbs
 {
@@ -14,6 +15,7 @@ namespace kbs
 
 	opt<ModelID> ModelManager::LoadFromGLTF(const std::string& path, RenderAPI& api, ModelLoadOption option)
 	{
+		KBS_MEMORY_TAG(Asset);
 		std::string absolutePath;
 		if (auto var = GetModelManagerFile()->FindAbsolutePath(path);var.has_value())
 		{
@@ -111,6 +113,7 @@ namespace kbs
 			
 			bool skipOpaque = kbs_contains_flags(option.flags, ModelLoadOption::SkipOpaque);
 			bool skipTransparent = kbs_contains_flags(option.flags, ModelLoadOption::SkipTransparent);
+			bool loadOccluders = kbs_contains_flags(option.flags, ModelLoadOption::Occluders);
 
 			if (node->mesh)
 			{
@@ -132,6 +135,26 @@ namespace kbs
 					
 					MeshID meshID = meshPool->CreateMeshFromGroup(meshGroupID, prim->firstVertex, prim->vertexCount, prim->firstIndex, prim->indexCount);
 					primitive.mesh = meshID;
+					for (uint32_t i = 0; i < prim->vertexCount; i++)
+					{
+						primitive.bounds.Merge(vkModel.assambledVertexBuffer[prim->firstVertex + i].inPos);
+					}
+
+					if (loadOccluders && prim->indexCount != 0 && materialSet[primitive.materialSetID].alphaMode == Model::AlphaMode::Opaque)
+					{
+						// the indices of the gltf loader are relative to the start of the model's vertex buffer
+						primitive.occluder = std::make_shared<OccluderMesh>();
+						primitive.occluder->vertices.resize(prim->vertexCount);
+						for (uint32_t i = 0; i < prim->vertexCount; i++)
+						{
+							primitive.occluder->vertices[i] = vkModel.assambledVertexBuffer[prim->firstVertex + i].inPos;
+						}
+						primitive.occluder->indices.resize(prim->indexCount);
+						for (uint32_t i = 0; i < prim->indexCount; i++)
+						{
+							primitive.occluder->indices[i] = vkModel.indexBuffer[prim->firstIndex + i] - prim->firstVertex;
+						}
+					}
 
 					primitiveSet.push_back(primitive);
 					meshPrimitiveId.push_back(primitiveSet.size() - 1);
@@ -151,7 +174,8 @@ namespace kbs
 		
 		ModelID modelID = UUID::GenerateUncollidedID(m_Models);
 		m_Models[modelID] = model;
-		m_ModelPathTable[path] = modelID;
+		// looked up by the absolute path like above
+		m_ModelPathTable[absolutePath] = modelID;
 
 		return modelID;
 }
@@ -231,6 +255,61 @@ opt<ModelID> ModelManager::GetModelByPath(const std::string& path)
 		}
 	}
 
+	static bool ContainsKeyword(const std::string& name, std::initializer_list<const char*> keywords)
+	{
+		std::string lowerName = lower_string(name);
+		for (const char* keyword : keywords)
+		{
+			if (string_contains(lowerName, lower_string(keyword)))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const Model::MaterialBinding& Model::GetMaterialBinding(ShaderID shaderID, ShaderReflection& reflect)
+	{
+		if (auto iter = m_MaterialBindings.find(shaderID); iter != m_MaterialBindings.end())
+		{
+			return iter->second;
+		}
+
+		// every parameter is bound to the first name containing one of its keywords
+		MaterialBinding& binding = m_MaterialBindings[shaderID];
+		auto bindTexture = [&](MaterialBinding::TextureSlot slot, std::initializer_list<const char*> keywords)
+		{
+			reflect.IterateTextures([&](const std::string& name, ShaderReflection::TextureInfo&)
+				{
+					if (!ContainsKeyword(name, keywords)) return true;
+					binding.textures.push_back({ name, slot });
+					return false;
+				}
+			);
+		};
+		auto bindVariable = [&](MaterialBinding::VariableSlot slot, std::initializer_list<const char*> keywords)
+		{
+			reflect.IterateVariables([&](const std::string& name, ShaderReflection::VariableInfo& info)
+				{
+					if (!ContainsKeyword(name, keywords)) return true;
+					binding.variables.push_back({ name, slot, info.type });
+					return false;
+				}
+			);
+		};
+
+		bindTexture(MaterialBinding::BaseColorTexture, { "baseColor", "albedo" });
+		bindTexture(MaterialBinding::DiffuseTexture, { "diffuse" });
+		bindTexture(MaterialBinding::MetallicRoughnessTexture, { "metallic", "roughness" });
+		bindTexture(MaterialBinding::EmissiveTexture, { "emissive" });
+		bindTexture(MaterialBinding::NormalTexture, { "normal" });
+
+		bindVariable(MaterialBinding::BaseColor, { "baseColor", "albedo" });
+		bindVariable(MaterialBinding::Metallic, { "metallic" });
+		bindVariable(MaterialBinding::Roughness, { "roughness" });
+		return binding;
+	}
+
 	opt<ptr<ModelMaterialSet>> Model::CreateMaterialSetForModel(ShaderID targetShaderID, RenderAPI& api)
 	{
 		AssetManager* assetManager = Singleton::GetInstance<AssetManager>();
@@ -244,7 +323,10 @@ opt<ModelID> ModelManager::GetModelByPath(const std::string& path)
 		{
 			return std::nullopt;
 		}
-		auto& reflect =  targetShader->GetShaderReflection();
+		const MaterialBinding& binding = GetMaterialBinding(targetShaderID, targetShader->GetShaderReflection());
+		auto texManager = assetManager->GetTextureManager();
+		TextureID defaultTextures[MaterialBinding::TextureSlotCount] = { texManager->GetDefaultWhite(), texManager->GetDefaultWhite(),
+			texManager->GetDefaultWhite(), texManager->GetDefaultBlack(), texManager->GetDefaultNormal() };
 		
 		std::vector<MaterialID> materials;
 		std::vector<RenderPassFlags> flag;
@@ -254,77 +336,43 @@ opt<ModelID> ModelManager::GetModelByPath(const std::string& path)
 			std::string materialName = m_Name + "_" + std::to_string(i);
 			MaterialID materialID = assetManager->GetMaterialManager()->CreateMaterial(targetShader, api, materialName);
 			ptr<Material> material = assetManager->GetMaterialManager()->GetMaterialByID(materialID).value();
-			
-			auto getMaterialParameterAssignment = [&](std::vector<std::string> keywords, TextureID texID, TextureID defaultTextureID)
+			const MaterialSet& set = m_MaterialSet[i];
+
+			TextureID textures[MaterialBinding::TextureSlotCount] = { set.baseColorTexture, set.diffuseTexture,
+				set.metallicRoughnessTexture, set.emissiveTexture, set.normalTexture };
+			for (auto& texture : binding.textures)
 			{
-				auto tex = assetManager->GetTextureManager()->GetTextureByID(texID);
+				auto tex = texManager->GetTextureByID(textures[texture.slot]);
 				if (!tex.has_value())
 				{
-					tex = assetManager->GetTextureManager()->GetTextureByID(defaultTextureID);
+					tex = texManager->GetTextureByID(defaultTextures[texture.slot]);
 				}
-				
-				
-				return [keywords, material, tex](const std::string& name, ShaderReflection::TextureInfo& _)
+				if (tex.has_value())
 				{
-					if (!tex.has_value())
-					{
-						return false;
-					}
-
-					for (auto& kw : keywords)
-					{
-						if (string_contains(lower_string(name), lower_string(kw)))
-						{
-							material->SetTexture(name, tex.value());
-							return false;
-						}
-					}
-					return true;
-				};
-			};
+					material->SetTexture(texture.name, tex.value());
+				}
+			}
 
-			auto getMaterialVariableAssignment = [&](std::vector<std::string> keywords, vec4 value)
+			vec4 values[MaterialBinding::VariableSlotCount] = { set.baseColor, vec4(set.metallicFactor), vec4(set.roughnessFactor) };
+			for (auto& variable : binding.variables)
 			{
-				return [keywords,material, value](const std::string& name, ShaderReflection::VariableInfo& varInfo)
+				vec4 value = values[variable.slot];
+				switch (variable.type)
 				{
-					for (auto& kw : keywords)
-					{
-						if (string_contains(lower_string(name), lower_string(kw)))
-						{
-							// TODO better way setting variables
-							// duplicated shader variable iteration
-							switch (varInfo.type)
-							{
-							case ShaderReflection::VariableType::Float:
-								material->SetFloat(name, value.x);
-								break;
-							case ShaderReflection::VariableType::Float2:
-								material->SetVec2(name, vec2(value.x, value.y));
-								break;
-							case ShaderReflection::VariableType::Float3:
-								material->SetVec3(name, vec3(value.x, value.y, value.z));
-								break;
-							case ShaderReflection::VariableType::Float4:
-								material->SetVec4(name, value);
-								break;
-							}
-							return false;
-						}
-					}
-					return true;
-				};
-			};
-			auto texManager = assetManager->GetTextureManager();
-
-			reflect.IterateTextures(getMaterialParameterAssignment({"baseColor","albedo"}, m_MaterialSet[i].baseColorTexture, texManager->GetDefaultWhite()));
-			reflect.IterateTextures(getMaterialParameterAssignment({"diffuse"}, m_MaterialSet[i].diffuseTexture, texManager->GetDefaultWhite()));
-			reflect.IterateTextures(getMaterialParameterAssignment({"metallic", "roughness"}, m_MaterialSet[i].metallicRoughnessTexture, texManager->GetDefaultWhite()));
-			reflect.IterateTextures(getMaterialParameterAssignment({"emissive"}, m_MaterialSet[i].emissiveTexture, texManager->GetDefaultBlack()));
-			reflect.IterateTextures(getMaterialParameterAssignment({ "normal" }, m_MaterialSet[i].normalTexture, texManager->GetDefaultNormal()));
-
-			reflect.IterateVariables(getMaterialVariableAssignment({ "baseColor", "albedo" }, m_MaterialSet[i].baseColor));
-			reflect.IterateVariables(getMaterialVariableAssignment({ "metallic" }, vec4(m_MaterialSet[i].metallicFactor)));
-			reflect.IterateVariables(getMaterialVariableAssignment({ "roughness" }, vec4(m_MaterialSet[i].roughnessFactor)));
+				case ShaderReflection::VariableType::Float:
+					material->SetFloat(variable.name, value.x);
+					break;
+				case ShaderReflection::VariableType::Float2:
+					material->SetVec2(variable.name, vec2(value.x, value.y));
+					break;
+				case ShaderReflection::VariableType::Float3:
+					material->SetVec3(variable.name, vec3(value.x, value.y, value.z));
+					break;
+				case ShaderReflection::VariableType::Float4:
+					material->SetVec4(variable.name, value);
+					break;
+				}
+			}
 			
 			materials.push_back(materialID);
 		}
@@ -337,73 +385,105 @@ opt<ModelID> ModelManager::GetModelByPath(const std::string& path)
 		return std::make_shared<ModelMaterialSet>(materials, targetShaderID, flag);
 	}
 
+	RTMaterialID Model::GetRTMaterial(uint32_t materialSetID)
+	{
+		if (m_RTMaterials.empty())
+		{
+			m_RTMaterials.resize(m_MaterialSet.size(), RTMaterialID::Invalid());
+		}
+		if (m_RTMaterials[materialSetID] != RTMaterialID::Invalid())
+		{
+			return m_RTMaterials[materialSetID];
+		}
+
+		const MaterialSet& modelMaterialSet = m_MaterialSet[materialSetID];
+		auto materialManager = Singleton::GetInstance<AssetManager>()->GetMaterialManager();
+		RTMaterialID rtMaterialID = materialManager->CreateRTMaterial(m_Name + "_" + std::to_string(materialSetID) + "_RTMaterial");
+		auto rtMaterial = materialManager->GetRTMaterialByID(rtMaterialID).value();
+
+		rtMaterial->SetDiffuseTexture(modelMaterialSet.baseColorTexture);
+		rtMaterial->SetEmissiveTexture(modelMaterialSet.emissiveTexture);
+		rtMaterial->SetMetallicTexture(modelMaterialSet.metallicRoughnessTexture);
+		rtMaterial->SetNormalTexture(modelMaterialSet.normalTexture);
+
+		PBRMaterialParameter& pbr = rtMaterial->GetMaterialParameter();
+		pbr.albedo = modelMaterialSet.baseColor;
+		pbr.metallic = modelMaterialSet.metallicFactor;
+		pbr.roughness = modelMaterialSet.roughnessFactor;
+
+		m_RTMaterials[materialSetID] = rtMaterialID;
+		return rtMaterialID;
+	}
+
 	Entity Model::Instantiate(ptr<Scene> scene, std::string name, View<ptr<ModelMaterialSet>> materialSets, const TransformComponent& modelTrans, ModelInstantiateOption options)
 	{
-		Entity entity = scene->CreateEntity(name);
-		entity.AddComponent<TransformComponent>(modelTrans);
+		return Instantiate(scene, name, materialSets, std::vector<TransformComponent>{ modelTrans }, options)[0];
+	}
 
-		ptr<MeshPool> meshPool = Singleton::GetInstance<AssetManager>()->GetMeshPool();
+	std::vector<Entity> Model::Instantiate(ptr<Scene> scene, const std::string& name, View<ptr<ModelMaterialSet>> materialSets,
+		const std::vector<TransformComponent>& modelTrans, ModelInstantiateOption options)
+	{
+		KBS_MEMORY_TAG(Scene);
+		bool rayTracing = kbs_contains_flags(options.flags, ModelInstantiateOption::RayTracingSupport);
+		KBS_ASSERT(!rayTracing || m_SupportRayTracing, "Only model loaded with RayTracingSupport flag can be instantiated by ray tracing support");
 
-		for (auto& mesh : m_MeshSet)
+		uint32_t instanceCount = (uint32_t)modelTrans.size();
+		std::vector<Entity> roots = scene->CreateEntities(instanceCount, name);
+		scene->AddComponents(roots, modelTrans.data());
+
+		// every primitive is added to all instances at once, the components only differ by their parent
+		std::vector<TransformComponent> transforms(instanceCount, TransformComponent(vec3(0, 0, 0), quat(), vec3(1, 1, 1)));
+		for (uint32_t i = 0; i < instanceCount; i++)
 		{
-			TransformComponent comp;
-			comp.parent = entity.GetUUID();
-			comp.position = vec3(0, 0, 0);
-			comp.rotation = quat();
-			comp.scale = vec3(1, 1, 1);
+			transforms[i].parent = roots[i].GetUUID();
+		}
+		std::vector<RenderableComponent> renderables;
+		std::vector<BoundsComponent> bounds;
+		std::vector<RayTracingGeometryComponent> rtGeoms;
+		std::vector<OccluderComponent> occluders;
 
+		for (auto& mesh : m_MeshSet)
+		{
 			std::string meshName = name + "_" + mesh.name;
 			for (auto& primID : mesh.primitiveID)
 			{
-				std::string primitiveName = meshName + "_" + std::to_string(primID);
 				Primitive& prim = m_PrimitiveSet[primID];
-				Model::MaterialSet& modelMaterialSet = m_MaterialSet[prim.materialSetID];
 
 				RenderableComponent renderableComp;
-				//renderableComp.targetMaterial = materialSet->GetModelMaterial(prim.materialSetID);
 				renderableComp.targetMesh = prim.mesh;
 				for (auto& materialSet : materialSets)
 				{
 					renderableComp.AddRenderablePass(materialSet->GetModelMaterial(prim.materialSetID),
 						materialSet->GetMaterialRenderPassFlag(prim.materialSetID));
 				}
-			
-				Entity subMeshEntity = scene->CreateEntity(primitiveName);
-				subMeshEntity.AddComponent<TransformComponent>(comp);
-				subMeshEntity.AddComponent<RenderableComponent>(renderableComp);
+				renderables.assign(instanceCount, renderableComp);
+				bounds.assign(instanceCount, BoundsComponent(prim.bounds));
 
-				if (kbs_contains_flags(options.flags, ModelInstantiateOption::RayTracingSupport))
-				{
-					KBS_ASSERT(m_SupportRayTracing, "Only model loaded with RayTracingSupport flag can be instantiated by ray tracing support");
-					RayTracingGeometryComponent rtGeom;
-					rtGeom.opaque = modelMaterialSet.alphaMode == AlphaMode::Opaque;
-						
-					std::string rtMaterialSetName = primitiveName + "_RTMaterial";
-					AssetManager* assetManager = Singleton::GetInstance<AssetManager>();
-					auto materialManager = assetManager->GetMaterialManager();
-					
-				    auto rtMaterialID = materialManager->CreateRTMaterial(rtMaterialSetName);
-					auto rtMaterial = materialManager->GetRTMaterialByID(rtMaterialID).value();
-
-					rtMaterial->SetDiffuseTexture(modelMaterialSet.baseColorTexture);
-					rtMaterial->SetEmissiveTexture(modelMaterialSet.emissiveTexture);
-					rtMaterial->SetMetallicTexture(modelMaterialSet.metallicRoughnessTexture);
-					rtMaterial->SetNormalTexture(modelMaterialSet.normalTexture);
-
-					PBRMaterialParameter& pbr = rtMaterial->GetMaterialParameter();
-					pbr.albedo = modelMaterialSet.baseColor;
-					pbr.metallic = modelMaterialSet.metallicFactor;
-					pbr.roughness = modelMaterialSet.roughnessFactor;
+				std::vector<Entity> subMeshEntities = scene->CreateEntities(instanceCount, meshName + "_" + std::to_string(primID));
+				scene->AddComponents(subMeshEntities, transforms.data());
+				scene->AddComponents(subMeshEntities, renderables.data());
+				scene->AddComponents(subMeshEntities, bounds.data());
 
+				if (prim.occluder != nullptr)
+				{
+					occluders.assign(instanceCount, OccluderComponent(prim.occluder));
+					scene->AddComponents(subMeshEntities, occluders.data());
+				}
 
-					rtGeom.rayTracingMaterial = rtMaterialID;
-					subMeshEntity.AddComponent<RayTracingGeometryComponent>(rtGeom);
+				if (rayTracing)
+				{
+					RayTracingGeometryComponent rtGeom;
+					rtGeom.opaque = m_MaterialSet[prim.materialSetID].alphaMode == AlphaMode::Opaque;
+					rtGeom.rayTracingMaterial = GetRTMaterial(prim.materialSetID);
+					rtGeoms.assign(instanceCount, rtGeom);
+					scene->AddComponents(subMeshEntities, rtGeoms.data());
 				}
 			}
 		}
 
-		return entity;
+		return roots;
 	}
+
 	Entity Model::Instantiate(ptr<Scene> scene, std::string name, ptr<ModelMaterialSet> materialSet, const TransformComponent& modelTrans, ModelInstantiateOption options)
 	{
 		return Instantiate(scene, name, View(&materialSet, 1), modelTrans, options);
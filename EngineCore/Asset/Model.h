@@ -48,7 +48,9 @@ namespace kbs
         {
             RayTracingSupport = 0x1,
             SkipOpaque = 0x2,
-            SkipTransparent = 0x4
+            SkipTransparent = 0x4,
+            // keeps a cpu copy of the opaque primitives, instances hide the objects behind them from occlusion culling
+            Occluders = 0x8
         };
         uint64_t flags = 0;
     };
@@ -81,6 +83,10 @@ namespace kbs
         {
             MeshID      mesh;
             uint32_t    materialSetID;
+            // bounds of the vertices in the space of the model
+            AABB        bounds;
+            // null unless the model is loaded with the Occluders flag and the primitive is opaque
+            ptr<OccluderMesh> occluder;
         };
 
         struct Mesh
@@ -96,18 +102,54 @@ namespace kbs
         Model(std::vector<TextureID>      textureSet, std::vector<MaterialSet>    materialSet, std::vector<Primitive>      primitiveSet, std::vector<Model::Mesh>           meshSet, const std::string& name,
             ModelLoadOption option);
         
+        // the shader textures and variables the materials are written to are looked up once per shader
         opt<ptr<ModelMaterialSet>> CreateMaterialSetForModel(ShaderID targetShader, RenderAPI& api);
 
         Entity Instantiate(ptr<Scene> scene, std::string name, View<ptr<ModelMaterialSet>> materialSet,const TransformComponent& modelTrans, ModelInstantiateOption options);
         Entity Instantiate(ptr<Scene> scene, std::string name, ptr<ModelMaterialSet> materialSet, const TransformComponent& modelTrans, ModelInstantiateOption options = ModelInstantiateOption{});
+        // instantiates the model once per transform and returns the root entity of every instance.
+        // the entities are created with one registry insertion per component type and primitive,
+        // all instances share the materials of the material sets and the ray tracing materials of the model
+        std::vector<Entity> Instantiate(ptr<Scene> scene, const std::string& name, View<ptr<ModelMaterialSet>> materialSet,
+            const std::vector<TransformComponent>& modelTrans, ModelInstantiateOption options = ModelInstantiateOption{});
+
+        const std::vector<Primitive>& GetPrimitives() { return m_PrimitiveSet; }
 
     private:
+        // names of the shader textures and variables matching the parameters of the material sets
+        struct MaterialBinding
+        {
+            enum TextureSlot { BaseColorTexture, DiffuseTexture, MetallicRoughnessTexture, EmissiveTexture, NormalTexture, TextureSlotCount };
+            enum VariableSlot { BaseColor, Metallic, Roughness, VariableSlotCount };
+
+            struct Texture
+            {
+                std::string name;
+                TextureSlot slot;
+            };
+            struct Variable
+            {
+                std::string                    name;
+                VariableSlot                   slot;
+                ShaderReflection::VariableType type;
+            };
+
+            std::vector<Texture>  textures;
+            std::vector<Variable> variables;
+        };
+
+        const MaterialBinding& GetMaterialBinding(ShaderID shaderID, ShaderReflection& reflect);
+        // created on the first instantiation with ray tracing support
+        RTMaterialID GetRTMaterial(uint32_t materialSetID);
+
         std::vector<TextureID>      m_TextureSet;
         std::vector<MaterialSet>    m_MaterialSet;
         std::vector<Primitive>      m_PrimitiveSet;
         std::vector<Mesh>           m_MeshSet;
         ModelID                     m_ModelID;
         std::string                 m_Name;
+        std::unordered_map<ShaderID, MaterialBinding> m_MaterialBindings;
+        std::vector<RTMaterialID>   m_RTMaterials;
 
         bool                        m_SupportRayTracing : 1;
     };
@@ -122,6 +164,8 @@ namespace kbs
 
         opt<ptr<Model>> GetModel(ModelID model);
         opt<ModelID> GetModelByPath(const std::string& path);
+        // absolute path -> model
+        const std::unordered_map<std::string, ModelID>& GetModelPaths() { return m_ModelPathTable; }
 
     private:
         std::unordered_map<ModelID, ptr<Model>> m_Models;
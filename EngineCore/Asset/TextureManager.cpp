@@ -4,6 +4,7 @@
 #include "stb_image.h"
 #include "Core/FileSystem.h"
 #include "Asset/AssetManager.h"
+#include "Core/MemoryTracker.h"
 namespace fs = std::filesystem;
 
 namespace kbs
@@ -78,8 +79,8 @@ namespace kbs
         {
             return std::nullopt;
         }
-        TextureID id = UUID::GenerateUncollidedID(m_Textures);
-        m_Textures[id] = std::make_shared<ManagedTexture>(image, sampler, view, fullPath, id);
+        TextureID id = UUID::GenerateUncollidedID(m_TextureHandles);
+        m_TextureHandles[id] = m_Textures.Insert(std::make_shared<ManagedTexture>(image, sampler, view, fullPath, id));
         m_TextureByPath[fullPath] = id;
 
         return id;
@@ -87,6 +88,7 @@ namespace kbs
 
 	kbs::opt<kbs::TextureID> TextureManager::Load(const std::string& path, RenderAPI& api, opt<TextureLoadOption> option, opt<GvkSamplerCreateInfo> samplerInfo /*= GvkSamplerCreateInfo(VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR)*/)
 	{
+        KBS_MEMORY_TAG(Asset);
         TextureLoadOption loadOption;
         if (option.has_value())
         {
@@ -105,18 +107,19 @@ namespace kbs
 
 
         auto* fileSystem = Singleton::GetInstance<FileSystem<TextureManager>>();
-        std::string absolutePath;
-        if (auto var = fileSystem->FindAbsolutePath(path); var.has_value())
+        FileBlob content;
+        if (auto var = fileSystem->ReadFile(path); var.has_value())
         {
-            absolutePath = var.value();
+            content = var.value();
         }
         else
         {
             return std::nullopt;
         }
 
+        // decoded straight from the mapped file or pack
         int width, height, comp = 0;
-        void* image = stbi_load(absolutePath.c_str(),&width, &height, &comp, 4);
+        void* image = stbi_load_from_memory(content.data, (int)content.size, &width, &height, &comp, 4);
         GvkImageCreateInfo imageCreateInfo = GvkImageCreateInfo::Image2D(VK_FORMAT_R8G8B8A8_UNORM, width, height, 
             VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 
@@ -205,11 +208,23 @@ namespace kbs
     */
     opt<ptr<ManagedTexture>> TextureManager::GetTextureByID(TextureID id)
     {
-        if (!m_Textures.count(id))
+        if (ptr<ManagedTexture>* texture = m_Textures.Get(GetTextureHandle(id)))
         {
-            return std::nullopt;
+            return *texture;
         }
-        return m_Textures[id];
+        return std::nullopt;
+    }
+
+    TextureHandle TextureManager::GetTextureHandle(TextureID id)
+    {
+        auto iter = m_TextureHandles.find(id);
+        return iter != m_TextureHandles.end() ? iter->second : TextureHandle{};
+    }
+
+    ManagedTexture* TextureManager::GetTexture(TextureHandle handle)
+    {
+        ptr<ManagedTexture>* texture = m_Textures.Get(handle);
+        return texture != nullptr ? texture->get() : nullptr;
     }
 
     opt<ptr<ManagedTexture>> TextureManager::GetTextureByPath(const std::string& path)
@@ -219,7 +234,7 @@ namespace kbs
         {
             return std::nullopt;
         }
-        return  m_Textures[m_TextureByPath[fullPath]];
+        return GetTextureByID(m_TextureByPath[fullPath]);
     }
 
 	kbs::TextureID TextureManager::GetDefaultWhite()
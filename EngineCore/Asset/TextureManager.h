@@ -1,11 +1,14 @@
 #pragma once
 #include "Scene/UUID.h"
+#include "Core/SlotMap.h"
 #include "Renderer/RenderResource.h"
 
 namespace kbs
 {
 	using TextureID = UUID;
 	class RenderAPI;
+	class ManagedTexture;
+	using TextureHandle = SlotHandle<ptr<ManagedTexture>>;
 
 	class ManagedTexture : public Texture
 	{
@@ -37,6 +40,9 @@ namespace kbs
 		opt<TextureID> Load(const std::string& path, RenderAPI& api, opt<TextureLoadOption> option, opt<GvkSamplerCreateInfo> samplerInfo);
 		opt<ptr<ManagedTexture>> GetTextureByID(TextureID id);
 		opt<ptr<ManagedTexture>> GetTextureByPath(const std::string& path);
+		// handle lookups don't hash, the returned pointers are valid until a texture is added
+		TextureHandle			 GetTextureHandle(TextureID id);
+		ManagedTexture*			 GetTexture(TextureHandle handle);
 
 		TextureID	GetDefaultWhite();
 		TextureID	GetDefaultNormal();
@@ -47,7 +53,8 @@ namespace kbs
 		TextureID		m_DefaultTextureBlack;
 		TextureID		m_DefaultTextureNormal;
 
-		std::unordered_map<TextureID, ptr<ManagedTexture>> m_Textures;
+		SlotMap<ptr<ManagedTexture>> m_Textures;
+		std::unordered_map<TextureID, TextureHandle> m_TextureHandles;
 		std::unordered_map<std::string, TextureID> m_TextureByPath;
 	};
 
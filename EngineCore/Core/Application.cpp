@@ -1,5 +1,12 @@
 #include "Core/Application.h"
 #include "Core/Log.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Core/FrameStatistics.h"
+#include "Core/VirtualFileSystem.h"
+#include "Core/MemoryTracker.h"
+#include <chrono>
+#include <stdexcept>
 
 
 KBS_API kbs::Application::Application(ApplicationCommandLine& commandLine)
@@ -7,9 +14,69 @@ KBS_API kbs::Application::Application(ApplicationCommandLine& commandLine)
 	m_WindowWidth = 600, m_WindowHeight = 600;
 
 	m_Title = "kbs";
+	LogOverflowPolicy logPolicy = LogOverflowPolicy::Block;
+	// records are written on the calling thread unless an async log mode is asked for
+	bool asyncLog = false;
 	for (int i = 0;i < commandLine.commands.size(); i++)
 	{
-		if (commandLine.commands[i].substr(0,2) == "-r")
+		// whole word parameters are checked first, "-report=" would be taken as a resolution and "-pack=" as a trace path otherwise
+		if (commandLine.commands[i] == "-headless")
+		{
+			m_Headless = true;
+		}
+		else if (commandLine.commands[i].substr(0, 8) == "-frames=")
+		{
+			std::string frameCountStr = commandLine.commands[i].substr(8, commandLine.commands[i].size() - 8);
+			try
+			{
+				m_FrameLimit = std::stoi(frameCountStr);
+			}
+			catch (...)
+			{
+				KBS_WARN("invalid frame count parameter {} : valid useage -frames=[FrameCount]", commandLine.commands[i].c_str());
+				continue;
+			}
+		}
+		else if (commandLine.commands[i].substr(0, 8) == "-warmup=")
+		{
+			std::string frameCountStr = commandLine.commands[i].substr(8, commandLine.commands[i].size() - 8);
+			try
+			{
+				m_WarmupFrames = std::stoi(frameCountStr);
+			}
+			catch (...)
+			{
+				KBS_WARN("invalid warmup frame count parameter {} : valid useage -warmup=[FrameCount]", commandLine.commands[i].c_str());
+				continue;
+			}
+		}
+		else if (commandLine.commands[i].substr(0, 8) == "-memory=")
+		{
+			// csv of the heap usage per memory tag, one line per frame
+			std::string dumpPath = commandLine.commands[i].substr(8, commandLine.commands[i].size() - 8);
+			if (!MemoryTracker::IsEnabled())
+			{
+				KBS_WARN("memory tracking is compiled out, {} is ignored", commandLine.commands[i].c_str());
+			}
+			else
+			{
+				Singleton::GetInstance<MemoryTracker>()->SetFrameDumpPath(dumpPath);
+			}
+		}
+		else if (commandLine.commands[i].substr(0, 8) == "-report=")
+		{
+			m_ReportPath = commandLine.commands[i].substr(8, commandLine.commands[i].size() - 8);
+		}
+		else if (commandLine.commands[i].substr(0, 6) == "-pack=")
+		{
+			// the pack's files are found as if they were extracted next to the pack file
+			std::string packPath = commandLine.commands[i].substr(6, commandLine.commands[i].size() - 6);
+			if (!Singleton::GetInstance<VirtualFileSystem>()->Mount(packPath))
+			{
+				KBS_WARN("fail to mount pack file {} : valid useage -pack=[PackFilePath]", commandLine.commands[i].c_str());
+			}
+		}
+		else if (commandLine.commands[i].substr(0,2) == "-r")
 		{
 			std::string resolutionStr = commandLine.commands[i].substr(2, commandLine.commands[i].size() - 2);
 			std::vector<std::string> splitedResolutionStr = string_split(resolutionStr, 'x');
@@ -36,12 +103,69 @@ KBS_API kbs::Application::Application(ApplicationCommandLine& commandLine)
 			std::string resolutionStr = commandLine.commands[i].substr(2, commandLine.commands[i].size() - 2);
 			m_Title = resolutionStr;
 		}
+		else if (commandLine.commands[i].substr(0, 2) == "-l")
+		{
+			std::string logMode = commandLine.commands[i].substr(2, commandLine.commands[i].size() - 2);
+			if (logMode == "sync") asyncLog = false;
+			else if (logMode == "block") logPolicy = LogOverflowPolicy::Block;
+			else if (logMode == "drop") logPolicy = LogOverflowPolicy::Drop;
+			else if (logMode == "count") logPolicy = LogOverflowPolicy::DropAndCount;
+			else
+			{
+				KBS_WARN("invalid log mode parameter {} : valid useage -l[sync|block|drop|count]", commandLine.commands[i].c_str());
+				continue;
+			}
+			// the other modes write on a background thread and differ in what a producer does when the queue is full
+			asyncLog = logMode != "sync";
+		}
+		else if (commandLine.commands[i].substr(0, 2) == "-p")
+		{
+			// chrome trace of the profiled zones, written when the application exits
+			std::string tracePath = commandLine.commands[i].substr(2, commandLine.commands[i].size() - 2);
+			Singleton::GetInstance<Profiler>()->SetTraceOutputPath(tracePath);
+		}
+		else if (commandLine.commands[i].substr(0, 2) == "-j")
+		{
+			std::string threadCountStr = commandLine.commands[i].substr(2, commandLine.commands[i].size() - 2);
+			int threadCount = 0;
+			try
+			{
+				size_t parsed = 0;
+				threadCount = std::stoi(threadCountStr, &parsed);
+				if (parsed != threadCountStr.size() || threadCount < 0)
+				{
+					throw std::invalid_argument(threadCountStr);
+				}
+			}
+			catch (...)
+			{
+				KBS_WARN("invalid job thread count parameter {} : valid useage -j[WorkerThreadCount]", commandLine.commands[i].c_str());
+				continue;
+			}
+			if (threadCount > maxJobThreadCount)
+			{
+				KBS_WARN("job thread count parameter {} is clamped to {} worker threads", commandLine.commands[i].c_str(), maxJobThreadCount);
+				threadCount = maxJobThreadCount;
+			}
+			m_JobThreadCount = (uint32_t)threadCount;
+		}
 		else
 		{
 			KBS_WARN("unknown command line parameter {}", commandLine.commands[i].c_str());
 		}
+	}
+	m_Timer = std::make_shared<Timer>();
 
-		m_Timer = std::make_shared<Timer>();
+	if (m_Headless && m_FrameLimit == 0)
+	{
+		KBS_WARN("headless mode without -frames=[FrameCount], the application will run {} frames", defaultHeadlessFrameCount);
+		m_FrameLimit = defaultHeadlessFrameCount;
+	}
+
+	// loading paths log a lot of warnings, writing them on a background thread keeps the caller from stalling
+	if (asyncLog)
+	{
+		_GetGlobalLogger()->EnableAsync(logPolicy);
 	}
 }
 
@@ -58,8 +182,9 @@ KBS_API void kbs::Application::OnUpdate()
 KBS_API int kbs::Application::Run()
 {
 	//m_EventManager = std::make_shared<kbs::EventManager>();
+	Singleton::GetInstance<JobSystem>()->Initialize(m_JobThreadCount);
 	m_LayerManager = std::make_shared<kbs::LayerManager>();
-	m_Window = std::make_shared<kbs::Window>(m_WindowWidth, m_WindowHeight, this, m_Title.c_str());
+	m_Window = std::make_shared<kbs::Window>(m_WindowWidth, m_WindowHeight, this, m_Title.c_str(), m_Headless);
 
 	m_LayerManager->ListenToEvents<KeyDownEvent, KeyHoldEvent, KeyReleasedEvent, MouseButtonEvent, MouseButtonDownEvent,
 		MouseButtonReleasedEvent, MouseMovedEvent, WindowResizeEvent, WindowCloseEvent>(Singleton::GetInstance<EventManager>());
@@ -68,12 +193,43 @@ KBS_API int kbs::Application::Run()
 
 	kbs::Singleton::GetInstance<kbs::EventManager>()->BoardcastEvent(kbs::WindowResizeEvent(m_Window->GetWidth(), m_Window->GetHeight()));
 
-	while (true)
+	FrameTimeRecorder frameTimes;
+	frameTimes.Reserve(m_FrameLimit);
+
+	for (uint32_t frame = 0; m_FrameLimit == 0 || frame < m_FrameLimit; frame++)
 	{
-		OnUpdate();
-		m_Window->Update();
+		auto frameStart = std::chrono::steady_clock::now();
+		KBS_PROFILE_BEGIN_FRAME();
+		{
+			KBS_PROFILE_SCOPE("Application::OnUpdate");
+			OnUpdate();
+		}
+		{
+			KBS_PROFILE_SCOPE("Window::Update");
+			m_Window->Update();
+		}
+		{
+			KBS_PROFILE_SCOPE("DispatchQueuedEvents");
+			Singleton::GetInstance<EventManager>()->DispatchQueuedEvents();
+		}
 		m_Timer->Tick();
+		KBS_PROFILE_END_FRAME();
+		Singleton::GetInstance<MemoryTracker>()->EndFrame(frame);
+		frameTimes.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+	}
+
+	FrameTimeReport report = frameTimes.BuildReport(m_WarmupFrames);
+	KBS_LOG("{} frames, cpu frame time mean {:.3f}ms p50 {:.3f}ms p95 {:.3f}ms p99 {:.3f}ms", report.frameCount,
+		report.meanMs, report.p50Ms, report.p95Ms, report.p99Ms);
+	if (!m_ReportPath.empty())
+	{
+		frameTimes.WriteJson(m_ReportPath, m_WarmupFrames);
+	}
+	if (MemoryTracker::IsEnabled())
+	{
+		Singleton::GetInstance<MemoryTracker>()->LogSummary();
 	}
+	KBS_FLUSH_LOG();
 
 	return 0;
 }
@@ -5,6 +5,7 @@
 #include "Core/LayerManager.h"
 #include "Core/Window.h"
 #include "Core/Timer.h"
+#include "Core/JobSystem.h"
 
 namespace kbs
 {
@@ -30,6 +31,14 @@ namespace kbs
 			eventManager->BoardcastEvent(T(args...));
 		}
 
+		// the event will be dispatched after the window update of this frame
+		template<typename T, typename...Args>
+		void QueueEvent(Args...args)
+		{
+			EventManager* eventManager = Singleton::GetInstance<EventManager>();
+			eventManager->QueueEvent<T>(args...);
+		}
+
 		template<typename T>
 		void AddListener(std::function<void(const T&)> eventListener)
 		{
@@ -52,7 +61,18 @@ namespace kbs
 
 		int m_WindowWidth;
 		int m_WindowHeight;
+		// worker threads of the job system, picked by hardware concurrency unless -j is given
+		uint32_t m_JobThreadCount = JobSystem::autoThreadCount;
+		static constexpr int maxJobThreadCount = 256;
 		std::string m_Title;
+
+		// headless runs have no window or swapchain and stop after m_FrameLimit frames, 0 runs forever
+		static constexpr uint32_t defaultHeadlessFrameCount = 1000;
+		bool m_Headless = false;
+		uint32_t m_FrameLimit = 0;
+		// the first frames compile pipelines and upload resources, they are left out of the report
+		uint32_t m_WarmupFrames = 0;
+		std::string m_ReportPath;
 	};
 
 	extern Application* CreateApplication(ApplicationCommandLine& commandLines);
@@ -1,4 +1,6 @@
 #include "Event.h"
+#include "Core/Log.h"
+#include <atomic>
 
 /*
 GVK_KEY_A, GVK_KEY_B, GVK_KEY_C, GVK_KEY_D, GVK_KEY_E, GVK_KEY_F, GVK_KEY_G, GVK_KEY_H,
@@ -14,4 +16,91 @@ GVK_KEY_NUM
 */
 std::vector<std::string> kbs::g_keyCodeStringTable = { "A","B","C","D","E","F","G","H","I","J","K","L","M","N","O","P","Q",
 "R","S","T","U","V","W","X","Y","Z","1","2","3","4","5","6","7","8","9","0", "MOUSE_1","MOUSE_2","MOUSE_3","SPACE","SHIFT", "ESCAPE","ENTER",
-"TAB","BACKSPACE","PRINT_SCREEN","CONTROL","RIGHT","LEFT","DOWN","UP","","","","","","",""};
\ No newline at end of file
+"TAB","BACKSPACE","PRINT_SCREEN","CONTROL","RIGHT","LEFT","DOWN","UP","","","","","","",""};
+
+namespace kbs
+{
+	uint32_t _AllocateEventTypeIndex()
+	{
+		static std::atomic<uint32_t> counter{ 0 };
+		return counter++;
+	}
+
+	EventManager::~EventManager()
+	{
+		for (auto& queue : m_Queues)
+		{
+			for (QueuedEventHeader* e = queue.GetFirst(); e != nullptr; e = e->next)
+			{
+				e->destroy(e);
+			}
+			queue.Reset();
+		}
+	}
+
+	void EventManager::DispatchQueuedEvents()
+	{
+		EventQueue& queue = m_Queues[m_WriteQueue];
+		// listeners queuing new events write to the other queue
+		m_WriteQueue = 1 - m_WriteQueue;
+
+		for (QueuedEventHeader* e = queue.GetFirst(); e != nullptr; e = e->next)
+		{
+			e->dispatch(this, e);
+			e->destroy(e);
+		}
+		queue.Reset();
+	}
+
+	uint32_t EventManager::GetQueuedEventCount()
+	{
+		return m_Queues[m_WriteQueue].GetCount();
+	}
+
+	void* EventManager::EventQueue::Allocate(size_t size, size_t alignment)
+	{
+		KBS_ASSERT(size <= blockSize, "event of size {} is too large to be queued", size);
+
+		while (true)
+		{
+			if (m_CurrentBlock == m_Blocks.size())
+			{
+				m_Blocks.push_back(std::make_unique<uint8_t[]>(blockSize));
+			}
+
+			uintptr_t base = reinterpret_cast<uintptr_t>(m_Blocks[m_CurrentBlock].get());
+			uintptr_t start = (base + m_BlockOffset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			if (start + size <= base + blockSize)
+			{
+				m_BlockOffset = start + size - base;
+				return reinterpret_cast<void*>(start);
+			}
+
+			m_CurrentBlock++;
+			m_BlockOffset = 0;
+		}
+	}
+
+	void EventManager::EventQueue::Link(QueuedEventHeader* header)
+	{
+		if (m_Last == nullptr)
+		{
+			m_First = header;
+		}
+		else
+		{
+			m_Last->next = header;
+		}
+		m_Last = header;
+		m_Count++;
+	}
+
+	void EventManager::EventQueue::Reset()
+	{
+		m_CurrentBlock = 0;
+		m_BlockOffset = 0;
+		m_First = nullptr;
+		m_Last = nullptr;
+		m_Count = 0;
+	}
+}
@@ -2,18 +2,18 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 
 #include "Core/Singleton.h"
+#include "Platform/Platform.h"
 #include "gvk_window.h"
 
 namespace kbs
 {
 	//mostly copied from hazel
 	
-	// Events in Hazel are currently blocking, meaning when an event occurs it
-	// immediately gets dispatched and must be dealt with right then an there.
-	// For the future, a better strategy might be to buffer events in an event
-	// bus and process them during the "event" part of the update stage.
+	// Events can either be dispatched right away by BoardcastEvent or be buffered
+	// by QueueEvent and dispatched once per frame by DispatchQueuedEvents.
 
 	enum class EventType
 	{
@@ -62,45 +62,137 @@ namespace kbs
 		}
 	};
 
+	// dense index per event type, listeners are looked up by array index instead of the event name
+	KBS_API uint32_t _AllocateEventTypeIndex();
+
+	template<typename T>
+	struct EventTypeIndex
+	{
+		static uint32_t Get()
+		{
+			static const uint32_t index = _AllocateEventTypeIndex();
+			return index;
+		}
+	};
+
 	class EventManager : public Is_Singleton
 	{
 	public:
 		using EventCallback = std::function<void(const Event&)>;
 
+		EventManager() = default;
+		~EventManager();
+
 		template<typename T>
 		void AddListener(std::function<void(const T&)> eventCallback)
 		{
 			static_assert(std::is_base_of_v<Event, T>, "listener must listen to a event object");
 
-			auto wapper = [eventCallback](const Event& e)
+			uint32_t typeIndex = EventTypeIndex<T>::Get();
+			if (typeIndex >= m_ListenerTable.size())
 			{
-				const T& tEvent = static_cast<const T&>(e);
-				eventCallback(tEvent);
-			};
-			
-			std::string eventClassName = T::GetName();
-			if (!m_CallbackTable.count(eventClassName))
+				m_ListenerTable.resize(typeIndex + 1);
+			}
+			if (m_ListenerTable[typeIndex] == nullptr)
 			{
-				m_CallbackTable[eventClassName] = std::vector<EventCallback>{};
+				m_ListenerTable[typeIndex] = std::make_unique<ListenerList<T>>();
 			}
 
-			m_CallbackTable[eventClassName].push_back(wapper);
+			static_cast<ListenerList<T>*>(m_ListenerTable[typeIndex].get())->callbacks.push_back(std::move(eventCallback));
 		}
 
+		// dispatches the event to the listeners right away
 		template<typename T>
 		void BoardcastEvent(const T& e)
 		{
-			if (m_CallbackTable.count(e.GetName()))
+			uint32_t typeIndex = EventTypeIndex<T>::Get();
+			if (typeIndex >= m_ListenerTable.size() || m_ListenerTable[typeIndex] == nullptr)
 			{
-				for (auto& callback : m_CallbackTable[e.GetName()])
-				{
-					callback(e);
-				}
+				return;
 			}
+
+			auto& callbacks = static_cast<ListenerList<T>*>(m_ListenerTable[typeIndex].get())->callbacks;
+			// listeners may add listeners while being called, don't hold iterators
+			for (size_t i = 0; i < callbacks.size(); i++)
+			{
+				callbacks[i](e);
+			}
+		}
+
+		// stores the event and dispatches it in DispatchQueuedEvents, should only be called from the main thread.
+		// the queue memory is reused between frames so queuing doesn't allocate once it has warmed up
+		template<typename T, typename ...Args>
+		void QueueEvent(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<Event, T>, "only event object can be queued");
+
+			constexpr size_t alignment = alignof(T) > alignof(QueuedEventHeader) ? alignof(T) : alignof(QueuedEventHeader);
+			void* memory = m_Queues[m_WriteQueue].Allocate(sizeof(QueuedEventHeader) + sizeof(T) + alignment, alignment);
+
+			QueuedEventHeader* header = new (memory) QueuedEventHeader();
+			header->dispatch = [](EventManager* manager, QueuedEventHeader* h) { manager->BoardcastEvent<T>(*h->GetPayload<T>()); };
+			header->destroy = [](QueuedEventHeader* h) { h->GetPayload<T>()->~T(); };
+			new (header->GetPayload<T>()) T(std::forward<Args>(args)...);
+
+			m_Queues[m_WriteQueue].Link(header);
 		}
 
+		// dispatches every queued event in queue order, events queued by listeners are delayed to the next call
+		void DispatchQueuedEvents();
+		uint32_t GetQueuedEventCount();
+
 	private:
-		std::unordered_map<std::string, std::vector<EventCallback>> m_CallbackTable;
+		struct ListenerListBase
+		{
+			virtual ~ListenerListBase() = default;
+		};
+
+		template<typename T>
+		struct ListenerList : public ListenerListBase
+		{
+			std::vector<std::function<void(const T&)>> callbacks;
+		};
+
+		struct QueuedEventHeader
+		{
+			void (*dispatch)(EventManager*, QueuedEventHeader*) = nullptr;
+			void (*destroy)(QueuedEventHeader*) = nullptr;
+			QueuedEventHeader* next = nullptr;
+
+			template<typename T>
+			T* GetPayload()
+			{
+				uintptr_t payload = reinterpret_cast<uintptr_t>(this + 1);
+				return reinterpret_cast<T*>((payload + alignof(T) - 1) & ~(uintptr_t)(alignof(T) - 1));
+			}
+		};
+
+		// a list of fixed size blocks, blocks are kept after Reset so a frame's events never allocate twice
+		class EventQueue
+		{
+		public:
+			static constexpr size_t blockSize = 16 * 1024;
+
+			void* Allocate(size_t size, size_t alignment);
+			void  Link(QueuedEventHeader* header);
+			void  Reset();
+
+			QueuedEventHeader* GetFirst() { return m_First; }
+			uint32_t		   GetCount() { return m_Count; }
+		private:
+			std::vector<std::unique_ptr<uint8_t[]>> m_Blocks;
+			size_t m_CurrentBlock = 0;
+			size_t m_BlockOffset = 0;
+
+			QueuedEventHeader* m_First = nullptr;
+			QueuedEventHeader* m_Last = nullptr;
+			uint32_t		   m_Count = 0;
+		};
+
+		std::vector<std::unique_ptr<ListenerListBase>> m_ListenerTable;
+
+		EventQueue m_Queues[2];
+		uint32_t   m_WriteQueue = 0;
 	};
 
 	extern std::vector<std::string> g_keyCodeStringTable;
@@ -1,6 +1,8 @@
 #include "Common.h"
 #include "Core/Singleton.h"
+#include "Core/VirtualFileSystem.h"
 #include <filesystem>
+#include <mutex>
 
 namespace kbs
 {
@@ -20,12 +22,15 @@ namespace kbs
 			KBS_ASSERT(p.is_absolute(), "path added to filesystem's search path must be absolute");
 			KBS_ASSERT(fs::is_directory(p), "path added to filesystem's search path must be a valid directory");
 
+			std::lock_guard lock(m_Lock);
 			if (std::find(m_SearchPathes.begin(), m_SearchPathes.end(), _path) == m_SearchPathes.end())
 			{
+				// appended pathes have the lowest priority, cached results stay valid
 				m_SearchPathes.push_back(_path);
 			}
 		}
 
+		// resolved pathes are cached, files removed from the disk afterwards are still reported
 		opt<std::string> FindAbsolutePath(const std::string& path)
 		{
 			namespace fs = std::filesystem;
@@ -34,18 +39,44 @@ namespace kbs
 			{
 				return path;
 			}
+
+			std::lock_guard lock(m_Lock);
+			if (auto iter = m_ResolvedPathes.find(path); iter != m_ResolvedPathes.end())
+			{
+				return iter->second;
+			}
+
+			VirtualFileSystem* vfs = Singleton::GetInstance<VirtualFileSystem>();
 			for (auto& s : m_SearchPathes)
 			{
 				auto searchedPath = fs::path(s) / path;
-				if (fs::exists(searchedPath))
+				if (vfs->Contains(searchedPath.string()) || fs::exists(searchedPath))
 				{
-					return searchedPath.string();
+					std::string absolutePath = searchedPath.string();
+					m_ResolvedPathes[path] = absolutePath;
+					return absolutePath;
 				}
 			}
 
 			return std::nullopt;
 		}
 
+		// content of the file from a mounted pack or memory mapped from the disk
+		opt<FileBlob> ReadFile(const std::string& path)
+		{
+			if (auto absolutePath = FindAbsolutePath(path); absolutePath.has_value())
+			{
+				return Singleton::GetInstance<VirtualFileSystem>()->Open(absolutePath.value());
+			}
+			return std::nullopt;
+		}
+
+		void ClearPathCache()
+		{
+			std::lock_guard lock(m_Lock);
+			m_ResolvedPathes.clear();
+		}
+
 		View<std::string> GetSearchPathes()
 		{
 			return View(m_SearchPathes);
@@ -59,7 +90,9 @@ namespace kbs
 		}
 
 	private:
+		std::mutex m_Lock;
 		std::vector<std::string> m_SearchPathes;
+		std::unordered_map<std::string, std::string> m_ResolvedPathes;
 	};
 
 }
\ No newline at end of file
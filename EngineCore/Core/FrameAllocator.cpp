@@ -0,0 +1,87 @@
+#include "Core/FrameAllocator.h"
+#include <cstdlib>
+
+namespace kbs
+{
+	LinearArena::LinearArena(uint64_t initialCapacity)
+	{
+		// growing the block list allocates, keep it out of the frame loop
+		m_Blocks.reserve(16);
+		AddBlock(initialCapacity);
+	}
+
+	LinearArena::~LinearArena()
+	{
+		ReleaseBlocks();
+	}
+
+	void* LinearArena::Allocate(uint64_t size, uint64_t alignment)
+	{
+		KBS_ASSERT((alignment & (alignment - 1)) == 0, "alignment {} is not a power of two", alignment);
+
+		while (true)
+		{
+			Block& block = m_Blocks[m_CurrentBlock];
+			uintptr_t base = (uintptr_t)block.memory;
+			uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			uint64_t end = aligned - base + size;
+			if (end <= block.size)
+			{
+				m_UsedSize += end - m_Offset;
+				m_Offset = end;
+				return (void*)aligned;
+			}
+
+			m_CurrentBlock++;
+			m_Offset = 0;
+			if (m_CurrentBlock == m_Blocks.size())
+			{
+				AddBlock(std::max(size + alignment, block.size * 2));
+			}
+		}
+	}
+
+	void LinearArena::Reset()
+	{
+		if (m_Blocks.size() > 1)
+		{
+			uint64_t capacity = GetCapacity();
+			ReleaseBlocks();
+			AddBlock(capacity);
+		}
+		m_CurrentBlock = 0;
+		m_Offset = 0;
+		m_UsedSize = 0;
+	}
+
+	uint64_t LinearArena::GetCapacity()
+	{
+		uint64_t capacity = 0;
+		for (auto& block : m_Blocks) capacity += block.size;
+		return capacity;
+	}
+
+	void LinearArena::AddBlock(uint64_t size)
+	{
+		Block block;
+		block.memory = (uint8_t*)std::malloc(size);
+		block.size = size;
+		KBS_ASSERT(block.memory != nullptr, "fail to allocate {} bytes for linear arena", size);
+		m_Blocks.push_back(block);
+	}
+
+	void LinearArena::ReleaseBlocks()
+	{
+		for (auto& block : m_Blocks)
+		{
+			std::free(block.memory);
+		}
+		m_Blocks.clear();
+	}
+
+	void FrameAllocator::BeginFrame(uint64_t frameIndex)
+	{
+		m_CurrentArena = (uint32_t)(frameIndex % frameCount);
+		m_Arenas[m_CurrentArena].Reset();
+	}
+}
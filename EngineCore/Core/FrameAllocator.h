@@ -0,0 +1,102 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+
+namespace kbs
+{
+	// bump allocator, memory is only released all at once by Reset.
+	// not thread safe, allocate on one thread and hand the memory to jobs
+	class KBS_API LinearArena
+	{
+	public:
+		LinearArena(uint64_t initialCapacity = 64 * 1024);
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+		~LinearArena();
+
+		void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t));
+
+		template<typename T>
+		T* AllocateArray(uint64_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destructed");
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// an arena that overflowed into several blocks is merged into a single block,
+		// so the next frame of the same size doesn't allocate from the heap
+		void Reset();
+
+		uint64_t GetUsedSize()	 { return m_UsedSize; }
+		uint64_t GetCapacity();
+		uint32_t GetBlockCount() { return (uint32_t)m_Blocks.size(); }
+
+	private:
+		struct Block
+		{
+			uint8_t* memory;
+			uint64_t size;
+		};
+
+		void AddBlock(uint64_t size);
+		void ReleaseBlocks();
+
+		std::vector<Block> m_Blocks;
+		uint32_t		   m_CurrentBlock = 0;
+		uint64_t		   m_Offset = 0;
+		uint64_t		   m_UsedSize = 0;
+	};
+
+	// one arena per frame in flight, memory allocated in frame N stays valid until
+	// BeginFrame is called for frame N + frameCount
+	class KBS_API FrameAllocator : public Is_Singleton
+	{
+	public:
+		static constexpr uint32_t frameCount = 3;
+
+		FrameAllocator() = default;
+
+		void		 BeginFrame(uint64_t frameIndex);
+		LinearArena& GetArena() { return m_Arenas[m_CurrentArena]; }
+
+	private:
+		LinearArena m_Arenas[frameCount];
+		uint32_t	m_CurrentArena = 0;
+	};
+
+	// stl adapter over a LinearArena, deallocation is a no-op.
+	// default constructed allocators use the arena of the current frame
+	template<typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		ArenaAllocator() : m_Arena(&Singleton::GetInstance<FrameAllocator>()->GetArena()) {}
+		ArenaAllocator(LinearArena* arena) : m_Arena(arena) {}
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : m_Arena(other.GetArena()) {}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(m_Arena->Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void deallocate(T*, size_t) {}
+
+		LinearArena* GetArena() const { return m_Arena; }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return m_Arena == other.GetArena(); }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return m_Arena != other.GetArena(); }
+
+	private:
+		LinearArena* m_Arena;
+	};
+
+	// must not outlive the frames in flight, see FrameAllocator
+	template<typename T>
+	using FrameVector = std::vector<T, ArenaAllocator<T>>;
+}
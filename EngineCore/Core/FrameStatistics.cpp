@@ -0,0 +1,76 @@
+#include "FrameStatistics.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace kbs
+{
+	void FrameTimeRecorder::Reserve(uint32_t frameCount)
+	{
+		m_FrameMs.reserve(frameCount);
+	}
+
+	void FrameTimeRecorder::AddFrame(double frameMs)
+	{
+		m_FrameMs.push_back(frameMs);
+	}
+
+	// nearest rank percentile of a sorted list
+	static double Percentile(const std::vector<double>& sorted, double percent)
+	{
+		uint64_t rank = (uint64_t)std::ceil(percent / 100.0 * (double)sorted.size());
+		rank = std::clamp<uint64_t>(rank, 1, sorted.size());
+		return sorted[rank - 1];
+	}
+
+	FrameTimeReport FrameTimeRecorder::BuildReport(uint32_t warmupFrames) const
+	{
+		FrameTimeReport report;
+		if (m_FrameMs.size() <= warmupFrames)
+		{
+			return report;
+		}
+
+		std::vector<double> sorted(m_FrameMs.begin() + warmupFrames, m_FrameMs.end());
+		std::sort(sorted.begin(), sorted.end());
+
+		double total = 0;
+		for (double ms : sorted) total += ms;
+
+		report.frameCount = (uint32_t)sorted.size();
+		report.meanMs = total / sorted.size();
+		report.minMs = sorted.front();
+		report.maxMs = sorted.back();
+		report.p50Ms = Percentile(sorted, 50);
+		report.p95Ms = Percentile(sorted, 95);
+		report.p99Ms = Percentile(sorted, 99);
+		return report;
+	}
+
+	std::string FrameTimeRecorder::ToJson(const FrameTimeReport& report)
+	{
+		std::stringstream ss;
+		ss << "{\n"
+			<< "  \"frames\": " << report.frameCount << ",\n"
+			<< "  \"mean_ms\": " << report.meanMs << ",\n"
+			<< "  \"min_ms\": " << report.minMs << ",\n"
+			<< "  \"max_ms\": " << report.maxMs << ",\n"
+			<< "  \"p50_ms\": " << report.p50Ms << ",\n"
+			<< "  \"p95_ms\": " << report.p95Ms << ",\n"
+			<< "  \"p99_ms\": " << report.p99Ms << "\n"
+			<< "}\n";
+		return ss.str();
+	}
+
+	bool FrameTimeRecorder::WriteJson(const std::string& path, uint32_t warmupFrames) const
+	{
+		std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+		if (!file.is_open())
+		{
+			KBS_WARN("fail to open frame time report file {}", path.c_str());
+			return false;
+		}
+		file << ToJson(BuildReport(warmupFrames));
+		return true;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Common.h"
+
+namespace kbs
+{
+	struct FrameTimeReport
+	{
+		uint32_t frameCount = 0;
+		double	 meanMs = 0;
+		double	 minMs = 0;
+		double	 maxMs = 0;
+		double	 p50Ms = 0;
+		double	 p95Ms = 0;
+		double	 p99Ms = 0;
+	};
+
+	// collects cpu frame times of a run and summarizes them as percentiles
+	class KBS_API FrameTimeRecorder
+	{
+	public:
+		FrameTimeRecorder() = default;
+
+		void Reserve(uint32_t frameCount);
+		void AddFrame(double frameMs);
+		uint32_t GetFrameCount() { return (uint32_t)m_FrameMs.size(); }
+
+		// the first warmupFrames frames (shader compilation, pipeline creation...) are excluded
+		FrameTimeReport BuildReport(uint32_t warmupFrames = 0) const;
+
+		static std::string ToJson(const FrameTimeReport& report);
+		bool WriteJson(const std::string& path, uint32_t warmupFrames = 0) const;
+
+	private:
+		std::vector<double> m_FrameMs;
+	};
+}
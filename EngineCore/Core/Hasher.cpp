@@ -1,24 +1,234 @@
 #include "Hasher.h"
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__SIZEOF_INT128__)
+    #include <intrin.h>
+    #pragma intrinsic(_umul128)
+#endif
 
 namespace kbs
 {
+    using namespace hash_detail;
+
+    static inline void Mum(uint64_t& a, uint64_t& b)
+    {
+#if defined(__SIZEOF_INT128__)
+        __uint128_t r = a;
+        r *= b;
+        a = (uint64_t)r;
+        b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        a = _umul128(a, b, &b);
+#else
+        MumPortable(a, b);
+#endif
+    }
+
+    static inline uint64_t Mix(uint64_t a, uint64_t b)
+    {
+        Mum(a, b);
+        return a ^ b;
+    }
+
+    // inputs are read as little endian, the same as ReadConstexpr
+    static inline uint64_t Read8(const uint8_t* p)
+    {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return v;
+    }
+
+    static inline uint64_t Read4(const uint8_t* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+
+    static inline uint64_t Read3(const uint8_t* p, uint64_t k)
+    {
+        return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+    }
+
+    static inline uint64_t InitializeSeed(uint64_t seed)
+    {
+        return seed ^ Mix(seed ^ secret[0], secret[1]);
+    }
+
+    // seed must be initialized by InitializeSeed
+    static FinalState HashState(const uint8_t* p, uint64_t len, uint64_t seed)
+    {
+        uint64_t a = 0, b = 0;
+        if (len <= 16)
+        {
+            if (len >= 4)
+            {
+                a = (Read4(p) << 32) | Read4(p + ((len >> 3) << 2));
+                b = (Read4(p + len - 4) << 32) | Read4(p + len - 4 - ((len >> 3) << 2));
+            }
+            else if (len > 0)
+            {
+                a = Read3(p, len);
+            }
+        }
+        else
+        {
+            uint64_t i = len;
+            if (i > 48)
+            {
+                uint64_t see1 = seed, see2 = seed;
+                do
+                {
+                    seed = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ seed);
+                    see1 = Mix(Read8(p + 16) ^ secret[2], Read8(p + 24) ^ see1);
+                    see2 = Mix(Read8(p + 32) ^ secret[3], Read8(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = Read8(p + i - 16);
+            b = Read8(p + i - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        Mum(a, b);
+        return FinalState{ a, b, seed };
+    }
+
+    static inline uint64_t Finalize64(const FinalState& s, uint64_t len)
+    {
+        return Mix(s.a ^ secret[0] ^ len, s.b ^ secret[1]);
+    }
+
+    static inline Hash128 Finalize128(const FinalState& s, uint64_t len)
+    {
+        return Hash128{ Finalize64(s, len), Mix(s.a ^ secret[2], s.b ^ secret[3] ^ len) };
+    }
+
+    HashStream::HashStream(uint64_t seed)
+    {
+        Reset(seed);
+    }
+
+    void HashStream::Reset(uint64_t seed)
+    {
+        m_Seed = InitializeSeed(seed);
+        m_Lanes[0] = m_Lanes[1] = m_Lanes[2] = m_Seed;
+        m_TotalSize = 0;
+        m_PendingSize = 0;
+    }
+
+    void HashStream::Update(const void* data, uint64_t dataSize)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        m_TotalSize += dataSize;
+
+        while (dataSize > 0)
+        {
+            // a stripe is only consumed once more data follows it, the last bytes belong to the final block
+            if (m_PendingSize == stripeSize)
+            {
+                ProcessStripe(m_Buffer + historySize);
+                memcpy(m_Buffer, m_Buffer + stripeSize, historySize);
+                m_PendingSize = 0;
+            }
+
+            if (m_PendingSize == 0 && dataSize > stripeSize)
+            {
+                while (dataSize > stripeSize)
+                {
+                    ProcessStripe(p);
+                    p += stripeSize;
+                    dataSize -= stripeSize;
+                }
+                memcpy(m_Buffer, p - historySize, historySize);
+            }
+
+            uint32_t copySize = (uint32_t)std::min<uint64_t>(dataSize, stripeSize - m_PendingSize);
+            memcpy(m_Buffer + historySize + m_PendingSize, p, copySize);
+            m_PendingSize += copySize;
+            p += copySize;
+            dataSize -= copySize;
+        }
+    }
+
+    uint64_t HashStream::Finalize() const
+    {
+        return Finalize64(FinalizeState(), m_TotalSize);
+    }
+
+    Hash128 HashStream::Finalize128() const
+    {
+        return kbs::Finalize128(FinalizeState(), m_TotalSize);
+    }
+
+    FinalState HashStream::FinalizeState() const
+    {
+        const uint8_t* pending = m_Buffer + historySize;
+        if (m_TotalSize <= stripeSize)
+        {
+            return HashState(pending, m_TotalSize, m_Seed);
+        }
+
+        uint64_t seed = m_Lanes[0] ^ m_Lanes[1] ^ m_Lanes[2];
+        const uint8_t* p = pending;
+        uint64_t i = m_PendingSize;
+        while (i > 16)
+        {
+            seed = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // may read into the history bytes in front of the pending bytes
+        uint64_t a = Read8(p + i - 16) ^ secret[1];
+        uint64_t b = Read8(p + i - 8) ^ seed;
+        Mum(a, b);
+        return FinalState{ a, b, seed };
+    }
+
+    void HashStream::ProcessStripe(const uint8_t* p)
+    {
+        m_Lanes[0] = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ m_Lanes[0]);
+        m_Lanes[1] = Mix(Read8(p + 16) ^ secret[2], Read8(p + 24) ^ m_Lanes[1]);
+        m_Lanes[2] = Mix(Read8(p + 32) ^ secret[3], Read8(p + 40) ^ m_Lanes[2]);
+    }
+
 	uint64_t Hasher::HashMemoryContent(const void* data, uint64_t dataSize)
 	{
-        return HashContent(
-        [data](uint64_t offset) 
-        {
-            return static_cast<const char*>(data)[offset];
-        }, 
-        dataSize);
+        return HashMemoryContent(data, dataSize, defaultSeed);
 	}
 
+    uint64_t Hasher::HashMemoryContent(const void* data, uint64_t dataSize, uint64_t seed)
+    {
+        return Finalize64(HashState(static_cast<const uint8_t*>(data), dataSize, InitializeSeed(seed)), dataSize);
+    }
+
+    Hash128 Hasher::HashMemoryContent128(const void* data, uint64_t dataSize, uint64_t seed)
+    {
+        return kbs::Finalize128(HashState(static_cast<const uint8_t*>(data), dataSize, InitializeSeed(seed)), dataSize);
+    }
+
     uint64_t Hasher::HashContent(HasherContentVisiter visiter, uint64_t dataSize)
     {
-        std::size_t hash_value = 0;
-        std::hash<char> hasher;
-        for (std::size_t i = 0; i < dataSize; ++i) {
-            hash_value ^= hasher(visiter(i)) + 0x9e3779b9 + (hash_value << 6) + (hash_value >> 2);
+        // gather the visited bytes in chunks so the hash itself runs over memory
+        char chunk[256];
+        HashStream stream;
+        for (uint64_t offset = 0; offset < dataSize; offset += sizeof(chunk))
+        {
+            uint64_t chunkSize = std::min<uint64_t>(sizeof(chunk), dataSize - offset);
+            for (uint64_t i = 0; i < chunkSize; i++)
+            {
+                chunk[i] = visiter(offset + i);
+            }
+            stream.Update(chunk, chunkSize);
         }
-        return hash_value;
+        return stream.Finalize();
     }
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include <string_view>
 
 
 
@@ -7,10 +8,151 @@ namespace kbs
 {
 	using HasherContentVisiter = std::function<char(uint64_t offset)>;
 
-	class Hasher
+	struct Hash128
+	{
+		uint64_t low;
+		uint64_t high;
+
+		bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+		bool operator!=(const Hash128& other) const { return !(*this == other); }
+	};
+
+	// wyhash style hash, three independent 64x64->128 multiply lanes for long inputs.
+	// the one shot functions, HashStream and the constexpr variants produce identical results
+	namespace hash_detail
+	{
+		constexpr uint64_t secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+		constexpr uint64_t defaultSeed = 0x9e3779b97f4a7c15ull;
+
+		// portable 64x64->128 multiply, usable in constant expressions
+		constexpr void MumPortable(uint64_t& a, uint64_t& b)
+		{
+			uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+			uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			uint64_t t = rl + (rm0 << 32);
+			uint64_t c = t < rl;
+			uint64_t lo = t + (rm1 << 32);
+			c += lo < t;
+			uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+			a = lo;
+			b = hi;
+		}
+
+		constexpr uint64_t MixPortable(uint64_t a, uint64_t b)
+		{
+			MumPortable(a, b);
+			return a ^ b;
+		}
+
+		constexpr uint64_t ReadConstexpr(const char* p, uint32_t bytes)
+		{
+			uint64_t v = 0;
+			for (uint32_t i = 0; i < bytes; i++)
+			{
+				v |= (uint64_t)(uint8_t)p[i] << (i * 8);
+			}
+			return v;
+		}
+
+		constexpr uint64_t Read3Constexpr(const char* p, uint64_t k)
+		{
+			return ((uint64_t)(uint8_t)p[0] << 16) | ((uint64_t)(uint8_t)p[k >> 1] << 8) | (uint8_t)p[k - 1];
+		}
+
+		struct FinalState
+		{
+			uint64_t a, b, seed;
+		};
+
+		constexpr FinalState HashConstexprState(const char* p, uint64_t len, uint64_t seed)
+		{
+			seed ^= MixPortable(seed ^ secret[0], secret[1]);
+			uint64_t a = 0, b = 0;
+			if (len <= 16)
+			{
+				if (len >= 4)
+				{
+					a = (ReadConstexpr(p, 4) << 32) | ReadConstexpr(p + ((len >> 3) << 2), 4);
+					b = (ReadConstexpr(p + len - 4, 4) << 32) | ReadConstexpr(p + len - 4 - ((len >> 3) << 2), 4);
+				}
+				else if (len > 0)
+				{
+					a = Read3Constexpr(p, len);
+				}
+			}
+			else
+			{
+				uint64_t i = len;
+				if (i > 48)
+				{
+					uint64_t see1 = seed, see2 = seed;
+					do
+					{
+						seed = MixPortable(ReadConstexpr(p, 8) ^ secret[1], ReadConstexpr(p + 8, 8) ^ seed);
+						see1 = MixPortable(ReadConstexpr(p + 16, 8) ^ secret[2], ReadConstexpr(p + 24, 8) ^ see1);
+						see2 = MixPortable(ReadConstexpr(p + 32, 8) ^ secret[3], ReadConstexpr(p + 40, 8) ^ see2);
+						p += 48;
+						i -= 48;
+					} while (i > 48);
+					seed ^= see1 ^ see2;
+				}
+				while (i > 16)
+				{
+					seed = MixPortable(ReadConstexpr(p, 8) ^ secret[1], ReadConstexpr(p + 8, 8) ^ seed);
+					i -= 16;
+					p += 16;
+				}
+				a = ReadConstexpr(p + i - 16, 8);
+				b = ReadConstexpr(p + i - 8, 8);
+			}
+			a ^= secret[1];
+			b ^= seed;
+			MumPortable(a, b);
+			return FinalState{ a, b, seed };
+		}
+	}
+
+	// incremental hashing of data arriving in pieces, Finalize can be called at any point
+	class KBS_API HashStream
+	{
+	public:
+		HashStream(uint64_t seed = hash_detail::defaultSeed);
+
+		void Reset(uint64_t seed = hash_detail::defaultSeed);
+		void Update(const void* data, uint64_t dataSize);
+
+		template<typename T>
+		void Update(const T& data)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects can be hashed by memory");
+			Update(&data, sizeof(data));
+		}
+
+		uint64_t Finalize() const;
+		Hash128	 Finalize128() const;
+
+	private:
+		hash_detail::FinalState FinalizeState() const;
+		void ProcessStripe(const uint8_t* p);
+
+		static constexpr uint32_t stripeSize = 48;
+		static constexpr uint32_t historySize = 16;
+
+		uint64_t m_Seed;
+		uint64_t m_Lanes[3];
+		uint64_t m_TotalSize;
+		// the final block may read up to 16 bytes that were already consumed by a stripe,
+		// so the buffer keeps them in front of the pending bytes
+		uint8_t	 m_Buffer[historySize + stripeSize];
+		uint32_t m_PendingSize;
+	};
+
+	class KBS_API Hasher
 	{
 	public:
 		static uint64_t HashMemoryContent(const void* data, uint64_t dataSize);
+		static uint64_t HashMemoryContent(const void* data, uint64_t dataSize, uint64_t seed);
+		static Hash128	HashMemoryContent128(const void* data, uint64_t dataSize, uint64_t seed = hash_detail::defaultSeed);
 		static uint64_t HashContent(HasherContentVisiter visiter, uint64_t dataSize);
 
 		template<typename T>
@@ -18,5 +160,17 @@ namespace kbs
 		{
 			return HashMemoryContent(&data, sizeof(data));
 		}
+
+		// compile time hashing of byte strings, e.g. names and small keys serialized to chars
+		static constexpr uint64_t HashConstexpr(const char* data, uint64_t dataSize, uint64_t seed = hash_detail::defaultSeed)
+		{
+			hash_detail::FinalState s = hash_detail::HashConstexprState(data, dataSize, seed);
+			return hash_detail::MixPortable(s.a ^ hash_detail::secret[0] ^ dataSize, s.b ^ hash_detail::secret[1]);
+		}
+
+		static constexpr uint64_t HashConstexpr(std::string_view str, uint64_t seed = hash_detail::defaultSeed)
+		{
+			return HashConstexpr(str.data(), str.size(), seed);
+		}
 	};
-}
\ No newline at end of file
+}
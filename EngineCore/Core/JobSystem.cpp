@@ -0,0 +1,293 @@
+#include "JobSystem.h"
+
+namespace kbs
+{
+	// the job system owning the current thread, nullptr for threads not created by a job system
+	static thread_local JobSystem* t_OwnerSystem = nullptr;
+	static thread_local uint32_t   t_QueueIndex = 0;
+
+	void JobCounter::Increment(uint32_t count)
+	{
+		m_Pending.fetch_add(count, std::memory_order_acq_rel);
+	}
+
+	void JobCounter::Decrement(std::vector<Job>& releasedJobs)
+	{
+		// the lock is the last access to the counter, JobSystem::Wait acquires it
+		// before returning so a counter living on the waiter's stack stays valid here
+		std::lock_guard<std::mutex> guard(m_ContinuationLock);
+		if (m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			releasedJobs.swap(m_Continuations);
+		}
+	}
+
+	bool JobCounter::AddContinuation(Job&& job)
+	{
+		std::lock_guard<std::mutex> guard(m_ContinuationLock);
+		if (m_Pending.load(std::memory_order_acquire) == 0)
+		{
+			return false;
+		}
+		m_Continuations.push_back(std::move(job));
+		return true;
+	}
+
+	JobSystem::~JobSystem()
+	{
+		Shutdown();
+	}
+
+	void JobSystem::Initialize(uint32_t threadCount)
+	{
+		if (m_Initialized)
+		{
+			Shutdown();
+		}
+
+		if (threadCount == autoThreadCount)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+		}
+
+		m_Running = true;
+		for (uint32_t i = 0; i < threadCount + 1; i++)
+		{
+			m_Queues.push_back(std::make_shared<WorkerQueue>());
+		}
+		for (uint32_t i = 1; i < threadCount + 1; i++)
+		{
+			m_Workers.emplace_back([this, i]() { WorkerMain(i); });
+		}
+		m_Initialized = true;
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!m_Initialized) return;
+
+		// finish what is left so no counter is waited on forever
+		while (TryExecuteOne()) {}
+
+		{
+			std::lock_guard<std::mutex> guard(m_SleepLock);
+			m_Running = false;
+		}
+		m_WakeCondition.notify_all();
+		for (auto& worker : m_Workers)
+		{
+			worker.join();
+		}
+		m_Workers.clear();
+		m_Queues.clear();
+		m_QueuedJobCount = 0;
+		m_Initialized = false;
+	}
+
+	uint32_t JobSystem::GetThreadCount()
+	{
+		EnsureInitialized();
+		return (uint32_t)m_Queues.size();
+	}
+
+	void JobSystem::Submit(JobFunction job, JobCounter* signal, JobCounter* dependency)
+	{
+		EnsureInitialized();
+		if (signal != nullptr)
+		{
+			signal->Increment(1);
+		}
+
+		Job newJob{ std::move(job), signal };
+		if (dependency != nullptr && dependency->AddContinuation(std::move(newJob)))
+		{
+			return;
+		}
+		Schedule(std::move(newJob));
+	}
+
+	void JobSystem::SubmitRange(uint32_t begin, uint32_t end, uint32_t grainSize, JobRangeFunction job, JobCounter* signal, JobCounter* dependency)
+	{
+		if (begin >= end) return;
+		EnsureInitialized();
+
+		if (grainSize == 0)
+		{
+			grainSize = std::max((end - begin) / (GetThreadCount() * 4), 1u);
+		}
+
+		// shared by all chunks, the caller is not required to keep anything alive
+		auto sharedJob = std::make_shared<JobRangeFunction>(std::move(job));
+		for (uint32_t first = begin; first < end; first += grainSize)
+		{
+			uint32_t last = std::min(first + grainSize, end);
+			Submit([sharedJob, first, last]() { (*sharedJob)(first, last); }, signal, dependency);
+			// prevent overflow when end is close to UINT32_MAX
+			if (last == end) break;
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		EnsureInitialized();
+		while (!counter.IsDone())
+		{
+			if (!TryExecuteOne())
+			{
+				std::this_thread::yield();
+			}
+		}
+		// synchronize with the last Decrement, see JobCounter::Decrement
+		std::lock_guard<std::mutex> guard(counter.m_ContinuationLock);
+	}
+
+	void JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, JobRangeFunction job)
+	{
+		if (begin >= end) return;
+		EnsureInitialized();
+
+		uint32_t count = end - begin;
+		if (grainSize == 0)
+		{
+			grainSize = std::max(count / (GetThreadCount() * 4), 1u);
+		}
+		if (count <= grainSize || GetThreadCount() == 1)
+		{
+			job(begin, end);
+			return;
+		}
+
+		// the caller blocks until every chunk is done, so the chunks can capture job by reference
+		JobCounter counter;
+		const JobRangeFunction* jobPtr = &job;
+		for (uint32_t first = begin; first < end; first += grainSize)
+		{
+			uint32_t last = std::min(first + grainSize, end);
+			Submit([jobPtr, first, last]() { (*jobPtr)(first, last); }, &counter);
+			if (last == end) break;
+		}
+		Wait(counter);
+	}
+
+	void JobSystem::EnsureInitialized()
+	{
+		if (!m_Initialized)
+		{
+			Initialize();
+		}
+	}
+
+	void JobSystem::WorkerMain(uint32_t workerIndex)
+	{
+		t_OwnerSystem = this;
+		t_QueueIndex = workerIndex;
+
+		constexpr uint32_t spinCount = 64;
+		uint32_t idleCount = 0;
+
+		while (m_Running)
+		{
+			if (TryExecuteOne())
+			{
+				idleCount = 0;
+				continue;
+			}
+
+			if (++idleCount < spinCount)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_SleepLock);
+			m_WakeCondition.wait(lock, [this]() { return m_QueuedJobCount.load() != 0 || !m_Running; });
+			idleCount = 0;
+		}
+
+		t_OwnerSystem = nullptr;
+	}
+
+	uint32_t JobSystem::GetCurrentQueueIndex()
+	{
+		return t_OwnerSystem == this ? t_QueueIndex : 0;
+	}
+
+	void JobSystem::Schedule(Job&& job)
+	{
+		WorkerQueue& queue = *m_Queues[GetCurrentQueueIndex()];
+		{
+			std::lock_guard<std::mutex> guard(queue.lock);
+			queue.jobs.push_back(std::move(job));
+		}
+		m_QueuedJobCount.fetch_add(1);
+
+		// taking the sleep lock guarantees a worker between its predicate check and wait can't miss the notify
+		{
+			std::lock_guard<std::mutex> guard(m_SleepLock);
+		}
+		m_WakeCondition.notify_one();
+	}
+
+	bool JobSystem::PopOrSteal(uint32_t queueIndex, Job& job)
+	{
+		// the owner takes the newest job, it is most likely still hot in cache
+		{
+			WorkerQueue& queue = *m_Queues[queueIndex];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				return true;
+			}
+		}
+
+		// thieves take the oldest job, which tends to be the largest piece of remaining work
+		uint32_t queueCount = (uint32_t)m_Queues.size();
+		for (uint32_t i = 1; i < queueCount; i++)
+		{
+			WorkerQueue& victim = *m_Queues[(queueIndex + i) % queueCount];
+			std::lock_guard<std::mutex> guard(victim.lock);
+			if (!victim.jobs.empty())
+			{
+				job = std::move(victim.jobs.front());
+				victim.jobs.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool JobSystem::TryExecuteOne()
+	{
+		if (m_QueuedJobCount.load(std::memory_order_relaxed) == 0)
+		{
+			return false;
+		}
+
+		Job job;
+		if (!PopOrSteal(GetCurrentQueueIndex(), job))
+		{
+			return false;
+		}
+		m_QueuedJobCount.fetch_sub(1);
+		Execute(job);
+		return true;
+	}
+
+	void JobSystem::Execute(Job& job)
+	{
+		job.function();
+
+		if (job.counter != nullptr)
+		{
+			std::vector<Job> releasedJobs;
+			job.counter->Decrement(releasedJobs);
+			for (auto& released : releasedJobs)
+			{
+				Schedule(std::move(released));
+			}
+		}
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <condition_variable>
+
+namespace kbs
+{
+	class JobSystem;
+	class JobCounter;
+
+	using JobFunction = std::function<void()>;
+	// receives a half-open range [first, last)
+	using JobRangeFunction = std::function<void(uint32_t first, uint32_t last)>;
+
+	struct Job
+	{
+		JobFunction function;
+		JobCounter* counter = nullptr;
+	};
+
+	// tracks the number of unfinished jobs submitted against it.
+	// jobs submitted with a counter as dependency are held back until the counter drops to zero
+	class KBS_API JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool	 IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+		uint32_t GetPendingCount() const { return m_Pending.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+
+		void Increment(uint32_t count);
+		// returns jobs waiting on this counter if the counter reaches zero
+		void Decrement(std::vector<Job>& releasedJobs);
+		// returns false if the counter is already done and the job should be scheduled right away
+		bool AddContinuation(Job&& job);
+
+		std::atomic<uint32_t> m_Pending{ 0 };
+		std::mutex			  m_ContinuationLock;
+		std::vector<Job>	  m_Continuations;
+	};
+
+	class KBS_API JobSystem : public Is_Singleton
+	{
+	public:
+		JobSystem() = default;
+		~JobSystem();
+
+		// picks hardware concurrency - 1 worker threads
+		static constexpr uint32_t autoThreadCount = ~0u;
+
+		// threadCount is the number of worker threads besides the calling thread,
+		// 0 runs every job on the calling thread
+		void Initialize(uint32_t threadCount = autoThreadCount);
+		void Shutdown();
+
+		bool	 IsInitialized() const { return m_Initialized; }
+		// worker threads + the main thread
+		uint32_t GetThreadCount();
+
+		// signal will be incremented right away and decremented after the job finishes.
+		// if dependency is not null, the job will not start before the dependency counter is done
+		void Submit(JobFunction job, JobCounter* signal = nullptr, JobCounter* dependency = nullptr);
+
+		// splits [begin, end) into chunks of grainSize elements, grainSize = 0 picks a chunk size by thread count
+		void SubmitRange(uint32_t begin, uint32_t end, uint32_t grainSize, JobRangeFunction job, JobCounter* signal, JobCounter* dependency = nullptr);
+
+		// the calling thread executes pending jobs until the counter is done
+		void Wait(JobCounter& counter);
+
+		// blocking parallel loop, the calling thread takes part in the work
+		void ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, JobRangeFunction job);
+
+		template<typename Func>
+		void ParallelForEach(uint32_t begin, uint32_t end, Func&& func, uint32_t grainSize = 0)
+		{
+			ParallelFor(begin, end, grainSize,
+				[&](uint32_t first, uint32_t last)
+				{
+					for (uint32_t i = first; i < last; i++) func(i);
+				}
+			);
+		}
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex		lock;
+			std::deque<Job> jobs;
+		};
+
+		void EnsureInitialized();
+		void WorkerMain(uint32_t workerIndex);
+		uint32_t GetCurrentQueueIndex();
+
+		void Schedule(Job&& job);
+		bool PopOrSteal(uint32_t queueIndex, Job& job);
+		bool TryExecuteOne();
+		void Execute(Job& job);
+
+		bool						m_Initialized = false;
+		std::atomic<bool>			m_Running{ false };
+		// queue 0 belongs to the main thread and any thread not owned by the job system
+		std::vector<ptr<WorkerQueue>> m_Queues;
+		std::vector<std::thread>	m_Workers;
+
+		std::atomic<uint32_t>		m_QueuedJobCount{ 0 };
+		std::mutex					m_SleepLock;
+		std::condition_variable		m_WakeCondition;
+	};
+}
@@ -2,20 +2,172 @@
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+KBS_API kbs::LogRecordQueue::LogRecordQueue(uint32_t capacity, LogOverflowPolicy policy)
+	:m_Policy(policy)
+{
+	uint64_t size = 2;
+	while (size < capacity) size <<= 1;
+
+	m_Cells = std::make_unique<Cell[]>(size);
+	m_Mask = size - 1;
+	for (uint64_t i = 0; i < size; i++)
+	{
+		m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+KBS_API kbs::LogRecordQueue::Cell* kbs::LogRecordQueue::BeginPush()
+{
+	uint64_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell& cell = m_Cells[position & m_Mask];
+		int64_t diff = (int64_t)cell.sequence.load(std::memory_order_acquire) - (int64_t)position;
+		if (diff == 0)
+		{
+			if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.position = position;
+				return &cell;
+			}
+		}
+		else if (diff < 0)
+		{
+			// the consumer hasn't freed this cell yet, the queue is full
+			if (m_Policy != LogOverflowPolicy::Block)
+			{
+				m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			std::this_thread::yield();
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+KBS_API void kbs::LogRecordQueue::EndPush(Cell* cell)
+{
+	cell->sequence.store(cell->position + 1, std::memory_order_release);
+}
+
 KBS_API kbs::Logger::Logger()
 {
-	m_stdLogger = spdlog::stdout_color_mt("kbs"); 
-	m_stdLogger->set_level(spdlog::level::trace); 
-	m_stdLogger->set_pattern("%^[%T] %n: %v%$");
+	auto stdSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+	auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/kbs.txt");
+
+	// one logger for both sinks so the message is only formatted once
+	m_Logger = std::make_shared<spdlog::logger>("kbs", spdlog::sinks_init_list{ stdSink, fileSink });
+	m_Logger->set_level(spdlog::level::trace);
+	m_Logger->set_pattern("%^[%T] %n: %v%$");
+}
 
-    m_fileLogger = spdlog::basic_logger_mt("kbs-file", "logs/kbs.txt"); 
-	m_fileLogger->set_level(spdlog::level::trace);
-    m_fileLogger->set_pattern("%^[%T] %n: %v%$");
+KBS_API kbs::Logger::Logger(const std::string& name, std::vector<spdlog::sink_ptr> sinks)
+{
+	m_Logger = std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+	m_Logger->set_level(spdlog::level::trace);
+	m_Logger->set_pattern("%^[%T] %n: %v%$");
+}
+
+KBS_API kbs::Logger::~Logger()
+{
+	DisableAsync();
+	m_Logger->flush();
 }
 
 KBS_API void kbs::Logger::flush()
 {
-	m_fileLogger->flush();
+	if (m_Queue != nullptr)
+	{
+		uint64_t pushed = m_Queue->GetPushedCount();
+		while (m_Queue->GetPoppedCount() < pushed)
+		{
+			std::this_thread::yield();
+		}
+	}
+	m_Logger->flush();
+}
+
+KBS_API void kbs::Logger::EnableAsync(LogOverflowPolicy policy, uint32_t queueCapacity)
+{
+	DisableAsync();
+
+	m_Queue = std::make_unique<LogRecordQueue>(queueCapacity, policy);
+	m_ConsumerRunning = true;
+	m_ConsumerThread = std::thread([this]() { ConsumerMain(); });
+}
+
+KBS_API void kbs::Logger::DisableAsync()
+{
+	if (m_Queue == nullptr) return;
+
+	flush();
+	m_ConsumerRunning = false;
+	WakeConsumer();
+	m_ConsumerThread.join();
+	m_Queue = nullptr;
+}
+
+void kbs::Logger::ConsumerMain()
+{
+	uint64_t reportedDrops = 0;
+	uint32_t idleCount = 0;
+
+	auto write = [&](LogRecord& record)
+	{
+		m_Logger->log(record.level, spdlog::string_view_t(record.text, record.length));
+	};
+
+	while (true)
+	{
+		if (m_Queue->TryPop(write))
+		{
+			idleCount = 0;
+			continue;
+		}
+
+		if (m_Queue->GetPolicy() == LogOverflowPolicy::DropAndCount)
+		{
+			uint64_t dropped = m_Queue->GetDroppedCount();
+			if (dropped != reportedDrops)
+			{
+				m_Logger->warn("{} log records dropped because the log queue was full", dropped - reportedDrops);
+				reportedDrops = dropped;
+			}
+		}
+
+		if (!m_ConsumerRunning)
+		{
+			break;
+		}
+
+		// bursts of records are caught by yielding, an idle queue puts the consumer to sleep
+		if (++idleCount < 64)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		m_ConsumerSleeping.store(true, std::memory_order_relaxed);
+		// pairs with the fence of the producers after a push, either they see the consumer sleeping or it sees their record
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		{
+			std::unique_lock<std::mutex> lock(m_ConsumerLock);
+			m_ConsumerWakeup.wait(lock, [&]() { return !m_Queue->IsEmpty() || !m_ConsumerRunning; });
+		}
+		m_ConsumerSleeping.store(false, std::memory_order_relaxed);
+		idleCount = 0;
+	}
+}
+
+void kbs::Logger::WakeConsumer()
+{
+	// taking the lock makes sure the consumer is either waiting or hasn't checked the queue yet
+	std::lock_guard<std::mutex> lock(m_ConsumerLock);
+	m_ConsumerWakeup.notify_one();
 }
 
 std::shared_ptr<kbs::Logger> g_logger;
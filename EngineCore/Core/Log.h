@@ -1,50 +1,216 @@
 #pragma once
 #include "Platform/Platform.h"
 #include "spdlog/spdlog.h"
+#include "spdlog/fmt/fmt.h"
 #include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+// messages below this level are removed at compile time, assertions are always kept
+#define KBS_LOG_LEVEL_INFO 0
+#define KBS_LOG_LEVEL_WARN 1
+#define KBS_LOG_LEVEL_ERROR 2
+#define KBS_LOG_LEVEL_OFF 3
+
+#ifndef KBS_LOG_LEVEL
+	#define KBS_LOG_LEVEL KBS_LOG_LEVEL_INFO
+#endif
 
 namespace kbs
 {
+	enum class LogOverflowPolicy
+	{
+		// the producer waits until the background thread frees a slot
+		Block,
+		// the record is discarded
+		Drop,
+		// the record is discarded and the number of lost records is logged once there is space again
+		DropAndCount
+	};
+
+	// a message formatted by the producer thread, long messages are truncated
+	struct LogRecord
+	{
+		static constexpr uint32_t textCapacity = 240;
+
+		spdlog::level::level_enum level;
+		uint32_t				  length;
+		char					  text[textCapacity];
+	};
+
+	// bounded lock free multi producer single consumer queue, based on Dmitry Vyukov's bounded queue
+	class KBS_API LogRecordQueue
+	{
+	public:
+		struct Cell
+		{
+			std::atomic<uint64_t> sequence;
+			uint64_t			  position;
+			LogRecord			  record;
+		};
+
+		// capacity is rounded up to a power of two
+		LogRecordQueue(uint32_t capacity, LogOverflowPolicy policy);
+
+		// claims a cell for the calling thread, returns nullptr if the record is dropped
+		Cell* BeginPush();
+		void  EndPush(Cell* cell);
+
+		// single consumer only
+		template<typename Func>
+		bool TryPop(Func&& handler)
+		{
+			Cell& cell = m_Cells[m_DequeuePosition & m_Mask];
+			if (cell.sequence.load(std::memory_order_acquire) != m_DequeuePosition + 1)
+			{
+				return false;
+			}
+			handler(cell.record);
+			cell.sequence.store(m_DequeuePosition + m_Mask + 1, std::memory_order_release);
+			m_DequeuePosition++;
+			m_PoppedCount.store(m_DequeuePosition, std::memory_order_release);
+			return true;
+		}
+
+		// single consumer only
+		bool IsEmpty()
+		{
+			return m_Cells[m_DequeuePosition & m_Mask].sequence.load(std::memory_order_acquire) != m_DequeuePosition + 1;
+		}
+
+		uint64_t GetPushedCount() { return m_EnqueuePosition.load(std::memory_order_acquire); }
+		uint64_t GetPoppedCount() { return m_PoppedCount.load(std::memory_order_acquire); }
+		uint64_t GetDroppedCount() { return m_DroppedCount.load(std::memory_order_relaxed); }
+		LogOverflowPolicy GetPolicy() { return m_Policy; }
+
+	private:
+		std::unique_ptr<Cell[]> m_Cells;
+		uint64_t			  m_Mask;
+		LogOverflowPolicy	  m_Policy;
+
+		alignas(64) std::atomic<uint64_t> m_EnqueuePosition{ 0 };
+		alignas(64) std::atomic<uint64_t> m_DroppedCount{ 0 };
+		alignas(64) uint64_t			  m_DequeuePosition = 0;
+		std::atomic<uint64_t>			  m_PoppedCount{ 0 };
+	};
+
 	class KBS_API Logger
 	{
 	public:
 
 		Logger();
+		// logger writing to custom sinks, mostly for tests and tools
+		Logger(const std::string& name, std::vector<spdlog::sink_ptr> sinks);
+		~Logger();
 
 		template<typename ...Args>
 		void info(const char* msg, Args... args)
 		{
-			m_stdLogger->info(msg, args...);
-			m_fileLogger->info(msg, args...);
+			Log(spdlog::level::info, msg, args...);
 		}
 
 		template<typename ...Args>
 		void warn(const char* msg, Args... args)
 		{
-			m_stdLogger->warn(msg, args...);
-			m_fileLogger->warn(msg, args...);
+			Log(spdlog::level::warn, msg, args...);
 		}
 
 		template<typename ...Args>
 		void error(const char* msg, Args... args)
 		{
-			m_stdLogger->error(msg, args...);
-			m_fileLogger->error(msg, args...);
+			Log(spdlog::level::err, msg, args...);
 		}
 
+		// waits until every queued record is written in async mode
 		void flush();
 
+		// records are formatted by the caller and written by a background thread.
+		// switch modes before other threads start logging
+		void EnableAsync(LogOverflowPolicy policy = LogOverflowPolicy::Block, uint32_t queueCapacity = 4096);
+		void DisableAsync();
+		bool IsAsync() { return m_Queue != nullptr; }
+		uint64_t GetDroppedCount() { return m_Queue != nullptr ? m_Queue->GetDroppedCount() : 0; }
 
 	private:
-		std::shared_ptr<spdlog::logger> m_stdLogger;
-		std::shared_ptr<spdlog::logger> m_fileLogger;
+		template<typename ...Args>
+		void Log(spdlog::level::level_enum level, const char* msg, Args... args)
+		{
+			if (m_Queue == nullptr)
+			{
+				m_Logger->log(level, msg, args...);
+				return;
+			}
+
+			LogRecordQueue::Cell* cell = m_Queue->BeginPush();
+			if (cell == nullptr) return;
+
+			cell->record.level = level;
+			cell->record.length = FormatRecord(cell->record, msg, args...);
+			m_Queue->EndPush(cell);
+
+			// pairs with the fence of the consumer before it sleeps, the system call is only paid while it sleeps
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_ConsumerSleeping.load(std::memory_order_relaxed))
+			{
+				WakeConsumer();
+			}
+		}
+
+		template<typename ...Args>
+		static uint32_t FormatRecord(LogRecord& record, const char* msg, Args... args)
+		{
+			constexpr uint32_t capacity = LogRecord::textCapacity;
+			try
+			{
+				auto result = fmt::format_to_n(record.text, capacity, msg, args...);
+				if (result.size <= capacity)
+				{
+					return (uint32_t)result.size;
+				}
+				memcpy(record.text + capacity - 3, "...", 3);
+				return capacity;
+			}
+			catch (...)
+			{
+				uint32_t length = (uint32_t)std::min<size_t>(strlen(msg), capacity);
+				memcpy(record.text, msg, length);
+				return length;
+			}
+		}
+
+		void ConsumerMain();
+		void WakeConsumer();
+
+		std::shared_ptr<spdlog::logger> m_Logger;
+
+		std::unique_ptr<LogRecordQueue> m_Queue;
+		std::thread						m_ConsumerThread;
+		std::atomic<bool>				m_ConsumerRunning{ false };
+		// the consumer waits on the condition variable while the queue is empty
+		std::atomic<bool>				m_ConsumerSleeping{ false };
+		std::mutex						m_ConsumerLock;
+		std::condition_variable			m_ConsumerWakeup;
 	};
 
     KBS_API std::shared_ptr<Logger> _GetGlobalLogger();
 }
 
-#define KBS_LOG(msg, ...) ::kbs::_GetGlobalLogger()->info(msg, __VA_ARGS__)
-#define KBS_WARN(msg, ...) ::kbs::_GetGlobalLogger()->warn("warning from file {} line {}:"##msg,__FILE__,__LINE__ ,__VA_ARGS__)
+#if KBS_LOG_LEVEL <= KBS_LOG_LEVEL_INFO
+	#define KBS_LOG(msg, ...) ::kbs::_GetGlobalLogger()->info(msg, __VA_ARGS__)
+#else
+	#define KBS_LOG(msg, ...) ((void)0)
+#endif
+
+#if KBS_LOG_LEVEL <= KBS_LOG_LEVEL_WARN
+	#define KBS_WARN(msg, ...) ::kbs::_GetGlobalLogger()->warn("warning from file {} line {}:"##msg,__FILE__,__LINE__ ,__VA_ARGS__)
+#else
+	#define KBS_WARN(msg, ...) ((void)0)
+#endif
+
 #define KBS_ASSERT(expr, msg, ...) if(!(expr)) {::kbs::_GetGlobalLogger()->error("assertion failure from file {} line {}:"##msg##" application quiting",__FILE__,__LINE__, __VA_ARGS__); KBS_BREAK_POINT;_GetGlobalLogger()->flush(); exit(-1); }
 #define KBS_FLUSH_LOG() ::kbs::_GetGlobalLogger()->flush();
 
@@ -0,0 +1,315 @@
+#include "Core/MemoryTracker.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace kbs
+{
+	static constexpr uint32_t tagCount = (uint32_t)MemoryTag::Count;
+
+	static const char* s_TagNames[tagCount] = { "General", "Asset", "Scene", "Renderer", "Shader" };
+
+	const char* GetMemoryTagName(MemoryTag tag)
+	{
+		return (uint32_t)tag < tagCount ? s_TagNames[(uint32_t)tag] : "Invalid";
+	}
+
+	static thread_local MemoryTag t_CurrentTag = MemoryTag::General;
+
+	MemoryTag MemoryTracker::GetCurrentTag()
+	{
+		return t_CurrentTag;
+	}
+
+	MemoryTag MemoryTracker::SetCurrentTag(MemoryTag tag)
+	{
+		MemoryTag previous = t_CurrentTag;
+		t_CurrentTag = tag;
+		return previous;
+	}
+
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+
+	// plain arrays of atomics are constant initialized, allocations before main are counted as well
+	static std::atomic<uint64_t> s_LiveBytes[tagCount];
+	static std::atomic<uint64_t> s_PeakBytes[tagCount];
+	static std::atomic<uint64_t> s_FramePeakBytes[tagCount];
+	static std::atomic<uint64_t> s_LiveAllocations[tagCount];
+	static std::atomic<uint64_t> s_TotalAllocations[tagCount];
+
+	// stored right in front of every tracked allocation
+	struct AllocationHeader
+	{
+		uint64_t size;
+		uint32_t tag;
+		// distance from the malloc'ed pointer to the returned one
+		uint32_t offset;
+	};
+	static_assert(sizeof(AllocationHeader) == 16, "the header keeps 16 bytes alignment of allocations");
+
+	static void UpdatePeak(std::atomic<uint64_t>& peak, uint64_t value)
+	{
+		uint64_t current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+
+	static void* TrackedAllocate(size_t size, size_t alignment)
+	{
+		alignment = std::max<size_t>(alignment, sizeof(AllocationHeader));
+		uint8_t* raw = (uint8_t*)std::malloc(size + alignment);
+		if (raw == nullptr)
+		{
+			return nullptr;
+		}
+
+		uintptr_t user = ((uintptr_t)raw + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		AllocationHeader* header = (AllocationHeader*)user - 1;
+		uint32_t tag = (uint32_t)t_CurrentTag;
+		header->size = size;
+		header->tag = tag;
+		header->offset = (uint32_t)(user - (uintptr_t)raw);
+
+		uint64_t live = s_LiveBytes[tag].fetch_add(size, std::memory_order_relaxed) + size;
+		UpdatePeak(s_PeakBytes[tag], live);
+		UpdatePeak(s_FramePeakBytes[tag], live);
+		s_LiveAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+		s_TotalAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+
+		return (void*)user;
+	}
+
+	static void TrackedFree(void* p)
+	{
+		if (p == nullptr)
+		{
+			return;
+		}
+		AllocationHeader* header = (AllocationHeader*)p - 1;
+		s_LiveBytes[header->tag].fetch_sub(header->size, std::memory_order_relaxed);
+		s_LiveAllocations[header->tag].fetch_sub(1, std::memory_order_relaxed);
+		std::free((uint8_t*)p - header->offset);
+	}
+
+	bool MemoryTracker::IsEnabled()
+	{
+		return true;
+	}
+
+	MemoryTagStatistics MemoryTracker::GetStatistics(MemoryTag tag)
+	{
+		uint32_t i = (uint32_t)tag;
+		MemoryTagStatistics statistics;
+		statistics.liveBytes = s_LiveBytes[i].load(std::memory_order_relaxed);
+		statistics.peakBytes = s_PeakBytes[i].load(std::memory_order_relaxed);
+		statistics.framePeakBytes = s_FramePeakBytes[i].load(std::memory_order_relaxed);
+		statistics.liveAllocations = s_LiveAllocations[i].load(std::memory_order_relaxed);
+		statistics.totalAllocations = s_TotalAllocations[i].load(std::memory_order_relaxed);
+		return statistics;
+	}
+
+	void* MemoryTracker::Malloc(size_t size)
+	{
+		return TrackedAllocate(size, sizeof(AllocationHeader));
+	}
+
+	void* MemoryTracker::Realloc(void* p, size_t size)
+	{
+		void* newMemory = TrackedAllocate(size, sizeof(AllocationHeader));
+		if (p != nullptr && newMemory != nullptr)
+		{
+			memcpy(newMemory, p, std::min<size_t>(size, ((AllocationHeader*)p - 1)->size));
+			TrackedFree(p);
+		}
+		return newMemory;
+	}
+
+	void MemoryTracker::Free(void* p)
+	{
+		TrackedFree(p);
+	}
+
+#else
+
+	bool MemoryTracker::IsEnabled()
+	{
+		return false;
+	}
+
+	MemoryTagStatistics MemoryTracker::GetStatistics(MemoryTag tag)
+	{
+		(void)tag;
+		return MemoryTagStatistics();
+	}
+
+	void* MemoryTracker::Malloc(size_t size)
+	{
+		return std::malloc(size);
+	}
+
+	void* MemoryTracker::Realloc(void* p, size_t size)
+	{
+		return std::realloc(p, size);
+	}
+
+	void MemoryTracker::Free(void* p)
+	{
+		std::free(p);
+	}
+
+#endif
+
+	MemoryTracker::~MemoryTracker()
+	{
+		if (m_FrameDump != nullptr)
+		{
+			fclose(m_FrameDump);
+		}
+	}
+
+	uint64_t MemoryTracker::GetTotalLiveBytes()
+	{
+		uint64_t total = 0;
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			total += GetStatistics((MemoryTag)i).liveBytes;
+		}
+		return total;
+	}
+
+	void MemoryTracker::SetBudget(MemoryTag tag, uint64_t bytes)
+	{
+		m_Budgets[(uint32_t)tag] = bytes;
+	}
+
+	bool MemoryTracker::SetFrameDumpPath(const std::string& path)
+	{
+		if (m_FrameDump != nullptr)
+		{
+			fclose(m_FrameDump);
+		}
+		m_FrameDump = fopen(path.c_str(), "w");
+		if (m_FrameDump == nullptr)
+		{
+			KBS_WARN("fail to open memory dump file {}", path.c_str());
+			return false;
+		}
+
+		fprintf(m_FrameDump, "frame");
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			fprintf(m_FrameDump, ",%s live,%s frame peak,%s allocations", s_TagNames[i], s_TagNames[i], s_TagNames[i]);
+		}
+		fprintf(m_FrameDump, "\n");
+		return true;
+	}
+
+	void MemoryTracker::EndFrame(uint64_t frameIndex)
+	{
+		if (!IsEnabled())
+		{
+			return;
+		}
+
+		MemoryTagStatistics statistics[tagCount];
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			statistics[i] = GetStatistics((MemoryTag)i);
+		}
+
+		if (m_FrameDump != nullptr)
+		{
+			fprintf(m_FrameDump, "%llu", (unsigned long long)frameIndex);
+			for (uint32_t i = 0; i < tagCount; i++)
+			{
+				fprintf(m_FrameDump, ",%llu,%llu,%llu", (unsigned long long)statistics[i].liveBytes,
+					(unsigned long long)statistics[i].framePeakBytes, (unsigned long long)statistics[i].liveAllocations);
+			}
+			fprintf(m_FrameDump, "\n");
+		}
+
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			// only the first frame of a series over the budget is reported
+			bool overBudget = m_Budgets[i] != 0 && statistics[i].framePeakBytes > m_Budgets[i];
+			if (overBudget && !m_OverBudget[i])
+			{
+				KBS_WARN("memory tag {} peaked at {} bytes in frame {}, budget {} bytes", s_TagNames[i],
+					statistics[i].framePeakBytes, frameIndex, m_Budgets[i]);
+			}
+			m_OverBudget[i] = overBudget;
+		}
+
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			s_FramePeakBytes[i].store(s_LiveBytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+#endif
+	}
+
+	void MemoryTracker::LogSummary()
+	{
+		if (!IsEnabled())
+		{
+			KBS_LOG("memory tracking is compiled out, build with KBS_ENABLE_MEMORY_TRACKING");
+			return;
+		}
+		for (uint32_t i = 0; i < tagCount; i++)
+		{
+			MemoryTagStatistics statistics = GetStatistics((MemoryTag)i);
+			KBS_LOG("memory {:<8} live {:>12} bytes peak {:>12} bytes allocations {:>8} live {:>10} total", s_TagNames[i],
+				statistics.liveBytes, statistics.peakBytes, statistics.liveAllocations, statistics.totalAllocations);
+		}
+	}
+}
+
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+
+// replacing the global allocation functions routes every c++ allocation of the module through the tracker
+
+void* operator new(size_t size)
+{
+	if (void* p = kbs::TrackedAllocate(size, alignof(std::max_align_t))) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (void* p = kbs::TrackedAllocate(size, alignof(std::max_align_t))) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return kbs::TrackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return kbs::TrackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* p = kbs::TrackedAllocate(size, (size_t)alignment)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (void* p = kbs::TrackedAllocate(size, (size_t)alignment)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { kbs::TrackedFree(p); }
+void operator delete[](void* p) noexcept { kbs::TrackedFree(p); }
+void operator delete(void* p, size_t) noexcept { kbs::TrackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { kbs::TrackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { kbs::TrackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { kbs::TrackedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { kbs::TrackedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { kbs::TrackedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { kbs::TrackedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { kbs::TrackedFree(p); }
+
+#endif
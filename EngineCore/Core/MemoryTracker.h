@@ -0,0 +1,88 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+#include <atomic>
+#include <cstdio>
+
+namespace kbs
+{
+	enum class MemoryTag : uint32_t
+	{
+		General,
+		Asset,
+		Scene,
+		Renderer,
+		Shader,
+		Count
+	};
+
+	KBS_API const char* GetMemoryTagName(MemoryTag tag);
+
+	struct MemoryTagStatistics
+	{
+		uint64_t liveBytes = 0;
+		uint64_t peakBytes = 0;
+		// peak since the last EndFrame
+		uint64_t framePeakBytes = 0;
+		uint64_t liveAllocations = 0;
+		uint64_t totalAllocations = 0;
+	};
+
+	// heap usage per subsystem. with KBS_ENABLE_MEMORY_TRACKING the global operator new/delete are
+	// replaced, every allocation is charged to the tag of the innermost MemoryTagScope of its thread
+	// and freed bytes are returned to the tag they were charged to
+	class KBS_API MemoryTracker : public Is_Singleton
+	{
+	public:
+		MemoryTracker() = default;
+		~MemoryTracker();
+
+		static bool IsEnabled();
+
+		MemoryTagStatistics GetStatistics(MemoryTag tag);
+		uint64_t			GetTotalLiveBytes();
+
+		// a warning is logged at the end of frames whose peak went over the budget, 0 disables the budget
+		void SetBudget(MemoryTag tag, uint64_t bytes);
+
+		// appends one csv line per frame with the live and peak bytes of every tag
+		bool SetFrameDumpPath(const std::string& path);
+		void EndFrame(uint64_t frameIndex);
+		void LogSummary();
+
+		// tagged malloc for c libraries, e.g. STBI_MALLOC
+		static void* Malloc(size_t size);
+		static void* Realloc(void* p, size_t size);
+		static void	 Free(void* p);
+
+		static MemoryTag GetCurrentTag();
+		static MemoryTag SetCurrentTag(MemoryTag tag);
+
+	private:
+		FILE*	 m_FrameDump = nullptr;
+		uint64_t m_Budgets[(uint32_t)MemoryTag::Count] = {};
+		bool	 m_OverBudget[(uint32_t)MemoryTag::Count] = {};
+	};
+
+	class KBS_API MemoryTagScope
+	{
+	public:
+		MemoryTagScope(MemoryTag tag) : m_Previous(MemoryTracker::SetCurrentTag(tag)) {}
+		~MemoryTagScope() { MemoryTracker::SetCurrentTag(m_Previous); }
+
+		MemoryTagScope(const MemoryTagScope&) = delete;
+		MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+	private:
+		MemoryTag m_Previous;
+	};
+}
+
+#define KBS_MEMORY_CONCAT_IMPL(a, b) a##b
+#define KBS_MEMORY_CONCAT(a, b) KBS_MEMORY_CONCAT_IMPL(a, b)
+
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+	#define KBS_MEMORY_TAG(tag) ::kbs::MemoryTagScope KBS_MEMORY_CONCAT(_kbsMemoryTagScope, __LINE__)(::kbs::MemoryTag::tag)
+#else
+	#define KBS_MEMORY_TAG(tag)
+#endif
@@ -0,0 +1,234 @@
+#include "Profiler.h"
+#include <chrono>
+#include <fstream>
+#include <string_view>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define KBS_PROFILER_USE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define KBS_PROFILER_USE_RDTSC
+#endif
+
+namespace kbs
+{
+	static thread_local Profiler*			 t_BufferOwner = nullptr;
+	static thread_local ProfileThreadBuffer* t_Buffer = nullptr;
+
+	// thread state of the zones, kept out of the exported ProfileScope class since dll interfaces can't hold thread locals
+	static thread_local uint32_t			 t_ZoneDepth = 0;
+	static thread_local ProfileThreadBuffer* t_ZoneBuffer = nullptr;
+
+	// the profiler is looked up by the first zone of a thread only
+	static ProfileThreadBuffer* GetZoneBuffer()
+	{
+		if (t_ZoneBuffer == nullptr)
+		{
+			t_ZoneBuffer = Singleton::GetInstance<Profiler>()->GetThreadBuffer();
+		}
+		return t_ZoneBuffer;
+	}
+
+	static uint64_t SteadyNanoseconds()
+	{
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	Profiler::Profiler()
+	{
+		m_CalibrationTick = Now();
+		m_CalibrationNs = SteadyNanoseconds();
+		m_FrameStart = m_CalibrationTick;
+
+#ifdef KBS_PROFILER_USE_RDTSC
+		// initial tick rate estimation, refined by CalibrateTicks as the application runs
+		while (SteadyNanoseconds() - m_CalibrationNs < 2000000);
+		CalibrateTicks();
+#endif
+	}
+
+	Profiler::~Profiler()
+	{
+		if (!m_TraceOutputPath.empty())
+		{
+			DumpChromeTrace(m_TraceOutputPath);
+		}
+	}
+
+	uint64_t Profiler::Now()
+	{
+#ifdef KBS_PROFILER_USE_RDTSC
+		return __rdtsc();
+#else
+		return SteadyNanoseconds();
+#endif
+	}
+
+	void Profiler::BeginFrame()
+	{
+		m_FrameStart = Now();
+	}
+
+	void Profiler::EndFrame()
+	{
+		uint64_t frameEnd = Now();
+		RecordZone("Frame", m_FrameStart, frameEnd, 0);
+		CalibrateTicks();
+
+		m_LastFrameMs = TicksToNanoseconds(frameEnd - m_FrameStart) / 1e6;
+		m_LastFrameSummary.clear();
+
+		std::unordered_map<std::string_view, uint32_t> summaryIndices;
+		std::lock_guard<std::mutex> guard(m_BufferLock);
+		for (auto& buffer : m_ThreadBuffers)
+		{
+			uint64_t writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+			// records older than the ring capacity are already overwritten
+			uint64_t first = std::max(buffer->summaryCursor, writeIndex > threadBufferCapacity ? writeIndex - threadBufferCapacity : 0);
+
+			for (uint64_t i = first; i < writeIndex; i++)
+			{
+				const ProfileZoneRecord& record = buffer->records[i & (threadBufferCapacity - 1)];
+				double ms = TicksToNanoseconds(record.end - record.start) / 1e6;
+
+				auto iter = summaryIndices.find(record.name);
+				if (iter == summaryIndices.end())
+				{
+					summaryIndices[record.name] = (uint32_t)m_LastFrameSummary.size();
+					m_LastFrameSummary.push_back(ProfileZoneSummary{ record.name, record.depth, 1, ms, ms });
+				}
+				else
+				{
+					ProfileZoneSummary& summary = m_LastFrameSummary[iter->second];
+					summary.depth = std::min(summary.depth, record.depth);
+					summary.callCount++;
+					summary.totalMs += ms;
+					summary.maxMs = std::max(summary.maxMs, ms);
+				}
+			}
+			buffer->summaryCursor = writeIndex;
+		}
+
+		std::sort(m_LastFrameSummary.begin(), m_LastFrameSummary.end(),
+			[](const ProfileZoneSummary& lhs, const ProfileZoneSummary& rhs) { return lhs.totalMs > rhs.totalMs; });
+		m_FrameIndex++;
+	}
+
+	void Profiler::RecordZone(const char* name, uint64_t start, uint64_t end, uint32_t depth)
+	{
+		GetThreadBuffer()->Push(ProfileZoneRecord{ name, start, end, depth });
+	}
+
+	void Profiler::LogLastFrameSummary()
+	{
+		KBS_LOG("frame {} : {:.3f} ms", m_FrameIndex, m_LastFrameMs);
+		for (auto& zone : m_LastFrameSummary)
+		{
+			KBS_LOG("{:<{}}{:<40} calls {:>5} total {:>8.3f} ms max {:>8.3f} ms", "", zone.depth * 2, zone.name, zone.callCount, zone.totalMs, zone.maxMs);
+		}
+	}
+
+	static void WriteJsonString(std::ofstream& file, const char* str)
+	{
+		file << '"';
+		for (const char* c = str; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\') file << '\\';
+			file << *c;
+		}
+		file << '"';
+	}
+
+	bool Profiler::DumpChromeTrace(const std::string& path)
+	{
+		std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+		if (!file.is_open())
+		{
+			KBS_WARN("fail to open profiler trace file {}", path.c_str());
+			return false;
+		}
+		CalibrateTicks();
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool firstEvent = true;
+
+		std::lock_guard<std::mutex> guard(m_BufferLock);
+		for (auto& buffer : m_ThreadBuffers)
+		{
+			uint64_t writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+			uint64_t first = writeIndex > threadBufferCapacity ? writeIndex - threadBufferCapacity : 0;
+
+			for (uint64_t i = first; i < writeIndex; i++)
+			{
+				const ProfileZoneRecord& record = buffer->records[i & (threadBufferCapacity - 1)];
+				// ticks taken before calibration can't be converted by the unsigned difference
+				double startUs = record.start >= m_CalibrationTick ? TicksToNanoseconds(record.start - m_CalibrationTick) / 1e3 : 0.0;
+				double durationUs = TicksToNanoseconds(record.end - record.start) / 1e3;
+
+				file << (firstEvent ? "\n" : ",\n") << "{\"name\":";
+				WriteJsonString(file, record.name);
+				file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+					<< ",\"ts\":" << std::to_string(startUs) << ",\"dur\":" << std::to_string(durationUs) << "}";
+				firstEvent = false;
+			}
+		}
+		file << "\n]}\n";
+
+		return true;
+	}
+
+	double Profiler::TicksToNanoseconds(uint64_t ticks)
+	{
+		return (double)ticks * m_NsPerTick;
+	}
+
+	ProfileThreadBuffer* Profiler::GetThreadBuffer()
+	{
+		if (t_BufferOwner == this)
+		{
+			return t_Buffer;
+		}
+
+		auto buffer = std::make_shared<ProfileThreadBuffer>();
+		buffer->records.resize(threadBufferCapacity);
+		{
+			std::lock_guard<std::mutex> guard(m_BufferLock);
+			buffer->threadIndex = (uint32_t)m_ThreadBuffers.size();
+			m_ThreadBuffers.push_back(buffer);
+		}
+
+		t_BufferOwner = this;
+		t_Buffer = buffer.get();
+		return buffer.get();
+	}
+
+	void Profiler::CalibrateTicks()
+	{
+#ifdef KBS_PROFILER_USE_RDTSC
+		uint64_t tick = Now();
+		uint64_t ns = SteadyNanoseconds();
+		// a short interval gives a noisy ratio, keep the old one until enough time passed
+		if (ns - m_CalibrationNs >= 1000000 && tick > m_CalibrationTick)
+		{
+			m_NsPerTick = (double)(ns - m_CalibrationNs) / (double)(tick - m_CalibrationTick);
+		}
+#endif
+	}
+
+	ProfileScope::ProfileScope(const char* name)
+		:m_Name(name), m_Depth(t_ZoneDepth++)
+	{
+		// the buffer lookup isn't timed
+		GetZoneBuffer();
+		m_Start = Profiler::Now();
+	}
+
+	ProfileScope::~ProfileScope()
+	{
+		uint64_t end = Profiler::Now();
+		t_ZoneDepth--;
+		t_ZoneBuffer->Push(ProfileZoneRecord{ m_Name, m_Start, end, m_Depth });
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+#include <atomic>
+#include <mutex>
+
+namespace kbs
+{
+	// name must point to a string that outlives the profiler, string literals and __FUNCTION__ are fine
+	struct ProfileZoneRecord
+	{
+		const char* name;
+		uint64_t	start;
+		uint64_t	end;
+		uint32_t	depth;
+	};
+
+	struct ProfileZoneSummary
+	{
+		const char* name;
+		uint32_t	depth;
+		uint32_t	callCount;
+		double		totalMs;
+		double		maxMs;
+	};
+
+	// ring of the zones of one thread, written only by its owning thread, readers see records up to writeIndex
+	struct ProfileThreadBuffer
+	{
+		static constexpr uint32_t capacity = 1 << 16;
+
+		uint32_t threadIndex;
+		std::atomic<uint64_t> writeIndex{ 0 };
+		uint64_t summaryCursor = 0;
+		std::vector<ProfileZoneRecord> records;
+
+		void Push(const ProfileZoneRecord& record)
+		{
+			uint64_t index = writeIndex.load(std::memory_order_relaxed);
+			records[index & (capacity - 1)] = record;
+			writeIndex.store(index + 1, std::memory_order_release);
+		}
+	};
+
+	class KBS_API Profiler : public Is_Singleton
+	{
+	public:
+		Profiler();
+		~Profiler();
+
+		// raw timestamp, rdtsc where available, use TicksToNanoseconds to convert
+		static uint64_t Now();
+
+		void BeginFrame();
+		void EndFrame();
+
+		void RecordZone(const char* name, uint64_t start, uint64_t end, uint32_t depth);
+
+		// zones of the last finished frame aggregated by name, sorted by total time
+		const std::vector<ProfileZoneSummary>& GetLastFrameSummary() { return m_LastFrameSummary; }
+		double GetLastFrameMs() { return m_LastFrameMs; }
+		void   LogLastFrameSummary();
+
+		// writes every zone still held by the thread buffers in chrome://tracing format
+		bool   DumpChromeTrace(const std::string& path);
+		// trace is written to this path when the profiler is destroyed
+		void   SetTraceOutputPath(const std::string& path) { m_TraceOutputPath = path; }
+
+		double TicksToNanoseconds(uint64_t ticks);
+
+		// buffer of the calling thread, created by its first zone
+		ProfileThreadBuffer* GetThreadBuffer();
+
+		static constexpr uint32_t threadBufferCapacity = ProfileThreadBuffer::capacity;
+
+	private:
+		void CalibrateTicks();
+
+		std::mutex							  m_BufferLock;
+		std::vector<ptr<ProfileThreadBuffer>> m_ThreadBuffers;
+
+		uint64_t m_FrameStart = 0;
+		uint64_t m_FrameIndex = 0;
+		double	 m_LastFrameMs = 0;
+		std::vector<ProfileZoneSummary> m_LastFrameSummary;
+
+		uint64_t m_CalibrationTick = 0;
+		uint64_t m_CalibrationNs = 0;
+		double	 m_NsPerTick = 1.0;
+
+		std::string m_TraceOutputPath;
+	};
+
+	class KBS_API ProfileScope
+	{
+	public:
+		ProfileScope(const char* name);
+		~ProfileScope();
+
+	private:
+		const char* m_Name;
+		uint32_t	m_Depth;
+		uint64_t	m_Start;
+	};
+}
+
+#define KBS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define KBS_PROFILE_CONCAT(a, b) KBS_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef KBS_ENABLE_PROFILER
+	#define KBS_PROFILE_SCOPE(name) ::kbs::ProfileScope KBS_PROFILE_CONCAT(_kbsProfileScope, __LINE__)(name)
+	#define KBS_PROFILE_FUNCTION() KBS_PROFILE_SCOPE(__FUNCTION__)
+	#define KBS_PROFILE_BEGIN_FRAME() ::kbs::Singleton::GetInstance<::kbs::Profiler>()->BeginFrame()
+	#define KBS_PROFILE_END_FRAME() ::kbs::Singleton::GetInstance<::kbs::Profiler>()->EndFrame()
+#else
+	#define KBS_PROFILE_SCOPE(name)
+	#define KBS_PROFILE_FUNCTION()
+	#define KBS_PROFILE_BEGIN_FRAME()
+	#define KBS_PROFILE_END_FRAME()
+#endif
@@ -0,0 +1,154 @@
+#pragma once
+#include "Common.h"
+
+namespace kbs
+{
+	// index + generation handle into a SlotMap<T>. a handle whose slot was freed
+	// (and possibly reused) has an old generation and is rejected by the map
+	template<typename T>
+	struct SlotHandle
+	{
+		static constexpr uint32_t invalidIndex = 0xffffffff;
+
+		uint32_t index = invalidIndex;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != invalidIndex; }
+
+		bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+		bool operator<(const SlotHandle& other) const { return index < other.index || (index == other.index && generation < other.generation); }
+	};
+
+	// values are stored densely, lookups through a handle are two array reads and a generation check.
+	// removing swaps the last value into the hole, iteration order is stable until a value is removed
+	// and pointers returned by Get are valid until the next Insert or Remove
+	template<typename T>
+	class SlotMap
+	{
+	public:
+		using Handle = SlotHandle<T>;
+
+		SlotMap() = default;
+
+		Handle Insert(T value)
+		{
+			uint32_t slotIndex;
+			if (m_FreeSlot != Handle::invalidIndex)
+			{
+				slotIndex = m_FreeSlot;
+				m_FreeSlot = m_Slots[slotIndex].denseIndex;
+			}
+			else
+			{
+				slotIndex = (uint32_t)m_Slots.size();
+				// generations start from 1 so default handles never match a slot
+				m_Slots.push_back(Slot{ 0, 1 });
+			}
+
+			Slot& slot = m_Slots[slotIndex];
+			slot.denseIndex = (uint32_t)m_Values.size();
+			m_Values.push_back(std::move(value));
+			m_ValueSlots.push_back(slotIndex);
+
+			return Handle{ slotIndex, slot.generation };
+		}
+
+		bool Remove(Handle handle)
+		{
+			if (!Contains(handle))
+			{
+				return false;
+			}
+
+			Slot& slot = m_Slots[handle.index];
+			uint32_t denseIndex = slot.denseIndex;
+			uint32_t lastIndex = (uint32_t)m_Values.size() - 1;
+			if (denseIndex != lastIndex)
+			{
+				m_Values[denseIndex] = std::move(m_Values[lastIndex]);
+				m_ValueSlots[denseIndex] = m_ValueSlots[lastIndex];
+				m_Slots[m_ValueSlots[denseIndex]].denseIndex = denseIndex;
+			}
+			m_Values.pop_back();
+			m_ValueSlots.pop_back();
+
+			slot.generation++;
+			slot.denseIndex = m_FreeSlot;
+			m_FreeSlot = handle.index;
+			return true;
+		}
+
+		bool Contains(Handle handle) const
+		{
+			return handle.index < m_Slots.size() && m_Slots[handle.index].generation == handle.generation;
+		}
+
+		// nullptr if the handle is invalid or the value was removed
+		T* Get(Handle handle)
+		{
+			return Contains(handle) ? &m_Values[m_Slots[handle.index].denseIndex] : nullptr;
+		}
+
+		const T* Get(Handle handle) const
+		{
+			return Contains(handle) ? &m_Values[m_Slots[handle.index].denseIndex] : nullptr;
+		}
+
+		// handle of the value at a position of the dense array
+		Handle GetHandle(uint32_t denseIndex) const
+		{
+			KBS_ASSERT(denseIndex < m_Values.size(), "slot map index out of boundary");
+			uint32_t slotIndex = m_ValueSlots[denseIndex];
+			return Handle{ slotIndex, m_Slots[slotIndex].generation };
+		}
+
+		void Clear()
+		{
+			for (uint32_t i = 0; i < m_ValueSlots.size(); i++)
+			{
+				Slot& slot = m_Slots[m_ValueSlots[i]];
+				slot.generation++;
+				slot.denseIndex = m_FreeSlot;
+				m_FreeSlot = m_ValueSlots[i];
+			}
+			m_Values.clear();
+			m_ValueSlots.clear();
+		}
+
+		uint32_t Size() const { return (uint32_t)m_Values.size(); }
+		bool	 Empty() const { return m_Values.empty(); }
+
+		View<T>	 GetValues() { return View<T>(m_Values); }
+
+		typename std::vector<T>::iterator		begin() { return m_Values.begin(); }
+		typename std::vector<T>::iterator		end() { return m_Values.end(); }
+		typename std::vector<T>::const_iterator begin() const { return m_Values.begin(); }
+		typename std::vector<T>::const_iterator end() const { return m_Values.end(); }
+
+	private:
+		struct Slot
+		{
+			// position in m_Values, or the next free slot if the slot is free
+			uint32_t denseIndex;
+			uint32_t generation;
+		};
+
+		std::vector<T>		  m_Values;
+		std::vector<uint32_t> m_ValueSlots;
+		std::vector<Slot>	  m_Slots;
+		uint32_t			  m_FreeSlot = Handle::invalidIndex;
+	};
+}
+
+namespace std
+{
+	template<typename T>
+	struct hash<kbs::SlotHandle<T>>
+	{
+		size_t operator()(const kbs::SlotHandle<T>& handle) const
+		{
+			return std::hash<uint64_t>()(((uint64_t)handle.generation << 32) | handle.index);
+		}
+	};
+}
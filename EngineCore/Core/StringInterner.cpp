@@ -0,0 +1,65 @@
+#include "Core/StringInterner.h"
+
+namespace kbs
+{
+	InternedString::InternedString(std::string_view str)
+		: InternedString(Singleton::GetInstance<StringInterner>()->Intern(str))
+	{
+	}
+
+	const std::string& InternedString::GetString() const
+	{
+		return Singleton::GetInstance<StringInterner>()->GetString(*this);
+	}
+
+	StringInterner::StringInterner()
+	{
+		m_Strings.emplace_back();
+		m_IDs[m_Strings.back()] = 0;
+	}
+
+	InternedString StringInterner::Intern(std::string_view str)
+	{
+		{
+			std::shared_lock lock(m_Lock);
+			if (auto iter = m_IDs.find(str); iter != m_IDs.end())
+			{
+				return InternedString(iter->second);
+			}
+		}
+
+		std::unique_lock lock(m_Lock);
+		// another thread could have added it between the locks
+		if (auto iter = m_IDs.find(str); iter != m_IDs.end())
+		{
+			return InternedString(iter->second);
+		}
+		uint32_t id = (uint32_t)m_Strings.size();
+		m_Strings.emplace_back(str);
+		m_IDs[m_Strings.back()] = id;
+		return InternedString(id);
+	}
+
+	opt<InternedString> StringInterner::Find(std::string_view str)
+	{
+		std::shared_lock lock(m_Lock);
+		if (auto iter = m_IDs.find(str); iter != m_IDs.end())
+		{
+			return InternedString(iter->second);
+		}
+		return std::nullopt;
+	}
+
+	const std::string& StringInterner::GetString(InternedString str)
+	{
+		std::shared_lock lock(m_Lock);
+		KBS_ASSERT(str.GetID() < m_Strings.size(), "invalid interned string {}", str.GetID());
+		return m_Strings[str.GetID()];
+	}
+
+	uint32_t StringInterner::GetCount()
+	{
+		std::shared_lock lock(m_Lock);
+		return (uint32_t)m_Strings.size();
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+#include <deque>
+#include <shared_mutex>
+#include <string_view>
+
+namespace kbs
+{
+	// handle of a string stored once by the StringInterner, comparing and hashing it is an integer operation.
+	// default constructed handles refer to the empty string
+	class KBS_API InternedString
+	{
+	public:
+		InternedString() = default;
+		explicit InternedString(std::string_view str);
+
+		const std::string& GetString() const;
+		uint32_t		   GetID() const { return m_ID; }
+
+		bool operator==(const InternedString& other) const { return m_ID == other.m_ID; }
+		bool operator!=(const InternedString& other) const { return m_ID != other.m_ID; }
+		bool operator<(const InternedString& other) const { return m_ID < other.m_ID; }
+
+	private:
+		friend class StringInterner;
+		explicit InternedString(uint32_t id) : m_ID(id) {}
+
+		uint32_t m_ID = 0;
+	};
+
+	// strings are never released, intern names and tags, not arbitrary user text
+	class KBS_API StringInterner : public Is_Singleton
+	{
+	public:
+		StringInterner();
+
+		InternedString	   Intern(std::string_view str);
+		// doesn't add the string if it was never interned
+		opt<InternedString> Find(std::string_view str);
+		const std::string& GetString(InternedString str);
+		uint32_t		   GetCount();
+
+	private:
+		std::shared_mutex							   m_Lock;
+		// deque keeps the strings in place, the map keys view them
+		std::deque<std::string>						   m_Strings;
+		std::unordered_map<std::string_view, uint32_t> m_IDs;
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<kbs::InternedString>
+	{
+		size_t operator()(const kbs::InternedString& str) const
+		{
+			return std::hash<uint32_t>()(str.GetID());
+		}
+	};
+}
@@ -5,24 +5,24 @@ namespace kbs
 {
 	Timer::Timer()
 	{
-		m_StartTick = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-		m_LastTick = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-		m_CurrentTick = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+		m_StartTick = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+		m_LastTick = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+		m_CurrentTick = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
 	}
 
 	float kbs::Timer::TotalTime()
 	{
-		return (float)(m_CurrentTick - m_StartTick) / 1000.f;
+		return (float)(m_CurrentTick - m_StartTick) / 1000000.f;
 	}
 
 	float Timer::DeltaTime()
 	{
-		return (float)(m_CurrentTick - m_LastTick) / 1000.f;
+		return (float)(m_CurrentTick - m_LastTick) / 1000000.f;
 	}
 
 	void Timer::Tick()
 	{
 		m_LastTick = m_CurrentTick;
-		m_CurrentTick = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+		m_CurrentTick = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
 	}
 }
@@ -14,6 +14,7 @@ namespace kbs
 
 		void  Tick();
 	private:
+		// microseconds of a steady clock
 		uint64_t m_StartTick = 0;
 		uint64_t m_LastTick = 0;
 		uint64_t m_CurrentTick = 0;
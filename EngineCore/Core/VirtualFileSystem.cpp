@@ -0,0 +1,365 @@
+#include "Core/VirtualFileSystem.h"
+#include "Core/Hasher.h"
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <mutex>
+
+#ifdef KBS_PLATFORM_WINDOWS
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace kbs
+{
+	opt<ptr<MappedFile>> MappedFile::Open(const std::string& path)
+	{
+		ptr<MappedFile> file = std::make_shared<MappedFile>();
+#ifdef KBS_PLATFORM_WINDOWS
+		HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			return std::nullopt;
+		}
+		file->m_File = handle;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(handle, &size))
+		{
+			return std::nullopt;
+		}
+		file->m_Size = (uint64_t)size.QuadPart;
+		// empty files can't be mapped
+		if (file->m_Size == 0)
+		{
+			return file;
+		}
+
+		HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			return std::nullopt;
+		}
+		file->m_Mapping = mapping;
+		file->m_Data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return std::nullopt;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			close(fd);
+			return std::nullopt;
+		}
+		file->m_Size = (uint64_t)st.st_size;
+		if (file->m_Size != 0)
+		{
+			void* data = mmap(nullptr, file->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+			file->m_Data = data == MAP_FAILED ? nullptr : (const uint8_t*)data;
+		}
+		close(fd);
+#endif
+		if (file->m_Size != 0 && file->m_Data == nullptr)
+		{
+			return std::nullopt;
+		}
+		return file;
+	}
+
+	MappedFile::~MappedFile()
+	{
+#ifdef KBS_PLATFORM_WINDOWS
+		if (m_Data != nullptr) UnmapViewOfFile(m_Data);
+		if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+		if (m_File != nullptr) CloseHandle(m_File);
+#else
+		if (m_Data != nullptr) munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+	}
+
+	opt<ptr<PackArchive>> PackArchive::Open(const std::string& path)
+	{
+		auto file = MappedFile::Open(path);
+		if (!file.has_value())
+		{
+			KBS_WARN("fail to open pack file {}", path.c_str());
+			return std::nullopt;
+		}
+
+		ptr<MappedFile> mapped = file.value();
+		const uint8_t* data = mapped->Data();
+		uint64_t size = mapped->Size();
+
+		if (size < sizeof(PackHeader))
+		{
+			KBS_WARN("pack file {} is too small", path.c_str());
+			return std::nullopt;
+		}
+		const PackHeader* header = (const PackHeader*)data;
+		if (header->fileMagic != PackHeader::magic || header->version != PackHeader::currentVersion)
+		{
+			KBS_WARN("file {} is not a pack file or its version is not supported", path.c_str());
+			return std::nullopt;
+		}
+		if (header->entryOffset > size || header->entryCount > (size - header->entryOffset) / sizeof(PackEntry) || header->stringOffset > size)
+		{
+			KBS_WARN("pack file {} is truncated", path.c_str());
+			return std::nullopt;
+		}
+
+		// validate every entry once so lookups can trust them, the string table runs to the end of the file
+		const PackEntry* entries = (const PackEntry*)(data + header->entryOffset);
+		uint64_t stringSize = size - header->stringOffset;
+		for (uint32_t i = 0; i < header->entryCount; i++)
+		{
+			const PackEntry& entry = entries[i];
+			if (entry.offset > size || entry.size > size - entry.offset ||
+				entry.pathOffset > stringSize || entry.pathLength > stringSize - entry.pathOffset ||
+				(i > 0 && entry.pathHash < entries[i - 1].pathHash))
+			{
+				KBS_WARN("entry {} of pack file {} is corrupted", i, path.c_str());
+				return std::nullopt;
+			}
+		}
+
+		ptr<PackArchive> archive = std::make_shared<PackArchive>();
+		archive->m_File = mapped;
+		archive->m_Header = header;
+		archive->m_Entries = entries;
+		archive->m_Strings = (const char*)(data + header->stringOffset);
+		return archive;
+	}
+
+	const PackEntry* PackArchive::FindEntry(std::string_view relativePath)
+	{
+		uint64_t hash = Hasher::HashMemoryContent(relativePath.data(), relativePath.size());
+
+		const PackEntry* end = m_Entries + m_Header->entryCount;
+		const PackEntry* entry = std::lower_bound(m_Entries, end, hash,
+			[](const PackEntry& e, uint64_t h) { return e.pathHash < h; });
+
+		// colliding hashes are adjacent, compare the stored paths
+		for (; entry != end && entry->pathHash == hash; entry++)
+		{
+			if (std::string_view(m_Strings + entry->pathOffset, entry->pathLength) == relativePath)
+			{
+				return entry;
+			}
+		}
+		return nullptr;
+	}
+
+	opt<FileBlob> PackArchive::Find(std::string_view relativePath)
+	{
+		const PackEntry* entry = FindEntry(relativePath);
+		if (entry == nullptr)
+		{
+			return std::nullopt;
+		}
+
+		FileBlob blob;
+		blob.data = m_File->Data() + entry->offset;
+		blob.size = entry->size;
+		blob.owner = m_File;
+		return blob;
+	}
+
+	bool PackArchive::Contains(std::string_view relativePath)
+	{
+		return FindEntry(relativePath) != nullptr;
+	}
+
+	bool PackArchive::BuildFromDirectory(const std::string& directory, const std::string& packPath)
+	{
+		namespace fs = std::filesystem;
+		if (!fs::is_directory(directory))
+		{
+			KBS_WARN("fail to build pack, {} is not a directory", directory.c_str());
+			return false;
+		}
+
+		std::vector<std::string> relativePaths;
+		for (auto& item : fs::recursive_directory_iterator(directory))
+		{
+			if (item.is_regular_file() && fs::absolute(item.path()) != fs::absolute(packPath))
+			{
+				relativePaths.push_back(fs::relative(item.path(), directory).generic_string());
+			}
+		}
+		std::sort(relativePaths.begin(), relativePaths.end());
+
+		std::ofstream pack(packPath, std::ios::binary | std::ios::trunc);
+		if (!pack.is_open())
+		{
+			KBS_WARN("fail to create pack file {}", packPath.c_str());
+			return false;
+		}
+
+		constexpr uint64_t alignment = 16;
+		auto pad = [&](uint64_t position)
+		{
+			static const char zeros[alignment] = {};
+			uint64_t aligned = (position + alignment - 1) / alignment * alignment;
+			pack.write(zeros, aligned - position);
+			return aligned;
+		};
+
+		PackHeader header{};
+		pack.write((const char*)&header, sizeof(header));
+		uint64_t position = pad(sizeof(header));
+
+		std::vector<PackEntry> entries;
+		std::string strings;
+		std::vector<char> content;
+		for (auto& relativePath : relativePaths)
+		{
+			std::ifstream file(fs::path(directory) / relativePath, std::ios::binary | std::ios::ate);
+			if (!file.is_open())
+			{
+				KBS_WARN("fail to read {} while building pack", relativePath.c_str());
+				return false;
+			}
+			content.resize((size_t)file.tellg());
+			file.seekg(0, std::ios::beg);
+			file.read(content.data(), content.size());
+
+			PackEntry entry{};
+			entry.pathHash = Hasher::HashMemoryContent(relativePath.data(), relativePath.size());
+			entry.offset = position;
+			entry.size = content.size();
+			entry.pathOffset = (uint32_t)strings.size();
+			entry.pathLength = (uint32_t)relativePath.size();
+			entries.push_back(entry);
+			strings += relativePath;
+
+			pack.write(content.data(), content.size());
+			position = pad(position + content.size());
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const PackEntry& lhs, const PackEntry& rhs) { return lhs.pathHash < rhs.pathHash; });
+
+		header.fileMagic = PackHeader::magic;
+		header.version = PackHeader::currentVersion;
+		header.entryCount = (uint32_t)entries.size();
+		header.entryOffset = position;
+		header.stringOffset = position + entries.size() * sizeof(PackEntry);
+
+		pack.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+		pack.write(strings.data(), strings.size());
+		pack.seekp(0, std::ios::beg);
+		pack.write((const char*)&header, sizeof(header));
+
+		return pack.good();
+	}
+
+	std::string VirtualFileSystem::NormalizePath(const std::string& path)
+	{
+		return std::filesystem::path(path).lexically_normal().generic_string();
+	}
+
+	bool VirtualFileSystem::Mount(const std::string& packPath, const std::string& mountDirectory)
+	{
+		auto archive = PackArchive::Open(packPath);
+		if (!archive.has_value())
+		{
+			return false;
+		}
+
+		MountPoint mount;
+		mount.archive = archive.value();
+		mount.directory = mountDirectory.empty() ?
+			NormalizePath(std::filesystem::absolute(packPath).parent_path().string()) :
+			NormalizePath(mountDirectory);
+		// "a/b/" and "a/b" should mount the same way
+		while (!mount.directory.empty() && mount.directory.back() == '/')
+		{
+			mount.directory.pop_back();
+		}
+
+		std::unique_lock lock(m_Lock);
+		// packs mounted later shadow the earlier ones
+		m_Mounts.insert(m_Mounts.begin(), mount);
+		KBS_LOG("pack {} with {} files mounted at {}", packPath.c_str(), mount.archive->GetEntryCount(), mount.directory.c_str());
+		return true;
+	}
+
+	void VirtualFileSystem::UnmountAll()
+	{
+		std::unique_lock lock(m_Lock);
+		m_Mounts.clear();
+	}
+
+	opt<std::string_view> VirtualFileSystem::RelativeToMount(const MountPoint& mount, std::string_view path)
+	{
+		if (path.size() <= mount.directory.size() + 1 ||
+			path.compare(0, mount.directory.size(), mount.directory) != 0 ||
+			path[mount.directory.size()] != '/')
+		{
+			return std::nullopt;
+		}
+		return path.substr(mount.directory.size() + 1);
+	}
+
+	bool VirtualFileSystem::Contains(const std::string& absolutePath)
+	{
+		std::shared_lock lock(m_Lock);
+		if (m_Mounts.empty())
+		{
+			return false;
+		}
+
+		std::string path = NormalizePath(absolutePath);
+		for (auto& mount : m_Mounts)
+		{
+			if (auto relative = RelativeToMount(mount, path); relative.has_value() && mount.archive->Contains(relative.value()))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	opt<FileBlob> VirtualFileSystem::Open(const std::string& absolutePath)
+	{
+		{
+			std::shared_lock lock(m_Lock);
+			if (!m_Mounts.empty())
+			{
+				std::string path = NormalizePath(absolutePath);
+				for (auto& mount : m_Mounts)
+				{
+					if (auto relative = RelativeToMount(mount, path); relative.has_value())
+					{
+						if (auto blob = mount.archive->Find(relative.value()); blob.has_value())
+						{
+							return blob;
+						}
+					}
+				}
+			}
+		}
+
+		auto file = MappedFile::Open(absolutePath);
+		if (!file.has_value())
+		{
+			return std::nullopt;
+		}
+
+		FileBlob blob;
+		blob.data = file.value()->Data();
+		blob.size = file.value()->Size();
+		blob.owner = file.value();
+		return blob;
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Common.h"
+#include "Core/Singleton.h"
+#include <string_view>
+#include <shared_mutex>
+
+namespace kbs
+{
+	// read only view of a file's content, owner keeps the memory mapping alive
+	struct FileBlob
+	{
+		const uint8_t* data = nullptr;
+		uint64_t	   size = 0;
+		ptr<void>	   owner;
+
+		std::string_view AsString() const { return std::string_view((const char*)data, size); }
+	};
+
+	// a whole file mapped into memory, the mapping is released with the object
+	class KBS_API MappedFile
+	{
+	public:
+		static opt<ptr<MappedFile>> Open(const std::string& path);
+
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		~MappedFile();
+
+		const uint8_t* Data() { return m_Data; }
+		uint64_t	   Size() { return m_Size; }
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		uint64_t	   m_Size = 0;
+#ifdef KBS_PLATFORM_WINDOWS
+		void*		   m_File = nullptr;
+		void*		   m_Mapping = nullptr;
+#endif
+	};
+
+	// packed archive layout:
+	//   PackHeader | file contents (16 bytes aligned) | PackEntry[entryCount] sorted by pathHash | path strings
+	// paths are stored relative to the packed directory with '/' separators
+	struct PackHeader
+	{
+		static constexpr uint32_t magic = 0x50534B42; // "KBSP"
+		static constexpr uint32_t currentVersion = 1;
+
+		uint32_t fileMagic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t entryOffset;
+		uint64_t stringOffset;
+	};
+
+	struct PackEntry
+	{
+		uint64_t pathHash;
+		uint64_t offset;
+		uint64_t size;
+		uint32_t pathOffset;
+		uint32_t pathLength;
+	};
+
+	class KBS_API PackArchive
+	{
+	public:
+		static opt<ptr<PackArchive>> Open(const std::string& path);
+
+		// relativePath must be normalized, see VirtualFileSystem::NormalizePath
+		opt<FileBlob> Find(std::string_view relativePath);
+		bool		  Contains(std::string_view relativePath);
+
+		uint32_t GetEntryCount() { return m_Header->entryCount; }
+
+		// packs every regular file under directory into packPath
+		static bool BuildFromDirectory(const std::string& directory, const std::string& packPath);
+
+	private:
+		const PackEntry* FindEntry(std::string_view relativePath);
+
+		ptr<MappedFile>	  m_File;
+		const PackHeader* m_Header = nullptr;
+		const PackEntry*  m_Entries = nullptr;
+		const char*		  m_Strings = nullptr;
+	};
+
+	// overlays packed archives on directories of the disk. files inside a mounted pack are
+	// found by their absolute path as if they were extracted to the mount directory,
+	// other files are memory mapped from the disk
+	class KBS_API VirtualFileSystem : public Is_Singleton
+	{
+	public:
+		VirtualFileSystem() = default;
+
+		// mountDirectory defaults to the directory containing the pack
+		bool Mount(const std::string& packPath, const std::string& mountDirectory = "");
+		void UnmountAll();
+
+		// true if a mounted pack holds the file, the disk is not checked
+		bool Contains(const std::string& absolutePath);
+		opt<FileBlob> Open(const std::string& absolutePath);
+
+		static std::string NormalizePath(const std::string& path);
+
+	private:
+		struct MountPoint
+		{
+			std::string		 directory;
+			ptr<PackArchive> archive;
+		};
+
+		// returns the pack relative path if path lies under the mount directory
+		static opt<std::string_view> RelativeToMount(const MountPoint& mount, std::string_view path);
+
+		std::shared_mutex		m_Lock;
+		std::vector<MountPoint> m_Mounts;
+	};
+}
@@ -1,10 +1,48 @@
 #include "Window.h"
 #include "Core/Application.h"
 
-kbs::Window::Window(uint32_t width, uint32_t height, Application* app, const char* title)
-	:m_App(app), m_Height(height), m_Width(width)
+kbs::Window::Window(uint32_t width, uint32_t height, Application* app, const char* title, bool headless)
+	:m_App(app), m_Height(height), m_Width(width), m_Headless(headless), title(title)
 {
-	m_Window = gvk::Window::Create(width, height, title).value();
+	if (!headless)
+	{
+		m_Window = gvk::Window::Create(width, height, title).value();
+	}
+}
+
+KBS_API bool kbs::Window::IsHeadless()
+{
+	return m_Headless;
+}
+
+KBS_API bool kbs::Window::KeyDown(GVK_KEY key)
+{
+	return m_Window != nullptr && m_Window->KeyDown(key);
+}
+
+KBS_API bool kbs::Window::KeyHold(GVK_KEY key)
+{
+	return m_Window != nullptr && m_Window->KeyHold(key);
+}
+
+KBS_API bool kbs::Window::KeyUp(GVK_KEY key)
+{
+	return m_Window != nullptr && m_Window->KeyUp(key);
+}
+
+KBS_API bool kbs::Window::MouseMove()
+{
+	return m_Window != nullptr && m_Window->MouseMove();
+}
+
+KBS_API GvkVector2 kbs::Window::GetMouseOffset()
+{
+	if (m_Window == nullptr)
+	{
+		GvkVector2 offset{};
+		return offset;
+	}
+	return m_Window->GetMouseOffset();
 }
 
 KBS_API const char*  kbs::Window::GetTitle()
@@ -19,10 +57,15 @@ KBS_API std::shared_ptr<gvk::Window> kbs::Window::GetGvkWindow()
 
 KBS_API void kbs::Window::Update()
 {
+	if (m_Headless)
+	{
+		return;
+	}
+
 	if (m_Window->MouseMove())
 	{
 		GvkVector2 offset = m_Window->GetMouseOffset();
-		m_App->BoardcastEvent<MouseMovedEvent>(offset.x, offset.y);
+		m_App->QueueEvent<MouseMovedEvent>(offset.x, offset.y);
 	}
 
 	for (int i = 0;i < GVK_KEY_NUM; i++)
@@ -32,26 +75,26 @@ KBS_API void kbs::Window::Update()
 		{
 			if (m_Window->KeyDown(keyi))
 			{
-				m_App->BoardcastEvent<MouseButtonDownEvent>(keyi);
+				m_App->QueueEvent<MouseButtonDownEvent>(keyi);
 			}
 			else if (m_Window->KeyUp(keyi))
 			{
-				m_App->BoardcastEvent<MouseButtonReleasedEvent>(keyi);
+				m_App->QueueEvent<MouseButtonReleasedEvent>(keyi);
 			}
 		}
 		else
 		{
 			if (m_Window->KeyDown(keyi))
 			{
-				m_App->BoardcastEvent<KeyDownEvent>(keyi);
+				m_App->QueueEvent<KeyDownEvent>(keyi);
 			}
 			else if (m_Window->KeyHold(keyi))
 			{
-				m_App->BoardcastEvent<KeyHoldEvent>(keyi);
+				m_App->QueueEvent<KeyHoldEvent>(keyi);
 			}
 			else if (m_Window->KeyUp(keyi))
 			{
-				m_App->BoardcastEvent<KeyReleasedEvent>(keyi);
+				m_App->QueueEvent<KeyReleasedEvent>(keyi);
 			}
 		}
 	}
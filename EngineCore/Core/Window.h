@@ -10,10 +10,19 @@ namespace kbs
 	class KBS_API Window
 	{
 	public:
-		Window(uint32_t width, uint32_t height, Application* app, const char* title);
+		Window(uint32_t width, uint32_t height, Application* app, const char* title, bool headless = false);
 
 		void Update();
 
+		// a headless window has no gvk window, renderers draw to offscreen images and input is always idle
+		bool IsHeadless();
+
+		bool KeyDown(GVK_KEY key);
+		bool KeyHold(GVK_KEY key);
+		bool KeyUp(GVK_KEY key);
+		bool MouseMove();
+		GvkVector2 GetMouseOffset();
+
 		uint32_t GetWidth();
 		uint32_t GetHeight();
 
@@ -26,5 +35,6 @@ namespace kbs
 
 		std::shared_ptr<gvk::Window> m_Window;
 		std::string title;
+		bool m_Headless;
 	};
 }
@@ -0,0 +1,390 @@
+#include "Math/DynamicAABBTree.h"
+
+namespace kbs
+{
+	uint32_t DynamicAABBTree::CreateProxy(const AABB& bounds, uint32_t userData)
+	{
+		uint32_t leaf = AllocateNode();
+		Node& node = m_Nodes[leaf];
+		m_Bounds[leaf] = bounds;
+		node.box = AABB(bounds.lower - vec3(m_Margin), bounds.upper + vec3(m_Margin));
+		node.userData = userData;
+		InsertLeaf(leaf);
+		m_ProxyCount++;
+		return leaf;
+	}
+
+	void DynamicAABBTree::DestroyProxy(uint32_t proxy)
+	{
+		KBS_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "{} is not a proxy of the tree", proxy);
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		m_ProxyCount--;
+	}
+
+	bool DynamicAABBTree::MoveProxy(uint32_t proxy, const AABB& bounds)
+	{
+		KBS_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "{} is not a proxy of the tree", proxy);
+		vec3 displacement = bounds.GetCenter() - m_Bounds[proxy].GetCenter();
+		m_Bounds[proxy] = bounds;
+		if (m_Nodes[proxy].box.Contains(bounds))
+		{
+			return false;
+		}
+
+		uint32_t parent = m_Nodes[proxy].parent;
+		uint32_t searchRoot = parent == nullNode ? nullNode : m_Nodes[parent].parent;
+		RemoveLeaf(proxy);
+
+		// a proxy keeping its velocity stays inside for displacementMultiplier more moves
+		AABB box(bounds.lower - vec3(m_Margin), bounds.upper + vec3(m_Margin));
+		vec3 ahead = displacement * displacementMultiplier;
+		box.lower += glm::min(ahead, vec3(0.f));
+		box.upper += glm::max(ahead, vec3(0.f));
+		m_Nodes[proxy].box = box;
+
+		// the proxy moved a little, the search starts from the closest old ancestor containing it. the ancestors above
+		// don't grow whichever sibling is picked below, and the nodes on the way are still in the cache
+		if (searchRoot == nullNode)
+		{
+			searchRoot = m_Root;
+		}
+		while (searchRoot != m_Root && !m_Nodes[searchRoot].box.Contains(box))
+		{
+			searchRoot = m_Nodes[searchRoot].parent;
+		}
+		InsertLeaf(proxy, searchRoot);
+		return true;
+	}
+
+	void DynamicAABBTree::Clear()
+	{
+		m_Nodes.clear();
+		m_Bounds.clear();
+		m_Root = nullNode;
+		m_FreeList = nullNode;
+		m_ProxyCount = 0;
+	}
+
+	float DynamicAABBTree::GetAreaRatio() const
+	{
+		if (m_Root == nullNode)
+		{
+			return 0.f;
+		}
+		float area = 0.f;
+		for (const Node& node : m_Nodes)
+		{
+			if (node.height > 0) area += node.box.GetSurfaceArea();
+		}
+		return area / m_Nodes[m_Root].box.GetSurfaceArea();
+	}
+
+	bool DynamicAABBTree::Validate() const
+	{
+		uint32_t freeCount = 0;
+		for (uint32_t node = m_FreeList; node != nullNode; node = m_Nodes[node].parent)
+		{
+			if (m_Nodes[node].height != -1) return false;
+			freeCount++;
+		}
+
+		uint32_t reachable = 0, leafCount = 0;
+		if (m_Root != nullNode)
+		{
+			if (m_Nodes[m_Root].parent != nullNode) return false;
+			std::vector<uint32_t> stack = { m_Root };
+			while (!stack.empty())
+			{
+				uint32_t index = stack.back();
+				stack.pop_back();
+				const Node& node = m_Nodes[index];
+				reachable++;
+				if (node.IsLeaf())
+				{
+					if (node.height != 0 || !node.box.Contains(m_Bounds[index])) return false;
+					leafCount++;
+					continue;
+				}
+
+				const Node& child1 = m_Nodes[node.child1];
+				const Node& child2 = m_Nodes[node.child2];
+				if (child1.parent != index || child2.parent != index) return false;
+				if (node.height != 1 + std::max(child1.height, child2.height)) return false;
+				AABB box = Union(child1.box, child2.box);
+				if (box.lower != node.box.lower || box.upper != node.box.upper) return false;
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+		return leafCount == m_ProxyCount && reachable + freeCount == m_Nodes.size();
+	}
+
+	uint32_t DynamicAABBTree::AllocateNode()
+	{
+		uint32_t index;
+		if (m_FreeList == nullNode)
+		{
+			index = (uint32_t)m_Nodes.size();
+			m_Nodes.emplace_back();
+			m_Bounds.emplace_back();
+		}
+		else
+		{
+			index = m_FreeList;
+			m_FreeList = m_Nodes[index].parent;
+		}
+
+		Node& node = m_Nodes[index];
+		node = Node();
+		node.height = 0;
+		return index;
+	}
+
+	void DynamicAABBTree::FreeNode(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		node.parent = m_FreeList;
+		node.height = -1;
+		m_FreeList = index;
+	}
+
+	// branch and bound search for the sibling with the lowest cost, the cost of a sibling is the surface
+	// area of the new parent plus the area the ancestors of the sibling grow by
+	uint32_t DynamicAABBTree::FindBestSibling(const AABB& box, uint32_t searchRoot) const
+	{
+		float area = box.GetSurfaceArea();
+
+		uint32_t best = searchRoot;
+		float directCost = Union(m_Nodes[searchRoot].box, box).GetSurfaceArea();
+		float bestCost = directCost;
+		float inheritedCost = 0.f;
+
+		uint32_t index = searchRoot;
+		while (!m_Nodes[index].IsLeaf())
+		{
+			const Node& node = m_Nodes[index];
+			float cost = directCost + inheritedCost;
+			if (cost < bestCost)
+			{
+				best = index;
+				bestCost = cost;
+			}
+			// the node grows by this much whichever of its descendants becomes the sibling
+			inheritedCost += directCost - node.box.GetSurfaceArea();
+
+			uint32_t children[2] = { node.child1, node.child2 };
+			float directCosts[2], lowerBounds[2];
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const Node& child = m_Nodes[children[i]];
+				directCosts[i] = Union(child.box, box).GetSurfaceArea();
+				if (child.IsLeaf())
+				{
+					float childCost = directCosts[i] + inheritedCost;
+					if (childCost < bestCost)
+					{
+						best = children[i];
+						bestCost = childCost;
+					}
+					lowerBounds[i] = FLT_MAX;
+				}
+				else
+				{
+					// any descendant adds at least the area of the new leaf and the growth of the child
+					lowerBounds[i] = inheritedCost + directCosts[i] - child.box.GetSurfaceArea() + area;
+				}
+			}
+
+			uint32_t next = lowerBounds[0] <= lowerBounds[1] ? 0 : 1;
+			if (lowerBounds[next] >= bestCost)
+			{
+				break;
+			}
+			index = children[next];
+			directCost = directCosts[next];
+		}
+		return best;
+	}
+
+	void DynamicAABBTree::InsertLeaf(uint32_t leaf, uint32_t searchRoot)
+	{
+		if (m_Root == nullNode)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].parent = nullNode;
+			return;
+		}
+
+		uint32_t sibling = FindBestSibling(m_Nodes[leaf].box, searchRoot == nullNode ? m_Root : searchRoot);
+		uint32_t oldParent = m_Nodes[sibling].parent;
+		uint32_t newParent = AllocateNode();
+
+		Node& parent = m_Nodes[newParent];
+		parent.parent = oldParent;
+		parent.box = Union(m_Nodes[leaf].box, m_Nodes[sibling].box);
+		parent.height = m_Nodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[leaf].parent = newParent;
+
+		if (oldParent == nullNode)
+		{
+			m_Root = newParent;
+		}
+		else
+		{
+			ReplaceChild(oldParent, sibling, newParent);
+			Refit(oldParent);
+		}
+	}
+
+	void DynamicAABBTree::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = nullNode;
+			return;
+		}
+
+		uint32_t parent = m_Nodes[leaf].parent;
+		uint32_t grandParent = m_Nodes[parent].parent;
+		uint32_t sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+		m_Nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		if (grandParent == nullNode)
+		{
+			m_Root = sibling;
+		}
+		else
+		{
+			// the ancestors only lose a leaf, they are rotated when the leaf is inserted again
+			ReplaceChild(grandParent, parent, sibling);
+			Shrink(grandParent);
+		}
+	}
+
+	void DynamicAABBTree::Shrink(uint32_t index)
+	{
+		while (index != nullNode)
+		{
+			Node& node = m_Nodes[index];
+			const Node& child1 = m_Nodes[node.child1];
+			const Node& child2 = m_Nodes[node.child2];
+			AABB box = Union(child1.box, child2.box);
+			int32_t height = 1 + std::max(child1.height, child2.height);
+			if (box.lower == node.box.lower && box.upper == node.box.upper && height == node.height)
+			{
+				break;
+			}
+			node.box = box;
+			node.height = height;
+			index = node.parent;
+		}
+	}
+
+	void DynamicAABBTree::Refit(uint32_t index)
+	{
+		while (index != nullNode)
+		{
+			Rotate(index);
+
+			Node& node = m_Nodes[index];
+			const Node& child1 = m_Nodes[node.child1];
+			const Node& child2 = m_Nodes[node.child2];
+			AABB box = Union(child1.box, child2.box);
+			int32_t height = 1 + std::max(child1.height, child2.height);
+			// the ancestors already contain the leaf, they were rotated when their bounds last changed
+			if (box.lower == node.box.lower && box.upper == node.box.upper && height == node.height)
+			{
+				break;
+			}
+			node.box = box;
+			node.height = height;
+			index = node.parent;
+		}
+	}
+
+	// swaps a child of the node with a grandchild under its other child if that shrinks the other child,
+	// the node itself covers the same leaves afterwards
+	void DynamicAABBTree::Rotate(uint32_t index)
+	{
+		enum Rotation { None, BF, BG, CD, CE } rotation = None;
+		float bestDiff = 0.f;
+
+		Node& a = m_Nodes[index];
+		uint32_t b = a.child1, c = a.child2;
+		Node& nodeB = m_Nodes[b];
+		Node& nodeC = m_Nodes[c];
+
+		// the children may still have the bounds before the leaf was inserted or removed below them
+		if (!nodeB.IsLeaf())
+		{
+			nodeB.box = Union(m_Nodes[nodeB.child1].box, m_Nodes[nodeB.child2].box);
+		}
+		if (!nodeC.IsLeaf())
+		{
+			nodeC.box = Union(m_Nodes[nodeC.child1].box, m_Nodes[nodeC.child2].box);
+		}
+
+		if (!nodeC.IsLeaf())
+		{
+			float areaC = nodeC.box.GetSurfaceArea();
+			const Node& f = m_Nodes[nodeC.child1];
+			const Node& g = m_Nodes[nodeC.child2];
+			float diffBF = Union(nodeB.box, g.box).GetSurfaceArea() - areaC;
+			float diffBG = Union(nodeB.box, f.box).GetSurfaceArea() - areaC;
+			if (diffBF < bestDiff) { rotation = BF; bestDiff = diffBF; }
+			if (diffBG < bestDiff) { rotation = BG; bestDiff = diffBG; }
+		}
+		if (!nodeB.IsLeaf())
+		{
+			float areaB = nodeB.box.GetSurfaceArea();
+			const Node& d = m_Nodes[nodeB.child1];
+			const Node& e = m_Nodes[nodeB.child2];
+			float diffCD = Union(nodeC.box, e.box).GetSurfaceArea() - areaB;
+			float diffCE = Union(nodeC.box, d.box).GetSurfaceArea() - areaB;
+			if (diffCD < bestDiff) { rotation = CD; bestDiff = diffCD; }
+			if (diffCE < bestDiff) { rotation = CE; bestDiff = diffCE; }
+		}
+
+		// moves child of a into the slot of grandChild under parent
+		auto swap = [&](uint32_t child, uint32_t parent, uint32_t grandChild)
+		{
+			Node& p = m_Nodes[parent];
+			ReplaceChild(index, child, grandChild);
+			m_Nodes[grandChild].parent = index;
+			if (p.child1 == grandChild) p.child1 = child; else p.child2 = child;
+			m_Nodes[child].parent = parent;
+
+			const Node& child1 = m_Nodes[p.child1];
+			const Node& child2 = m_Nodes[p.child2];
+			p.box = Union(child1.box, child2.box);
+			p.height = 1 + std::max(child1.height, child2.height);
+		};
+
+		switch (rotation)
+		{
+		case BF: swap(b, c, nodeC.child1); break;
+		case BG: swap(b, c, nodeC.child2); break;
+		case CD: swap(c, b, nodeB.child1); break;
+		case CE: swap(c, b, nodeB.child2); break;
+		default: break;
+		}
+	}
+
+	void DynamicAABBTree::ReplaceChild(uint32_t parent, uint32_t oldChild, uint32_t newChild)
+	{
+		Node& node = m_Nodes[parent];
+		if (node.child1 == oldChild)
+		{
+			node.child1 = newChild;
+		}
+		else
+		{
+			node.child2 = newChild;
+		}
+	}
+}
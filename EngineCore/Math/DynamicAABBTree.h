@@ -0,0 +1,213 @@
+#pragma once
+#include "Common.h"
+#include "Math/Geometry.h"
+
+namespace kbs
+{
+	// bounding volume hierarchy over moving boxes, based on box2d's dynamic tree. leaves keep the tight
+	// bounds of their proxy and a fattened copy in the tree, so proxies moving inside their fattened
+	// bounds don't touch the tree. the fattened bounds of a moved proxy are stretched along its last
+	// displacement to keep steadily moving proxies in place for a few frames. new leaves are inserted next
+	// to the sibling with the lowest surface area cost and the refitted ancestors are rotated to lower their surface area
+	class KBS_API DynamicAABBTree
+	{
+	public:
+		static constexpr uint32_t nullNode = 0xffffffff;
+
+		DynamicAABBTree(float margin = .1f) : m_Margin(margin) {}
+
+		// the fattened bounds of a reinserted proxy reach this many displacements ahead of it
+		static constexpr float displacementMultiplier = 4.f;
+
+		uint32_t CreateProxy(const AABB& bounds, uint32_t userData);
+		void	 DestroyProxy(uint32_t proxy);
+		// returns true if the proxy left its fattened bounds and was reinserted
+		bool	 MoveProxy(uint32_t proxy, const AABB& bounds);
+		void	 Clear();
+
+		uint32_t	GetUserData(uint32_t proxy) const { return m_Nodes[proxy].userData; }
+		const AABB& GetBounds(uint32_t proxy) const { return m_Bounds[proxy]; }
+		const AABB& GetFatBounds(uint32_t proxy) const { return m_Nodes[proxy].box; }
+		uint32_t	GetProxyCount() const { return m_ProxyCount; }
+		// height of the root, 0 for a tree holding a single leaf
+		int32_t		GetHeight() const { return m_Root == nullNode ? 0 : m_Nodes[m_Root].height; }
+		// sum of the surface areas of the internal nodes divided by the surface area of the root
+		float		GetAreaRatio() const;
+		// checks the links, heights and bounds of every node
+		bool		Validate() const;
+
+		// the visitors are called with the user data of every proxy whose tight bounds pass the test
+		template<typename Func>
+		void QueryAABB(const AABB& box, Func&& visitor) const
+		{
+			Query([&](const AABB& b) { return b.Overlaps(box); }, visitor);
+		}
+
+		template<typename Func>
+		void QuerySphere(const Sphere& sphere, Func&& visitor) const
+		{
+			Query([&](const AABB& b) { return sphere.Overlaps(b); }, visitor);
+		}
+
+		template<typename Func>
+		void QueryFrustum(const Frustum& frustum, Func&& visitor) const
+		{
+			if (m_Root == nullNode) return;
+			NodeStack stack;
+			stack.Push(m_Root);
+			while (!stack.Empty())
+			{
+				uint32_t index = stack.Pop();
+				const Node& node = m_Nodes[index];
+				Frustum::Result result = frustum.Test(node.box);
+				if (result == Frustum::Outside) continue;
+				if (result == Frustum::Inside)
+				{
+					// every leaf below is inside as well
+					VisitLeaves(node, visitor);
+				}
+				else if (node.IsLeaf())
+				{
+					if (frustum.Overlaps(m_Bounds[index])) visitor(node.userData);
+				}
+				else
+				{
+					stack.Push(node.child1);
+					stack.Push(node.child2);
+				}
+			}
+		}
+
+		// the visitor is called with the user data and the distance the ray enters the tight bounds of a proxy.
+		// it returns the new maximum distance of the ray: the distance itself to find the closest hit,
+		// maxDistance to find all of them or 0 to stop
+		template<typename Func>
+		void Raycast(const Ray& ray, float maxDistance, Func&& visitor) const
+		{
+			if (m_Root == nullNode) return;
+			RaySlab slab(ray);
+			NodeStack stack;
+			stack.Push(m_Root);
+			while (!stack.Empty() && maxDistance > 0.f)
+			{
+				uint32_t index = stack.Pop();
+				const Node& node = m_Nodes[index];
+				if (!slab.Intersect(node.box, maxDistance).has_value()) continue;
+				if (node.IsLeaf())
+				{
+					if (auto t = slab.Intersect(m_Bounds[index], maxDistance); t.has_value())
+					{
+						maxDistance = std::min(maxDistance, (float)visitor(node.userData, t.value()));
+					}
+				}
+				else
+				{
+					stack.Push(node.child1);
+					stack.Push(node.child2);
+				}
+			}
+		}
+
+	private:
+		struct Node
+		{
+			// fattened bounds for leaves, union of the children for internal nodes.
+			// the tight bounds live in m_Bounds, traversals touch fewer cache lines without them
+			AABB	 box;
+			// next free node while the node is in the free list
+			uint32_t parent = nullNode;
+			uint32_t child1 = nullNode;
+			uint32_t child2 = nullNode;
+			uint32_t userData = 0;
+			// 0 for leaves, -1 for free nodes
+			int32_t	 height = -1;
+
+			bool IsLeaf() const { return child1 == nullNode; }
+		};
+
+		// traversal stack living on the call stack for usual tree heights
+		class NodeStack
+		{
+		public:
+			void	 Push(uint32_t node) { if (m_Size < inlineCapacity) m_Inline[m_Size] = node; else m_Overflow.push_back(node); m_Size++; }
+			uint32_t Pop() { m_Size--; if (m_Size < inlineCapacity) return m_Inline[m_Size]; uint32_t node = m_Overflow.back(); m_Overflow.pop_back(); return node; }
+			bool	 Empty() const { return m_Size == 0; }
+
+		private:
+			static constexpr uint32_t inlineCapacity = 64;
+			uint32_t			  m_Inline[inlineCapacity];
+			std::vector<uint32_t> m_Overflow;
+			uint32_t			  m_Size = 0;
+		};
+
+		template<typename Test, typename Func>
+		void Query(Test&& test, Func&& visitor) const
+		{
+			if (m_Root == nullNode) return;
+			NodeStack stack;
+			stack.Push(m_Root);
+			while (!stack.Empty())
+			{
+				uint32_t index = stack.Pop();
+				const Node& node = m_Nodes[index];
+				if (!test(node.box)) continue;
+				if (node.IsLeaf())
+				{
+					if (test(m_Bounds[index])) visitor(node.userData);
+				}
+				else
+				{
+					stack.Push(node.child1);
+					stack.Push(node.child2);
+				}
+			}
+		}
+
+		template<typename Func>
+		void VisitLeaves(const Node& node, Func&& visitor) const
+		{
+			if (node.IsLeaf())
+			{
+				visitor(node.userData);
+				return;
+			}
+			NodeStack subtree;
+			subtree.Push(node.child1);
+			subtree.Push(node.child2);
+			while (!subtree.Empty())
+			{
+				const Node& n = m_Nodes[subtree.Pop()];
+				if (n.IsLeaf())
+				{
+					visitor(n.userData);
+				}
+				else
+				{
+					subtree.Push(n.child1);
+					subtree.Push(n.child2);
+				}
+			}
+		}
+
+		uint32_t AllocateNode();
+		void	 FreeNode(uint32_t node);
+		// searches the subtree of searchRoot, the box must be inside searchRoot unless it is the root
+		uint32_t FindBestSibling(const AABB& box, uint32_t searchRoot) const;
+		void	 InsertLeaf(uint32_t leaf, uint32_t searchRoot = nullNode);
+		void	 RemoveLeaf(uint32_t leaf);
+		// recomputes the bounds and heights from node to the root, rotating every ancestor on the way
+		void	 Refit(uint32_t node);
+		// recomputes the bounds and heights from node up to the first ancestor which doesn't change
+		void	 Shrink(uint32_t node);
+		void	 Rotate(uint32_t node);
+		void	 ReplaceChild(uint32_t parent, uint32_t oldChild, uint32_t newChild);
+
+		std::vector<Node> m_Nodes;
+		// tight bounds of the proxies, m_Bounds[proxy] belongs to the leaf m_Nodes[proxy]
+		std::vector<AABB> m_Bounds;
+		uint32_t		  m_Root = nullNode;
+		uint32_t		  m_FreeList = nullNode;
+		uint32_t		  m_ProxyCount = 0;
+		float			  m_Margin;
+	};
+}
@@ -0,0 +1,84 @@
+#include "Math/FrustumCulling.h"
+#include "Math/FrustumCullingKernels.h"
+#include "Math/SimdLanes.h"
+
+namespace kbs
+{
+	void BoundsSoA::Resize(uint32_t count)
+	{
+		uint32_t padded = (count + TransformBatchAlignment - 1) / TransformBatchAlignment * TransformBatchAlignment;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			center[i].resize(padded, 0.f);
+			extent[i].resize(padded, 0.f);
+		}
+		radius.resize(padded, 0.f);
+		m_Count = count;
+	}
+
+	void BoundsSoA::Set(uint32_t index, const AABB& box)
+	{
+		vec3 c = box.GetCenter(), e = box.GetExtent();
+		center[0][index] = c.x, center[1][index] = c.y, center[2][index] = c.z;
+		extent[0][index] = e.x, extent[1][index] = e.y, extent[2][index] = e.z;
+		radius[index] = math::length(e);
+	}
+
+	void BoundsSoA::Set(uint32_t index, const Sphere& sphere)
+	{
+		center[0][index] = sphere.center.x, center[1][index] = sphere.center.y, center[2][index] = sphere.center.z;
+		extent[0][index] = extent[1][index] = extent[2][index] = sphere.radius;
+		radius[index] = sphere.radius;
+	}
+
+	void BoundsSoA::SetUnbounded(uint32_t index)
+	{
+		// the projected extents are at least FLT_MAX, they may overflow to infinity but never become nan
+		center[0][index] = center[1][index] = center[2][index] = 0.f;
+		extent[0][index] = extent[1][index] = extent[2][index] = FLT_MAX;
+		radius[index] = FLT_MAX;
+	}
+
+	AABB BoundsSoA::GetBox(uint32_t index) const
+	{
+		vec3 c(center[0][index], center[1][index], center[2][index]);
+		vec3 e(extent[0][index], extent[1][index], extent[2][index]);
+		return AABB::FromCenterExtent(c, e);
+	}
+
+	uint32_t math::CullFrustum(const Frustum& frustum, const BoundsSoA& bounds, uint32_t begin, uint32_t end, uint32_t* visible, CullingShape shape)
+	{
+		KBS_ASSERT(begin % TransformBatchAlignment == 0, "culled ranges must start at a multiple of TransformBatchAlignment");
+		KBS_ASSERT(begin <= end && end <= bounds.Size(), "bounds out of range");
+
+		float planes[6][4];
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				planes[p][c] = frustum.planes[p][c];
+			}
+		}
+		kernels::BoundsStreams in;
+		for (uint32_t i = 0; i < 3; i++) in.center[i] = bounds.center[i].data();
+		for (uint32_t i = 0; i < 3; i++) in.extent[i] = bounds.extent[i].data();
+		in.radius = bounds.radius.data();
+
+		bool spheres = shape == CullingShape::Sphere;
+		switch (GetSimdLevel())
+		{
+#ifdef KBS_ENABLE_AVX2
+		case SimdLevel::AVX2:
+			return kernels::CullFrustumAVX2(planes, in, begin, end, visible, spheres);
+#endif
+#ifdef KBS_SIMD_SSE
+		case SimdLevel::SSE:
+			return spheres ? kernels::CullFrustum<SSELane, true>(planes, in, begin, end, visible)
+				: kernels::CullFrustum<SSELane, false>(planes, in, begin, end, visible);
+#endif
+		default:
+			return spheres ? kernels::CullFrustum<ScalarLane, true>(planes, in, begin, end, visible)
+				: kernels::CullFrustum<ScalarLane, false>(planes, in, begin, end, visible);
+		}
+	}
+}
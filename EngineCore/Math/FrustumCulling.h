@@ -0,0 +1,44 @@
+#pragma once
+#include "Common.h"
+#include "Math/Geometry.h"
+#include "Math/TransformBatch.h"
+
+namespace kbs
+{
+	// world bounds of many objects as structure of arrays, padded like TransformSoA.
+	// every element holds a box and its bounding sphere, both share the center
+	struct KBS_API BoundsSoA
+	{
+		std::vector<float> center[3];
+		std::vector<float> extent[3];
+		std::vector<float> radius;
+
+		void	 Resize(uint32_t count);
+		uint32_t Size() const { return m_Count; }
+		void	 Set(uint32_t index, const AABB& box);
+		void	 Set(uint32_t index, const Sphere& sphere);
+		// never culled
+		void	 SetUnbounded(uint32_t index);
+		AABB	 GetBox(uint32_t index) const;
+
+	private:
+		uint32_t m_Count = 0;
+	};
+
+	enum class CullingShape
+	{
+		// tests the boxes of the bounds, tighter for axis aligned objects
+		Box,
+		// tests the spheres of the bounds, cheaper
+		Sphere
+	};
+
+	namespace math
+	{
+		// writes the indices in [begin, end) of the bounds overlapping the frustum to visible in increasing order and returns
+		// their count. visible must hold end - begin indices, begin must be a multiple of TransformBatchAlignment so ranges
+		// can be culled on different threads. uses the simd level of the batch transform functions
+		KBS_API uint32_t CullFrustum(const Frustum& frustum, const BoundsSoA& bounds, uint32_t begin, uint32_t end, uint32_t* visible,
+			CullingShape shape = CullingShape::Box);
+	}
+}
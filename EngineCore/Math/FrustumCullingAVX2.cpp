@@ -0,0 +1,14 @@
+#include "Math/FrustumCullingKernels.h"
+
+// compiled with avx2 code generation, only called after FrustumCulling.cpp checked the simd level
+#ifdef KBS_ENABLE_AVX2
+#include "Math/SimdLanes.h"
+
+namespace kbs
+{
+	uint32_t kernels::CullFrustumAVX2(const float(&planes)[6][4], const BoundsStreams& in, uint32_t begin, uint32_t end, uint32_t* visible, bool spheres)
+	{
+		return spheres ? CullFrustum<AVX2Lane, true>(planes, in, begin, end, visible) : CullFrustum<AVX2Lane, false>(planes, in, begin, end, visible);
+	}
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+
+// frustum culling kernels of the scalar, SSE and AVX2 paths, see TransformBatchKernels.h for the constraints
+namespace kbs
+{
+	namespace kernels
+	{
+		struct BoundsStreams
+		{
+			const float* center[3];
+			const float* extent[3];
+			const float* radius;
+		};
+
+		// writes the indices in [begin, end) of the bounds in front of all planes to visible and returns their count.
+		// the planes point inwards, begin must be a multiple of V::width and the streams padded to one
+		template<typename V, bool Spheres>
+		uint32_t CullFrustum(const float(&planes)[6][4], const BoundsStreams& inStreams, uint32_t begin, uint32_t end, uint32_t* visible)
+		{
+			const BoundsStreams in = inStreams;
+			V normal[6][3], absNormal[6][3], offset[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					normal[p][c] = V::Set(planes[p][c]);
+					absNormal[p][c] = V::Set(planes[p][c] < 0.f ? -planes[p][c] : planes[p][c]);
+				}
+				offset[p] = V::Set(planes[p][3]);
+			}
+
+			uint32_t count = 0;
+			for (uint32_t i = begin; i < end; i += V::width)
+			{
+				V center[3] = { V::Load(in.center[0] + i), V::Load(in.center[1] + i), V::Load(in.center[2] + i) };
+				V extent[3], radius;
+				if constexpr (Spheres)
+				{
+					radius = V::Load(in.radius + i);
+				}
+				else
+				{
+					extent[0] = V::Load(in.extent[0] + i), extent[1] = V::Load(in.extent[1] + i), extent[2] = V::Load(in.extent[2] + i);
+				}
+
+				// signed distance of the point of the bounds furthest along the plane normal
+				V distance;
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					V d = normal[p][0] * center[0] + normal[p][1] * center[1] + normal[p][2] * center[2] + offset[p];
+					if constexpr (Spheres)
+					{
+						d = d + radius;
+					}
+					else
+					{
+						d = d + (absNormal[p][0] * extent[0] + absNormal[p][1] * extent[1] + absNormal[p][2] * extent[2]);
+					}
+					distance = p == 0 ? d : V::Min(distance, d);
+				}
+
+				// compacted without branching on the visibility, the lanes past end are dropped
+				uint32_t mask = V::NonNegativeMask(distance);
+				uint32_t laneCount = end - i < V::width ? end - i : V::width;
+				for (uint32_t j = 0; j < laneCount; j++)
+				{
+					visible[count] = i + j;
+					count += (mask >> j) & 1;
+				}
+			}
+			return count;
+		}
+
+		uint32_t CullFrustumAVX2(const float(&planes)[6][4], const BoundsStreams& in, uint32_t begin, uint32_t end, uint32_t* visible, bool spheres);
+	}
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include "Common.h"
+#include "Math/math.h"
+#include <float.h>
+
+namespace kbs
+{
+	struct AABB
+	{
+		vec3 lower = vec3(FLT_MAX);
+		vec3 upper = vec3(-FLT_MAX);
+
+		AABB() = default;
+		AABB(vec3 lower, vec3 upper) : lower(lower), upper(upper) {}
+
+		static AABB FromCenterExtent(vec3 center, vec3 extent) { return AABB(center - extent, center + extent); }
+
+		bool IsValid() const { return lower.x <= upper.x && lower.y <= upper.y && lower.z <= upper.z; }
+		vec3 GetCenter() const { return (lower + upper) * .5f; }
+		vec3 GetExtent() const { return (upper - lower) * .5f; }
+
+		float GetSurfaceArea() const
+		{
+			vec3 d = upper - lower;
+			return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		void Merge(vec3 p)
+		{
+			lower = glm::min(lower, p);
+			upper = glm::max(upper, p);
+		}
+
+		void Merge(const AABB& box)
+		{
+			lower = glm::min(lower, box.lower);
+			upper = glm::max(upper, box.upper);
+		}
+
+		bool Contains(const AABB& box) const
+		{
+			return lower.x <= box.lower.x && lower.y <= box.lower.y && lower.z <= box.lower.z &&
+				upper.x >= box.upper.x && upper.y >= box.upper.y && upper.z >= box.upper.z;
+		}
+
+		bool Overlaps(const AABB& box) const
+		{
+			return lower.x <= box.upper.x && lower.y <= box.upper.y && lower.z <= box.upper.z &&
+				upper.x >= box.lower.x && upper.y >= box.lower.y && upper.z >= box.lower.z;
+		}
+
+		// bounds of the box transformed by an affine matrix
+		AABB Transform(const mat4& m) const
+		{
+			vec3 center = vec3(m * vec4(GetCenter(), 1.f));
+			vec3 extent = GetExtent();
+			vec3 transformed = glm::abs(vec3(m[0])) * extent.x + glm::abs(vec3(m[1])) * extent.y + glm::abs(vec3(m[2])) * extent.z;
+			return FromCenterExtent(center, transformed);
+		}
+	};
+
+	inline AABB Union(const AABB& lhs, const AABB& rhs)
+	{
+		return AABB(glm::min(lhs.lower, rhs.lower), glm::max(lhs.upper, rhs.upper));
+	}
+
+	struct Sphere
+	{
+		vec3  center;
+		float radius;
+
+		bool Overlaps(const AABB& box) const
+		{
+			vec3 d = center - glm::clamp(center, box.lower, box.upper);
+			return glm::dot(d, d) <= radius * radius;
+		}
+	};
+
+	struct Ray
+	{
+		vec3 origin;
+		// doesn't have to be normalized, distances are measured in multiples of it
+		vec3 direction;
+
+		vec3 At(float t) const { return origin + direction * t; }
+	};
+
+	// ray with the reciprocal of its direction precomputed for slab tests
+	struct RaySlab
+	{
+		vec3 origin;
+		vec3 invDirection;
+
+		RaySlab(const Ray& ray) : origin(ray.origin), invDirection(1.f / ray.direction) {}
+
+		// distance the ray enters the box, nullopt if it misses the box within [0, maxDistance]
+		opt<float> Intersect(const AABB& box, float maxDistance) const
+		{
+			vec3 t0 = (box.lower - origin) * invDirection;
+			vec3 t1 = (box.upper - origin) * invDirection;
+			vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+			float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+			float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+			if (enter > exit)
+			{
+				return std::nullopt;
+			}
+			return enter;
+		}
+	};
+
+	// planes point inwards, a point p is inside if dot(plane.xyz, p) + plane.w >= 0 for every plane
+	struct Frustum
+	{
+		enum Result
+		{
+			Outside,
+			Intersect,
+			Inside
+		};
+
+		vec4 planes[6];
+
+		// extracts the planes of a view projection matrix with [0, 1] depth
+		static Frustum FromMatrix(const mat4& viewProjection)
+		{
+			mat4 m = glm::transpose(viewProjection);
+			Frustum frustum;
+			frustum.planes[0] = m[3] + m[0];
+			frustum.planes[1] = m[3] - m[0];
+			frustum.planes[2] = m[3] + m[1];
+			frustum.planes[3] = m[3] - m[1];
+			frustum.planes[4] = m[2];
+			frustum.planes[5] = m[3] - m[2];
+			for (auto& plane : frustum.planes)
+			{
+				plane /= glm::length(vec3(plane));
+			}
+			return frustum;
+		}
+
+		Result Test(const AABB& box) const
+		{
+			vec3 center = box.GetCenter(), extent = box.GetExtent();
+			Result result = Inside;
+			for (const auto& plane : planes)
+			{
+				vec3 normal = vec3(plane);
+				float distance = glm::dot(normal, center) + plane.w;
+				float radius = glm::dot(glm::abs(normal), extent);
+				if (distance < -radius) return Outside;
+				if (distance < radius) result = Intersect;
+			}
+			return result;
+		}
+
+		bool Overlaps(const AABB& box) const { return Test(box) != Outside; }
+	};
+}
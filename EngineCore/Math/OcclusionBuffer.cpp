@@ -0,0 +1,347 @@
+#include "Math/OcclusionBuffer.h"
+#include "Math/OcclusionBufferKernels.h"
+#include "Math/TransformBatch.h"
+#include "Math/SimdLanes.h"
+
+namespace kbs
+{
+	namespace
+	{
+		constexpr uint32_t FullRowMask = ~0u;
+		// triangles are gathered and set up this many at a time
+		constexpr uint32_t TriangleBatchSize = 64;
+
+		struct TriangleBatch
+		{
+			float	 x[3][TriangleBatchSize];
+			float	 y[3][TriangleBatchSize];
+			float	 z[3][TriangleBatchSize];
+			float	 w[3][TriangleBatchSize];
+			float	 bounds[4][TriangleBatchSize];
+			float	 area[TriangleBatchSize];
+			float	 slope[3][TriangleBatchSize];
+			float	 depthGradient[2][TriangleBatchSize];
+			float	 maxDepth[TriangleBatchSize];
+			uint32_t visible[TriangleBatchSize];
+		};
+
+		// bits [first, last] of a tile row, empty if first > last
+		uint32_t GetRowMask(int32_t first, int32_t last)
+		{
+			if (first > last) return 0;
+			uint32_t count = (uint32_t)(last - first + 1);
+			return (count == 32 ? FullRowMask : (1u << count) - 1) << first;
+		}
+	}
+
+	OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+	{
+		Resize(width, height);
+	}
+
+	void OcclusionBuffer::Resize(uint32_t width, uint32_t height)
+	{
+		m_TileCountX = (width + TileWidth - 1) / TileWidth;
+		m_TileCountY = (height + TileHeight - 1) / TileHeight;
+		m_Width = m_TileCountX * TileWidth;
+		m_Height = m_TileCountY * TileHeight;
+		m_Tiles.resize(m_TileCountX * m_TileCountY);
+		Clear(m_ViewProjection);
+	}
+
+	void OcclusionBuffer::Clear(const mat4& viewProjection)
+	{
+		m_ViewProjection = viewProjection;
+		for (Tile& tile : m_Tiles)
+		{
+			tile.zMax0 = 1.f;
+			tile.zMax1 = 0.f;
+			std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+		}
+	}
+
+	void OcclusionBuffer::RenderOccluder(const OccluderMesh& mesh, const mat4& model)
+	{
+		RenderTriangles(model, mesh.vertices.data(), (uint32_t)mesh.vertices.size(), mesh.indices.data(), (uint32_t)mesh.indices.size());
+	}
+
+	void OcclusionBuffer::RenderTriangles(const mat4& model, const vec3* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+	{
+		uint32_t padded = (vertexCount + TransformBatchAlignment - 1) / TransformBatchAlignment * TransformBatchAlignment;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			m_Vertices[i].resize(padded, 0.f);
+		}
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			m_ScreenVertices[i].resize(padded);
+		}
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			m_Vertices[0][i] = vertices[i].x, m_Vertices[1][i] = vertices[i].y, m_Vertices[2][i] = vertices[i].z;
+		}
+
+		mat4 modelViewProjection = m_ViewProjection * model;
+		float m[16];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			for (uint32_t r = 0; r < 4; r++)
+			{
+				m[c * 4 + r] = modelViewProjection[c][r];
+			}
+		}
+		kernels::VertexStreams in{ { m_Vertices[0].data(), m_Vertices[1].data(), m_Vertices[2].data() } };
+		kernels::ScreenVertexStreams out{ { m_ScreenVertices[0].data(), m_ScreenVertices[1].data(), m_ScreenVertices[2].data(), m_ScreenVertices[3].data() } };
+
+		// the padding lanes are projected as well and never read
+		SimdLevel level = math::GetSimdLevel();
+		switch (level)
+		{
+#ifdef KBS_ENABLE_AVX2
+		case SimdLevel::AVX2:
+			kernels::ProjectVerticesAVX2(m, in, out, padded, (float)m_Width, (float)m_Height);
+			break;
+#endif
+#ifdef KBS_SIMD_SSE
+		case SimdLevel::SSE:
+			kernels::ProjectVertices<SSELane>(m, in, out, padded, (float)m_Width, (float)m_Height);
+			break;
+#endif
+		default:
+			kernels::ProjectVertices<ScalarLane>(m, in, out, vertexCount, (float)m_Width, (float)m_Height);
+			break;
+		}
+
+		// the indices are checked once instead of for every vertex gathered
+		uint32_t triangleCount = indexCount / 3, maxIndex = 0;
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			maxIndex = std::max(maxIndex, indices[i]);
+		}
+		KBS_ASSERT(triangleCount == 0 || maxIndex < vertexCount, "occluder index out of range");
+
+		// most occluder triangles cover a few pixels or none, they are culled and set up a lane of triangles at a time.
+		// only the visible ones are rasterized one by one
+		TriangleBatch batch;
+		kernels::TriangleStreams setupIn;
+		kernels::TriangleSetupStreams setupOut{ { batch.bounds[0], batch.bounds[1], batch.bounds[2], batch.bounds[3] }, batch.area,
+			{ batch.slope[0], batch.slope[1], batch.slope[2] }, { batch.depthGradient[0], batch.depthGradient[1] }, batch.maxDepth };
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			setupIn.x[k] = batch.x[k], setupIn.y[k] = batch.y[k], setupIn.z[k] = batch.z[k], setupIn.w[k] = batch.w[k];
+		}
+
+		const float* screen[4] = { m_ScreenVertices[0].data(), m_ScreenVertices[1].data(), m_ScreenVertices[2].data(), m_ScreenVertices[3].data() };
+		for (uint32_t first = 0; first < triangleCount; first += TriangleBatchSize)
+		{
+			uint32_t count = std::min(TriangleBatchSize, triangleCount - first);
+			for (uint32_t t = 0; t < TriangleBatchSize; t++)
+			{
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					// the triangles past the end have w = 0 and are culled
+					uint32_t index = t < count ? indices[(first + t) * 3 + k] : 0;
+					batch.x[k][t] = screen[0][index];
+					batch.y[k][t] = screen[1][index];
+					batch.z[k][t] = screen[2][index];
+					batch.w[k][t] = t < count ? screen[3][index] : 0.f;
+				}
+			}
+
+			uint32_t visibleCount = 0;
+			switch (level)
+			{
+#ifdef KBS_ENABLE_AVX2
+			case SimdLevel::AVX2:
+				visibleCount = kernels::SetupTrianglesAVX2(setupIn, setupOut, TriangleBatchSize, (float)m_Width, (float)m_Height, batch.visible);
+				break;
+#endif
+#ifdef KBS_SIMD_SSE
+			case SimdLevel::SSE:
+				visibleCount = kernels::SetupTriangles<SSELane>(setupIn, setupOut, TriangleBatchSize, (float)m_Width, (float)m_Height, batch.visible);
+				break;
+#endif
+			default:
+				visibleCount = kernels::SetupTriangles<ScalarLane>(setupIn, setupOut, TriangleBatchSize, (float)m_Width, (float)m_Height, batch.visible);
+				break;
+			}
+
+			for (uint32_t i = 0; i < visibleCount; i++)
+			{
+				uint32_t t = batch.visible[i];
+				TriangleSetup triangle;
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					triangle.vertices[k] = vec2(batch.x[k][t], batch.y[k][t]);
+					triangle.slope[k] = batch.slope[k][t];
+				}
+				triangle.depth = batch.z[0][t];
+				triangle.x0 = (int32_t)batch.bounds[0][t], triangle.x1 = (int32_t)batch.bounds[1][t];
+				triangle.y0 = (int32_t)batch.bounds[2][t], triangle.y1 = (int32_t)batch.bounds[3][t];
+				triangle.area = batch.area[t];
+				triangle.depthGradient = vec2(batch.depthGradient[0][t], batch.depthGradient[1][t]);
+				triangle.maxDepth = batch.maxDepth[t];
+				RasterizeTriangle(triangle);
+			}
+		}
+	}
+
+	void OcclusionBuffer::RasterizeTriangle(const TriangleSetup& triangle)
+	{
+		const int32_t x0 = triangle.x0, x1 = triangle.x1, y0 = triangle.y0, y1 = triangle.y1;
+
+		// every row is covered by a single span, the edges bound it from the left or from the right. an edge going
+		// down bounds a counter clockwise triangle from the left, a clockwise one from the right
+		float anchorX[2][2], anchorY[2][2], slope[2][2];
+		uint32_t edgeCount[2] = {};
+		for (uint32_t e = 0; e < 3; e++)
+		{
+			const vec2& p = triangle.vertices[e];
+			const vec2& q = triangle.vertices[e == 2 ? 0 : e + 1];
+			// horizontal edges are at the top or the bottom of the triangle, they never cut into its bounding box
+			if (p.y == q.y) continue;
+			uint32_t side = (p.y > q.y) == (triangle.area > 0.f) ? 0 : 1;
+			if (edgeCount[side] == 2) return;
+			anchorX[side][edgeCount[side]] = p.x;
+			anchorY[side][edgeCount[side]] = p.y;
+			slope[side][edgeCount[side]] = triangle.slope[e];
+			edgeCount[side]++;
+		}
+		if (edgeCount[0] == 0 || edgeCount[1] == 0) return;
+
+		m_Spans[0].resize(y1 - y0 + 1);
+		m_Spans[1].resize(y1 - y0 + 1);
+		for (int32_t y = y0; y <= y1; y++)
+		{
+			float py = (float)y + .5f;
+			float left = -FLT_MAX, right = FLT_MAX;
+			for (uint32_t i = 0; i < edgeCount[0]; i++)
+			{
+				left = std::max(left, anchorX[0][i] + (py - anchorY[0][i]) * slope[0][i]);
+			}
+			for (uint32_t i = 0; i < edgeCount[1]; i++)
+			{
+				right = std::min(right, anchorX[1][i] + (py - anchorY[1][i]) * slope[1][i]);
+			}
+			// the bounds are clamped to the bounding box before converting them, nearly horizontal edges reach far out
+			left = std::min(std::max(left, (float)x0 + .5f), (float)x1 + 1.5f);
+			right = std::min(std::max(right, (float)x0 - .5f), (float)x1 + .5f);
+			m_Spans[0][y - y0] = (int32_t)std::ceil(left - .5f);
+			m_Spans[1][y - y0] = (int32_t)std::floor(right - .5f);
+		}
+
+		// the depth of the triangle plane, bounded per tile by its corners and by the farthest vertex
+		const vec2& v0 = triangle.vertices[0];
+		auto depthAt = [&](float x, float y) { return triangle.depth + triangle.depthGradient.x * (x - v0.x) + triangle.depthGradient.y * (y - v0.y); };
+
+		for (int32_t ty = y0 / (int32_t)TileHeight; ty <= y1 / (int32_t)TileHeight; ty++)
+		{
+			int32_t tileY0 = std::max(y0, ty * (int32_t)TileHeight), tileY1 = std::min(y1, ty * (int32_t)TileHeight + (int32_t)TileHeight - 1);
+			for (int32_t tx = x0 / (int32_t)TileWidth; tx <= x1 / (int32_t)TileWidth; tx++)
+			{
+				int32_t tileX = tx * (int32_t)TileWidth;
+				uint32_t coverage[TileHeight] = {};
+				bool covered = false;
+				for (int32_t y = tileY0; y <= tileY1; y++)
+				{
+					int32_t first = std::max(m_Spans[0][y - y0], tileX) - tileX;
+					int32_t last = std::min(m_Spans[1][y - y0], tileX + (int32_t)TileWidth - 1) - tileX;
+					coverage[y % TileHeight] = GetRowMask(first, last);
+					covered = covered || coverage[y % TileHeight] != 0;
+				}
+				if (!covered) continue;
+
+				float cornerX0 = (float)std::max(x0, tileX) + .5f, cornerX1 = (float)std::min(x1, tileX + (int32_t)TileWidth - 1) + .5f;
+				float cornerY0 = (float)tileY0 + .5f, cornerY1 = (float)tileY1 + .5f;
+				float depth = std::max(std::max(depthAt(cornerX0, cornerY0), depthAt(cornerX1, cornerY0)),
+					std::max(depthAt(cornerX0, cornerY1), depthAt(cornerX1, cornerY1)));
+				UpdateTile(m_Tiles[ty * m_TileCountX + tx], coverage, std::min(depth, triangle.maxDepth));
+			}
+		}
+	}
+
+	void OcclusionBuffer::UpdateTile(Tile& tile, const uint32_t(&coverage)[TileHeight], float depth)
+	{
+		// the covered pixels can't get farther than the tile already is
+		if (depth >= tile.zMax0) return;
+
+		// a working layer much farther than the new triangle is dropped instead of pushing the triangle back,
+		// the pixels it covered are still bounded by zMax0
+		if (tile.zMax1 - depth > tile.zMax0 - tile.zMax1)
+		{
+			tile.zMax1 = 0.f;
+			std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+		}
+
+		tile.zMax1 = std::max(tile.zMax1, depth);
+		bool full = true;
+		for (uint32_t r = 0; r < TileHeight; r++)
+		{
+			tile.mask[r] |= coverage[r];
+			full = full && tile.mask[r] == FullRowMask;
+		}
+
+		// every pixel is covered by the working layer, it becomes the depth of the whole tile
+		if (full)
+		{
+			tile.zMax0 = tile.zMax1;
+			tile.zMax1 = 0.f;
+			std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const AABB& worldBounds) const
+	{
+		vec3 extent = worldBounds.GetExtent();
+		if (!worldBounds.IsValid() || !(extent.x < FLT_MAX && extent.y < FLT_MAX && extent.z < FLT_MAX)) return true;
+
+		vec2 lower(FLT_MAX), upper(-FLT_MAX);
+		float nearest = FLT_MAX;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			vec3 corner((i & 1) ? worldBounds.upper.x : worldBounds.lower.x, (i & 2) ? worldBounds.upper.y : worldBounds.lower.y,
+				(i & 4) ? worldBounds.upper.z : worldBounds.lower.z);
+			vec4 clip = m_ViewProjection * vec4(corner, 1.f);
+			if (!(clip.w > 0.f) || clip.z < 0.f) return true;
+
+			vec3 ndc = vec3(clip) / clip.w;
+			vec2 screen((ndc.x * .5f + .5f) * (float)m_Width, (ndc.y * .5f + .5f) * (float)m_Height);
+			lower = glm::min(lower, screen);
+			upper = glm::max(upper, screen);
+			nearest = std::min(nearest, ndc.z);
+		}
+
+		// every pixel on the screen the box touches, boxes outside the screen are left to frustum culling
+		int32_t x0 = std::max(0, (int32_t)std::floor(lower.x)), x1 = std::min((int32_t)m_Width - 1, (int32_t)std::floor(upper.x));
+		int32_t y0 = std::max(0, (int32_t)std::floor(lower.y)), y1 = std::min((int32_t)m_Height - 1, (int32_t)std::floor(upper.y));
+		if (x0 > x1 || y0 > y1) return true;
+
+		for (int32_t ty = y0 / (int32_t)TileHeight; ty <= y1 / (int32_t)TileHeight; ty++)
+		{
+			for (int32_t tx = x0 / (int32_t)TileWidth; tx <= x1 / (int32_t)TileWidth; tx++)
+			{
+				const Tile& tile = m_Tiles[ty * m_TileCountX + tx];
+				if (nearest > tile.zMax0) continue;
+				if (!(nearest > tile.zMax1)) return true;
+
+				// hidden only if the box pixels of the tile are covered by the working layer
+				int32_t tileX = tx * (int32_t)TileWidth;
+				uint32_t rowMask = GetRowMask(std::max(x0, tileX) - tileX, std::min(x1, tileX + (int32_t)TileWidth - 1) - tileX);
+				int32_t rowBegin = std::max(y0, ty * (int32_t)TileHeight), rowEnd = std::min(y1, ty * (int32_t)TileHeight + (int32_t)TileHeight - 1);
+				for (int32_t y = rowBegin; y <= rowEnd; y++)
+				{
+					if (rowMask & ~tile.mask[y % TileHeight]) return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	float OcclusionBuffer::GetDepth(uint32_t x, uint32_t y) const
+	{
+		KBS_ASSERT(x < m_Width && y < m_Height, "pixel out of range");
+		const Tile& tile = m_Tiles[(y / TileHeight) * m_TileCountX + x / TileWidth];
+		bool covered = (tile.mask[y % TileHeight] >> (x % TileWidth)) & 1;
+		return covered ? std::min(tile.zMax0, tile.zMax1) : tile.zMax0;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Common.h"
+#include "Math/Geometry.h"
+
+namespace kbs
+{
+	// triangles drawn into an occlusion buffer, usually a low polygon version of an opaque mesh
+	struct OccluderMesh
+	{
+		std::vector<vec3>	  vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// masked software occlusion culling. the screen is split into tiles of 32x8 pixels, every tile stores a far depth
+	// bounding all of its pixels and a second depth bounding the pixels covered since the tile was last fully covered.
+	// the coverage is rasterized with one bit per pixel, so a row of a tile is updated with a single mask.
+	// depth is z / w of a projection with [0, 1] depth, the buffer only ever reports depths at least as far as the
+	// occluders drawn into it, occludees it hides are hidden by the exact rasterization as well
+	class KBS_API OcclusionBuffer
+	{
+	public:
+		static constexpr uint32_t TileWidth = 32;
+		static constexpr uint32_t TileHeight = 8;
+
+		// the size is rounded up to whole tiles
+		OcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+
+		void	 Resize(uint32_t width, uint32_t height);
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+
+		// clears the buffer to the far plane and sets the camera the occluders and occludees are projected with
+		void Clear(const mat4& viewProjection);
+
+		// triangles crossing the near plane are skipped, the buffer stays conservative without clipping them
+		void RenderOccluder(const OccluderMesh& mesh, const mat4& model);
+		void RenderTriangles(const mat4& model, const vec3* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+		// false if the box is hidden behind the occluders. boxes crossing the near plane or leaving the screen
+		// are visible, thread safe as long as no occluders are rendered at the same time
+		bool  IsVisible(const AABB& worldBounds) const;
+		// the depth every occluder at pixel (x, y) is in front of
+		float GetDepth(uint32_t x, uint32_t y) const;
+
+	private:
+		struct Tile
+		{
+			float	 zMax0;
+			float	 zMax1;
+			uint32_t mask[TileHeight];
+		};
+
+		// a triangle set up by kernels::SetupTriangles
+		struct TriangleSetup
+		{
+			vec2	vertices[3];
+			// depth of the first vertex
+			float	depth;
+			int32_t x0, x1, y0, y1;
+			float	area;
+			float	slope[3];
+			vec2	depthGradient;
+			float	maxDepth;
+		};
+
+		void RasterizeTriangle(const TriangleSetup& triangle);
+		void UpdateTile(Tile& tile, const uint32_t (&coverage)[TileHeight], float depth);
+
+		uint32_t			m_Width = 0;
+		uint32_t			m_Height = 0;
+		uint32_t			m_TileCountX = 0;
+		uint32_t			m_TileCountY = 0;
+		mat4				m_ViewProjection = mat4(1.f);
+		std::vector<Tile>	m_Tiles;
+
+		// scratch buffers of RenderTriangles, the vertices as structure of arrays before and after projection
+		std::vector<float>	m_Vertices[3];
+		std::vector<float>	m_ScreenVertices[4];
+		// pixel span [first, last] covered by the current triangle in every row of its bounding box
+		std::vector<int32_t> m_Spans[2];
+	};
+}
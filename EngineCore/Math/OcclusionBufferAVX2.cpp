@@ -0,0 +1,19 @@
+#include "Math/OcclusionBufferKernels.h"
+
+// compiled with avx2 code generation, only called after OcclusionBuffer.cpp checked the simd level
+#ifdef KBS_ENABLE_AVX2
+#include "Math/SimdLanes.h"
+
+namespace kbs
+{
+	void kernels::ProjectVerticesAVX2(const float(&m)[16], const VertexStreams& in, const ScreenVertexStreams& out, uint32_t count, float width, float height)
+	{
+		ProjectVertices<AVX2Lane>(m, in, out, count, width, height);
+	}
+
+	uint32_t kernels::SetupTrianglesAVX2(const TriangleStreams& in, const TriangleSetupStreams& out, uint32_t count, float width, float height, uint32_t* visible)
+	{
+		return SetupTriangles<AVX2Lane>(in, out, count, width, height, visible);
+	}
+}
+#endif
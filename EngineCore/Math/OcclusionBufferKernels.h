@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+
+// occluder vertex projection and triangle setup of the scalar, SSE and AVX2 paths, see TransformBatchKernels.h for the constraints
+namespace kbs
+{
+	namespace kernels
+	{
+		struct VertexStreams
+		{
+			const float* position[3];
+		};
+
+		// screen x, y in pixels, depth z / w and the clip space w
+		struct ScreenVertexStreams
+		{
+			float* position[4];
+		};
+
+		// m is a column major model view projection matrix with [0, 1] depth, count must be a multiple of V::width
+		template<typename V>
+		void ProjectVertices(const float(&m)[16], const VertexStreams& inStreams, const ScreenVertexStreams& outStreams, uint32_t count, float width, float height)
+		{
+			const VertexStreams in = inStreams;
+			const ScreenVertexStreams out = outStreams;
+			V matrix[16];
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				matrix[i] = V::Set(m[i]);
+			}
+			const V one = V::Set(1.f), halfWidth = V::Set(width * .5f), halfHeight = V::Set(height * .5f);
+
+			for (uint32_t i = 0; i < count; i += V::width)
+			{
+				V x = V::Load(in.position[0] + i), y = V::Load(in.position[1] + i), z = V::Load(in.position[2] + i);
+				V clip[4];
+				for (uint32_t r = 0; r < 4; r++)
+				{
+					clip[r] = matrix[r] * x + matrix[4 + r] * y + matrix[8 + r] * z + matrix[12 + r];
+				}
+				V invW = one / clip[3];
+				V::Store(out.position[0] + i, clip[0] * invW * halfWidth + halfWidth);
+				V::Store(out.position[1] + i, clip[1] * invW * halfHeight + halfHeight);
+				V::Store(out.position[2] + i, clip[2] * invW);
+				V::Store(out.position[3] + i, clip[3]);
+			}
+		}
+
+		// screen vertices of triangles gathered by their indices, as written by ProjectVertices
+		struct TriangleStreams
+		{
+			const float* x[3];
+			const float* y[3];
+			const float* z[3];
+			const float* w[3];
+		};
+
+		struct TriangleSetupStreams
+		{
+			// first and last column and row of the pixels whose centers are inside the bounding box
+			float* bounds[4];
+			// twice the signed screen area, the sign is the winding
+			float* area;
+			// dx / dy of the edge from vertex e to vertex e + 1
+			float* slope[3];
+			// dz / dx and dz / dy of the triangle plane
+			float* depthGradient[2];
+			float* maxDepth;
+		};
+
+		// sets up count triangles of a width x height screen a lane at a time. writes the indices of the triangles in front
+		// of the camera covering the center of a pixel in their bounding box to visible and returns their count, the
+		// other triangles aren't rasterized. count must be a multiple of V::width
+		template<typename V>
+		uint32_t SetupTriangles(const TriangleStreams& inStreams, const TriangleSetupStreams& outStreams, uint32_t count, float width, float height, uint32_t* visible)
+		{
+			const TriangleStreams in = inStreams;
+			const TriangleSetupStreams out = outStreams;
+			const V zero = V::Set(0.f), one = V::Set(1.f), half = V::Set(.5f), minArea = V::Set(1e-6f);
+			const V minSlope = V::Set(-1e20f), maxSlope = V::Set(1e20f);
+			const V lastColumn = V::Set(width - 1.f), lastRow = V::Set(height - 1.f);
+			// vertices far outside the screen are moved to its border before rounding, the pixel bounds stay the same
+			const V minX = V::Set(-1.f), maxX = V::Set(width + 1.f), minY = V::Set(-1.f), maxY = V::Set(height + 1.f);
+
+			uint32_t visibleCount = 0;
+			for (uint32_t i = 0; i < count; i += V::width)
+			{
+				V x[3], y[3], z[3];
+				// the vertices are in front of the camera, w > 0 and z >= 0
+				uint32_t mask = (1u << V::width) - 1;
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					x[k] = V::Load(in.x[k] + i), y[k] = V::Load(in.y[k] + i), z[k] = V::Load(in.z[k] + i);
+					mask &= ~V::NonNegativeMask(zero - V::Load(in.w[k] + i)) & V::NonNegativeMask(z[k]);
+				}
+
+				// both windings are drawn, degenerate triangles and nans are skipped
+				V area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+				mask &= V::NonNegativeMask(V::Max(area, zero - area) - minArea);
+
+				// the pixel centers are at half integers, ceil(lower - .5) is -floor(.5 - lower)
+				V lowerX = V::Max(V::Min(x[0], V::Min(x[1], x[2])), minX), upperX = V::Min(V::Max(x[0], V::Max(x[1], x[2])), maxX);
+				V lowerY = V::Max(V::Min(y[0], V::Min(y[1], y[2])), minY), upperY = V::Min(V::Max(y[0], V::Max(y[1], y[2])), maxY);
+				V x0 = V::Max(zero, zero - V::Floor(half - lowerX)), x1 = V::Min(lastColumn, V::Floor(upperX - half));
+				V y0 = V::Max(zero, zero - V::Floor(half - lowerY)), y1 = V::Min(lastRow, V::Floor(upperY - half));
+				mask &= V::NonNegativeMask(x1 - x0) & V::NonNegativeMask(y1 - y0);
+
+				V::Store(out.bounds[0] + i, x0);
+				V::Store(out.bounds[1] + i, x1);
+				V::Store(out.bounds[2] + i, y0);
+				V::Store(out.bounds[3] + i, y1);
+				V::Store(out.area + i, area);
+				// horizontal edges get an infinite slope clamped to a finite one, they never bound a row
+				for (uint32_t e = 0; e < 3; e++)
+				{
+					uint32_t n = e == 2 ? 0 : e + 1;
+					V::Store(out.slope[e] + i, V::Min(V::Max((x[n] - x[e]) / (y[n] - y[e]), minSlope), maxSlope));
+				}
+				// the gradients don't depend on the winding
+				V invArea = one / area;
+				V::Store(out.depthGradient[0] + i, ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea);
+				V::Store(out.depthGradient[1] + i, ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea);
+				V::Store(out.maxDepth + i, V::Max(z[0], V::Max(z[1], z[2])));
+
+				// compacted without branching on the visibility
+				for (uint32_t j = 0; j < V::width; j++)
+				{
+					visible[visibleCount] = i + j;
+					visibleCount += (mask >> j) & 1;
+				}
+			}
+			return visibleCount;
+		}
+
+		void ProjectVerticesAVX2(const float(&m)[16], const VertexStreams& in, const ScreenVertexStreams& out, uint32_t count, float width, float height);
+		uint32_t SetupTrianglesAVX2(const TriangleStreams& in, const TriangleSetupStreams& out, uint32_t count, float width, float height, uint32_t* visible);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+// lane types the batch kernels are instantiated with. every lane provides width, Load, Store, Set,
+// Min, Max, Floor, NonNegativeMask and the arithmetic operators. the AVX2 lane only exists in translation units
+// compiled with avx2 code generation
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+	#define KBS_SIMD_SSE
+	#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+namespace kbs
+{
+	namespace
+	{
+		struct ScalarLane
+		{
+			static constexpr uint32_t width = 1;
+			float v;
+
+			static ScalarLane Load(const float* p) { return { *p }; }
+			static void		  Store(float* p, ScalarLane x) { *p = x.v; }
+			static ScalarLane Set(float x) { return { x }; }
+			static ScalarLane Min(ScalarLane lhs, ScalarLane rhs) { return { std::min(lhs.v, rhs.v) }; }
+			static ScalarLane Max(ScalarLane lhs, ScalarLane rhs) { return { std::max(lhs.v, rhs.v) }; }
+			static ScalarLane Floor(ScalarLane x) { return { std::floor(x.v) }; }
+			// bit i is set if lane i is >= 0
+			static uint32_t	  NonNegativeMask(ScalarLane x) { return x.v >= 0.f ? 1u : 0u; }
+		};
+		inline ScalarLane operator+(ScalarLane lhs, ScalarLane rhs) { return { lhs.v + rhs.v }; }
+		inline ScalarLane operator-(ScalarLane lhs, ScalarLane rhs) { return { lhs.v - rhs.v }; }
+		inline ScalarLane operator*(ScalarLane lhs, ScalarLane rhs) { return { lhs.v * rhs.v }; }
+		inline ScalarLane operator/(ScalarLane lhs, ScalarLane rhs) { return { lhs.v / rhs.v }; }
+
+#ifdef KBS_SIMD_SSE
+		struct SSELane
+		{
+			static constexpr uint32_t width = 4;
+			__m128 v;
+
+			static SSELane	Load(const float* p) { return { _mm_loadu_ps(p) }; }
+			static void		Store(float* p, SSELane x) { _mm_storeu_ps(p, x.v); }
+			static SSELane	Set(float x) { return { _mm_set1_ps(x) }; }
+			static SSELane	Min(SSELane lhs, SSELane rhs) { return { _mm_min_ps(lhs.v, rhs.v) }; }
+			static SSELane	Max(SSELane lhs, SSELane rhs) { return { _mm_max_ps(lhs.v, rhs.v) }; }
+			// sse2 has no rounding instruction, truncation rounds negative lanes up and one is subtracted there.
+			// lanes must be within the int32 range
+			static SSELane	Floor(SSELane x)
+			{
+				__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+				return { _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x.v), _mm_set1_ps(1.f))) };
+			}
+			static uint32_t NonNegativeMask(SSELane x) { return (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(x.v, _mm_setzero_ps())); }
+		};
+		inline SSELane operator+(SSELane lhs, SSELane rhs) { return { _mm_add_ps(lhs.v, rhs.v) }; }
+		inline SSELane operator-(SSELane lhs, SSELane rhs) { return { _mm_sub_ps(lhs.v, rhs.v) }; }
+		inline SSELane operator*(SSELane lhs, SSELane rhs) { return { _mm_mul_ps(lhs.v, rhs.v) }; }
+		inline SSELane operator/(SSELane lhs, SSELane rhs) { return { _mm_div_ps(lhs.v, rhs.v) }; }
+#endif
+
+#ifdef __AVX2__
+		struct AVX2Lane
+		{
+			static constexpr uint32_t width = 8;
+			__m256 v;
+
+			static AVX2Lane Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+			static void		Store(float* p, AVX2Lane x) { _mm256_storeu_ps(p, x.v); }
+			static AVX2Lane Set(float x) { return { _mm256_set1_ps(x) }; }
+			static AVX2Lane Min(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_min_ps(lhs.v, rhs.v) }; }
+			static AVX2Lane Max(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_max_ps(lhs.v, rhs.v) }; }
+			static AVX2Lane Floor(AVX2Lane x) { return { _mm256_floor_ps(x.v) }; }
+			static uint32_t NonNegativeMask(AVX2Lane x) { return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(x.v, _mm256_setzero_ps(), _CMP_GE_OQ)); }
+		};
+		inline AVX2Lane operator+(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_add_ps(lhs.v, rhs.v) }; }
+		inline AVX2Lane operator-(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_sub_ps(lhs.v, rhs.v) }; }
+		inline AVX2Lane operator*(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_mul_ps(lhs.v, rhs.v) }; }
+		inline AVX2Lane operator/(AVX2Lane lhs, AVX2Lane rhs) { return { _mm256_div_ps(lhs.v, rhs.v) }; }
+#endif
+	}
+}
@@ -0,0 +1,247 @@
+#include "Math/TransformBatch.h"
+#include "Math/TransformBatchKernels.h"
+#include "Math/SimdLanes.h"
+#include <atomic>
+
+#if defined(KBS_SIMD_SSE) && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace kbs
+{
+	namespace
+	{
+		SimdLevel DetectSimdLevel()
+		{
+#ifdef KBS_SIMD_SSE
+	#ifdef KBS_ENABLE_AVX2
+		#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] >= 7)
+			{
+				__cpuid(info, 1);
+				bool fma = (info[2] & (1 << 12)) != 0;
+				bool osxsave = (info[2] & (1 << 27)) != 0;
+				bool avx = (info[2] & (1 << 28)) != 0;
+				__cpuidex(info, 7, 0);
+				bool avx2 = (info[1] & (1 << 5)) != 0;
+				// the os must save the ymm registers on context switches
+				if (fma && osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6)
+				{
+					return SimdLevel::AVX2;
+				}
+			}
+		#else
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			{
+				return SimdLevel::AVX2;
+			}
+		#endif
+	#endif
+			return SimdLevel::SSE;
+#else
+			return SimdLevel::Scalar;
+#endif
+		}
+
+		std::atomic<SimdLevel> s_SimdLevel{ DetectSimdLevel() };
+
+		kernels::TransformStreams GetStreams(const TransformSoA& transforms)
+		{
+			kernels::TransformStreams streams;
+			for (uint32_t i = 0; i < 3; i++) streams.position[i] = transforms.position[i].data();
+			for (uint32_t i = 0; i < 4; i++) streams.rotation[i] = transforms.rotation[i].data();
+			for (uint32_t i = 0; i < 3; i++) streams.scale[i] = transforms.scale[i].data();
+			return streams;
+		}
+
+		kernels::MatrixStreams GetStreams(AffineMatrixSoA& matrices)
+		{
+			kernels::MatrixStreams streams;
+			for (uint32_t i = 0; i < 12; i++) streams.m[i] = matrices.m[i].data();
+			return streams;
+		}
+
+		kernels::ConstMatrixStreams GetStreams(const AffineMatrixSoA& matrices)
+		{
+			kernels::ConstMatrixStreams streams;
+			for (uint32_t i = 0; i < 12; i++) streams.m[i] = matrices.m[i].data();
+			return streams;
+		}
+
+		uint32_t GetPaddedSize(uint32_t count)
+		{
+			return (count + TransformBatchAlignment - 1) / TransformBatchAlignment * TransformBatchAlignment;
+		}
+	}
+
+	void TransformSoA::Resize(uint32_t count)
+	{
+		uint32_t padded = GetPaddedSize(count);
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			// padding lanes hold identity transforms so inverses stay finite
+			position[i].resize(padded, 0.f);
+			scale[i].resize(padded, 1.f);
+		}
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			rotation[i].resize(padded, i == 3 ? 1.f : 0.f);
+		}
+		for (uint32_t i = count; i < m_Count && i < padded; i++)
+		{
+			Set(i, vec3(0.f), quat(1, 0, 0, 0), vec3(1.f));
+		}
+		m_Count = count;
+	}
+
+	void TransformSoA::Set(uint32_t index, vec3 p, quat r, vec3 s)
+	{
+		position[0][index] = p.x, position[1][index] = p.y, position[2][index] = p.z;
+		rotation[0][index] = r.x, rotation[1][index] = r.y, rotation[2][index] = r.z, rotation[3][index] = r.w;
+		scale[0][index] = s.x, scale[1][index] = s.y, scale[2][index] = s.z;
+	}
+
+	void AffineMatrixSoA::Resize(uint32_t count)
+	{
+		uint32_t padded = GetPaddedSize(count);
+		for (uint32_t i = 0; i < 12; i++)
+		{
+			// identity padding, diagonal elements are 0, 4 and 8
+			m[i].resize(padded, i % 4 == 0 && i < 9 ? 1.f : 0.f);
+		}
+		for (uint32_t i = count; i < m_Count && i < padded; i++)
+		{
+			Set(i, mat4(1.f));
+		}
+		m_Count = count;
+	}
+
+	void AffineMatrixSoA::Set(uint32_t index, const mat4& matrix)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			for (uint32_t r = 0; r < 3; r++)
+			{
+				m[c * 3 + r][index] = matrix[c][r];
+			}
+		}
+	}
+
+	mat4 AffineMatrixSoA::Get(uint32_t index) const
+	{
+		mat4 matrix(1.f);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			for (uint32_t r = 0; r < 3; r++)
+			{
+				matrix[c][r] = m[c * 3 + r][index];
+			}
+		}
+		return matrix;
+	}
+
+	SimdLevel math::GetSupportedSimdLevel()
+	{
+		static SimdLevel level = DetectSimdLevel();
+		return level;
+	}
+
+	SimdLevel math::GetSimdLevel()
+	{
+		return s_SimdLevel.load(std::memory_order_relaxed);
+	}
+
+	void math::SetSimdLevel(SimdLevel level)
+	{
+		s_SimdLevel.store(std::min(level, GetSupportedSimdLevel()), std::memory_order_relaxed);
+	}
+
+	void math::ComposeTRS(const TransformSoA& transforms, AffineMatrixSoA& world, AffineMatrixSoA* inverse)
+	{
+		uint32_t count = transforms.Size();
+		world.Resize(count);
+		if (inverse != nullptr)
+		{
+			inverse->Resize(count);
+		}
+
+		kernels::TransformStreams in = GetStreams(transforms);
+		kernels::MatrixStreams worldStreams = GetStreams(world);
+		kernels::MatrixStreams inverseStreams;
+		if (inverse != nullptr)
+		{
+			inverseStreams = GetStreams(*inverse);
+		}
+		const kernels::MatrixStreams* out = inverse != nullptr ? &inverseStreams : nullptr;
+
+		// the streams are padded, the simd paths may process the padding lanes
+		switch (GetSimdLevel())
+		{
+#ifdef KBS_ENABLE_AVX2
+		case SimdLevel::AVX2:
+			kernels::ComposeTRSAVX2(in, worldStreams, out, GetPaddedSize(count));
+			break;
+#endif
+#ifdef KBS_SIMD_SSE
+		case SimdLevel::SSE:
+			kernels::ComposeTRS<SSELane>(in, worldStreams, out, GetPaddedSize(count));
+			break;
+#endif
+		default:
+			kernels::ComposeTRS<ScalarLane>(in, worldStreams, out, count);
+			break;
+		}
+	}
+
+	void math::InverseAffine(const AffineMatrixSoA& matrices, AffineMatrixSoA& inverse)
+	{
+		uint32_t count = matrices.Size();
+		inverse.Resize(count);
+
+		kernels::ConstMatrixStreams in = GetStreams(matrices);
+		kernels::MatrixStreams out = GetStreams(inverse);
+		switch (GetSimdLevel())
+		{
+#ifdef KBS_ENABLE_AVX2
+		case SimdLevel::AVX2:
+			kernels::InverseAffineAVX2(in, out, GetPaddedSize(count));
+			break;
+#endif
+#ifdef KBS_SIMD_SSE
+		case SimdLevel::SSE:
+			kernels::InverseAffine<SSELane>(in, out, GetPaddedSize(count));
+			break;
+#endif
+		default:
+			kernels::InverseAffine<ScalarLane>(in, out, count);
+			break;
+		}
+	}
+
+	void math::StoreMatrices(const AffineMatrixSoA& matrices, uint32_t first, uint32_t count, mat4* out, bool transpose)
+	{
+		KBS_ASSERT(first + count <= matrices.Size(), "matrices out of range");
+		for (uint32_t i = 0; i < count; i++)
+		{
+			mat4& matrix = out[i];
+			uint32_t index = first + i;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				for (uint32_t r = 0; r < 3; r++)
+				{
+					float value = matrices.m[c * 3 + r][index];
+					if (transpose) matrix[r][c] = value;
+					else matrix[c][r] = value;
+				}
+			}
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				if (transpose) matrix[3][k] = 0.f;
+				else matrix[k][3] = 0.f;
+			}
+			matrix[3][3] = 1.f;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Common.h"
+#include "Math/math.h"
+
+namespace kbs
+{
+	// local transforms of many objects as structure of arrays, the arrays are padded
+	// to a multiple of TransformBatchAlignment elements with identity transforms
+	constexpr uint32_t TransformBatchAlignment = 8;
+
+	struct KBS_API TransformSoA
+	{
+		std::vector<float> position[3];
+		// x, y, z, w
+		std::vector<float> rotation[4];
+		std::vector<float> scale[3];
+
+		void	 Resize(uint32_t count);
+		uint32_t Size() const { return m_Count; }
+		void	 Set(uint32_t index, vec3 position, quat rotation, vec3 scale);
+
+	private:
+		uint32_t m_Count = 0;
+	};
+
+	// affine matrices as structure of arrays, the last row is always 0, 0, 0, 1.
+	// element (row, column) of matrix i is m[column * 3 + row][i]
+	struct KBS_API AffineMatrixSoA
+	{
+		std::vector<float> m[12];
+
+		void	 Resize(uint32_t count);
+		uint32_t Size() const { return m_Count; }
+		void	 Set(uint32_t index, const mat4& matrix);
+		mat4	 Get(uint32_t index) const;
+
+	private:
+		uint32_t m_Count = 0;
+	};
+
+	enum class SimdLevel
+	{
+		Scalar,
+		SSE,
+		AVX2
+	};
+
+	namespace math
+	{
+		// the best instruction set supported by both the build and the cpu
+		KBS_API SimdLevel GetSupportedSimdLevel();
+		// the batch functions use the supported level by default, tests and benchmarks can force a lower one
+		KBS_API SimdLevel GetSimdLevel();
+		KBS_API void	  SetSimdLevel(SimdLevel level);
+
+		// world = translate * rotate * scale, inverses are computed in closed form if requested
+		KBS_API void ComposeTRS(const TransformSoA& transforms, AffineMatrixSoA& world, AffineMatrixSoA* inverse = nullptr);
+		KBS_API void InverseAffine(const AffineMatrixSoA& matrices, AffineMatrixSoA& inverse);
+
+		// writes count matrices starting from first, transposing them if requested.
+		// storing the inverse transposed gives the normal matrix, same as transpose(inverse(m))
+		KBS_API void StoreMatrices(const AffineMatrixSoA& matrices, uint32_t first, uint32_t count, mat4* out, bool transpose = false);
+	}
+}
@@ -0,0 +1,19 @@
+#include "Math/TransformBatchKernels.h"
+
+// compiled with avx2 code generation, only called after TransformBatch.cpp checked the cpu
+#ifdef KBS_ENABLE_AVX2
+#include "Math/SimdLanes.h"
+
+namespace kbs
+{
+	void kernels::ComposeTRSAVX2(const TransformStreams& in, const MatrixStreams& world, const MatrixStreams* inverse, uint32_t count)
+	{
+		ComposeTRS<AVX2Lane>(in, world, inverse, count);
+	}
+
+	void kernels::InverseAffineAVX2(const ConstMatrixStreams& in, const MatrixStreams& out, uint32_t count)
+	{
+		InverseAffine<AVX2Lane>(in, out, count);
+	}
+}
+#endif
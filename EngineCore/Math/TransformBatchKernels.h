@@ -0,0 +1,137 @@
+#pragma once
+#include <stdint.h>
+
+// kernels shared by the scalar, SSE and AVX2 paths of TransformBatch. they are instantiated with a lane type
+// from Math/SimdLanes.h and must not depend on other engine headers, the AVX2 instantiation is compiled with
+// different code generation flags
+namespace kbs
+{
+	namespace kernels
+	{
+		struct TransformStreams
+		{
+			const float* position[3];
+			const float* rotation[4];
+			const float* scale[3];
+		};
+
+		// 3x4 affine matrices, element (row, column) is stored in m[column * 3 + row]
+		struct MatrixStreams
+		{
+			float* m[12];
+		};
+
+		struct ConstMatrixStreams
+		{
+			const float* m[12];
+		};
+
+		// count must be a multiple of V::width
+		template<typename V>
+		void ComposeTRS(const TransformStreams& inStreams, const MatrixStreams& worldStreams, const MatrixStreams* inverseStreams, uint32_t count)
+		{
+			// local copies of the stream pointers, the stores could alias the structures otherwise
+			const TransformStreams in = inStreams;
+			const MatrixStreams world = worldStreams;
+			MatrixStreams inverseCopy = inverseStreams != nullptr ? *inverseStreams : MatrixStreams{};
+			const MatrixStreams* inverse = inverseStreams != nullptr ? &inverseCopy : nullptr;
+
+			const V one = V::Set(1.f), two = V::Set(2.f);
+			for (uint32_t i = 0; i < count; i += V::width)
+			{
+				V x = V::Load(in.rotation[0] + i), y = V::Load(in.rotation[1] + i), z = V::Load(in.rotation[2] + i), w = V::Load(in.rotation[3] + i);
+				V xx = x * x, yy = y * y, zz = z * z;
+				V xy = x * y, xz = x * z, yz = y * z;
+				V wx = w * x, wy = w * y, wz = w * z;
+
+				// rotation matrix r[column][row], same as glm::mat4_cast
+				V r[3][3] =
+				{
+					{ one - two * (yy + zz), two * (xy + wz), two * (xz - wy) },
+					{ two * (xy - wz), one - two * (xx + zz), two * (yz + wx) },
+					{ two * (xz + wy), two * (yz - wx), one - two * (xx + yy) }
+				};
+				V s[3] = { V::Load(in.scale[0] + i), V::Load(in.scale[1] + i), V::Load(in.scale[2] + i) };
+				V t[3] = { V::Load(in.position[0] + i), V::Load(in.position[1] + i), V::Load(in.position[2] + i) };
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					for (uint32_t row = 0; row < 3; row++)
+					{
+						V::Store(world.m[c * 3 + row] + i, r[c][row] * s[c]);
+					}
+				}
+				for (uint32_t row = 0; row < 3; row++)
+				{
+					V::Store(world.m[9 + row] + i, t[row]);
+				}
+
+				if (inverse != nullptr)
+				{
+					// (T R S)^-1 = S^-1 R^T T^-1
+					V invS[3] = { one / s[0], one / s[1], one / s[2] };
+					V a[3][3];
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						for (uint32_t row = 0; row < 3; row++)
+						{
+							a[c][row] = r[row][c] * invS[row];
+							V::Store(inverse->m[c * 3 + row] + i, a[c][row]);
+						}
+					}
+					for (uint32_t row = 0; row < 3; row++)
+					{
+						V::Store(inverse->m[9 + row] + i, V::Set(0.f) - (a[0][row] * t[0] + a[1][row] * t[1] + a[2][row] * t[2]));
+					}
+				}
+			}
+		}
+
+		// inverse of general affine matrices, count must be a multiple of V::width
+		template<typename V>
+		void InverseAffine(const ConstMatrixStreams& inStreams, const MatrixStreams& outStreams, uint32_t count)
+		{
+			const ConstMatrixStreams in = inStreams;
+			const MatrixStreams out = outStreams;
+			const V one = V::Set(1.f);
+			for (uint32_t i = 0; i < count; i += V::width)
+			{
+				V a[3][3];
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					for (uint32_t r = 0; r < 3; r++)
+					{
+						a[c][r] = V::Load(in.m[c * 3 + r] + i);
+					}
+				}
+				V t[3] = { V::Load(in.m[9] + i), V::Load(in.m[10] + i), V::Load(in.m[11] + i) };
+
+				// rows of the inverse are the cross products of the columns divided by the determinant
+				V rows[3][3] =
+				{
+					{ a[1][1] * a[2][2] - a[1][2] * a[2][1], a[1][2] * a[2][0] - a[1][0] * a[2][2], a[1][0] * a[2][1] - a[1][1] * a[2][0] },
+					{ a[2][1] * a[0][2] - a[2][2] * a[0][1], a[2][2] * a[0][0] - a[2][0] * a[0][2], a[2][0] * a[0][1] - a[2][1] * a[0][0] },
+					{ a[0][1] * a[1][2] - a[0][2] * a[1][1], a[0][2] * a[1][0] - a[0][0] * a[1][2], a[0][0] * a[1][1] - a[0][1] * a[1][0] }
+				};
+				V invDet = one / (a[0][0] * rows[0][0] + a[0][1] * rows[0][1] + a[0][2] * rows[0][2]);
+
+				V inv[3][3];
+				for (uint32_t r = 0; r < 3; r++)
+				{
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						inv[c][r] = rows[r][c] * invDet;
+						V::Store(out.m[c * 3 + r] + i, inv[c][r]);
+					}
+				}
+				for (uint32_t r = 0; r < 3; r++)
+				{
+					V::Store(out.m[9 + r] + i, V::Set(0.f) - (inv[0][r] * t[0] + inv[1][r] * t[1] + inv[2][r] * t[2]));
+				}
+			}
+		}
+
+		void ComposeTRSAVX2(const TransformStreams& in, const MatrixStreams& world, const MatrixStreams* inverse, uint32_t count);
+		void InverseAffineAVX2(const ConstMatrixStreams& in, const MatrixStreams& out, uint32_t count);
+	}
+}
@@ -28,15 +28,26 @@ void kbs::DeferredPass::Initialize(ptr<vkrg::RenderPass> pass, RendererAttachmen
 }
 
 void kbs::DeferredPass::OnSceneRender(vkrg::RenderPassRuntimeContext& ctx, VkCommandBuffer cmd, RenderCamera& camera, ptr<Scene> scene)
+{
+	if (m_IndirectDraws.has_value())
+	{
+		GetRenderer()->RenderIndirectDraws(m_IndirectDraws.value(), camera, cmd);
+		return;
+	}
+	RenderSceneByCamera(GetGBufferFilter(), cmd);
+}
+
+kbs::RenderFilter kbs::DeferredPass::GetGBufferFilter()
 {
 	RenderFilter filter;
 	filter.flags = RenderPass_Opaque;
-	filter.shaderFilter = [&](const ShaderID& id)
+	filter.occlusionCulling = true;
+	ShaderID mrtShaderID = m_MRTShader->GetShaderID();
+	filter.shaderFilter = [mrtShaderID](const ShaderID& id)
 	{
-		return id == m_MRTShader->GetShaderID();
+		return id == mrtShaderID;
 	};
-	
-	RenderSceneByCamera(filter, cmd);
+	return filter;
 }
 
 void kbs::DeferredPass::GetClearValue(uint32_t attachment, VkClearValue& value)
@@ -143,42 +154,33 @@ namespace kbs
 
 
 
-void kbs::DeferredShadingPass::AttachScene(ptr<Scene> scene, opt<Entity> mainLight, opt<kbs::mat4> mainLightMVP)
+void kbs::DeferredShadingPass::AttachRenderWorld(const RenderWorld& world, opt<UUID> mainLight, opt<kbs::mat4> mainLightMVP)
 {
-	bool mainLightFounded = false;
 	RenderAPI api = GetRenderAPI();
 
-	std::vector<DeferredPassLight> lights;
-	scene->IterateAllEntitiesWith<LightComponent>(
-		[&](Entity e)
-		{
-			LightComponent lc = e.GetComponent<LightComponent>();
-	Transform lTrans(e);
-
-	DeferredPassLight lightData;
-	lightData.emission = lc.intensity;
-	lightData.lightType = lc.type;
-	lightData.shadowBias = 1e-4;
-	lightData.mainLightFlag = false;
-
-	if (lc.type == LightComponent::Directional)
+	FrameVector<DeferredPassLight> lights;
+	lights.reserve(world.lights.size());
+	for (const RenderWorldLight& light : world.lights)
 	{
-		lightData.position = -lTrans.GetFront();
+		DeferredPassLight lightData;
+		lightData.emission = light.light.intensity;
+		lightData.lightType = light.light.type;
+		lightData.shadowBias = 1e-4;
+		lightData.mainLightFlag = false;
 
-		if (mainLight.has_value())
+		if (light.light.type == LightComponent::Directional)
 		{
-			if (e.GetUUID() == mainLight.value().GetUUID())
+			lightData.position = -light.front;
+
+			if (mainLight.has_value() && light.id == mainLight.value())
 			{
 				lightData.mainLightFlag = true;
-				ObjectUBO objectUBO = lTrans.GetObjectUBO();
 				lightData.lightVP = mainLightMVP.value();
 			}
 		}
-	}
 
-	lights.push_back(lightData);
-		}
-	);
+		lights.push_back(lightData);
+	}
 
 	uint32_t deferredPassLightBufferSize = lights.size() * sizeof(DeferredPassLight);
 
@@ -190,7 +192,9 @@ void kbs::DeferredShadingPass::AttachScene(ptr<Scene> scene, opt<Entity> mainLig
 			deferredPassLightBufferSize, 0);
 	}
 	
-	RenderCamera renderCamera(scene->GetMainCamera());
+	const RenderWorldCamera* mainCamera = world.GetMainCamera();
+	KBS_ASSERT(mainCamera != nullptr, "main camera must be created");
+	RenderCamera renderCamera(mainCamera->camera, mainCamera->GetTransform());
 	CameraUBO cameraUBO = renderCamera.GetCameraUBO();
 
 	DeferredPassUniform uniformData;
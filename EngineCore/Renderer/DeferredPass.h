@@ -26,6 +26,10 @@ namespace kbs
 		virtual bool OnValidationCheck(std::string& msg) override;
 
 		ptr<GraphicsShader>	 GetMRTShader();
+		// objects drawn into the gbuffer
+		RenderFilter		 GetGBufferFilter();
+		// the gbuffer is drawn by the prepared indirect draws instead of RenderSceneByCamera
+		void				 SetIndirectDraws(opt<IndirectDrawHandle> handle) { m_IndirectDraws = handle; }
 
 	protected:
 		virtual void Initialize(ptr<vkrg::RenderPass> pass, RendererAttachmentDescriptor& desc,
@@ -39,13 +43,15 @@ namespace kbs
 		vkrg::RenderPassAttachment depthStencil;
 
 		ptr<GraphicsShader>		m_MRTShader;
+		opt<IndirectDrawHandle>	m_IndirectDraws;
 	};
 
 	class DeferredShadingPass : public ComputePass
 	{
 	public:
 		
-		void AttachScene(ptr<Scene> scene, opt<Entity> mainLight, opt<kbs::mat4> mainLightMVP);
+		// lights and the main camera are read from the render world of the frame
+		void AttachRenderWorld(const RenderWorld& world, opt<UUID> mainLight, opt<kbs::mat4> mainLightMVP);
 		void ResizeScreen(uint32_t width, uint32_t height);
 
 	protected:
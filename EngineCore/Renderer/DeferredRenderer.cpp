@@ -28,7 +28,7 @@ namespace kbs
 		renderGraph->AddGraphResource("material", info, false);
 
 		info.format = GetBackBufferFormat();
-		renderGraph->AddGraphResource("backBuffer", info, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		renderGraph->AddGraphResource("backBuffer", info, true, GetBackBufferFinalLayout());
 
 		info.format = VK_FORMAT_D24_UNORM_S8_UINT;
 		renderGraph->AddGraphResource("depth", info, false);
@@ -113,7 +113,7 @@ namespace kbs
 			return false;
 		}
 
-		auto backBuffers = m_Context->GetBackBuffers();
+		auto backBuffers = GetBackBuffers();
 		auto extData = renderGraph->GetExternalDataFrame();
 		for (uint32_t i = 0; i < backBuffers.size(); i++)
 		{
@@ -132,16 +132,26 @@ namespace kbs
 
 	void DeferredRenderer::OnSceneRender(ptr<Scene> scene)
 	{
-		Entity mainCamera = scene->GetMainCamera();
+		const RenderWorldCamera* worldCamera = GetRenderWorld().GetMainCamera();
+		KBS_ASSERT(worldCamera != nullptr, "main camera must be created");
+		RenderCamera mainCamera(worldCamera->camera, worldCamera->GetTransform());
 
 
 		m_DeferredPass->SetTargetCamera(mainCamera);
 		m_DeferredPass->SetTargetScene(scene);
+		if (IsGPUDrivenRendering())
+		{
+			m_DeferredPass->SetIndirectDraws(PrepareIndirectDraws(mainCamera, m_DeferredPass->GetGBufferFilter()));
+		}
+		else
+		{
+			m_DeferredPass->SetIndirectDraws(std::nullopt);
+		}
 
 		m_ShadowPass->SetTargetScene(scene);
 		m_ShadowPass->SetTargetCamera(mainCamera);
 
-		m_DeferredShadingPass->AttachScene(scene, m_ShadowPass->GetShadowCaster(), m_ShadowPass->GetLightVP());
+		m_DeferredShadingPass->AttachRenderWorld(GetRenderWorld(), m_ShadowPass->GetShadowCaster(), m_ShadowPass->GetLightVP());
 	}
 
 }
@@ -0,0 +1,83 @@
+#include "Renderer/DrawSort.h"
+#include "Core/Profiler.h"
+#include <cstring>
+
+namespace kbs
+{
+	uint16_t QuantizeDrawDepth(float distance2)
+	{
+		// also catches nans
+		if (!(distance2 > 0.f))
+		{
+			return 0;
+		}
+		// positive floats order like their bits, the sign bit is zero so the upper 17 bits fit in 16
+		uint32_t bits;
+		std::memcpy(&bits, &distance2, sizeof(float));
+		return (uint16_t)(bits >> 15);
+	}
+
+	uint64_t PackDrawSortKey(bool transparent, uint32_t pipeline, uint32_t material, uint32_t mesh, float distance2)
+	{
+		using namespace DrawSortKey;
+		uint64_t depth = QuantizeDrawDepth(distance2);
+		uint64_t state = ((uint64_t)(pipeline & ((1u << pipelineBits) - 1)) << (materialBits + meshBits))
+			| ((uint64_t)(material & ((1u << materialBits) - 1)) << meshBits)
+			| (uint64_t)(mesh & ((1u << meshBits) - 1));
+
+		if (transparent)
+		{
+			uint64_t farFirst = ((1u << depthBits) - 1) - depth;
+			return (transparentPass << 62) | (farFirst << (pipelineBits + materialBits + meshBits)) | state;
+		}
+		return (opaquePass << 62) | (state << depthBits) | depth;
+	}
+
+	void RadixSortDrawItems(DrawSortItem* items, DrawSortItem* scratch, uint32_t count)
+	{
+		KBS_PROFILE_FUNCTION();
+		constexpr uint32_t digitCount = 8;
+		constexpr uint32_t radix = 256;
+
+		// histograms of every digit in one read of the keys
+		uint32_t histograms[digitCount * radix] = {};
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint64_t key = items[i].key;
+			for (uint32_t d = 0; d < digitCount; d++)
+			{
+				histograms[d * radix + ((key >> (d * 8)) & 0xff)]++;
+			}
+		}
+
+		DrawSortItem* src = items;
+		DrawSortItem* dst = scratch;
+		for (uint32_t d = 0; d < digitCount; d++)
+		{
+			uint32_t* histogram = histograms + d * radix;
+			// every key has the same digit, the pass wouldn't move anything
+			if (count == 0 || histogram[(src[0].key >> (d * 8)) & 0xff] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t b = 0; b < radix; b++)
+			{
+				uint32_t size = histogram[b];
+				histogram[b] = offset;
+				offset += size;
+			}
+			for (uint32_t i = 0; i < count; i++)
+			{
+				dst[histogram[(src[i].key >> (d * 8)) & 0xff]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != items)
+		{
+			std::memcpy(items, src, sizeof(DrawSortItem) * count);
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Common.h"
+
+// sort keys of the draw list. the state and depth of a draw are packed into one 64 bit key once, the keys are
+// sorted by a radix sort without comparing draws. see Renderer::SortRenderableObjects
+namespace kbs
+{
+	// opaque draws  : pass 2 | pipeline 10 | material 16 | mesh 20 | depth 16 , state changes first then front to back
+	// transparent   : pass 2 | inverted depth 16 | pipeline 10 | material 16 | mesh 20 , back to front first
+	// ids wider than their bits wrap, which only costs state changes as the draw loop compares the real state
+	namespace DrawSortKey
+	{
+		constexpr uint32_t passBits = 2;
+		constexpr uint32_t pipelineBits = 10;
+		constexpr uint32_t materialBits = 16;
+		constexpr uint32_t meshBits = 20;
+		constexpr uint32_t depthBits = 16;
+
+		constexpr uint64_t opaquePass = 0;
+		constexpr uint64_t transparentPass = 1;
+	}
+
+	struct DrawSortItem
+	{
+		uint64_t key;
+		// index of the draw in the list the keys are built for
+		uint32_t index;
+	};
+
+	// the view distance squared keeps its order in the upper bits of the float, no far plane is needed
+	KBS_API uint16_t QuantizeDrawDepth(float distance2);
+
+	KBS_API uint64_t PackDrawSortKey(bool transparent, uint32_t pipeline, uint32_t material, uint32_t mesh, float distance2);
+
+	// stable LSD radix sort by key, 8 bits a pass. passes where every key has the same digit are skipped.
+	// scratch must hold count items, the sorted items end up in items
+	KBS_API void RadixSortDrawItems(DrawSortItem* items, DrawSortItem* scratch, uint32_t count);
+}
@@ -0,0 +1,61 @@
+#include "Renderer/IndirectDraw.h"
+#include "Core/Profiler.h"
+
+namespace kbs
+{
+	void BuildIndirectDraws(std::vector<IndirectDrawSource>& sources, std::vector<IndirectDrawRecord>& records,
+		std::vector<IndirectDrawBatch>& batches)
+	{
+		KBS_PROFILE_FUNCTION();
+		auto batchKey = [](const IndirectDrawSource& s) { return std::make_tuple((uint64_t)s.shader, (uint64_t)s.material, (uint64_t)s.meshGroup); };
+		std::sort(sources.begin(), sources.end(),
+			[&](const IndirectDrawSource& lhs, const IndirectDrawSource& rhs)
+			{
+				auto l = batchKey(lhs), r = batchKey(rhs);
+				return l != r ? l < r : lhs.objectIndex < rhs.objectIndex;
+			}
+		);
+
+		records.resize(sources.size());
+		batches.clear();
+		for (uint32_t i = 0; i < sources.size(); i++)
+		{
+			const IndirectDrawSource& source = sources[i];
+			if (batches.empty() || batchKey(sources[batches.back().firstCommand]) != batchKey(source))
+			{
+				batches.push_back(IndirectDrawBatch{ source.shader, source.material, source.meshGroup, i, 0 });
+			}
+			IndirectDrawBatch& batch = batches.back();
+			batch.maxCommandCount++;
+
+			// the indices of a mesh group are relative to the start of its vertex buffer
+			IndirectDrawRecord& record = records[i];
+			record.indexCount = source.indexCount;
+			record.firstIndex = source.firstIndex;
+			record.vertexOffset = 0;
+			record.objectIndex = source.objectIndex;
+			record.batch = (uint32_t)batches.size() - 1;
+			record.commandBase = batch.firstCommand;
+			record.padding[0] = record.padding[1] = 0;
+		}
+	}
+
+	void CountVisibleIndirectDraws(const std::vector<IndirectDrawRecord>& records, const BoundsSoA& bounds,
+		const Frustum& frustum, std::vector<uint32_t>& counts)
+	{
+		std::vector<uint32_t> visible(bounds.Size());
+		visible.resize(math::CullFrustum(frustum, bounds, 0, bounds.Size(), visible.data()));
+		std::vector<bool> isVisible(bounds.Size(), false);
+		for (uint32_t i : visible)
+		{
+			isVisible[i] = true;
+		}
+
+		uint32_t batchCount = records.empty() ? 0 : records.back().batch + 1;
+		counts.assign(batchCount, 0);
+		for (const IndirectDrawRecord& record : records)
+		{
+			counts[record.batch] += isVisible[record.objectIndex];
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Common.h"
+#include "Scene/UUID.h"
+#include "Math/FrustumCulling.h"
+
+// draw lists of the gpu driven path, the records are culled by shader/Indirect/cull.comp and the visible ones
+// become VkDrawIndexedIndirectCommands. this part doesn't touch the device, see Renderer::PrepareIndirectDraws
+namespace kbs
+{
+	// one pass of a render world object drawn by an indirect draw list
+	struct IndirectDrawSource
+	{
+		UUID		shader;
+		UUID		material;
+		UUID		meshGroup;
+		uint32_t	objectIndex;
+		uint32_t	indexCount;
+		uint32_t	firstIndex;
+	};
+
+	// read by the culling shader, std430 layout
+	struct IndirectDrawRecord
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t  vertexOffset;
+		// index of the object in the render world, written to the instance of the command
+		uint32_t objectIndex;
+		// counter of the batch and the first command of the batch, the visible records of a batch are compacted behind it
+		uint32_t batch;
+		uint32_t commandBase;
+		uint32_t padding[2];
+	};
+	static_assert(sizeof(IndirectDrawRecord) == 32, "IndirectDrawRecord must match DrawRecord in cull.comp");
+
+	// draws sharing the pipeline, material and mesh group, recorded as a single indirect draw with a count
+	struct IndirectDrawBatch
+	{
+		UUID	 shader;
+		UUID	 material;
+		UUID	 meshGroup;
+		uint32_t firstCommand;
+		uint32_t maxCommandCount;
+	};
+
+	// sorts the sources by shader, material and mesh group and groups them into batches.
+	// the commands of a batch are reserved behind each other, one for every record of the batch
+	KBS_API void BuildIndirectDraws(std::vector<IndirectDrawSource>& sources, std::vector<IndirectDrawRecord>& records,
+		std::vector<IndirectDrawBatch>& batches);
+
+	// the number of commands the culling shader writes for every batch, a reference for the gpu counts
+	KBS_API void CountVisibleIndirectDraws(const std::vector<IndirectDrawRecord>& records, const BoundsSoA& bounds,
+		const Frustum& frustum, std::vector<uint32_t>& counts);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Common.h"
+
+namespace kbs
+{
+	// consecutive draws of a sorted draw list recorded as the instances of one draw
+	struct InstancedDraw
+	{
+		uint32_t firstDraw;
+		uint32_t instanceCount;
+	};
+
+	// splits draws [0, drawCount) into the longest runs whose draws share their state with the first draw of the run.
+	// sameState(first, i) compares the pipeline, material and mesh of two draws, the draws must be sorted so equal
+	// states are next to each other. InstancedDrawList is a vector of InstancedDraw, it is cleared first
+	template<typename SameState, typename InstancedDrawList>
+	void BuildInstancedDraws(uint32_t drawCount, SameState&& sameState, InstancedDrawList& instancedDraws)
+	{
+		instancedDraws.clear();
+		// at most one draw per object
+		instancedDraws.reserve(drawCount);
+		for (uint32_t first = 0; first < drawCount;)
+		{
+			uint32_t end = first + 1;
+			while (end < drawCount && sameState(first, end))
+			{
+				end++;
+			}
+			instancedDraws.push_back(InstancedDraw{ first, end - first });
+			first = end;
+		}
+	}
+}
@@ -184,24 +184,35 @@ namespace kbs
 
     View<ptr<Material>> kbs::MaterialManager::GetMaterials()
     {
-        return View(m_Materials);
+        return m_Materials.GetValues();
     }
 
     opt<ptr<Material>> kbs::MaterialManager::GetMaterialByID(const MaterialID& id)
     {
-        if (m_MaterialIDTable.count(id))
+        if (ptr<Material>* mat = m_Materials.Get(GetMaterialHandle(id)))
         {
-            return m_MaterialIDTable[id];
+            return *mat;
         }
         return std::nullopt;
     }
 
+    MaterialHandle MaterialManager::GetMaterialHandle(const MaterialID& id)
+    {
+        auto iter = m_MaterialIDTable.find(id);
+        return iter != m_MaterialIDTable.end() ? iter->second : MaterialHandle{};
+    }
+
+    Material* MaterialManager::GetMaterial(MaterialHandle handle)
+    {
+        ptr<Material>* mat = m_Materials.Get(handle);
+        return mat != nullptr ? mat->get() : nullptr;
+    }
+
     kbs::MaterialID kbs::MaterialManager::CreateMaterial(ptr<GraphicsShader> shader, ptr<RenderBuffer> buffer, const std::string& name)
     {
         auto mat = std::make_shared<Material>(UUID::GenerateUncollidedID(m_MaterialIDTable), name, shader->GetShaderID(), buffer);
 
-        m_MaterialIDTable[mat->GetID()] = mat;
-        m_Materials.push_back(mat);
+        m_MaterialIDTable[mat->GetID()] = m_Materials.Insert(mat);
 
         return mat->GetID();
     }
@@ -218,11 +229,16 @@ namespace kbs
         return CreateMaterial(shader, buffer, name);
     }
 
+    View<ptr<RTMaterial>> MaterialManager::GetRTMaterials()
+    {
+        return m_RTMaterials.GetValues();
+    }
+
     opt<ptr<RTMaterial>> MaterialManager::GetRTMaterialByID(const RTMaterialID& id)
     {
-        if (m_RTMaterialIDTable.count(id))
+        if (ptr<RTMaterial>* mat = m_RTMaterials.Get(GetRTMaterialHandle(id)))
         {
-            return m_RTMaterialIDTable[id];
+            return *mat;
         }
         return std::nullopt;
     }
@@ -232,10 +248,22 @@ namespace kbs
         RTMaterialID matID = UUID::GenerateUncollidedID(m_RTMaterialIDTable);
         ptr<RTMaterial> rtMaterial = std::make_shared<RTMaterial>(matID, name);
 
-        m_RTMaterialIDTable[matID] = rtMaterial;
+        m_RTMaterialIDTable[matID] = m_RTMaterials.Insert(rtMaterial);
         return matID;
     }
 
+    RTMaterialHandle MaterialManager::GetRTMaterialHandle(const RTMaterialID& id)
+    {
+        auto iter = m_RTMaterialIDTable.find(id);
+        return iter != m_RTMaterialIDTable.end() ? iter->second : RTMaterialHandle{};
+    }
+
+    RTMaterial* MaterialManager::GetRTMaterial(RTMaterialHandle handle)
+    {
+        ptr<RTMaterial>* mat = m_RTMaterials.Get(handle);
+        return mat != nullptr ? mat->get() : nullptr;
+    }
+
 
     RTMaterial::RTMaterial(RTMaterialID matID, const std::string& name)
         :m_RTMaterialID(matID),m_Name(name)
@@ -293,4 +321,9 @@ namespace kbs
         return m_Name;
     }
 
+    RTMaterialID RTMaterial::GetID()
+    {
+        return m_RTMaterialID;
+    }
+
 }
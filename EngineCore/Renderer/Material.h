@@ -11,6 +11,11 @@ namespace kbs
 	using MaterialID = UUID;
 	using RTMaterialID = UUID;
 
+	class Material;
+	class RTMaterial;
+	using MaterialHandle = SlotHandle<ptr<Material>>;
+	using RTMaterialHandle = SlotHandle<ptr<RTMaterial>>;
+
 	class Material
 	{
 	public:
@@ -109,6 +114,7 @@ namespace kbs
 		PBRMaterialParameter& GetMaterialParameter();
 
 		std::string GetName();
+		RTMaterialID GetID();
 		
 	private:
 		std::string  m_Name;
@@ -131,16 +137,22 @@ namespace kbs
 
 		View<ptr<Material>> GetMaterials();
 		opt<ptr<Material>>	GetMaterialByID(const MaterialID& id);
+		// handle lookups don't hash, the returned pointers are valid until a material is created
+		MaterialHandle		GetMaterialHandle(const MaterialID& id);
+		Material*			GetMaterial(MaterialHandle handle);
 		MaterialID			CreateMaterial(ptr<GraphicsShader> shader, ptr<RenderBuffer> buffer,const std::string& name);
 		MaterialID			CreateMaterial(ptr<GraphicsShader> shader, RenderAPI& api, const std::string& name);
 
+		View<ptr<RTMaterial>> GetRTMaterials();
 		opt<ptr<RTMaterial>> GetRTMaterialByID(const RTMaterialID& id);
 		RTMaterialID		 CreateRTMaterial(const std::string& name);
+		RTMaterialHandle	 GetRTMaterialHandle(const RTMaterialID& id);
+		RTMaterial*			 GetRTMaterial(RTMaterialHandle handle);
 
 	private:
-		// std::vector<ptr<RTMaterial>> m_RTMaterials;
-		std::vector<ptr<Material>> m_Materials;
-		std::unordered_map<MaterialID, ptr<Material>> m_MaterialIDTable;
-		std::unordered_map<RTMaterialID, ptr<RTMaterial>> m_RTMaterialIDTable;
+		SlotMap<ptr<Material>>	 m_Materials;
+		SlotMap<ptr<RTMaterial>> m_RTMaterials;
+		std::unordered_map<MaterialID, MaterialHandle> m_MaterialIDTable;
+		std::unordered_map<RTMaterialID, RTMaterialHandle> m_RTMaterialIDTable;
 	};
 }
@@ -6,9 +6,9 @@ namespace kbs
 {
     opt<Mesh> kbs::MeshPool::GetMesh(const MeshID& id)
     {
-        if (m_Meshs.count(id))
+        if (Mesh* mesh = GetMesh(GetMeshHandle(id)))
         {
-            return m_Meshs[id];
+            return *mesh;
         }
 
         return std::nullopt;
@@ -16,14 +16,37 @@ namespace kbs
 
     opt<ptr<MeshGroup>> kbs::MeshPool::GetMeshGroup(const MeshGroupID& id)
     {
-        if (m_MeshGroups.count(id));
+        if (ptr<MeshGroup>* meshGroup = m_MeshGroups.Get(GetMeshGroupHandle(id)))
         {
-            return m_MeshGroups[id];
+            return *meshGroup;
         }
 
         return std::nullopt;
     }
 
+    MeshHandle MeshPool::GetMeshHandle(const MeshID& id)
+    {
+        auto iter = m_MeshHandles.find(id);
+        return iter != m_MeshHandles.end() ? iter->second : MeshHandle{};
+    }
+
+    MeshGroupHandle MeshPool::GetMeshGroupHandle(const MeshGroupID& id)
+    {
+        auto iter = m_MeshGroupHandles.find(id);
+        return iter != m_MeshGroupHandles.end() ? iter->second : MeshGroupHandle{};
+    }
+
+    Mesh* MeshPool::GetMesh(MeshHandle handle)
+    {
+        return m_Meshs.Get(handle);
+    }
+
+    MeshGroup* MeshPool::GetMeshGroup(MeshGroupHandle handle)
+    {
+        ptr<MeshGroup>* meshGroup = m_MeshGroups.Get(handle);
+        return meshGroup != nullptr ? meshGroup->get() : nullptr;
+    }
+
     MeshGroupID kbs::MeshPool::CreateMeshGroup(ptr<RenderBuffer> vertices, uint32_t verticesCount)
     {
         ptr<MeshGroup> meshGroup = std::make_shared<MeshGroup>();
@@ -32,10 +55,11 @@ namespace kbs
         meshGroup->m_IndicesCount = 0;
         meshGroup->m_MeshGroupType = MeshGroupType::Vertices;
 
-        MeshGroupID id = UUID::GenerateUncollidedID(m_MeshGroups);
-        m_MeshGroups[id] = meshGroup;
+        MeshGroupID id = UUID::GenerateUncollidedID(m_MeshGroupHandles);
         meshGroup->m_MeshGroupID = id;
+        meshGroup->m_Handle = m_MeshGroups.Insert(meshGroup);
         meshGroup->m_Pool = this;
+        m_MeshGroupHandles[id] = meshGroup->m_Handle;
 
         return id;
     }
@@ -55,10 +79,11 @@ namespace kbs
         meshGroup->m_IndicesCount = indicesCount;
         meshGroup->m_MeshGroupType = type;
 
-        MeshGroupID id = UUID::GenerateUncollidedID(m_MeshGroups);
-        m_MeshGroups[id] = meshGroup;
+        MeshGroupID id = UUID::GenerateUncollidedID(m_MeshGroupHandles);
         meshGroup->m_MeshGroupID = id;
+        meshGroup->m_Handle = m_MeshGroups.Insert(meshGroup);
         meshGroup->m_Pool = this;
+        m_MeshGroupHandles[id] = meshGroup->m_Handle;
 
         return id;
     }
@@ -80,9 +105,12 @@ namespace kbs
         mesh.m_VerticesStart = verticesStart;
         mesh.m_Pool = this;
         mesh.m_GroupID = groupID;
-        mesh.m_Id = UUID::GenerateUncollidedID(m_Meshs);
+        mesh.m_GroupHandle = meshGroup.value()->m_Handle;
+        mesh.m_Id = UUID::GenerateUncollidedID(m_MeshHandles);
 
-        m_Meshs[mesh.m_Id] = mesh;
+        MeshHandle handle = m_Meshs.Insert(mesh);
+        m_Meshs.Get(handle)->m_Handle = handle;
+        m_MeshHandles[mesh.m_Id] = handle;
         meshGroup.value()->m_SubMeshes.push_back(mesh.m_Id);
 
         return mesh.m_Id;
@@ -110,13 +138,14 @@ namespace kbs
 
     opt<ptr<MeshAccelerationStructure>> MeshPool::CreateAccelerationStructure(const MeshID& id, RenderAPI api, bool opaque)
     {
-        KBS_ASSERT(m_Meshs.count(id), "invalid mesh id");
+        Mesh* mesh = GetMesh(GetMeshHandle(id));
+        KBS_ASSERT(mesh != nullptr, "invalid mesh id");
         if (auto var = GetAccelerationStructure(id, opaque); var.has_value())
         {
             return var.value();
         }
 
-        MeshGroupID meshGroupID = m_Meshs[id].m_GroupID;
+        MeshGroupID meshGroupID = mesh->m_GroupID;
         ptr<RenderBuffer> vertexBuffer;
         ptr<RenderBuffer> indexBuffer;
         uint32_t vertexStride, vertexPositionOffset;
@@ -143,9 +172,10 @@ namespace kbs
 
     opt<std::vector<ptr<MeshAccelerationStructure>>> MeshPool::CreateGroupAccelerationStructure(const MeshGroupID& id, RenderAPI api, bool opaque)
     {
-        KBS_ASSERT(m_MeshGroups.count(id), "invalid mesh group id");
+        auto optMeshGroup = GetMeshGroup(id);
+        KBS_ASSERT(optMeshGroup.has_value(), "invalid mesh group id");
         
-        ptr<MeshGroup> meshGroup = m_MeshGroups[id];
+        ptr<MeshGroup> meshGroup = optMeshGroup.value();
         auto& subMeshes = meshGroup->m_SubMeshes;
 
         ptr<RenderBuffer> vertexBuffer;
@@ -199,10 +229,11 @@ namespace kbs
             return;
         }
 
-        m_Meshs.erase(m_Meshs.find(id));
-        auto meshGroup = GetMeshGroup(mesh.value().m_GroupID);
-        KBS_ASSERT(meshGroup.has_value(), "invalid mesh group id for mesh");
-        auto& meshGroupSubMeshes = meshGroup.value()->m_SubMeshes;
+        m_Meshs.Remove(mesh.value().m_Handle);
+        m_MeshHandles.erase(id);
+        MeshGroup* meshGroup = GetMeshGroup(mesh.value().m_GroupHandle);
+        KBS_ASSERT(meshGroup != nullptr, "invalid mesh group id for mesh");
+        auto& meshGroupSubMeshes = meshGroup->m_SubMeshes;
 
         meshGroupSubMeshes.erase(std::find(meshGroupSubMeshes.begin(), meshGroupSubMeshes.end(), id));
     }
@@ -215,16 +246,18 @@ namespace kbs
             return;
         }
 
-        m_MeshGroups.erase(m_MeshGroups.find(id));
+        m_MeshGroups.Remove(meshGroup.value()->m_Handle);
+        m_MeshGroupHandles.erase(id);
         for (auto& mesh : meshGroup.value()->m_SubMeshes)
         {
-            m_Meshs.erase(m_Meshs.find(mesh));
+            m_Meshs.Remove(GetMeshHandle(mesh));
+            m_MeshHandles.erase(mesh);
         }
     }
 
     opt<ptr<MeshAccelerationStructure>> MeshPool::CreateAccelerationStructureForVertexBuffer(RenderAPI api, const MeshID& id, ptr<RenderBuffer> vertexBuffer, ptr<RenderBuffer> indiceBuffer, bool opaque, VkIndexType indexType, uint32_t vertexPositionOffset, uint32_t vertexStride)
     {
-        Mesh& mesh = m_Meshs[id];
+        Mesh& mesh = *GetMesh(GetMeshHandle(id));
 
         gvk::GvkBottomAccelerationStructureGeometryTriangles structure{};
         structure.flags = opaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0;
@@ -252,7 +285,7 @@ namespace kbs
 
     void MeshPool::CopyMeshGroupVertexBuffer(RenderAPI api,const MeshGroupID& meshGroupID, ptr<RenderBuffer>& vertexBuffer, ptr<RenderBuffer>& indexBuffer, uint32_t& vertexStride, uint32_t& vertexPositionOffset, VkIndexType& indexType)
     {
-        ptr<MeshGroup> meshGroup = m_MeshGroups[meshGroupID];
+        ptr<MeshGroup> meshGroup = GetMeshGroup(meshGroupID).value();
         ptr<gvk::Buffer> meshGroupVertexBuffer = meshGroup->m_Vertices->GetBuffer();
         ptr<gvk::Buffer> meshGroupIndexBuffer = meshGroup->m_Indices->GetBuffer();
 
@@ -300,6 +333,11 @@ namespace kbs
         return m_MeshGroupID;
     }
 
+    MeshGroupHandle MeshGroup::GetHandle()
+    {
+        return m_Handle;
+    }
+
     MeshGroupType MeshGroup::GetType()
     {
         return m_MeshGroupType;
@@ -342,19 +380,29 @@ namespace kbs
         return m_GroupID;
     }
 
-    void Mesh::Draw(VkCommandBuffer cmd, uint32_t instanceCount)
+    MeshHandle Mesh::GetHandle()
     {
-        auto meshGroup = m_Pool->GetMeshGroup(m_GroupID);
-        KBS_ASSERT(meshGroup.has_value(), " invalid id for mesh");
+        return m_Handle;
+    }
 
-        switch (meshGroup.value()->GetType())
+    MeshGroupHandle Mesh::GetMeshGroupHandle()
+    {
+        return m_GroupHandle;
+    }
+
+    void Mesh::Draw(VkCommandBuffer cmd, uint32_t instanceCount, uint32_t firstInstance)
+    {
+        MeshGroup* meshGroup = m_Pool->GetMeshGroup(m_GroupHandle);
+        KBS_ASSERT(meshGroup != nullptr, " invalid id for mesh");
+
+        switch (meshGroup->GetType())
         {
         case MeshGroupType::Vertices:
-            vkCmdDraw(cmd, m_VerticesCount, instanceCount, m_VerticesStart, 0);
+            vkCmdDraw(cmd, m_VerticesCount, instanceCount, m_VerticesStart, firstInstance);
             break;
         case MeshGroupType::Indices_I16:
         case MeshGroupType::Indices_I32:
-            vkCmdDrawIndexed(cmd, m_IndicesCount, instanceCount, m_IndicesStart, 0, 0);
+            vkCmdDrawIndexed(cmd, m_IndicesCount, instanceCount, m_IndicesStart, 0, firstInstance);
             break;
         }
     }
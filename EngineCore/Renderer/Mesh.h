@@ -1,6 +1,7 @@
 #pragma once
 #include "Common.h"
 #include "Scene/UUID.h"
+#include "Core/SlotMap.h"
 #include "Renderer/RenderResource.h"
 #include "Renderer/RenderAPI.h"
 
@@ -10,6 +11,12 @@ namespace kbs
 	using MeshGroupID = UUID;
 
 	class MeshPool;
+	class Mesh;
+	class MeshGroup;
+
+	// handles are resolved without hashing, keep ids for serialization and lookup by id
+	using MeshHandle = SlotHandle<Mesh>;
+	using MeshGroupHandle = SlotHandle<ptr<MeshGroup>>;
 
 	enum class MeshGroupType
 	{
@@ -26,6 +33,7 @@ namespace kbs
 		MeshGroup() = default;
 
 		MeshGroupID		GetID();
+		MeshGroupHandle GetHandle();
 		MeshGroupType	GetType();
 		void BindVertexBuffer(VkCommandBuffer cmd);
 
@@ -36,6 +44,7 @@ namespace kbs
 
 	private:
 		MeshGroupID				m_MeshGroupID;
+		MeshGroupHandle			m_Handle;
 		uint32_t				m_VerticesCount;
 		uint32_t				m_IndicesCount;
 
@@ -56,8 +65,11 @@ namespace kbs
 
 		MeshID		GetMeshID();
 		MeshGroupID	GetMeshGroupID();
+		MeshHandle		GetHandle();
+		MeshGroupHandle GetMeshGroupHandle();
 
-		void		Draw(VkCommandBuffer cmd, uint32_t instanceCount);
+		// the instances start at firstInstance, the index of the object in the object buffer of the frame
+		void		Draw(VkCommandBuffer cmd, uint32_t instanceCount, uint32_t firstInstance = 0);
 
 		uint32_t GetVertexStart();
 		uint32_t GetIndexStart();
@@ -66,6 +78,8 @@ namespace kbs
 	private:
 		MeshID m_Id;
 		MeshGroupID m_GroupID;
+		MeshHandle m_Handle;
+		MeshGroupHandle m_GroupHandle;
 
 		uint32_t m_VerticesStart;
 		uint32_t m_VerticesCount;
@@ -97,6 +111,13 @@ namespace kbs
 		opt<Mesh>			GetMesh(const MeshID& id);
 		opt<ptr<MeshGroup>> GetMeshGroup(const MeshGroupID& id);
 
+		// invalid handles if the id doesn't exist
+		MeshHandle			GetMeshHandle(const MeshID& id);
+		MeshGroupHandle		GetMeshGroupHandle(const MeshGroupID& id);
+		// nullptr if the handle is stale, valid until meshes or mesh groups are created or removed
+		Mesh*				GetMesh(MeshHandle handle);
+		MeshGroup*			GetMeshGroup(MeshGroupHandle handle);
+
 		MeshGroupID			CreateMeshGroup(ptr<RenderBuffer> vertices, uint32_t verticesCount);
 		MeshGroupID			CreateMeshGroup(ptr<RenderBuffer> vertices, ptr<RenderBuffer> indices, uint32_t verticesCount, uint32_t indicesCount, MeshGroupType type);
 
@@ -119,8 +140,10 @@ namespace kbs
 		std::unordered_map<MeshID, ptr<MeshAccelerationStructure>> m_MeshAsTransparent;
 
 
-		std::unordered_map<MeshID, Mesh> m_Meshs;
-		std::unordered_map<MeshGroupID, ptr<MeshGroup>> m_MeshGroups;
+		SlotMap<Mesh>			m_Meshs;
+		SlotMap<ptr<MeshGroup>> m_MeshGroups;
+		std::unordered_map<MeshID, MeshHandle> m_MeshHandles;
+		std::unordered_map<MeshGroupID, MeshGroupHandle> m_MeshGroupHandles;
 
 	};
 
@@ -102,7 +102,7 @@ bool kbs::PTRenderer::InitRenderGraph(ptr<kbs::Window> window, ptr<vkrg::RenderG
 	renderGraph->AddGraphResource("accumulationImage", info, false);
 
 	info.format = GetBackBufferFormat();
-	renderGraph->AddGraphResource("backBuffer", info, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	renderGraph->AddGraphResource("backBuffer", info, true, GetBackBufferFinalLayout());
 
 	kbs::RendererAttachmentDescriptor desc;
 	
@@ -125,7 +125,7 @@ bool kbs::PTRenderer::InitRenderGraph(ptr<kbs::Window> window, ptr<vkrg::RenderG
 		return false;
 	}
 
-	auto backBuffers = m_Context->GetBackBuffers();
+	auto backBuffers = GetBackBuffers();
 	auto extData = renderGraph->GetExternalDataFrame();
 	for (uint32_t i = 0; i < backBuffers.size(); i++)
 	{
@@ -196,7 +196,7 @@ void kbs::PTRenderer::OnSceneRender(ptr<Scene> scene)
 		}
 
 		{
-			std::vector<PTLight> lightDatas;
+			FrameVector<PTLight> lightDatas;
 			scene->IterateAllEntitiesWith<LightComponent>(
 				[&](kbs::Entity e)
 				{
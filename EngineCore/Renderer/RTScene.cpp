@@ -3,6 +3,7 @@
 #include "Scene/Entity.h"
 #include "Scene/Transform.h"
 #include "Asset/AssetManager.h"
+#include "Core/Profiler.h"
 
 
 namespace kbs
@@ -39,6 +40,7 @@ namespace kbs
 
     void RTScene::UpdateSceneAccelerationStructure(RenderAPI api, RTSceneUpdateOption option)
     {
+        KBS_PROFILE_FUNCTION();
         KBS_ASSERT(m_Slas == nullptr, "currently update tlas dynamically is not supported");
 
         std::vector<gvk::GvkTopAccelerationStructureInstance> instances;
@@ -83,11 +85,12 @@ namespace kbs
                     
                     instances.push_back(topInstance);
 
-                    ptr<RTMaterial> mat = materialManager->GetRTMaterialByID(rtComponent.rayTracingMaterial).value();
+                    RTMaterial* mat = materialManager->GetRTMaterial(materialManager->GetRTMaterialHandle(rtComponent.rayTracingMaterial));
+                    KBS_ASSERT(mat != nullptr, "invalid ray tracing material id");
                     
-                    Mesh mesh = meshPool->GetMesh(renderableComponent.targetMesh).value();
-                    MeshGroupID meshGroupID = mesh.GetMeshGroupID();
-                    ptr<MeshGroup> meshGroup = meshPool->GetMeshGroup(meshGroupID).value();
+                    Mesh* mesh = meshPool->GetMesh(meshPool->GetMeshHandle(renderableComponent.targetMesh));
+                    KBS_ASSERT(mesh != nullptr, "invalid mesh id");
+                    MeshGroup* meshGroup = meshPool->GetMeshGroup(mesh->GetMeshGroupHandle());
 
                     uint64_t vertexAddress = meshGroup->GetVertexBuffer()->GetBuffer()->GetAddress();
                     uint64_t indexAddress = meshGroup->GetType() != MeshGroupType::Vertices ?
@@ -134,8 +137,8 @@ namespace kbs
                     RTObjectDesc objectDesc;
                     objectDesc.indexBufferAddress = indexAddress;
                     objectDesc.vertexBufferAddress = vertexAddress;
-                    objectDesc.vertexOffset = mesh.GetVertexStart();
-                    objectDesc.indexOffset = mesh.GetIndexStart();
+                    objectDesc.vertexOffset = mesh->GetVertexStart();
+                    objectDesc.indexOffset = mesh->GetIndexStart();
                     objectDesc.entity = e;
                     objectDesc.materialSetIndex = materialSetIdx;
 
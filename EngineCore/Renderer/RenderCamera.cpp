@@ -1,6 +1,8 @@
 #include "RenderCamera.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include "Scene/Entity.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
 
 #include <iostream>
 
@@ -69,6 +71,61 @@ namespace kbs
 		return frustrum;
 	}
 	
+	Frustum RenderCamera::GetCullingFrustum()
+	{
+		CameraUBO ubo = GetCameraUBO();
+		return Frustum::FromMatrix(ubo.projection * ubo.view);
+	}
+
+	void RenderCamera::Cull(const RenderWorld& world, RenderCameraCullingResult& result, CullingShape shape, OcclusionBuffer* occlusion)
+	{
+		KBS_PROFILE_FUNCTION();
+		// a multiple of TransformBatchAlignment, every range is compacted into its own part of the result first
+		constexpr uint32_t rangeSize = 4096;
+
+		CameraUBO ubo = GetCameraUBO();
+		Frustum frustum = Frustum::FromMatrix(ubo.projection * ubo.view);
+		if (occlusion != nullptr)
+		{
+			KBS_PROFILE_SCOPE("Render Occluders");
+			occlusion->Clear(ubo.projection * ubo.view);
+			for (const RenderWorldOccluder& occluder : world.occluders)
+			{
+				occlusion->RenderOccluder(*occluder.mesh, occluder.world);
+			}
+		}
+
+		uint32_t objectCount = world.bounds.Size();
+		uint32_t rangeCount = (objectCount + rangeSize - 1) / rangeSize;
+		std::vector<uint32_t>& visible = result.m_VisibleObjects;
+		visible.resize(objectCount);
+		std::vector<uint32_t>& rangeSizes = result.m_RangeSizes;
+		rangeSizes.resize(rangeCount);
+
+		Singleton::GetInstance<JobSystem>()->ParallelForEach(0, rangeCount,
+			[&](uint32_t range)
+			{
+				uint32_t begin = range * rangeSize, end = std::min(begin + rangeSize, objectCount);
+				uint32_t count = math::CullFrustum(frustum, world.bounds, begin, end, visible.data() + begin, shape);
+				if (occlusion != nullptr)
+				{
+					uint32_t* first = visible.data() + begin;
+					count = (uint32_t)(std::remove_if(first, first + count,
+						[&](uint32_t i) { return !occlusion->IsVisible(world.bounds.GetBox(i)); }) - first);
+				}
+				rangeSizes[range] = count;
+			}, 1
+		);
+
+		uint32_t visibleCount = 0;
+		for (uint32_t range = 0; range < rangeCount; range++)
+		{
+			uint32_t* first = visible.data() + range * rangeSize;
+			visibleCount = (uint32_t)(std::copy(first, first + rangeSizes[range], visible.data() + visibleCount) - visible.data());
+		}
+		visible.resize(visibleCount);
+		result.m_Valid = true;
+	}
 }
 
 
@@ -2,6 +2,9 @@
 #include "Common.h"
 #include "Scene/Scene.h"
 #include "Scene/Transform.h"
+#include "Scene/RenderWorld.h"
+#include "Math/FrustumCulling.h"
+#include "Math/OcclusionBuffer.h"
 // Camera used in rendering
 
 
@@ -18,7 +21,19 @@ namespace kbs
 
 	class RenderCameraCullingResult
 	{
+	public:
+		// false until the result is filled by RenderCamera::Cull, every object is treated as visible then
+		bool						 IsValid() const { return m_Valid; }
+		// indices into RenderWorld::objects in increasing order
+		const std::vector<uint32_t>& GetVisibleObjects() const { return m_VisibleObjects; }
+
+	private:
+		friend class RenderCamera;
 
+		std::vector<uint32_t> m_VisibleObjects;
+		// visible objects of every range culled by one job
+		std::vector<uint32_t> m_RangeSizes;
+		bool				  m_Valid = false;
 	};
 
 	struct CameraFrustrum
@@ -43,6 +58,14 @@ namespace kbs
 			return GetFrustrum(0, 1, 0, 1, 0, 1);
 		}
 		CameraFrustrum  GetFrustrum(float u_tile, float u_tile_1, float v_tile, float v_tile_1, float d, float d_1);
+		// normalized planes of the view projection pointing inwards, used for culling
+		Frustum			GetCullingFrustum();
+
+		// tests the world bounds of the render world objects against the frustum of the camera.
+		// the objects are split into ranges culled by the job system threads, the result keeps its capacity.
+		// with an occlusion buffer the occluders of the world are rendered into it first and the objects
+		// inside the frustum are tested against it as well
+		void			Cull(const RenderWorld& world, RenderCameraCullingResult& result, CullingShape shape = CullingShape::Box, OcclusionBuffer* occlusion = nullptr);
 
 
 	private:
@@ -2,15 +2,21 @@
 #include "Asset/AssetManager.h"
 #include "Scene/Entity.h"
 #include "Core/Singleton.h"
+#include "Core/Profiler.h"
+#include "Core/FrameAllocator.h"
+#include "Core/MemoryTracker.h"
 
 namespace kbs
 {
     bool kbs::Renderer::Initialize(ptr<kbs::Window> window, RendererCreateInfo& info)
     {
+        KBS_MEMORY_TAG(Renderer);
         m_FrameCounter = 0;
 
         m_Window = window;
+        m_Headless = window->IsHeadless();
         std::string msg;
+        // a headless window has no gvk window, the context is created without a surface
         if (auto ctx = gvk::Context::CreateContext(info.appName.c_str(), GVK_VERSION{ 1, 0, 0 }, VK_API_VERSION_1_3, window->GetGvkWindow(), &msg);
             ctx.has_value())
         {
@@ -30,7 +36,30 @@ namespace kbs
         }
 
         if (info.device.required_queues.empty()) info.device.RequireQueue(VK_QUEUE_GRAPHICS_BIT, 1);
-        info.device.AddDeviceExtension(GVK_DEVICE_EXTENSION_SWAP_CHAIN);
+        if (!m_Headless) info.device.AddDeviceExtension(GVK_DEVICE_EXTENSION_SWAP_CHAIN);
+
+        // indirect draws read their count from a buffer and the culling shader writes non zero first instances
+        VkPhysicalDeviceVulkan12Features indirectFeatures12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+        VkPhysicalDeviceFeatures2 indirectFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &indirectFeatures12 };
+        m_GPUDrivenRenderingSupported = false;
+        if (info.gpuDrivenRendering)
+        {
+            VkPhysicalDeviceVulkan12Features supported12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+            VkPhysicalDeviceFeatures2 supported{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &supported12 };
+            vkGetPhysicalDeviceFeatures2(m_Context->GetPhysicalDevice(), &supported);
+
+            if (supported12.drawIndirectCount && supported.features.drawIndirectFirstInstance)
+            {
+                indirectFeatures12.drawIndirectCount = VK_TRUE;
+                indirectFeatures.features.drawIndirectFirstInstance = VK_TRUE;
+                info.device.AddDeviceFeatures(&indirectFeatures);
+                m_GPUDrivenRenderingSupported = true;
+            }
+            else
+            {
+                KBS_WARN("device doesn't support drawIndirectCount and drawIndirectFirstInstance, gpu driven rendering is disabled");
+            }
+        }
 
         if (!m_Context->InitializeDevice(info.device, &msg))
         {
@@ -42,11 +71,21 @@ namespace kbs
 		// TODO better way initialize AssetManager::ShaderManager
 		Singleton::GetInstance<AssetManager>()->GetShaderManager()->Initialize(m_Context);
 
-        m_BackBufferFormat = m_Context->PickBackbufferFormatByHint({ VK_FORMAT_R8G8B8A8_UNORM,VK_FORMAT_R8G8B8A8_UNORM });
-        if (!m_Context->CreateSwapChain(m_BackBufferFormat, &msg))
+        if (m_Headless)
         {
-            KBS_WARN("fail to create swap chain for renderer reason : {}", msg.c_str());
-            return false;
+            if (!CreateOffscreenBackBuffers())
+            {
+                return false;
+            }
+        }
+        else
+        {
+            m_BackBufferFormat = m_Context->PickBackbufferFormatByHint({ VK_FORMAT_R8G8B8A8_UNORM,VK_FORMAT_R8G8B8A8_UNORM });
+            if (!m_Context->CreateSwapChain(m_BackBufferFormat, &msg))
+            {
+                KBS_WARN("fail to create swap chain for renderer reason : {}", msg.c_str());
+                return false;
+            }
         }
 
         m_Graph = std::make_shared<vkrg::RenderGraph>();
@@ -62,7 +101,7 @@ namespace kbs
             return false;
         }
 
-        uint32_t backBufferCount = m_Context->GetBackBufferCount();
+        uint32_t backBufferCount = GetBackBufferCount();
         for (uint32_t i = 0;i < backBufferCount;i++)
         {
             m_Fences.push_back(m_Context->CreateFence(VK_FENCE_CREATE_SIGNALED_BIT).value());
@@ -89,7 +128,7 @@ namespace kbs
         // TODO destroy all resources
         m_Graph = nullptr;
         m_Window = nullptr;
-        uint32_t backBufferCnt = m_Context->GetBackBufferCount();
+        uint32_t backBufferCnt = GetBackBufferCount();
         m_PrimaryCmdPool = nullptr;
         m_PrimaryCmdQueue = nullptr;
 
@@ -101,6 +140,7 @@ namespace kbs
         {
             m_Context->DestroyVkSemaphore(m_ColorOutputFinish[i]);
         }
+        m_OffscreenBackBuffers.clear();
         m_Context = nullptr;
     }
 
@@ -109,57 +149,110 @@ namespace kbs
         return m_BackBufferFormat;
     }
 
-    RenderAPI Renderer::GetAPI()
+    std::vector<ptr<gvk::Image>> Renderer::GetBackBuffers()
     {
-        KBS_ASSERT(m_Context != nullptr, "you can get render api only after renderer has been initialized");
-        return RenderAPI(m_Context, m_APIDescriptorSetAllocator);
+        if (m_Headless)
+        {
+            return m_OffscreenBackBuffers;
+        }
+        return m_Context->GetBackBuffers();
     }
 
-    RenderableObjectSorter Renderer::GetDefaultRenderableObjectSorter(vec3 cameraPosition)
+    uint32_t Renderer::GetBackBufferCount()
     {
-        auto sort_by_distance = [cameraPosition](RenderableObject& lhs, RenderableObject& rhs)
+        if (m_Headless)
         {
-            if ((lhs.targetRenderFlag & RenderOption_DontCullByDistance) != (rhs.targetRenderFlag & RenderOption_DontCullByDistance))
-            {
-                return kbs_contains_flags(lhs.targetRenderFlag, RenderOption_DontCullByDistance);
-            }
+            return (uint32_t)m_OffscreenBackBuffers.size();
+        }
+        return m_Context->GetBackBufferCount();
+    }
 
-            vec3 cameraPos = cameraPosition;
-            return math::length(cameraPos - lhs.transform.GetPosition()) < math::length(cameraPos - rhs.transform.GetPosition());
-        };
-        auto sort_by_mesh = [&](RenderableObject& lhs, RenderableObject& rhs)
-        {
-            ShaderID lhsShaderID = GetMaterialByID(lhs.targetMaterial)->GetShader()->GetShaderID();
-            ShaderID rhsShaderID = GetMaterialByID(rhs.targetMaterial)->GetShader()->GetShaderID();
+    VkImageLayout Renderer::GetBackBufferFinalLayout()
+    {
+        // offscreen images are never presented
+        return m_Headless ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
+    bool Renderer::CreateOffscreenBackBuffers()
+    {
+        m_BackBufferFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        GvkImageCreateInfo imageInfo = GvkImageCreateInfo::Image2D(m_BackBufferFormat, m_Window->GetWidth(), m_Window->GetHeight(),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
 
-            if (lhsShaderID != rhsShaderID)
+        for (uint32_t i = 0; i < m_OffscreenBackBufferCount; i++)
+        {
+            if (auto image = m_Context->CreateImage(imageInfo); image.has_value())
             {
-                return lhsShaderID < rhsShaderID;
+                m_OffscreenBackBuffers.push_back(image.value());
             }
-            if (lhs.targetMaterial != rhs.targetMaterial)
+            else
             {
-                return lhs.targetMaterial < rhs.targetMaterial;
+                KBS_WARN("fail to create offscreen back buffer for headless renderer");
+                return false;
             }
-            MeshGroupID lhsGroup = GetMeshGroupByMesh(lhs.targetMeshID)->GetID();
-            MeshGroupID rhsGroup = GetMeshGroupByMesh(rhs.targetMeshID)->GetID();
+        }
+        return true;
+    }
 
-            if (lhsGroup != rhsGroup)
-            {
-                return lhsGroup < rhsGroup;
-            }
+    RenderAPI Renderer::GetAPI()
+    {
+        KBS_ASSERT(m_Context != nullptr, "you can get render api only after renderer has been initialized");
+        return RenderAPI(m_Context, m_APIDescriptorSetAllocator);
+    }
 
-            return lhs.id < rhs.id;
-        };
-        auto defaultObjectSorter = [&](std::vector<RenderableObject>& objects)
+    RenderableObjectSorter Renderer::GetDefaultRenderableObjectSorter(vec3 cameraPosition)
+    {
+        return [this, cameraPosition](RenderableObjectList& objects)
         {
-            std::sort(objects.begin(), objects.end(), sort_by_distance);
-            if (objects.size() > m_ObjectPoolSize)
-            {
-                objects.erase(objects.begin() + m_ObjectPoolSize, objects.end());
-            }
-            std::sort(objects.begin(), objects.end(), sort_by_mesh);
+            SortRenderableObjects(objects, cameraPosition);
         };
-        return defaultObjectSorter;
+    }
+
+    void Renderer::SortRenderableObjects(RenderableObjectList& objects, vec3 cameraPosition)
+    {
+        // the keys are built once per object, the radix sort never compares objects or looks up their state
+        FrameVector<DrawSortItem> items(objects.size()), scratch(objects.size());
+        for (uint32_t i = 0; i < objects.size(); i++)
+        {
+            const RenderableObject& object = objects[i];
+            const MaterialSortInfo& info = GetMaterialSortInfo(object.materialHandle);
+            vec3 offset = object.object->position - cameraPosition;
+            items[i] = DrawSortItem{ PackDrawSortKey(info.transparent, info.pipelineIndex, object.materialHandle.index,
+                object.meshHandle.index, math::dot(offset, offset)), i };
+        }
+        RadixSortDrawItems(items.data(), scratch.data(), (uint32_t)items.size());
+
+        RenderableObjectList sorted;
+        sorted.reserve(objects.size());
+        for (const DrawSortItem& item : items)
+        {
+            sorted.push_back(objects[item.index]);
+        }
+        objects.swap(sorted);
+    }
+
+    const Renderer::MaterialSortInfo& Renderer::GetMaterialSortInfo(MaterialHandle handle)
+    {
+        if (handle.index < m_MaterialSortInfos.size() && m_MaterialSortInfos[handle.index].filled)
+        {
+            return m_MaterialSortInfos[handle.index];
+        }
+
+        // materials created after the pipelines were initialized are filled on their first sort,
+        // a shader without a pipeline yet shares the first pipeline index, which only costs state changes
+        if (handle.index >= m_MaterialSortInfos.size())
+        {
+            m_MaterialSortInfos.resize(handle.index + 1);
+        }
+        MaterialSortInfo& info = m_MaterialSortInfos[handle.index];
+        if (Material* mat = Singleton::GetInstance<AssetManager>()->GetMaterialManager()->GetMaterial(handle))
+        {
+            auto pipelineIndex = m_PipelineSortIndices.find(mat->GetShader()->GetShaderID());
+            info.pipelineIndex = pipelineIndex != m_PipelineSortIndices.end() ? pipelineIndex->second : 0;
+            info.transparent = kbs_contains_flags(mat->GetRenderPassFlags(), RenderPass_Transparent);
+            info.filled = true;
+        }
+        return info;
     }
 
     RenderShaderFilter Renderer::GetDefaultShaderFilter()
@@ -169,9 +262,12 @@ namespace kbs
 
 
     // CollectRenderableObjects() + RenderObjects()
-    void Renderer::RenderSceneByCamera(ptr<Scene> scene, RenderCamera& camera, RenderFilter filter, VkCommandBuffer cmd)
+    void Renderer::RenderSceneByCamera(ptr<Scene> scene, RenderCamera& camera, const RenderFilter& filter, VkCommandBuffer cmd)
     {
+        KBS_PROFILE_FUNCTION();
         AssetManager* assetManager = Singleton::GetInstance<AssetManager>();
+        ptr<MaterialManager> materialManager = assetManager->GetMaterialManager();
+        ptr<MeshPool> meshPool = assetManager->GetMeshPool();
         
         uint32_t cameraBufferIndex = 0;
         {
@@ -180,53 +276,81 @@ namespace kbs
         }
         
 
-        std::vector<RenderableObject> objects;
-        
+        // transient per camera data lives in the frame arena, steady state frames don't touch the heap.
+        // growing an arena vector leaves its old copies behind, so it starts at the largest size seen so far
+        RenderableObjectList objects;
+        objects.reserve(m_RenderableObjectHighWater);
 
-        if (filter.renderableObjectSorter == nullptr)
+        const RenderWorld& world = GetRenderWorld();
+        const RenderCameraCullingResult* culling = &filter.cullingResult;
+        if (!culling->IsValid())
         {
-            filter.renderableObjectSorter = GetDefaultRenderableObjectSorter(camera.GetCameraTransform().GetPosition());
+            // shadow cameras and the like don't pay for rasterizing the occluders again
+            bool occlusionCulling = m_OcclusionCulling && filter.occlusionCulling;
+            camera.Cull(world, m_CullingResult, CullingShape::Box, occlusionCulling ? &m_OcclusionBuffer : nullptr);
+            culling = &m_CullingResult;
         }
-        if (filter.shaderFilter == nullptr)
+
+        KBS_PROFILE_SCOPE("CollectRenderableObjects");
+        for (uint32_t objectIndex : culling->GetVisibleObjects())
         {
-            filter.shaderFilter = GetDefaultShaderFilter();
-        }
+            const RenderWorldObject& object = world.objects[objectIndex];
+            MeshHandle meshHandle = meshPool->GetMeshHandle(object.mesh);
 
-        scene->IterateAllEntitiesWith<RenderableComponent>
-        (
-            [&](Entity e)
+            for (uint32_t i = 0;i < object.passCount;i++)
             {
-                RenderableComponent render = e.GetComponent<RenderableComponent>();
+                const RenderWorldPass& pass = world.passes[object.firstPass + i];
+                MaterialHandle materialHandle = materialManager->GetMaterialHandle(pass.material);
+                Material* mat = GetMaterial(materialHandle);
 
-                for (uint32_t i = 0;i < render.passCount;i++)
+                if (kbs_contains_flags(mat->GetRenderPassFlags(), filter.flags) && (filter.shaderFilter == nullptr || filter.shaderFilter(mat->GetShader()->GetShaderID())))
                 {
-                    ptr<Material>  mat = assetManager->GetMaterialManager()->GetMaterialByID(render.targetMaterials[i]).value();
-
-                    if (kbs_contains_flags(mat->GetRenderPassFlags(), filter.flags) && filter.shaderFilter(mat->GetShader()->GetShaderID()))
-                    {
-                        TransformComponent  trans = e.GetComponent<TransformComponent>();
-                        IDComponent idcomp = e.GetComponent<IDComponent>();
-                        objects.push_back(RenderableObject{ idcomp.ID, render.targetMaterials[i], render.renderOptionFlags[i], render.targetMesh, Transform(trans, e)});
-                    }
+                    objects.push_back(RenderableObject{ object.id, pass.material, pass.renderOptionFlags, object.mesh, &object, objectIndex, materialHandle, meshHandle });
                 }
             }
-        );
+        }
+        m_RenderableObjectHighWater = std::max(m_RenderableObjectHighWater, (uint32_t)objects.size());
+
+        {
+            KBS_PROFILE_SCOPE("SortRenderableObjects");
+            if (filter.renderableObjectSorter != nullptr)
+            {
+                filter.renderableObjectSorter(objects);
+            }
+            else
+            {
+                SortRenderableObjects(objects, camera.GetCameraTransform().GetPosition());
+            }
+        }
+
+        if (objects.empty())
+        {
+            return;
+        }
+
+        // runs of objects sharing the material and mesh become one instanced draw
+        FrameVector<InstancedDraw> instancedDraws;
+        BuildInstancedDraws((uint32_t)objects.size(), [&](uint32_t first, uint32_t i)
+            {
+                return objects[first].targetMaterial == objects[i].targetMaterial && objects[first].meshHandle == objects[i].meshHandle;
+            }, instancedDraws);
 
-        filter.renderableObjectSorter(objects);
-        KBS_ASSERT(objects.size() <= m_ObjectPoolSize);
+        InstanceRange instances = AllocateInstances((uint32_t)objects.size());
+        FrameVector<uint32_t> objectIndices(objects.size());
+        for (uint32_t i = 0; i < objects.size(); i++)
+        {
+            objectIndices[i] = objects[i].objectIndex;
+        }
+        instances.buffer->GetBuffer()->Write(objectIndices.data(), sizeof(uint32_t) * instances.firstInstance, sizeof(uint32_t) * objectIndices.size());
 
         ShaderID   bindedShaderID;
         MaterialID bindedMaterialID;
-        MeshGroupID bindedMeshGroupID;
+        MeshGroupHandle bindedMeshGroup;
         
-        for (uint32_t i = 0;i < objects.size();i++)
+        for (const InstancedDraw& draw : instancedDraws)
         {
-            uint32_t objectUBOIdx = m_ObjectUBOPoolCounter++;
-
-            ObjectUBO objectUbo = objects[i].transform.GetObjectUBO();
-            m_ObjectUBOPool->GetBuffer()->Write(&objectUbo, sizeof(ObjectUBO) * objectUBOIdx, sizeof(ObjectUBO));
-
-            ptr<Material> mat = GetMaterialByID(objects[i].targetMaterial);
+            uint32_t i = draw.firstDraw;
+            Material* mat = GetMaterial(objects[i].materialHandle);
             if (mat->GetShader()->GetShaderID() != bindedShaderID)
             {
                 bindedShaderID = mat->GetShader()->GetShaderID();
@@ -234,6 +358,10 @@ namespace kbs
                 GvkBindPipeline(cmd, shaderPipeline);
                 vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     shaderPipeline->GetPipelineLayout(), (uint32_t)ShaderSetUsage::perCamera, 1, &m_CameraDescriptorSets[cameraBufferIndex], 0, NULL);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    shaderPipeline->GetPipelineLayout(), (uint32_t)ShaderSetUsage::perObject, 1, &instances.objectSet, 0, NULL);
+                // a new pipeline may disturb the material set
+                bindedMaterialID = MaterialID::Invalid();
             }
 
             ptr<gvk::Pipeline>      materialPipeline = m_ShaderPipelines[bindedShaderID];
@@ -252,19 +380,340 @@ namespace kbs
                 }
             }
 
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                materialPipeline->GetPipelineLayout(), (uint32_t)ShaderSetUsage::perObject, 1, &m_ObjectDescriptorSetPool[objectUBOIdx], 0, NULL);
+            Mesh* mesh = GetMesh(objects[i].meshHandle);
+            if (mesh->GetMeshGroupHandle() != bindedMeshGroup)
+            {
+                bindedMeshGroup = mesh->GetMeshGroupHandle();
+                meshPool->GetMeshGroup(bindedMeshGroup)->BindVertexBuffer(cmd);
+            }
+            mesh->Draw(cmd, draw.instanceCount, instances.firstInstance + i);
+        }
+
+    }
+
+    // grows the buffer to the next power of two, steady state frames don't recreate it
+    static void ReserveRenderBuffer(RenderAPI api, ptr<RenderBuffer>& buffer, VkBufferUsageFlags usage, GVK_HOST_WRITE_PROPERTY prop, uint64_t size)
+    {
+        if (buffer != nullptr && buffer->GetBuffer()->GetSize() >= size)
+        {
+            return;
+        }
+        uint64_t capacity = 256;
+        while (capacity < size) capacity <<= 1;
+        buffer = api.CreateBuffer(usage, (uint32_t)capacity, prop);
+    }
+
+    static void WriteStorageBufferDescriptor(VkDevice device, VkDescriptorSet set, uint32_t binding, ptr<RenderBuffer> buffer)
+    {
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = buffer->GetBuffer()->GetBuffer();
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.dstArrayElement = 0;
+        write.dstBinding = binding;
+        write.dstSet = set;
+        write.pBufferInfo = &bufferInfo;
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+    }
+
+    // matches the uniform of shader/Indirect/cull.comp
+    struct IndirectCullingUniform
+    {
+        vec4     planes[6];
+        uint32_t recordCount;
+        uint32_t instanceBase;
+        uint32_t padding[2];
+    };
+
+    void Renderer::SetGPUDrivenRendering(bool enable)
+    {
+        if (enable && !m_GPUDrivenRenderingSupported)
+        {
+            KBS_WARN("gpu driven rendering is not available, request it by RendererCreateInfo::gpuDrivenRendering on a device "
+                "supporting drawIndirectCount and drawIndirectFirstInstance. objects are drawn by RenderSceneByCamera");
+            enable = false;
+        }
+        // the culling shader is only needed by the gpu driven path
+        if (enable && !m_IndirectCullingShader.has_value())
+        {
+            auto cullingShader = Singleton::GetInstance<AssetManager>()->GetShaderManager()->Load("Indirect/cull.comp");
+            if (!cullingShader.has_value())
+            {
+                KBS_WARN("fail to load indirect draw culling shader Indirect/cull.comp, objects are drawn by RenderSceneByCamera");
+                enable = false;
+            }
+            else
+            {
+                m_IndirectCullingShader = cullingShader.value()->GetShaderID();
+            }
+        }
+        m_GPUDrivenRendering = enable;
+    }
+
+    IndirectDrawHandle Renderer::PrepareIndirectDraws(RenderCamera& camera, const RenderFilter& filter)
+    {
+        KBS_PROFILE_FUNCTION();
+        KBS_ASSERT(m_GPUDrivenRendering, "indirect draws are prepared only when gpu driven rendering is on, see SetGPUDrivenRendering");
+        AssetManager* assetManager = Singleton::GetInstance<AssetManager>();
+        ptr<MaterialManager> materialManager = assetManager->GetMaterialManager();
+        ptr<MeshPool> meshPool = assetManager->GetMeshPool();
+
+        if (m_IndirectDrawListCounter == m_IndirectDrawLists.size())
+        {
+            m_IndirectDrawLists.emplace_back();
+        }
+        IndirectDrawHandle handle = m_IndirectDrawListCounter++;
+        IndirectDrawList& list = m_IndirectDrawLists[handle];
+        list.frustum = camera.GetCullingFrustum();
+        list.sources.clear();
+
+        const RenderWorld& world = GetRenderWorld();
+        for (uint32_t objectIndex = 0; objectIndex < world.objects.size(); objectIndex++)
+        {
+            const RenderWorldObject& object = world.objects[objectIndex];
+            Mesh* mesh = GetMesh(meshPool->GetMeshHandle(object.mesh));
+            // indirect draws are indexed, meshes without indices are only drawn by RenderSceneByCamera
+            if (meshPool->GetMeshGroup(mesh->GetMeshGroupHandle())->GetType() == MeshGroupType::Vertices)
+            {
+                continue;
+            }
+
+            for (uint32_t i = 0; i < object.passCount; i++)
+            {
+                const RenderWorldPass& pass = world.passes[object.firstPass + i];
+                Material* mat = GetMaterial(materialManager->GetMaterialHandle(pass.material));
+                ptr<GraphicsShader> shader = mat->GetShader();
+
+                if (shader->SupportsIndirectDraw() && kbs_contains_flags(mat->GetRenderPassFlags(), filter.flags)
+                    && (filter.shaderFilter == nullptr || filter.shaderFilter(shader->GetShaderID())))
+                {
+                    list.sources.push_back(IndirectDrawSource{ shader->GetShaderID(), pass.material, mesh->GetMeshGroupID(),
+                        objectIndex, mesh->GetIndexCount(), mesh->GetIndexStart() });
+                }
+            }
+        }
+
+        BuildIndirectDraws(list.sources, list.records, list.batches);
+        list.batchMaterials.resize(list.batches.size());
+        list.batchMeshGroups.resize(list.batches.size());
+        for (uint32_t i = 0; i < list.batches.size(); i++)
+        {
+            list.batchMaterials[i] = materialManager->GetMaterialHandle(list.batches[i].material);
+            list.batchMeshGroups[i] = meshPool->GetMeshGroupHandle(list.batches[i].meshGroup);
+        }
+
+        return handle;
+    }
+
+    void Renderer::UploadRenderWorldObjects()
+    {
+        KBS_PROFILE_FUNCTION();
+        const RenderWorld& world = GetRenderWorld();
+        uint32_t objectCount = (uint32_t)world.objects.size();
+
+        // object matrices were computed by the extraction, gather them to upload them in one write.
+        // the buffer is written after the fence of the previous frame, nothing reads it anymore
+        FrameVector<ObjectUBO> objects(objectCount);
+        world.GatherObjectUBOs(objects.data());
+
+        ptr<RenderBuffer> previousBuffer = m_ObjectBuffer;
+        ReserveRenderBuffer(GetAPI(), m_ObjectBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GVK_HOST_WRITE_SEQUENTIAL,
+            sizeof(ObjectUBO) * std::max(objectCount, 1u));
+        if (objectCount != 0)
+        {
+            m_ObjectBuffer->GetBuffer()->Write(objects.data(), 0, sizeof(ObjectUBO) * objectCount);
+        }
+
+        if (m_ObjectBuffer != previousBuffer)
+        {
+            for (InstanceChunk& chunk : m_InstanceChunks)
+            {
+                WriteStorageBufferDescriptor(m_Context->GetDevice(), chunk.objectSet, 0, m_ObjectBuffer);
+            }
+        }
+    }
+
+    Renderer::InstanceRange Renderer::AllocateInstances(uint32_t count)
+    {
+        while (true)
+        {
+            KBS_ASSERT(m_InstanceChunkCounter < m_InstanceChunks.size(), "too many instances are drawn in a frame");
+            InstanceChunk& chunk = m_InstanceChunks[m_InstanceChunkCounter];
+            // the chunk isn't bound by the frame yet, it can grow for a range larger than a chunk
+            if (chunk.used == 0 && chunk.capacity < count)
+            {
+                chunk.capacity = m_InstanceChunkSize;
+                while (chunk.capacity < count) chunk.capacity <<= 1;
+                chunk.buffer = GetAPI().CreateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sizeof(uint32_t) * chunk.capacity, GVK_HOST_WRITE_SEQUENTIAL);
+                WriteStorageBufferDescriptor(m_Context->GetDevice(), chunk.objectSet, 0, m_ObjectBuffer);
+                WriteStorageBufferDescriptor(m_Context->GetDevice(), chunk.objectSet, 1, chunk.buffer);
+            }
+            if (chunk.used + count <= chunk.capacity)
+            {
+                InstanceRange range{ chunk.buffer, chunk.used, chunk.objectSet };
+                chunk.used += count;
+                return range;
+            }
+            m_InstanceChunkCounter++;
+        }
+    }
+
+    void Renderer::RecordIndirectCulling(VkCommandBuffer cmd)
+    {
+        if (m_IndirectDrawListCounter == 0)
+        {
+            return;
+        }
+        KBS_PROFILE_FUNCTION();
+        RenderAPI api = GetAPI();
+        const RenderWorld& world = GetRenderWorld();
+        uint32_t objectCount = (uint32_t)world.objects.size();
+
+        {
+            KBS_PROFILE_SCOPE("UploadIndirectBounds");
+            FrameVector<vec4> bounds(objectCount * 2);
+            for (uint32_t i = 0; i < objectCount; i++)
+            {
+                bounds[i * 2] = vec4(world.bounds.center[0][i], world.bounds.center[1][i], world.bounds.center[2][i], 0.f);
+                bounds[i * 2 + 1] = vec4(world.bounds.extent[0][i], world.bounds.extent[1][i], world.bounds.extent[2][i], 0.f);
+            }
+
+            ReserveRenderBuffer(api, m_IndirectBoundsBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GVK_HOST_WRITE_SEQUENTIAL,
+                sizeof(vec4) * 2 * std::max(objectCount, 1u));
+            if (objectCount != 0)
+            {
+                m_IndirectBoundsBuffer->GetBuffer()->Write(bounds.data(), 0, sizeof(vec4) * 2 * objectCount);
+            }
+        }
+
+        for (uint32_t i = 0; i < m_IndirectDrawListCounter; i++)
+        {
+            IndirectDrawList& list = m_IndirectDrawLists[i];
+            if (list.records.empty())
+            {
+                continue;
+            }
+            if (list.cullingKernel == nullptr)
+            {
+                auto kernel = api.CreateComputeKernel(m_IndirectCullingShader.value());
+                KBS_ASSERT(kernel.has_value(), "fail to create compute kernel for indirect draw culling");
+                list.cullingKernel = kernel.value();
+                list.uniformBuffer = api.CreateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(IndirectCullingUniform), GVK_HOST_WRITE_SEQUENTIAL);
+            }
+            ReserveRenderBuffer(api, list.recordBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GVK_HOST_WRITE_SEQUENTIAL,
+                sizeof(IndirectDrawRecord) * list.records.size());
+            ReserveRenderBuffer(api, list.commandBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                GVK_HOST_WRITE_NONE, sizeof(VkDrawIndexedIndirectCommand) * list.records.size());
+            ReserveRenderBuffer(api, list.countBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                GVK_HOST_WRITE_NONE, sizeof(uint32_t) * list.batches.size());
+
+            list.instances = AllocateInstances((uint32_t)list.records.size());
+
+            IndirectCullingUniform uniform{};
+            for (uint32_t p = 0; p < 6; p++)
+            {
+                uniform.planes[p] = list.frustum.planes[p];
+            }
+            uniform.recordCount = (uint32_t)list.records.size();
+            uniform.instanceBase = list.instances.firstInstance;
+            list.uniformBuffer->Write(uniform);
+            list.recordBuffer->GetBuffer()->Write(list.records.data(), 0, sizeof(IndirectDrawRecord) * list.records.size());
+
+            list.cullingKernel->UpdateBuffer("uni", list.uniformBuffer);
+            list.cullingKernel->UpdateBuffer("records", list.recordBuffer);
+            list.cullingKernel->UpdateBuffer("bounds", m_IndirectBoundsBuffer);
+            list.cullingKernel->UpdateBuffer("commands", list.commandBuffer);
+            list.cullingKernel->UpdateBuffer("counts", list.countBuffer);
+            list.cullingKernel->UpdateBuffer("objectIndices", list.instances.buffer);
+
+            vkCmdFillBuffer(cmd, list.countBuffer->GetBuffer()->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+        }
+
+        VkMemoryBarrier clearBarrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
 
-            ptr<MeshGroup> meshGroup = GetMeshGroupByMesh(objects[i].targetMeshID);
-            if (meshGroup->GetID() != bindedMeshGroupID)
+        for (uint32_t i = 0; i < m_IndirectDrawListCounter; i++)
+        {
+            IndirectDrawList& list = m_IndirectDrawLists[i];
+            if (!list.records.empty())
             {
-                bindedMeshGroupID = meshGroup->GetID();
-                meshGroup->BindVertexBuffer(cmd);
+                list.cullingKernel->Dispatch(((uint32_t)list.records.size() + 63) / 64, 1, 1, cmd);
             }
-            Mesh mesh = GetMeshByMeshID(objects[i].targetMeshID);
-            mesh.Draw(cmd, 1);
         }
 
+        VkMemoryBarrier commandBarrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+        commandBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        commandBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            0, 1, &commandBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void Renderer::RenderIndirectDraws(IndirectDrawHandle handle, RenderCamera& camera, VkCommandBuffer cmd)
+    {
+        KBS_PROFILE_FUNCTION();
+        KBS_ASSERT(handle < m_IndirectDrawListCounter, "indirect draws must be prepared in the frame they are rendered");
+        IndirectDrawList& list = m_IndirectDrawLists[handle];
+        if (list.batches.empty())
+        {
+            return;
+        }
+        MeshPool* meshPool = Singleton::GetInstance<AssetManager>()->GetMeshPool().get();
+
+        uint32_t cameraBufferIndex = m_CameraDescriptorSetCounter++;
+        m_CameraBuffer->GetBuffer()->Write(&camera.GetCameraUBO(), cameraBufferIndex * m_CameraUBOAlignedSize, m_CameraUBOAlignedSize);
+
+        ShaderID   bindedShaderID;
+        MaterialID bindedMaterialID;
+        MeshGroupHandle bindedMeshGroup;
+        ptr<gvk::Pipeline> pipeline;
+
+        for (uint32_t i = 0; i < list.batches.size(); i++)
+        {
+            const IndirectDrawBatch& batch = list.batches[i];
+            if (batch.shader != bindedShaderID)
+            {
+                bindedShaderID = batch.shader;
+                pipeline = m_ShaderPipelines[bindedShaderID];
+                GvkBindPipeline(cmd, pipeline);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    pipeline->GetPipelineLayout(), (uint32_t)ShaderSetUsage::perCamera, 1, &m_CameraDescriptorSets[cameraBufferIndex], 0, NULL);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    pipeline->GetPipelineLayout(), (uint32_t)ShaderSetUsage::perObject, 1, &list.instances.objectSet, 0, NULL);
+                // a new pipeline may disturb the material set
+                bindedMaterialID = MaterialID::Invalid();
+            }
+
+            if (batch.material != bindedMaterialID)
+            {
+                bindedMaterialID = batch.material;
+                ptr<gvk::DescriptorSet> materialDescriptorSet = m_MaterialDescriptors[bindedMaterialID];
+                if (materialDescriptorSet != nullptr)
+                {
+                    GetMaterial(list.batchMaterials[i])->UpdateDescriptorSet(m_Context, materialDescriptorSet);
+                    GvkDescriptorSetBindingUpdate(cmd, pipeline)
+                        .BindDescriptorSet(materialDescriptorSet)
+                        .Update();
+                }
+            }
+
+            if (list.batchMeshGroups[i] != bindedMeshGroup)
+            {
+                bindedMeshGroup = list.batchMeshGroups[i];
+                meshPool->GetMeshGroup(bindedMeshGroup)->BindVertexBuffer(cmd);
+            }
+
+            vkCmdDrawIndexedIndirectCount(cmd,
+                list.commandBuffer->GetBuffer()->GetBuffer(), sizeof(VkDrawIndexedIndirectCommand) * batch.firstCommand,
+                list.countBuffer->GetBuffer()->GetBuffer(), sizeof(uint32_t) * i,
+                batch.maxCommandCount, sizeof(VkDrawIndexedIndirectCommand));
+        }
     }
 
 	uint32_t Renderer::GetCurrentFrameIdx()
@@ -302,8 +751,18 @@ namespace kbs
                     return false;
                 }
                 pipeline = optPipeline.value();
+                m_PipelineSortIndices[shaderID] = (uint32_t)m_ShaderPipelines.size();
                 m_ShaderPipelines[shaderID] = pipeline;
             }
+
+            MaterialHandle materialHandle = Singleton::GetInstance<AssetManager>()->GetMaterialManager()->GetMaterialHandle(mat->GetID());
+            if (materialHandle.index >= m_MaterialSortInfos.size())
+            {
+                m_MaterialSortInfos.resize(materialHandle.index + 1);
+            }
+            m_MaterialSortInfos[materialHandle.index].pipelineIndex = m_PipelineSortIndices[shaderID];
+            m_MaterialSortInfos[materialHandle.index].transparent = kbs_contains_flags(mat->GetRenderPassFlags(), RenderPass_Transparent);
+            m_MaterialSortInfos[materialHandle.index].filled = true;
             auto layout = pipeline->GetInternalLayout((uint32_t)ShaderSetUsage::perMaterial);
 
             ptr<gvk::DescriptorSet> materialSet;
@@ -320,13 +779,16 @@ namespace kbs
     {
         VkDevice device = m_Context->GetDevice();
 
-        VkDescriptorPoolSize poolSizes[] = { VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_ObjectCameraPoolSize} };
+        VkDescriptorPoolSize poolSizes[] = {
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * m_InstanceChunkPoolSize},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_CameraDescriptorSetPoolSize}
+        };
 
         VkDescriptorPoolCreateInfo descPoolInfo{};
         descPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        descPoolInfo.poolSizeCount = 1;
+        descPoolInfo.poolSizeCount = 2;
         descPoolInfo.pPoolSizes = poolSizes;
-        descPoolInfo.maxSets = m_ObjectCameraPoolSize;
+        descPoolInfo.maxSets = m_CameraDescriptorSetPoolSize + m_InstanceChunkPoolSize;
         descPoolInfo.flags = 0;
 
         if (VK_SUCCESS != vkCreateDescriptorPool(device, &descPoolInfo, NULL, &m_ObjectCameraDescriptorPool))
@@ -335,12 +797,18 @@ namespace kbs
             return  false;
         }
 
-        // m_ObjectDescriptorSet
+        // object sets of the instance chunks, the buffers are bound by UploadRenderWorldObjects and AllocateInstances
         {
             VkDescriptorSetLayoutBinding bindings[] = {
                 VkDescriptorSetLayoutBinding
                 {
-                    0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    1, VK_SHADER_STAGE_ALL,
+                    NULL
+                },
+                VkDescriptorSetLayoutBinding
+                {
+                    1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     1, VK_SHADER_STAGE_ALL,
                     NULL
                 }
@@ -348,57 +816,30 @@ namespace kbs
 
             VkDescriptorSetLayoutCreateInfo descSetCI{};
             descSetCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            descSetCI.bindingCount = 1;
+            descSetCI.bindingCount = 2;
             descSetCI.pBindings = bindings;
             descSetCI.flags = 0;
 
             vkCreateDescriptorSetLayout(device, &descSetCI, NULL, &m_ObjectDescriptorSetLayout);
-            m_ObjectDescriptorSetPool.resize(m_ObjectPoolSize);
 
-            std::vector<VkDescriptorSetLayout> layouts(m_ObjectPoolSize, m_ObjectDescriptorSetLayout);
+            std::vector<VkDescriptorSetLayout> layouts(m_InstanceChunkPoolSize, m_ObjectDescriptorSetLayout);
+            std::vector<VkDescriptorSet> sets(m_InstanceChunkPoolSize);
             VkDescriptorSetAllocateInfo alloc{};
             alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            alloc.descriptorSetCount = m_ObjectPoolSize;
+            alloc.descriptorSetCount = m_InstanceChunkPoolSize;
             alloc.descriptorPool = m_ObjectCameraDescriptorPool;
             alloc.pSetLayouts = layouts.data();
 
-            if (VK_SUCCESS != vkAllocateDescriptorSets(device, &alloc, m_ObjectDescriptorSetPool.data()))
+            if (VK_SUCCESS != vkAllocateDescriptorSets(device, &alloc, sets.data()))
             {
-                KBS_WARN("fail to initialize renderer reason : fail to allocate descriptor sets for object pool");
-                return false;
-            }
-
-            if (auto buf = m_Context->CreateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(ObjectUBO) * m_ObjectPoolSize, GVK_HOST_WRITE_SEQUENTIAL);
-                buf.has_value())
-            {
-                m_ObjectUBOPool = std::make_shared<RenderBuffer>(buf.value());
-            }
-            else
-            {
-                KBS_WARN("fail to initialize renderer reason : fail to allocate render buffer for object pool");
+                KBS_WARN("fail to initialize renderer reason : fail to allocate descriptor sets for instance chunks");
                 return false;
             }
-
-            std::vector<VkWriteDescriptorSet> writes(m_ObjectPoolSize, VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
-            std::vector<VkDescriptorBufferInfo> buffers(m_ObjectPoolSize, VkDescriptorBufferInfo{});
-            for (uint32_t i = 0; i < m_ObjectPoolSize; i++)
+            m_InstanceChunks.resize(m_InstanceChunkPoolSize);
+            for (uint32_t i = 0; i < m_InstanceChunkPoolSize; i++)
             {
-                auto& write = writes[i];
-                write.descriptorCount = 1;
-                write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                write.dstArrayElement = 0;
-                write.dstBinding = 0;
-                write.dstSet = m_ObjectDescriptorSetPool[i];
-
-                auto& buffer = buffers[i];
-                buffer.buffer = m_ObjectUBOPool->GetBuffer()->GetBuffer();
-                buffer.offset = i * sizeof(ObjectUBO);
-                buffer.range = sizeof(ObjectUBO);
-
-                write.pBufferInfo = &buffers[i];
+                m_InstanceChunks[i].objectSet = sets[i];
             }
-
-            vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, NULL);
         }
         
         // m_CameraDescriptorSet
@@ -470,33 +911,59 @@ namespace kbs
         return true;
     }
 
-    ptr<Material> Renderer::GetMaterialByID(MaterialID id)
+    Material* Renderer::GetMaterial(MaterialHandle handle)
+    {
+        Material* mat = Singleton::GetInstance<AssetManager>()->GetMaterialManager()->GetMaterial(handle);
+        KBS_ASSERT(mat != nullptr, "handle passed to this function must be a valid handle");
+
+        return mat;
+    }
+
+    Mesh* Renderer::GetMesh(MeshHandle handle)
     {
-        auto mat = Singleton::GetInstance<AssetManager>()->GetMaterialManager()->GetMaterialByID(id);
-        KBS_ASSERT(mat.has_value(), "id passed to this function must be a valid id");
+        Mesh* mesh = Singleton::GetInstance<AssetManager>()->GetMeshPool()->GetMesh(handle);
+        KBS_ASSERT(mesh != nullptr, "handle passed to this function must be a valid handle");
 
-        return mat.value();
+        return mesh;
     }
 
-    ptr<MeshGroup> Renderer::GetMeshGroupByMesh(const MeshID& id)
+    void Renderer::ExtractRenderWorld(ptr<Scene> scene)
     {
-        ptr<MeshPool> pool = Singleton::GetInstance<AssetManager>()->GetMeshPool();
-        return pool->GetMeshGroup(pool->GetMesh(id)->GetMeshGroupID()).value();
+        KBS_PROFILE_FUNCTION();
+        // from now on RenderScene waits for the extraction of every frame instead of extracting itself
+        m_ExtractsRenderWorld = true;
+        m_RenderWorlds.Extract(*scene);
     }
 
-    Mesh Renderer::GetMeshByMeshID(const MeshID& id)
+    const RenderWorld& Renderer::GetRenderWorld()
     {
-        ptr<MeshPool> pool = Singleton::GetInstance<AssetManager>()->GetMeshPool();
-        return pool->GetMesh(id).value();
+        return m_RenderWorlds.GetFront();
     }
 
     void kbs::Renderer::RenderScene(ptr<Scene> scene)
     {
+        KBS_PROFILE_FUNCTION();
+        KBS_MEMORY_TAG(Renderer);
         // TODO better way to initialize materials
-        m_ObjectUBOPoolCounter = 0;
         m_CameraDescriptorSetCounter = 0;
+        m_IndirectDrawListCounter = 0;
+        m_InstanceChunkCounter = 0;
+        for (InstanceChunk& chunk : m_InstanceChunks)
+        {
+            chunk.used = 0;
+        }
+        Singleton::GetInstance<FrameAllocator>()->BeginFrame(m_FrameCounter);
+        if (!m_RenderWorlds.Swap(m_ExtractsRenderWorld))
+        {
+            // ExtractRenderWorld was never called, the scene is updated on this thread
+            m_RenderWorlds.Extract(*scene);
+            m_RenderWorlds.Swap();
+        }
 
-        OnSceneRender(scene);
+        {
+            KBS_PROFILE_SCOPE("OnSceneRender");
+            OnSceneRender(scene);
+        }
 
         static bool materialInitialized = false;
         if (!materialInitialized)
@@ -510,7 +977,10 @@ namespace kbs
         uint32_t currentSemaphoreIdx = 0;
         uint32_t currentCommandBufferIdx = 0;
         
-        vkWaitForFences(m_Context->GetDevice(), 1, &m_Fences[currentFenceIdx], VK_TRUE, 0xffffffff);
+        {
+            KBS_PROFILE_SCOPE("WaitForFrameFence");
+            vkWaitForFences(m_Context->GetDevice(), 1, &m_Fences[currentFenceIdx], VK_TRUE, 0xffffffff);
+        }
         vkResetFences(m_Context->GetDevice(), 1, &m_Fences[currentFenceIdx]);
 
         VkCommandBuffer cmd = m_PrimaryCmdBuffer[currentCommandBufferIdx];
@@ -521,6 +991,10 @@ namespace kbs
         cmdBeginInfo.flags = 0;
         vkBeginCommandBuffer(cmd, &cmdBeginInfo);
 
+        UploadRenderWorldObjects();
+        // compute work can't be recorded inside the render passes of the graph
+        RecordIndirectCulling(cmd);
+
         auto onResize = [&](uint32_t w, uint32_t h)
         {
             // TODO resize window by resize event
@@ -530,8 +1004,13 @@ namespace kbs
 
         std::string error;
         uint32_t currentImageIdx;
-        VkSemaphore acquire_image_semaphore;
-        if (auto v = m_Context->AcquireNextImageAfterResize(onResize, &error))
+        VkSemaphore acquire_image_semaphore = VK_NULL_HANDLE;
+        if (m_Headless)
+        {
+            // offscreen back buffers are used round robin, there is nothing to acquire
+            currentImageIdx = m_FrameCounter % GetBackBufferCount();
+        }
+        else if (auto v = m_Context->AcquireNextImageAfterResize(onResize, &error))
         {
             auto [_, a, i] = v.value();
             acquire_image_semaphore = a;
@@ -543,6 +1022,7 @@ namespace kbs
         }
 
         
+        KBS_PROFILE_SCOPE("ExecuteRenderGraph");
         auto [state, msg] =  m_Graph->Execute(currentImageIdx, cmd);
         KBS_ASSERT(state == vkrg::RenderGraphRuntimeState::Success, "error occurs while excuting render graph {}", msg.c_str());
 
@@ -550,6 +1030,13 @@ namespace kbs
 
         vkEndCommandBuffer(cmd);
 
+        if (m_Headless)
+        {
+            m_PrimaryCmdQueue->Submit(&cmd, 1, gvk::SemaphoreInfo(), m_Fences[currentFenceIdx]);
+            m_FrameCounter++;
+            return;
+        }
+
         m_PrimaryCmdQueue->Submit(&cmd, 1,
             gvk::SemaphoreInfo()
             .Wait(acquire_image_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT)
@@ -638,7 +1125,7 @@ namespace kbs
         m_PerdrawDescriptorSet = m_Renderer->GetAPI().AllocateDescriptorSet(setLayout.value());
     }
 
-    void RendererPass::RenderSceneByCamera(RenderFilter filter, VkCommandBuffer cmd)
+    void RendererPass::RenderSceneByCamera(const RenderFilter& filter, VkCommandBuffer cmd)
     {
         m_Renderer->RenderSceneByCamera(m_TargetScene, m_Camera, filter, cmd);
     }
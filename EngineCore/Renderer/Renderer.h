@@ -3,12 +3,17 @@
 #include "Core/Window.h"
 #include "vkrg/graph.h"
 #include "Scene/Scene.h"
+#include "Scene/RenderWorld.h"
 #include "Renderer/RenderCamera.h"
 #include "Renderer/RenderResource.h"
 #include "Renderer/Material.h"
 #include "Renderer/Flags.h"
 #include "Renderer/Mesh.h"
 #include "Renderer/RenderAPI.h"
+#include "Renderer/IndirectDraw.h"
+#include "Renderer/Instancing.h"
+#include "Renderer/DrawSort.h"
+#include "Core/FrameAllocator.h"
 
 namespace kbs
 {
@@ -18,6 +23,8 @@ namespace kbs
 		GvkDeviceCreateInfo		device;
 		GvkInstanceCreateInfo	instance;
 		std::string				appName;
+		// enables the device features of the gpu driven path when the device supports them, see Renderer::SetGPUDrivenRendering
+		bool					gpuDrivenRendering = false;
 	};
 
 	struct RenderableObject
@@ -26,10 +33,18 @@ namespace kbs
 		MaterialID          targetMaterial;
 		uint64_t            targetRenderFlag;
 		MeshID              targetMeshID;
-		Transform           transform;
+		// owned by the render world the object was collected from
+		const RenderWorldObject* object;
+		// index of the object in the render world and in the object buffer of the frame
+		uint32_t			objectIndex;
+		// resolved once when the object is collected, sorting and drawing don't look up ids
+		MaterialHandle		materialHandle;
+		MeshHandle			meshHandle;
 	};
 
-	using RenderableObjectSorter = std::function<void(std::vector<RenderableObject>&)>;
+	// allocated from the frame arena, see FrameAllocator
+	using RenderableObjectList = FrameVector<RenderableObject>;
+	using RenderableObjectSorter = std::function<void(RenderableObjectList&)>;
 	using RenderShaderFilter = std::function<bool(ShaderID shaderID)>;
 
 	struct RenderFilter
@@ -38,8 +53,13 @@ namespace kbs
 		RenderCameraCullingResult	cullingResult;
 		RenderableObjectSorter		renderableObjectSorter;
 		RenderShaderFilter			shaderFilter;
+		// set by the passes drawing the main camera, only they test objects against the occluders, see SetOcclusionCulling
+		bool						occlusionCulling = false;
 	};
 
+	// draws of a filter culled and compacted on the gpu, valid for the frame it was prepared in
+	using IndirectDrawHandle = uint32_t;
+
 	class Renderer;
 
 	class RendererAttachmentDescriptor
@@ -173,7 +193,7 @@ namespace kbs
 		RenderCamera GetRenderCamera() { return m_Camera; }
 		Renderer* GetRenderer() { return m_Renderer; }
 
-		void RenderSceneByCamera(RenderFilter filter, VkCommandBuffer cmd);
+		void RenderSceneByCamera(const RenderFilter& filter, VkCommandBuffer cmd);
 
 		void SetUpPerpassParameterSet(ShaderID targetShaderID);
 		PassParameterUpdater UpdatePassParameter();
@@ -199,14 +219,47 @@ namespace kbs
 		bool Initialize(ptr<kbs::Window> window, RendererCreateInfo& info);
 		void Destroy();
 
+		// renders the render world extracted by ExtractRenderWorld. once ExtractRenderWorld was called it waits
+		// for the extraction of the frame, until then the scene is extracted here on the calling thread
 		void RenderScene(ptr<Scene> scene);
+		// snapshots the scene for the next RenderScene call into the render world RenderScene doesn't read,
+		// so it can run on the thread updating the scene while the previous frame is rendered.
+		// call it once per frame, and before the first RenderScene when it runs on another thread. it waits
+		// until RenderScene took the previous snapshot
+		void ExtractRenderWorld(ptr<Scene> scene);
+		// the render world of the frame being rendered
+		const RenderWorld& GetRenderWorld();
 		VkFormat GetBackBufferFormat();
 
+		// swap chain images, or offscreen images when the window is headless
+		std::vector<ptr<gvk::Image>> GetBackBuffers();
+		uint32_t GetBackBufferCount();
+		// layout the back buffer resource should end the render graph in
+		VkImageLayout GetBackBufferFinalLayout();
+
 		RenderAPI GetAPI();
 		RenderableObjectSorter GetDefaultRenderableObjectSorter(vec3 cameraPosistion);
 		RenderShaderFilter	   GetDefaultShaderFilter();
 
-		void RenderSceneByCamera(ptr<Scene> scene, RenderCamera& camera, RenderFilter filter, VkCommandBuffer cmd);
+		// renderableObjectSorter and shaderFilter are optional, objects are sorted by state and depth by default, see DrawSort.h.
+		// objects are read from the render world, not from the scene
+		void RenderSceneByCamera(ptr<Scene> scene, RenderCamera& camera, const RenderFilter& filter, VkCommandBuffer cmd);
+		// objects hidden behind the occluders of the render world are skipped by RenderSceneByCamera
+		// when it culls them itself for a filter with occlusionCulling. the occluders are rasterized once
+		// per such filter, so only the main camera passes set it. off by default
+		void SetOcclusionCulling(bool enable) { m_OcclusionCulling = enable; }
+
+		// gpu driven path, the passes read it to replace RenderSceneByCamera by indirect draws. off by default.
+		// requires RendererCreateInfo::gpuDrivenRendering and the drawIndirectCount and drawIndirectFirstInstance
+		// features, the passes keep drawing by RenderSceneByCamera when the device doesn't support them
+		void SetGPUDrivenRendering(bool enable);
+		bool IsGPUDrivenRendering() { return m_GPUDrivenRendering; }
+		// collects the draws of the filter from the render world, they are frustum culled by a compute shader
+		// before the render graph executes. call it from OnSceneRender.
+		// only surface shaders and indexed meshes are drawn, the sorter and culling result of the filter are ignored
+		IndirectDrawHandle PrepareIndirectDraws(RenderCamera& camera, const RenderFilter& filter);
+		// one vkCmdDrawIndexedIndirectCount for every shader, material and mesh group of the prepared draws
+		void RenderIndirectDraws(IndirectDrawHandle handle, RenderCamera& camera, VkCommandBuffer cmd);
 	
 		uint32_t GetCurrentFrameIdx();
 
@@ -261,18 +314,35 @@ namespace kbs
 		virtual void OnSceneRender(ptr<Scene> scene) {}
 
 		static constexpr uint32_t				m_CameraDescriptorSetPoolSize = 64;
-		static constexpr uint32_t				m_ObjectPoolSize = 1024;
-		static constexpr uint32_t				m_ObjectCameraPoolSize = m_ObjectPoolSize + m_CameraDescriptorSetPoolSize;
+		static constexpr uint32_t				m_InstanceChunkPoolSize = 16;
+		static constexpr uint32_t				m_InstanceChunkSize = 64 * 1024;
 
 
 		static constexpr uint32_t				m_CameraUBOAlignedSize = 320;
 
 		VkDescriptorSetLayout					m_ObjectDescriptorSetLayout;
 		VkDescriptorPool						m_ObjectCameraDescriptorPool;
-		std::vector<VkDescriptorSet>			m_ObjectDescriptorSetPool;
-		
-		ptr<RenderBuffer>						m_ObjectUBOPool;
-		uint32_t								m_ObjectUBOPoolCounter;
+		// transforms of all render world objects, uploaded once per frame before the render graph executes.
+		// instances find their object through the object indices of an instance chunk
+		ptr<RenderBuffer>						m_ObjectBuffer;
+
+		// object indices of the instances drawn in a frame. a chunk is never resized while the frame uses it,
+		// the object set of the chunk binds it next to the object buffer
+		struct InstanceChunk
+		{
+			ptr<RenderBuffer>	buffer;
+			uint32_t			capacity = 0;
+			uint32_t			used = 0;
+			VkDescriptorSet		objectSet;
+		};
+		struct InstanceRange
+		{
+			ptr<RenderBuffer>	buffer;
+			uint32_t			firstInstance;
+			VkDescriptorSet		objectSet;
+		};
+		std::vector<InstanceChunk>				m_InstanceChunks;
+		uint32_t								m_InstanceChunkCounter = 0;
 
 		// TODO camera buffer and camera descriptor set
 		uint32_t								m_CameraDescriptorSetCounter = 0;
@@ -285,6 +355,17 @@ namespace kbs
 		ptr<gvk::DescriptorAllocator>			m_MaterialDescriptorAllocator;
 		std::unordered_map<ShaderID, ptr<gvk::Pipeline>>		m_ShaderPipelines;
 		std::unordered_map<MaterialID, ptr<gvk::DescriptorSet>> m_MaterialDescriptors;
+		// indexed by the slot of the material handle, the sort keys don't look up the shader of a material
+		struct MaterialSortInfo
+		{
+			uint32_t pipelineIndex = 0;
+			bool	 transparent = false;
+			bool	 filled = false;
+		};
+		const MaterialSortInfo& GetMaterialSortInfo(MaterialHandle handle);
+		std::vector<MaterialSortInfo>							m_MaterialSortInfos;
+		// pipelines are numbered in the order they are created
+		std::unordered_map<ShaderID, uint32_t>					m_PipelineSortIndices;
 		
 		ptr<vkrg::RenderGraph>	m_Graph;
 		ptr<gvk::Context>		m_Context;
@@ -296,15 +377,62 @@ namespace kbs
 		ptr<gvk::CommandQueue>		 m_PrimaryCmdQueue;
 	private:
 		bool InitializeObjectDescriptorPool();
+		void SortRenderableObjects(RenderableObjectList& objects, vec3 cameraPosition);
+		bool CreateOffscreenBackBuffers();
+
+		void UploadRenderWorldObjects();
+		// consecutive instances in one chunk, valid for the current frame
+		InstanceRange AllocateInstances(uint32_t count);
+		void RecordIndirectCulling(VkCommandBuffer cmd);
 
-		ptr<Material>	GetMaterialByID(MaterialID id);
-		ptr<MeshGroup>	GetMeshGroupByMesh(const MeshID& id);
-		Mesh			GetMeshByMeshID(const MeshID& comp);
+		Material*		GetMaterial(MaterialHandle handle);
+		Mesh*			GetMesh(MeshHandle handle);
 		uint32_t		m_FramebufferIdx;
 		
 		std::vector<VkSemaphore>	 m_ColorOutputFinish;
 		std::vector<VkFence> m_Fences;
 
 		uint32_t		m_FrameCounter;
+
+		static constexpr uint32_t		m_OffscreenBackBufferCount = 2;
+		bool							m_Headless = false;
+		std::vector<ptr<gvk::Image>>	m_OffscreenBackBuffers;
+
+		RenderWorldBuffer				m_RenderWorlds;
+		std::atomic<bool>				m_ExtractsRenderWorld{ false };
+		// culled by RenderSceneByCamera when the filter doesn't bring a culling result
+		RenderCameraCullingResult		m_CullingResult;
+		OcclusionBuffer					m_OcclusionBuffer;
+		bool							m_OcclusionCulling = false;
+		// largest renderable list of a camera so far, the lists are reserved to it
+		uint32_t						m_RenderableObjectHighWater = 0;
+
+		struct IndirectDrawList
+		{
+			std::vector<IndirectDrawSource>	sources;
+			std::vector<IndirectDrawRecord>	records;
+			std::vector<IndirectDrawBatch>	batches;
+			// resolved when the list is prepared, drawing doesn't look up ids
+			std::vector<MaterialHandle>		batchMaterials;
+			std::vector<MeshGroupHandle>	batchMeshGroups;
+			Frustum							frustum;
+
+			ptr<ComputeKernel>				cullingKernel;
+			ptr<RenderBuffer>				uniformBuffer;
+			ptr<RenderBuffer>				recordBuffer;
+			ptr<RenderBuffer>				commandBuffer;
+			ptr<RenderBuffer>				countBuffer;
+			InstanceRange					instances;
+		};
+
+		bool							m_GPUDrivenRendering = false;
+		bool							m_GPUDrivenRenderingSupported = false;
+		// reused by the following frames, only the first m_IndirectDrawListCounter lists belong to the current frame
+		std::vector<IndirectDrawList>	m_IndirectDrawLists;
+		uint32_t						m_IndirectDrawListCounter = 0;
+		// loaded when gpu driven rendering is turned on
+		opt<ShaderID>					m_IndirectCullingShader;
+		// boxes of all render world objects, shared by the draw lists of a frame
+		ptr<RenderBuffer>				m_IndirectBoundsBuffer;
 	};
 }
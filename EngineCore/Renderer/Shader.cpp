@@ -2,6 +2,8 @@
 #include "Core/Log.h"
 #include <fstream>
 #include "Core/FileSystem.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
 
 
 namespace kbs
@@ -18,6 +20,7 @@ namespace kbs
 
 	void ShaderManager::Initialize(ptr<gvk::Context> ctx)
 	{
+		KBS_MEMORY_TAG(Shader);
 		GetShaderFileManager()->AddSearchPath(KBS_ROOT_DIRECTORY"/Renderer/shader/");
 
 		const char* shaderDirectorys[] = { KBS_ROOT_DIRECTORY"/Renderer/Shader/" };
@@ -50,6 +53,8 @@ namespace kbs
 
 	opt<ptr<Shader>> kbs::ShaderManager::Load(const std::string& _filePath)
 	{
+		KBS_PROFILE_FUNCTION();
+		KBS_MEMORY_TAG(Shader);
 		if (auto var = GetByPath(_filePath);var.has_value())
 		{
 			return var.value();
@@ -225,10 +230,12 @@ namespace kbs
 
 	opt<ptr<Shader>> ShaderManager::GetByPath(const std::string& filePath)
 	{
-		if (Exists(filePath))
+		if (auto var = GetShaderFileManager()->FindAbsolutePath(filePath); var.has_value())
 		{
-			std::string fullPath = GetShaderFileManager()->FindAbsolutePath(filePath).value();
-			return m_Shaders[m_ShaderPathTable[fullPath]];
+			if (auto iter = m_ShaderPathTable.find(var.value()); iter != m_ShaderPathTable.end())
+			{
+				return m_Shaders[iter->second];
+			}
 		}
 		return std::nullopt;
 	}
@@ -272,13 +279,15 @@ namespace kbs
 			return std::nullopt;
 		}
 
-		std::ifstream inf(validAbsolutePath);
-		inf.seekg(0, std::ios::end);
-		size_t fileSize = inf.tellg();
-		inf.seekg(0, std::ios::beg);
-
-		std::string str(fileSize, ' ');
-		inf.read(str.data(), fileSize);
+		opt<FileBlob> content = Singleton::GetInstance<VirtualFileSystem>()->Open(validAbsolutePath);
+		if (!content.has_value())
+		{
+			KBS_WARN("fail to read shader file {}", validAbsolutePath.c_str());
+			return std::nullopt;
+		}
+		// the content is read in binary, drop carriage returns like a text mode stream does
+		std::string str(content.value().AsString());
+		str.erase(std::remove(str.begin(), str.end(), '\r'), str.end());
 
 		std::string msg;
 		opt<ShaderInfo> info = kbs::ShaderParser::Parse(str, &msg);
@@ -653,14 +662,15 @@ namespace kbs
 			}
 			else if (b->set == (uint32_t)ShaderSetUsage::perObject)
 			{
-				if (b->binding != 0 || b->descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+				if (b->binding > 1 || b->descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER)
 				{
-					msg = "invalid shader binding at set perObject binding " + std::to_string(b->binding) + " only binding 0 is allowed at set perObject";
+					msg = "invalid shader binding at set perObject binding " + std::to_string(b->binding) + " only the object and instance storage buffers at binding 0 and 1 are allowed at set perObject";
 					return false;
 				}
-				if (std::string(b->name) != "object")
+				const char* expectedName = b->binding == 0 ? "object" : "instance";
+				if (std::string(b->name) != expectedName)
 				{
-					msg = "invalid shader binding name at set perObject binding " + std::string(b->name) + " name must be 'object'";
+					msg = "invalid shader binding name at set perObject binding " + std::string(b->name) + " name must be '" + expectedName + "'";
 					return false;
 				}
 
@@ -7,7 +7,7 @@
 namespace kbs
 {
 	// shader set usages
-	// set 0 perObject : 0 object uniform buffer
+	// set 0 perObject : 0 object storage buffer, 1 object indices of the instances
 	// set 1 perMaterial : 0 material uniform buffer(material variables), other buffers, other textures
 	// set 2 perCamera : 0 camera uniform buffer, unused
 	// set 3 perDraw : other buffers
@@ -146,6 +146,8 @@ namespace kbs
 		}
 
 		RenderPassFlags GetRenderPassFlags();
+		// shaders drawn by the standard vertex shader find their objects through the first instance of indirect draws
+		virtual bool SupportsIndirectDraw() { return false; }
 
 	protected:
 		void AssignRFDState(GvkGraphicsPipelineCreateInfo& info);
@@ -177,6 +179,7 @@ namespace kbs
 			GraphicsShader(ShaderType::Surface, shaderPath, info, manager, flags, id, fragmentShader->GetOutputVariableCount()), frag(fragmentShader) {}
 
 		void OnPipelineStateCreate(GvkGraphicsPipelineCreateInfo& info) override;
+		bool SupportsIndirectDraw() override { return true; }
 	private:
 		virtual bool GenerateReflection() override;
 
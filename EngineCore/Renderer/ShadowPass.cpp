@@ -46,31 +46,29 @@ namespace kbs
 		return ubo.projection * ubo.view;
 	}
 
-	kbs::opt<kbs::Entity> ShadowPass::GetShadowCaster()
+	kbs::opt<kbs::UUID> ShadowPass::GetShadowCaster()
 	{
 		return m_ShadowCaster;
 	}
 
 	void ShadowPass::SetTargetScene(ptr<Scene> scene)
 	{
-		opt<Entity> shadowCaster;
-		scene->IterateAllEntitiesWith<LightComponent>(
-			[&](Entity e)
+		const RenderWorldLight* shadowCaster = nullptr;
+		for (const RenderWorldLight& light : GetRenderer()->GetRenderWorld().lights)
+		{
+			if (light.light.shadowCaster.castShadow)
 			{
-				LightComponent lightComp = e.GetComponent<LightComponent>();
-				if (lightComp.shadowCaster.castShadow && !shadowCaster.has_value())
-				{
-					shadowCaster = e;
-				}
+				shadowCaster = &light;
+				break;
 			}
-		);
+		}
 
-		m_ShadowCaster = shadowCaster;
+		m_ShadowCaster = shadowCaster != nullptr ? opt<UUID>(shadowCaster->id) : std::nullopt;
 
-		if (shadowCaster.has_value())
+		if (shadowCaster != nullptr)
 		{
-			Transform shadowCasterTransform(shadowCaster.value());
-			LightComponent shadowCasterLight = shadowCaster->GetComponent<LightComponent>();
+			Transform shadowCasterTransform(TransformComponent(shadowCaster->position, shadowCaster->rotation, vec3(1.f)), Entity());
+			LightComponent shadowCasterLight = shadowCaster->light;
 
 			shadowCasterTransform.SetPosition(shadowCasterTransform.GetPosition() -
 				shadowCasterTransform.GetFront() * shadowCasterLight.shadowCaster.distance * 0.8f);
@@ -25,8 +25,9 @@ namespace kbs
 			VkAttachmentLoadOp& stencilLoadOp, VkAttachmentStoreOp& stencilStoreOp) override;
 
 		opt<mat4>	GetLightVP();
-		opt<Entity> GetShadowCaster();
+		opt<UUID>	GetShadowCaster();
 
+		// the shadow caster is the first light casting shadows in the render world of the frame
 		virtual void SetTargetScene(ptr<Scene> scene) override;
 
 	protected:
@@ -35,6 +36,6 @@ namespace kbs
 
 		vkrg::RenderPassAttachment m_ShadowDepthAttachment;
 		RenderCamera	m_LightCamera;
-		opt<Entity>		m_ShadowCaster;
+		opt<UUID>		m_ShadowCaster;
 	};
 }
\ No newline at end of file
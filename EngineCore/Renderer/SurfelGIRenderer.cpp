@@ -185,7 +185,7 @@ namespace kbs
 
 		vkrg::ResourceInfo imageInfo;
 		imageInfo.format = GetBackBufferFormat();
-		renderGraph->AddGraphResource("backBuffer", imageInfo, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		renderGraph->AddGraphResource("backBuffer", imageInfo, true, GetBackBufferFinalLayout());
 
 		vkrg::ImageSlice slice;
 		slice.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -277,7 +277,7 @@ namespace kbs
 			return false;
 		}
 
-		auto backBuffers = m_Context->GetBackBuffers();
+		auto backBuffers = GetBackBuffers();
 		auto extData = renderGraph->GetExternalDataFrame();
 		for (uint32_t i = 0; i < backBuffers.size(); i++)
 		{
@@ -3,6 +3,10 @@
 #include "Common.h"
 #include "UUID.h"
 #include "Math/math.h"
+#include "Math/Geometry.h"
+#include "Math/OcclusionBuffer.h"
+#include "Core/StringInterner.h"
+#include "Scene/entt/entt.h"
 
 
 
@@ -26,6 +30,15 @@ namespace kbs
 			: name(name) {}
 	};
 
+	// change tags through Entity::AddTag and Entity::RemoveTag, the scene keeps a group per tag
+	struct TagComponent
+	{
+		std::vector<InternedString> tags;
+
+		TagComponent() = default;
+		TagComponent(const TagComponent&) = default;
+	};
+
 	struct TransformComponent
 	{
 		UUID parent;
@@ -37,6 +50,32 @@ namespace kbs
 		TransformComponent(const TransformComponent&) = default;
 		TransformComponent(vec3 position, quat rotation, vec3 scale)
 			: position(position), rotation(rotation), scale(scale) {}
+
+		mat4 GetLocalMatrix() const { return math::position(position) * math::quat2mat(rotation) * math::scale(scale); }
+	};
+
+	// world space transform cached by Scene::UpdateWorldTransforms, don't modify it directly
+	struct WorldTransformComponent
+	{
+		mat4 world;
+		mat4 invTransWorld;
+		quat rotation;
+
+		// the local transform the world transform was computed from, used to find out changed entities
+		UUID parent;
+		// the entity the parent resolved to, entt::null for children of the root
+		entt::entity parentEntity = entt::null;
+		vec3 localPosition;
+		quat localRotation;
+		vec3 localScale;
+
+		WorldTransformComponent() = default;
+		WorldTransformComponent(const WorldTransformComponent&) = default;
+
+		bool IsComputedFrom(const TransformComponent& local) const
+		{
+			return parent == local.parent && localPosition == local.position && localRotation == local.rotation && localScale == local.scale;
+		}
 	};
 
 	struct CustomScript
@@ -154,17 +193,7 @@ namespace kbs
 		float m_Height = 0;
 
 		CameraComponent() = default;
-		CameraComponent(const CameraComponent& comp)
-		{
-			m_Fov = comp.m_Fov;
-			m_Height = comp.m_Height;
-			m_Width = comp.m_Width;
-			m_AspectRatio = comp.m_AspectRatio;
-
-			m_Far = comp.m_Far;
-			m_Near = comp.m_Near;
-			m_Type = comp.m_Type;
-		}
+		CameraComponent(const CameraComponent&) = default;
 
 		CameraComponent(float cameraFar, float cameraNear, float cameraAspect, float cameraFov)
 			:m_Far(cameraFar), m_Near(cameraNear), m_AspectRatio(cameraAspect), m_Fov(cameraFov),m_Type(CameraType::Perspective)
@@ -198,9 +227,33 @@ namespace kbs
 		UUID rayTracingMaterial;
 	};
 	
+	// bounds in the local space of the entity, the scene indexes the world space bounds for spatial queries.
+	// change them through Entity::SetBounds
+	struct BoundsComponent
+	{
+		AABB local;
+
+		BoundsComponent() = default;
+		BoundsComponent(const BoundsComponent&) = default;
+		BoundsComponent(const AABB& local)
+			: local(local) {}
+	};
+
+	// triangles in the local space of the entity hiding the objects behind them, see OcclusionBuffer.
+	// the mesh is shared between the instances of a model and must not be changed while a frame is rendered
+	struct OccluderComponent
+	{
+		ptr<const OccluderMesh> mesh;
+
+		OccluderComponent() = default;
+		OccluderComponent(const OccluderComponent&) = default;
+		OccluderComponent(ptr<const OccluderMesh> mesh)
+			: mesh(mesh) {}
+	};
+
 	template<typename ...Args>
 	struct ComponentGroup {};
 	using AllCopiableComponents = ComponentGroup<TransformComponent, RenderableComponent, CameraComponent, CustomScriptCompoent, RayTracingGeometryComponent,
-		LightComponent>;
+		LightComponent, TagComponent, BoundsComponent, OccluderComponent>;
 
 }
\ No newline at end of file
@@ -2,13 +2,36 @@
 
 namespace kbs {
 
-	Entity::Entity(entt::entity handle, Scene* scene)
-		: m_EntityHandle(handle), m_Scene(scene)
-	{}
-
 	Scene* Entity::GetScene()
 	{
 		return m_Scene;
 	}
 
+	void Entity::SetName(const std::string& name)
+	{
+		// patch triggers the update listener which re-indexes the entity
+		m_Scene->m_Registry.patch<NameComponent>(m_EntityHandle, [&](NameComponent& comp) { comp.name = name; });
+	}
+
+	void Entity::SetBounds(const AABB& local)
+	{
+		KBS_MEMORY_TAG(Scene);
+		m_Scene->m_Registry.emplace_or_replace<BoundsComponent>(m_EntityHandle, local);
+	}
+
+	void Entity::AddTag(InternedString tag)
+	{
+		m_Scene->AddTag(m_EntityHandle, tag);
+	}
+
+	void Entity::RemoveTag(InternedString tag)
+	{
+		m_Scene->RemoveTag(m_EntityHandle, tag);
+	}
+
+	bool Entity::HasTag(InternedString tag)
+	{
+		return m_Scene->HasTag(m_EntityHandle, tag);
+	}
+
 }
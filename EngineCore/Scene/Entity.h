@@ -2,6 +2,7 @@
 
 #include "Scene/Scene.h"
 #include "Core/Log.h"
+#include "Core/MemoryTracker.h"
 #include "Scene/Components.h"
 #include "Scene/entt/entt.h"
 
@@ -15,13 +16,15 @@ namespace kbs
 	{
 	public:
 		Entity() = default;
-		Entity(entt::entity handle, Scene* scene);
+		Entity(entt::entity handle, Scene* scene) : m_EntityHandle(handle), m_Scene(scene) {}
 		Entity(const Entity& other) = default;
 
 		template<typename T, typename... Args>
 		T& AddComponent(Args&&... args)
 		{
+			KBS_ASSERT(!m_Scene->IsIteratingInParallel(), "components can't be added or removed during a parallel iteration");
 			KBS_ASSERT(!HasComponent<T>(), "Entity already has component!");
+			KBS_MEMORY_TAG(Scene);
 			T& component = m_Scene->m_Registry.emplace<T>(m_EntityHandle, std::forward<Args>(args)...);
 			return component;
 		}
@@ -29,10 +32,21 @@ namespace kbs
 		template<typename T, typename... Args>
 		T& AddOrReplaceComponent(Args&&... args)
 		{
+			KBS_ASSERT(!m_Scene->IsIteratingInParallel(), "components can't be added or removed during a parallel iteration");
+			KBS_MEMORY_TAG(Scene);
 			T& component = m_Scene->m_Registry.emplace_or_replace<T>(m_EntityHandle, std::forward<Args>(args)...);
 			return component;
 		}
 
+		// changes the component in place and notifies the scene, changes of the components tracked by
+		// Scene::GetChanges are only seen if they are made through here or AddOrReplaceComponent
+		template<typename T, typename Func>
+		T& PatchComponent(Func&& func)
+		{
+			KBS_ASSERT(HasComponent<T>(), "Entity does not have component!");
+			return m_Scene->m_Registry.patch<T>(m_EntityHandle, std::forward<Func>(func));
+		}
+
 		template<typename T>
 		T& GetComponent()
 		{
@@ -59,6 +73,7 @@ namespace kbs
 		template<typename T>
 		void RemoveComponent()
 		{
+			KBS_ASSERT(!m_Scene->IsIteratingInParallel(), "components can't be added or removed during a parallel iteration");
 			KBS_ASSERT(HasComponent<T>(), "Entity does not have component!");
 			m_Scene->m_Registry.remove<T>(m_EntityHandle);
 		}
@@ -69,6 +84,15 @@ namespace kbs
 
 		UUID GetUUID() { return GetComponent<IDComponent>().ID; }
 		const std::string& GetName() { return GetComponent<NameComponent>().name; }
+		// keeps the name index of the scene up to date, don't write NameComponent::name directly
+		void SetName(const std::string& name);
+
+		// adds or replaces the BoundsComponent, the spatial index of the scene picks it up on the next update
+		void SetBounds(const AABB& local);
+
+		void AddTag(InternedString tag);
+		void RemoveTag(InternedString tag);
+		bool HasTag(InternedString tag);
 
 		bool operator==(const Entity& other) const
 		{
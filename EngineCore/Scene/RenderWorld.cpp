@@ -0,0 +1,186 @@
+#include "Scene/RenderWorld.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Renderer/Flags.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
+
+namespace kbs
+{
+	void RenderWorld::Extract(Scene& scene)
+	{
+		KBS_PROFILE_FUNCTION();
+		KBS_MEMORY_TAG(Renderer);
+		scene.UpdateWorldTransforms();
+		Clear();
+
+		entt::registry& registry = scene.m_Registry;
+		root = scene.GetRootID();
+
+		for (uint32_t type = 0; type < (uint32_t)SceneChangeType::Count; type++)
+		{
+			const SceneChangeSet& sceneChanges = scene.GetChanges((SceneChangeType)type);
+			for (entt::entity e : sceneChanges.changed)
+			{
+				changes.changed[type].push_back(registry.get<IDComponent>(e).ID);
+			}
+			changes.removed[type] = sceneChanges.removed;
+		}
+		scene.ClearChanges();
+
+		// the passes of an object are stored contiguously, count them before filling the objects in parallel
+		auto renderables = registry.view<RenderableComponent, WorldTransformComponent, IDComponent>();
+		for (auto e : renderables)
+		{
+			m_Entities.push_back(e);
+		}
+		objects.resize(m_Entities.size());
+		uint32_t passCount = 0;
+		for (uint32_t i = 0; i < m_Entities.size(); i++)
+		{
+			objects[i].firstPass = passCount;
+			objects[i].passCount = renderables.get<RenderableComponent>(m_Entities[i]).passCount;
+			passCount += objects[i].passCount;
+		}
+		passes.resize(passCount);
+		bounds.Resize((uint32_t)objects.size());
+
+		Singleton::GetInstance<JobSystem>()->ParallelForEach(0, (uint32_t)m_Entities.size(),
+			[&](uint32_t i)
+			{
+				entt::entity e = m_Entities[i];
+				const RenderableComponent& render = renderables.get<RenderableComponent>(e);
+				const WorldTransformComponent& world = renderables.get<WorldTransformComponent>(e);
+
+				RenderWorldObject& object = objects[i];
+				object.id = renderables.get<IDComponent>(e).ID;
+				object.mesh = render.targetMesh;
+				object.transform = ObjectUBO{ world.world, world.invTransWorld };
+				object.position = vec3(world.world[3]);
+				bool cullable = true;
+				for (uint32_t p = 0; p < object.passCount; p++)
+				{
+					passes[object.firstPass + p] = RenderWorldPass{ render.targetMaterials[p], render.renderOptionFlags[p] };
+					cullable = cullable && !kbs_contains_flags(render.renderOptionFlags[p], RenderOption_DontCullByDistance);
+				}
+
+				const BoundsComponent* local = registry.try_get<BoundsComponent>(e);
+				if (cullable && local != nullptr && local->local.IsValid())
+				{
+					bounds.Set(i, local->local.Transform(world.world));
+				}
+				else
+				{
+					bounds.SetUnbounded(i);
+				}
+			}
+		);
+
+		for (auto e : registry.view<OccluderComponent, WorldTransformComponent>())
+		{
+			const OccluderComponent& occluder = registry.get<OccluderComponent>(e);
+			if (occluder.mesh != nullptr)
+			{
+				occluders.push_back(RenderWorldOccluder{ occluder.mesh, registry.get<WorldTransformComponent>(e).world });
+			}
+		}
+
+		for (auto e : registry.view<LightComponent, WorldTransformComponent, IDComponent>())
+		{
+			const WorldTransformComponent& world = registry.get<WorldTransformComponent>(e);
+			lights.push_back(RenderWorldLight{ registry.get<IDComponent>(e).ID, registry.get<LightComponent>(e),
+				vec3(world.world[3]), world.rotation, world.rotation * vec3(0, 0, 1) });
+		}
+
+		for (auto e : registry.view<CameraComponent, WorldTransformComponent, IDComponent>())
+		{
+			const WorldTransformComponent& world = registry.get<WorldTransformComponent>(e);
+			vec3 scale(math::length(vec3(world.world[0])), math::length(vec3(world.world[1])), math::length(vec3(world.world[2])));
+
+			RenderWorldCamera camera;
+			camera.id = registry.get<IDComponent>(e).ID;
+			camera.camera = registry.get<CameraComponent>(e);
+			camera.transform = TransformComponent(vec3(world.world[3]), world.rotation, scale);
+			camera.transform.parent = root;
+
+			if (scene.m_MainCamera.has_value() && scene.m_MainCamera.value() == camera.id)
+			{
+				mainCamera = (uint32_t)cameras.size();
+			}
+			cameras.push_back(camera);
+		}
+	}
+
+	void RenderWorld::Clear()
+	{
+		objects.clear();
+		passes.clear();
+		occluders.clear();
+		lights.clear();
+		cameras.clear();
+		bounds.Resize(0);
+		for (uint32_t type = 0; type < (uint32_t)SceneChangeType::Count; type++)
+		{
+			changes.changed[type].clear();
+			changes.removed[type].clear();
+		}
+		m_Entities.clear();
+		mainCamera = std::nullopt;
+	}
+
+	const RenderWorldCamera* RenderWorld::GetMainCamera() const
+	{
+		return mainCamera.has_value() ? &cameras[mainCamera.value()] : nullptr;
+	}
+
+	void RenderWorld::GatherObjectUBOs(ObjectUBO* objectUBOs) const
+	{
+		KBS_PROFILE_FUNCTION();
+		for (uint32_t i = 0; i < objects.size(); i++)
+		{
+			objectUBOs[i] = objects[i].transform;
+		}
+	}
+
+	const RenderWorldCamera* RenderWorld::FindCamera(UUID id) const
+	{
+		for (auto& camera : cameras)
+		{
+			if (camera.id == id)
+			{
+				return &camera;
+			}
+		}
+		return nullptr;
+	}
+
+	void RenderWorldBuffer::Extract(Scene& scene)
+	{
+		std::unique_lock<std::mutex> lock(m_Lock);
+		// the back world holds the changes of the previous extraction until the render thread took it
+		m_Handoff.wait(lock, [&]() { return !m_Extracted; });
+		m_Worlds[1 - m_Front].Extract(scene);
+		m_Extracted = true;
+		lock.unlock();
+		m_Handoff.notify_all();
+	}
+
+	bool RenderWorldBuffer::Swap(bool waitForExtraction)
+	{
+		std::unique_lock<std::mutex> lock(m_Lock);
+		if (waitForExtraction)
+		{
+			m_Handoff.wait(lock, [&]() { return m_Extracted; });
+		}
+		if (!m_Extracted)
+		{
+			return false;
+		}
+		m_Front = 1 - m_Front;
+		m_Extracted = false;
+		lock.unlock();
+		m_Handoff.notify_all();
+		return true;
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Common.h"
+#include "Scene/Components.h"
+#include "Scene/Transform.h"
+#include "Scene/Scene.h"
+#include "Math/FrustumCulling.h"
+#include <mutex>
+#include <condition_variable>
+
+namespace kbs
+{
+	// one render pass of a renderable object, see RenderableComponent
+	struct RenderWorldPass
+	{
+		UUID	 material;
+		uint64_t renderOptionFlags;
+	};
+
+	struct RenderWorldObject
+	{
+		UUID	  id;
+		UUID	  mesh;
+		ObjectUBO transform;
+		vec3	  position;
+		// passes[firstPass, firstPass + passCount) of the render world
+		uint32_t  firstPass;
+		uint32_t  passCount;
+	};
+
+	struct RenderWorldOccluder
+	{
+		ptr<const OccluderMesh> mesh;
+		mat4					world;
+	};
+
+	struct RenderWorldLight
+	{
+		UUID		   id;
+		LightComponent light;
+		vec3		   position;
+		quat		   rotation;
+		vec3		   front;
+	};
+
+	struct RenderWorldCamera
+	{
+		UUID			   id;
+		CameraComponent	   camera;
+		// world space transform, its parent is the root of the scene
+		TransformComponent transform;
+
+		// a transform which doesn't reference the scene, safe to use while the scene is updated
+		Transform		   GetTransform() const { return Transform(transform, Entity()); }
+	};
+
+	// ids of the entities whose state changed between the previous extraction and this one, see Scene::GetChanges.
+	// renderers keeping gpu buffers across frames apply removed before changed
+	struct RenderWorldChanges
+	{
+		std::vector<UUID> changed[(uint32_t)SceneChangeType::Count];
+		std::vector<UUID> removed[(uint32_t)SceneChangeType::Count];
+
+		const std::vector<UUID>& GetChanged(SceneChangeType type) const { return changed[(uint32_t)type]; }
+		const std::vector<UUID>& GetRemoved(SceneChangeType type) const { return removed[(uint32_t)type]; }
+	};
+
+	// snapshot of everything the renderer reads from a scene. it is filled by Extract on the thread
+	// updating the scene and doesn't reference the registry, so rendering from it can run while the
+	// scene simulates the next frame
+	class KBS_API RenderWorld
+	{
+	public:
+		RenderWorld() = default;
+
+		// updates the world transforms of the scene and copies the renderables, lights and cameras.
+		// the changes of the scene are moved into the snapshot and cleared. the arrays keep their capacity between frames
+		void Extract(Scene& scene);
+		void Clear();
+
+		const RenderWorldCamera* GetMainCamera() const;
+		const RenderWorldCamera* FindCamera(UUID id) const;
+		// the object buffer the renderer uploads every frame, objectUBOs[i] belongs to objects[i] and is
+		// read by the shaders through the object index of the instance. objectUBOs must hold objects.size() elements
+		void GatherObjectUBOs(ObjectUBO* objectUBOs) const;
+
+		std::vector<RenderWorldObject> objects;
+		std::vector<RenderWorldPass>   passes;
+		std::vector<RenderWorldOccluder> occluders;
+		std::vector<RenderWorldLight>  lights;
+		std::vector<RenderWorldCamera> cameras;
+		RenderWorldChanges			   changes;
+		// world bounds of the objects, bounds[i] belongs to objects[i]. objects without a BoundsComponent
+		// and objects with a pass flagged RenderOption_DontCullByDistance are unbounded
+		BoundsSoA					   bounds;
+
+		UUID root;
+		opt<uint32_t> mainCamera;
+
+	private:
+		std::vector<entt::entity> m_Entities;
+	};
+
+	// two render worlds, the scene thread extracts into the back one while the render thread reads the
+	// front one. Swap is called by the render thread only, the front world stays valid until its next Swap.
+	// an extraction waits until the previous one was swapped to the front, so no scene changes are dropped
+	class KBS_API RenderWorldBuffer
+	{
+	public:
+		RenderWorldBuffer() = default;
+
+		void			   Extract(Scene& scene);
+		// brings the last extracted world to the front, returns false if nothing was extracted since the last swap.
+		// with waitForExtraction it blocks until the scene thread finished its extraction
+		bool			   Swap(bool waitForExtraction = false);
+
+		const RenderWorld& GetFront() const { return m_Worlds[m_Front]; }
+		// not synchronized, only read it while no extraction runs
+		RenderWorld&	   GetBack() { return m_Worlds[1 - m_Front]; }
+
+	private:
+		RenderWorld				m_Worlds[2];
+		uint32_t				m_Front = 0;
+		bool					m_Extracted = false;
+		std::mutex				m_Lock;
+		std::condition_variable m_Handoff;
+	};
+}
@@ -2,6 +2,8 @@
 #include "Scene/Components.h"
 #include "Scene/UUID.h"
 #include "Scene/Entity.h"
+#include "Core/Profiler.h"
+#include "Core/Hasher.h"
 
 /*
 kbs::opt<kbs::Entity> kbs::Scene::FindEntityByName(std::string_view name)
@@ -32,6 +34,28 @@ namespace kbs {
 
 	Scene::Scene()
 	{
+		KBS_MEMORY_TAG(Scene);
+		m_Registry.on_construct<TransformComponent>().connect<&Scene::OnTransformHierarchyChanged>(*this);
+		m_Registry.on_destroy<TransformComponent>().connect<&Scene::OnTransformHierarchyChanged>(*this);
+		m_Registry.on_construct<NameComponent>().connect<&Scene::OnNameConstructed>(*this);
+		m_Registry.on_update<NameComponent>().connect<&Scene::OnNameUpdated>(*this);
+		m_Registry.on_destroy<NameComponent>().connect<&Scene::OnNameDestroyed>(*this);
+		m_Registry.on_construct<TagComponent>().connect<&Scene::OnTagsConstructed>(*this);
+		m_Registry.on_update<TagComponent>().connect<&Scene::OnTagsUpdated>(*this);
+		m_Registry.on_destroy<TagComponent>().connect<&Scene::OnTagsDestroyed>(*this);
+		m_Registry.on_construct<BoundsComponent>().connect<&Scene::OnBoundsChanged>(*this);
+		m_Registry.on_update<BoundsComponent>().connect<&Scene::OnBoundsChanged>(*this);
+		m_Registry.on_destroy<BoundsComponent>().connect<&Scene::OnBoundsDestroyed>(*this);
+
+		m_ChangeObservers[(uint32_t)SceneChangeType::Renderable - 1].connect(m_Registry, entt::collector.group<RenderableComponent>().update<RenderableComponent>());
+		m_ChangeObservers[(uint32_t)SceneChangeType::Light - 1].connect(m_Registry, entt::collector.group<LightComponent>().update<LightComponent>());
+		m_ChangeObservers[(uint32_t)SceneChangeType::RayTracingGeometry - 1].connect(m_Registry,
+			entt::collector.group<RayTracingGeometryComponent>().update<RayTracingGeometryComponent>());
+		m_Registry.on_destroy<TransformComponent>().connect<&Scene::OnTrackedComponentDestroyed<SceneChangeType::Transform>>(*this);
+		m_Registry.on_destroy<RenderableComponent>().connect<&Scene::OnTrackedComponentDestroyed<SceneChangeType::Renderable>>(*this);
+		m_Registry.on_destroy<LightComponent>().connect<&Scene::OnTrackedComponentDestroyed<SceneChangeType::Light>>(*this);
+		m_Registry.on_destroy<RayTracingGeometryComponent>().connect<&Scene::OnTrackedComponentDestroyed<SceneChangeType::RayTracingGeometry>>(*this);
+
 		Entity rootEntity =  { m_Registry.create(), this };
 		m_Root = UUID::GenerateUncollidedID(m_EntityMap);
 		rootEntity.AddComponent<IDComponent>(m_Root);
@@ -43,6 +67,10 @@ namespace kbs {
 
 	Scene::~Scene()
 	{
+		for (auto& observer : m_ChangeObservers)
+		{
+			observer.disconnect();
+		}
 	}
 
 	template<typename... Component>
@@ -91,17 +119,28 @@ namespace kbs {
 		auto& dstSceneRegistry = newScene->m_Registry;
 		std::unordered_map<UUID, entt::entity> enttMap;
 
+		// the new scene only holds its root so far, it takes over the id of the source root.
+		// the root has no name and is not created again below
+		for (auto e : dstSceneRegistry.view<IDComponent>())
+		{
+			enttMap[other->m_Root] = e;
+			dstSceneRegistry.get<IDComponent>(e).ID = other->m_Root;
+		}
+		newScene->m_Root = other->m_Root;
+		newScene->m_MainCamera = other->m_MainCamera;
+
 		// Create entities in new scene
 		auto idView = srcSceneRegistry.view<IDComponent>();
 		for (auto e : idView)
 		{
 			UUID uuid = srcSceneRegistry.get<IDComponent>(e).ID;
+			if (uuid == other->m_Root) continue;
 			const auto& name = srcSceneRegistry.get<NameComponent>(e).name;
 			Entity newEntity = newScene->CreateEntityWithUUID(uuid, name);
 			enttMap[uuid] = (entt::entity)newEntity.m_EntityHandle;
 		}
 
-		// Copy components (except IDComponent and TagComponent)
+		// Copy components (except IDComponent)
 		CopyComponent(AllCopiableComponents{}, dstSceneRegistry, srcSceneRegistry, enttMap);
 
 		return newScene;
@@ -145,34 +184,208 @@ namespace kbs {
 
 	Entity Scene::CreateEntityWithUUID(UUID uuid, const std::string& name)
 	{
+		KBS_MEMORY_TAG(Scene);
 		Entity entity = { m_Registry.create(), this };
 		entity.AddComponent<IDComponent>(uuid);
-		auto& nameComp = entity.AddComponent<NameComponent>();
-		nameComp.name = name.empty() ? "Entity" : name;
+		entity.AddComponent<NameComponent>(name.empty() ? "Entity" : name);
 
 		m_EntityMap[uuid] = entity;
 
 		return entity;
 	}
 
+	std::vector<Entity> Scene::CreateEntities(uint32_t count, const std::string& name)
+	{
+		KBS_ASSERT(!IsIteratingInParallel(), "entities can't be created during a parallel iteration");
+		KBS_MEMORY_TAG(Scene);
+		std::vector<entt::entity> handles(count);
+		m_Registry.create(handles.begin(), handles.end());
+
+		std::vector<Entity> entities;
+		std::vector<IDComponent> ids(count);
+		entities.reserve(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			ids[i].ID = UUID::GenerateUncollidedID(m_EntityMap);
+			m_EntityMap[ids[i].ID] = handles[i];
+			entities.push_back(Entity(handles[i], this));
+		}
+		m_Registry.insert<IDComponent>(handles.begin(), handles.end(), ids.begin(), ids.end());
+		m_Registry.insert<NameComponent>(handles.begin(), handles.end(), NameComponent(name.empty() ? "Entity" : name));
+		return entities;
+	}
+
 	void Scene::DestroyEntity(Entity entity)
 	{
+		KBS_ASSERT(!IsIteratingInParallel(), "entities can't be destroyed during a parallel iteration");
 		m_EntityMap.erase(entity.GetUUID());
+		// removed before the id so the change sets can record it
+		m_Registry.remove_if_exists<TransformComponent, RenderableComponent, LightComponent, RayTracingGeometryComponent>(entity);
 		m_Registry.destroy(entity);
 	}
 
+	static uint64_t HashName(std::string_view name)
+	{
+		return Hasher::HashMemoryContent(name.data(), name.size());
+	}
+
+	static uint32_t GetEntityIndex(entt::entity e)
+	{
+		return (uint32_t)(entt::to_integral(e) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask);
+	}
+
 	Entity Scene::FindEntityByName(std::string_view name)
 	{
-		auto view = m_Registry.view<NameComponent>();
-		for (auto entity : view)
+		auto [begin, end] = m_NameIndex.equal_range(HashName(name));
+		for (auto iter = begin; iter != end; iter++)
 		{
-			const NameComponent& tc = view.get<NameComponent>(entity);
-			if (tc.name == name)
-				return Entity{ entity, this };
+			// hashes may collide
+			if (m_Registry.get<NameComponent>(iter->second).name == name)
+			{
+				return Entity{ iter->second, this };
+			}
 		}
 		return {};
 	}
 
+	std::vector<Entity> Scene::FindEntitiesByName(std::string_view name)
+	{
+		std::vector<Entity> entities;
+		auto [begin, end] = m_NameIndex.equal_range(HashName(name));
+		for (auto iter = begin; iter != end; iter++)
+		{
+			if (m_Registry.get<NameComponent>(iter->second).name == name)
+			{
+				entities.push_back(Entity{ iter->second, this });
+			}
+		}
+		return entities;
+	}
+
+	Entity Scene::FindEntityWithTag(InternedString tag)
+	{
+		auto group = m_TagGroups.find(tag);
+		if (group == m_TagGroups.end() || group->second.empty())
+		{
+			return {};
+		}
+		return Entity{ *group->second.begin(), this };
+	}
+
+	uint32_t Scene::GetEntityCountWithTag(InternedString tag)
+	{
+		auto group = m_TagGroups.find(tag);
+		return group == m_TagGroups.end() ? 0 : (uint32_t)group->second.size();
+	}
+
+	void Scene::IterateEntitiesWithTag(InternedString tag, std::function<void(Entity e)> visiter)
+	{
+		auto group = m_TagGroups.find(tag);
+		if (group == m_TagGroups.end())
+		{
+			return;
+		}
+		for (auto e : group->second)
+		{
+			visiter(Entity(e, this));
+		}
+	}
+
+	void Scene::OnNameConstructed(entt::registry&, entt::entity e)
+	{
+		uint64_t hash = HashName(m_Registry.get<NameComponent>(e).name);
+		uint32_t index = GetEntityIndex(e);
+		if (index >= m_IndexedNameHashes.size())
+		{
+			m_IndexedNameHashes.resize(std::max<size_t>(index + 1, m_IndexedNameHashes.size() * 2));
+		}
+		m_IndexedNameHashes[index] = hash;
+		m_NameIndex.emplace(hash, e);
+	}
+
+	void Scene::OnNameUpdated(entt::registry& registry, entt::entity e)
+	{
+		// the old name is gone already, the entity is found by the hash it was indexed with
+		OnNameDestroyed(registry, e);
+		OnNameConstructed(registry, e);
+	}
+
+	void Scene::OnNameDestroyed(entt::registry&, entt::entity e)
+	{
+		auto [begin, end] = m_NameIndex.equal_range(m_IndexedNameHashes[GetEntityIndex(e)]);
+		for (auto iter = begin; iter != end; iter++)
+		{
+			if (iter->second == e)
+			{
+				m_NameIndex.erase(iter);
+				return;
+			}
+		}
+	}
+
+	void Scene::OnTagsConstructed(entt::registry&, entt::entity e)
+	{
+		for (InternedString tag : m_Registry.get<TagComponent>(e).tags)
+		{
+			auto& group = m_TagGroups[tag];
+			if (!group.contains(e)) group.emplace(e);
+		}
+	}
+
+	void Scene::OnTagsUpdated(entt::registry& registry, entt::entity e)
+	{
+		// the old tags are gone already
+		for (auto& [tag, group] : m_TagGroups)
+		{
+			if (group.contains(e)) group.erase(e);
+		}
+		OnTagsConstructed(registry, e);
+	}
+
+	void Scene::OnTagsDestroyed(entt::registry&, entt::entity e)
+	{
+		for (InternedString tag : m_Registry.get<TagComponent>(e).tags)
+		{
+			if (auto group = m_TagGroups.find(tag); group != m_TagGroups.end() && group->second.contains(e))
+			{
+				group->second.erase(e);
+			}
+		}
+	}
+
+	void Scene::AddTag(entt::entity e, InternedString tag)
+	{
+		if (TagComponent* tags = m_Registry.try_get<TagComponent>(e))
+		{
+			if (std::find(tags->tags.begin(), tags->tags.end(), tag) == tags->tags.end())
+			{
+				tags->tags.push_back(tag);
+				m_TagGroups[tag].emplace(e);
+			}
+			return;
+		}
+		TagComponent tags;
+		tags.tags.push_back(tag);
+		m_Registry.emplace<TagComponent>(e, tags);
+	}
+
+	void Scene::RemoveTag(entt::entity e, InternedString tag)
+	{
+		TagComponent* tags = m_Registry.try_get<TagComponent>(e);
+		if (tags == nullptr) return;
+
+		auto iter = std::find(tags->tags.begin(), tags->tags.end(), tag);
+		if (iter == tags->tags.end()) return;
+		tags->tags.erase(iter);
+		m_TagGroups[tag].erase(e);
+	}
+
+	bool Scene::HasTag(entt::entity e, InternedString tag)
+	{
+		auto group = m_TagGroups.find(tag);
+		return group != m_TagGroups.end() && group->second.contains(e);
+	}
+
 	Entity Scene::GetEntityByUUID(UUID uuid)
 	{
 		// TODO(Yan): Maybe should be assert
@@ -185,5 +398,386 @@ namespace kbs {
 	{
 		return m_Root;
 	}
-}
 
+	void Scene::RebuildTransformHierarchy()
+	{
+		KBS_PROFILE_FUNCTION();
+		KBS_MEMORY_TAG(Scene);
+		entt::entity root = m_EntityMap[m_Root];
+
+		std::vector<TransformHierarchyNode> nodes;
+		std::unordered_map<entt::entity, uint32_t> nodeIndices;
+		auto view = m_Registry.view<TransformComponent>();
+		nodes.reserve(view.size());
+		nodeIndices.reserve(view.size());
+		for (auto e : view)
+		{
+			if (e == root) continue;
+			nodeIndices[e] = (uint32_t)nodes.size();
+			nodes.push_back(TransformHierarchyNode{ e, entt::null, view.get<TransformComponent>(e).parent, invalidNodeIndex });
+		}
+
+		// children of a node are stored contiguously, childOffsets[i] is the first child of node i
+		std::vector<uint32_t> childOffsets(nodes.size() + 1, 0);
+		std::vector<uint32_t> parents(nodes.size(), invalidNodeIndex);
+		for (uint32_t i = 0; i < nodes.size(); i++)
+		{
+			if (nodes[i].parent == m_Root) continue;
+			if (auto entity = m_EntityMap.find(nodes[i].parent); entity != m_EntityMap.end())
+			{
+				if (auto parent = nodeIndices.find(entity->second); parent != nodeIndices.end())
+				{
+					nodes[i].parentEntity = entity->second;
+					parents[i] = parent->second;
+					childOffsets[parent->second + 1]++;
+					continue;
+				}
+			}
+			KBS_WARN("parent of entity {} doesn't exist, it is treated as a child of the root", (uint32_t)nodes[i].entity);
+		}
+		for (uint32_t i = 0; i < nodes.size(); i++)
+		{
+			childOffsets[i + 1] += childOffsets[i];
+		}
+		std::vector<uint32_t> children(childOffsets.back());
+		std::vector<uint32_t> childCounts(nodes.size(), 0);
+		for (uint32_t i = 0; i < nodes.size(); i++)
+		{
+			if (parents[i] != invalidNodeIndex)
+			{
+				children[childOffsets[parents[i]] + childCounts[parents[i]]++] = i;
+			}
+		}
+
+		// breadth first from the children of the root, the output order doubles as the queue
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> newIndices(nodes.size(), invalidNodeIndex);
+		order.reserve(nodes.size());
+		auto visit = [&](uint32_t node, uint32_t parentIndex)
+		{
+			newIndices[node] = (uint32_t)order.size();
+			nodes[node].parentIndex = parentIndex;
+			order.push_back(node);
+		};
+		for (uint32_t i = 0; i < nodes.size(); i++)
+		{
+			if (parents[i] == invalidNodeIndex) visit(i, invalidNodeIndex);
+		}
+		uint32_t unvisited = 0;
+		for (uint32_t head = 0; ; head++)
+		{
+			if (head == order.size())
+			{
+				// the remaining nodes are parented in cycles, break each cycle at its first node
+				while (unvisited < nodes.size() && newIndices[unvisited] != invalidNodeIndex) unvisited++;
+				if (unvisited == nodes.size()) break;
+
+				KBS_WARN("entity {} is its own ancestor, it is treated as a child of the root", (uint32_t)nodes[unvisited].entity);
+				nodes[unvisited].parentEntity = entt::null;
+				visit(unvisited, invalidNodeIndex);
+			}
+
+			uint32_t node = order[head];
+			for (uint32_t c = childOffsets[node]; c < childOffsets[node + 1]; c++)
+			{
+				if (newIndices[children[c]] == invalidNodeIndex) visit(children[c], head);
+			}
+		}
+
+		// the parents the world transforms were computed under, only the nodes whose parent changed are marked
+		std::unordered_map<entt::entity, entt::entity> previousParents;
+		previousParents.reserve(m_TransformHierarchy.size());
+		for (auto& node : m_TransformHierarchy)
+		{
+			previousParents[node.entity] = node.parentEntity;
+		}
+
+		m_TransformHierarchy.clear();
+		m_TransformHierarchy.reserve(order.size());
+		m_TransformChanged.assign(order.size(), 0);
+		for (uint32_t node : order)
+		{
+			auto previous = previousParents.find(nodes[node].entity);
+			if (previous == previousParents.end() || previous->second != nodes[node].parentEntity)
+			{
+				m_TransformChanged[m_TransformHierarchy.size()] = 1;
+			}
+			m_TransformHierarchy.push_back(nodes[node]);
+		}
+
+		// entities which lost their TransformComponent
+		std::vector<entt::entity> staleEntities;
+		for (auto e : m_Registry.view<WorldTransformComponent>(entt::exclude<TransformComponent>))
+		{
+			staleEntities.push_back(e);
+		}
+		m_Registry.remove<WorldTransformComponent>(staleEntities.begin(), staleEntities.end());
+
+		for (uint32_t i = 0; i < m_TransformHierarchy.size(); i++)
+		{
+			entt::entity e = m_TransformHierarchy[i].entity;
+			if (!m_Registry.has<WorldTransformComponent>(e))
+			{
+				m_Registry.emplace<WorldTransformComponent>(e);
+				m_TransformChanged[i] = 1;
+			}
+		}
+		m_TransformHierarchyDirty = false;
+	}
+
+	void Scene::UpdateWorldTransforms()
+	{
+		KBS_PROFILE_FUNCTION();
+		UpdateWorldMatrices();
+		UpdateSpatialIndex();
+	}
+
+	void Scene::UpdateWorldMatrices()
+	{
+		bool rebuilt = m_TransformHierarchyDirty;
+		if (rebuilt)
+		{
+			RebuildTransformHierarchy();
+		}
+
+		// find the changed nodes first, their matrices are computed in batches
+		m_ChangedTransforms.clear();
+		for (uint32_t i = 0; i < m_TransformHierarchy.size(); i++)
+		{
+			const TransformHierarchyNode& node = m_TransformHierarchy[i];
+			const TransformComponent& local = m_Registry.get<TransformComponent>(node.entity);
+			if (local.parent != node.parent)
+			{
+				// reparented by writing the component, the order is no longer valid
+				m_TransformHierarchyDirty = true;
+				UpdateWorldMatrices();
+				return;
+			}
+
+			bool parentChanged = node.parentIndex != invalidNodeIndex && m_TransformChanged[node.parentIndex];
+			// a rebuild marks the new and reparented nodes, their subtrees follow through parentChanged
+			bool changed = (rebuilt && m_TransformChanged[i]) || parentChanged || !m_Registry.get<WorldTransformComponent>(node.entity).IsComputedFrom(local);
+			m_TransformChanged[i] = changed;
+			if (changed)
+			{
+				m_ChangedTransforms.push_back(i);
+				if (!m_ChangedWorldTransforms.contains(node.entity))
+				{
+					m_ChangedWorldTransforms.emplace(node.entity);
+				}
+			}
+		}
+		if (m_ChangedTransforms.empty())
+		{
+			return;
+		}
+
+		uint32_t changedCount = (uint32_t)m_ChangedTransforms.size();
+		m_ChangedLocals.Resize(changedCount);
+		for (uint32_t k = 0; k < changedCount; k++)
+		{
+			const TransformComponent& local = m_Registry.get<TransformComponent>(m_TransformHierarchy[m_ChangedTransforms[k]].entity);
+			m_ChangedLocals.Set(k, local.position, local.rotation, local.scale);
+		}
+		math::ComposeTRS(m_ChangedLocals, m_ChangedMatrices);
+
+		// parents come before their children, so their world matrices are already up to date
+		for (uint32_t k = 0; k < changedCount; k++)
+		{
+			const TransformHierarchyNode& node = m_TransformHierarchy[m_ChangedTransforms[k]];
+			const TransformComponent& local = m_Registry.get<TransformComponent>(node.entity);
+			WorldTransformComponent& world = m_Registry.get<WorldTransformComponent>(node.entity);
+
+			mat4 localMatrix = m_ChangedMatrices.Get(k);
+			if (node.parentIndex != invalidNodeIndex)
+			{
+				const WorldTransformComponent& parentWorld = m_Registry.get<WorldTransformComponent>(node.parentEntity);
+				world.world = parentWorld.world * localMatrix;
+				world.rotation = parentWorld.rotation * local.rotation;
+				m_ChangedMatrices.Set(k, world.world);
+			}
+			else
+			{
+				world.world = localMatrix;
+				world.rotation = local.rotation;
+			}
+			world.parent = local.parent;
+			world.parentEntity = node.parentIndex != invalidNodeIndex ? node.parentEntity : entt::null;
+			world.localPosition = local.position;
+			world.localRotation = local.rotation;
+			world.localScale = local.scale;
+		}
+
+		// the normal matrices are the transposed inverses of the world matrices
+		math::InverseAffine(m_ChangedMatrices, m_ChangedInverses);
+		for (uint32_t k = 0; k < changedCount; k++)
+		{
+			WorldTransformComponent& world = m_Registry.get<WorldTransformComponent>(m_TransformHierarchy[m_ChangedTransforms[k]].entity);
+			math::StoreMatrices(m_ChangedInverses, k, 1, &world.invTransWorld, true);
+		}
+	}
+
+	const WorldTransformComponent* Scene::GetCachedWorldTransform(entt::entity e, const TransformComponent& local)
+	{
+		const WorldTransformComponent* world = m_Registry.try_get<WorldTransformComponent>(e);
+		if (world == nullptr || !world->IsComputedFrom(local))
+		{
+			return nullptr;
+		}
+		// an ancestor moved since the last update leaves the world transforms of its whole subtree stale
+		for (entt::entity parent = world->parentEntity; parent != entt::null; )
+		{
+			if (!m_Registry.valid(parent))
+			{
+				return nullptr;
+			}
+			const TransformComponent* parentLocal = m_Registry.try_get<TransformComponent>(parent);
+			const WorldTransformComponent* parentWorld = m_Registry.try_get<WorldTransformComponent>(parent);
+			if (parentLocal == nullptr || parentWorld == nullptr || !parentWorld->IsComputedFrom(*parentLocal))
+			{
+				return nullptr;
+			}
+			parent = parentWorld->parentEntity;
+		}
+		return world;
+	}
+
+	template<SceneChangeType type>
+	void Scene::OnTrackedComponentDestroyed(entt::registry&, entt::entity e)
+	{
+		if (type == SceneChangeType::Transform && m_ChangedWorldTransforms.contains(e))
+		{
+			m_ChangedWorldTransforms.erase(e);
+		}
+		if (auto id = m_Registry.try_get<IDComponent>(e))
+		{
+			m_Changes[(uint32_t)type].removed.push_back(id->ID);
+		}
+	}
+
+	const SceneChangeSet& Scene::GetChanges(SceneChangeType type)
+	{
+		SceneChangeSet& changes = m_Changes[(uint32_t)type];
+		if (type == SceneChangeType::Transform)
+		{
+			changes.changed.assign(m_ChangedWorldTransforms.begin(), m_ChangedWorldTransforms.end());
+		}
+		else
+		{
+			const entt::observer& observer = m_ChangeObservers[(uint32_t)type - 1];
+			changes.changed.assign(observer.begin(), observer.end());
+		}
+		return changes;
+	}
+
+	void Scene::ClearChanges()
+	{
+		m_ChangedWorldTransforms.clear();
+		for (auto& observer : m_ChangeObservers)
+		{
+			observer.clear();
+		}
+		for (auto& changes : m_Changes)
+		{
+			changes.changed.clear();
+			changes.removed.clear();
+		}
+	}
+
+	void Scene::OnBoundsDestroyed(entt::registry&, entt::entity e)
+	{
+		uint32_t index = GetEntityIndex(e);
+		if (index < m_SpatialProxies.size() && m_SpatialProxies[index] != DynamicAABBTree::nullNode)
+		{
+			m_SpatialIndex.DestroyProxy(m_SpatialProxies[index]);
+			m_SpatialProxies[index] = DynamicAABBTree::nullNode;
+		}
+	}
+
+	void Scene::UpdateSpatialIndex()
+	{
+		KBS_PROFILE_SCOPE("UpdateSpatialIndex");
+		for (auto e : m_ChangedBounds)
+		{
+			// the entity may be destroyed after its bounds were changed
+			if (m_Registry.valid(e) && m_Registry.has<BoundsComponent>(e))
+			{
+				UpdateSpatialProxy(e);
+			}
+		}
+		m_ChangedBounds.clear();
+
+		for (uint32_t node : m_ChangedTransforms)
+		{
+			entt::entity e = m_TransformHierarchy[node].entity;
+			if (m_Registry.has<BoundsComponent>(e))
+			{
+				UpdateSpatialProxy(e);
+			}
+		}
+	}
+
+	void Scene::UpdateSpatialProxy(entt::entity e)
+	{
+		AABB bounds = m_Registry.get<BoundsComponent>(e).local;
+		if (auto world = m_Registry.try_get<WorldTransformComponent>(e))
+		{
+			bounds = bounds.Transform(world->world);
+		}
+
+		uint32_t index = GetEntityIndex(e);
+		if (index >= m_SpatialProxies.size())
+		{
+			m_SpatialProxies.resize(std::max<size_t>(index + 1, m_SpatialProxies.size() * 2), DynamicAABBTree::nullNode);
+		}
+		if (m_SpatialProxies[index] == DynamicAABBTree::nullNode)
+		{
+			m_SpatialProxies[index] = m_SpatialIndex.CreateProxy(bounds, entt::to_integral(e));
+		}
+		else
+		{
+			m_SpatialIndex.MoveProxy(m_SpatialProxies[index], bounds);
+		}
+	}
+
+	void Scene::QueryAABB(const AABB& box, std::function<void(Entity e)> visiter)
+	{
+		m_SpatialIndex.QueryAABB(box, [&](uint32_t e) { visiter(Entity((entt::entity)e, this)); });
+	}
+
+	void Scene::QuerySphere(const Sphere& sphere, std::function<void(Entity e)> visiter)
+	{
+		m_SpatialIndex.QuerySphere(sphere, [&](uint32_t e) { visiter(Entity((entt::entity)e, this)); });
+	}
+
+	void Scene::QueryFrustum(const Frustum& frustum, std::function<void(Entity e)> visiter)
+	{
+		m_SpatialIndex.QueryFrustum(frustum, [&](uint32_t e) { visiter(Entity((entt::entity)e, this)); });
+	}
+
+	Entity Scene::Raycast(const Ray& ray, float maxDistance, float* hitDistance)
+	{
+		Entity hit;
+		m_SpatialIndex.Raycast(ray, maxDistance,
+			[&](uint32_t e, float distance)
+			{
+				hit = Entity((entt::entity)e, this);
+				if (hitDistance != nullptr) *hitDistance = distance;
+				// only closer entities are visited afterwards
+				return distance;
+			}
+		);
+		return hit;
+	}
+
+	void Scene::RaycastAll(const Ray& ray, float maxDistance, std::function<void(Entity e, float distance)> visiter)
+	{
+		m_SpatialIndex.Raycast(ray, maxDistance,
+			[&](uint32_t e, float distance)
+			{
+				visiter(Entity((entt::entity)e, this), distance);
+				return maxDistance;
+			}
+		);
+	}
+}
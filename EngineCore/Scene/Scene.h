@@ -5,13 +5,39 @@
 #include "Scene/UUID.h"
 #include "Scene/entt/entt.h"
 #include "Scene/Components.h"
+#include "Math/TransformBatch.h"
+#include "Math/DynamicAABBTree.h"
+#include "Core/JobSystem.h"
+#include "Core/MemoryTracker.h"
 #include "Common.h"
+#include <atomic>
 
 // copied mostly from hazel
 namespace kbs
 {
 	class Entity;
 
+	// renderer relevant state tracked by the scene, see Scene::GetChanges
+	enum class SceneChangeType : uint32_t
+	{
+		// the world transform, changes inherited from an ancestor included
+		Transform,
+		Renderable,
+		Light,
+		RayTracingGeometry,
+		Count
+	};
+
+	struct SceneChangeSet
+	{
+		// entities which got the component or changed it, without duplicates and in no particular order
+		std::vector<entt::entity> changed;
+		// ids of entities which lost the component or were destroyed. apply them before the changed entities,
+		// an entity losing and getting the component again between two clears is in both lists.
+		// ids of entities which were never reported as changed can show up here
+		std::vector<UUID>		  removed;
+	};
+
 	class Scene
 	{
 	public:
@@ -29,13 +55,56 @@ namespace kbs
 		Entity CreateEntityWithUUID(UUID uuid, const std::string& name = std::string());
 		void DestroyEntity(Entity entity);
 
+		// bulk versions of CreateEntity and Entity::AddComponent, every entity created at once gets the same name.
+		// AddComponents inserts the components with one registry call, entities[i] gets components[i]
+		std::vector<Entity> CreateEntities(uint32_t count, const std::string& name = std::string());
+		template<typename T>
+		void AddComponents(const std::vector<Entity>& entities, const T* components)
+		{
+			KBS_ASSERT(!IsIteratingInParallel(), "components can't be added or removed during a parallel iteration");
+			KBS_MEMORY_TAG(Scene);
+			m_Registry.insert<T>(entities.begin(), entities.end(), components, components + entities.size());
+		}
+
+		// names are indexed, change them through Entity::SetName.
+		// any of the entities sharing a name may be returned
 		Entity FindEntityByName(std::string_view name);
+		std::vector<Entity> FindEntitiesByName(std::string_view name);
+
+		Entity	 FindEntityWithTag(InternedString tag);
+		uint32_t GetEntityCountWithTag(InternedString tag);
+		void	 IterateEntitiesWithTag(InternedString tag, std::function<void(Entity e)> visiter);
 		Entity GetEntityByUUID(UUID uuid);
 
 		UUID   GetRootID();
 
-		template<typename... Components>
-		void IterateAllEntitiesWith(std::function<void(Entity e)> visiter)
+		// recomputes the WorldTransformComponent of entities whose local transform or ancestors changed
+		// since the last call, parents are always updated before their children.
+		// the renderer calls it at the beginning of every frame
+		void   UpdateWorldTransforms();
+		// the world transform of e computed by the last UpdateWorldTransforms, nullptr if local or the local
+		// transform of an ancestor changed since
+		const WorldTransformComponent* GetCachedWorldTransform(entt::entity e, const TransformComponent& local);
+
+		// spatial queries over the world bounds of entities with a BoundsComponent,
+		// the bounds are updated by UpdateWorldTransforms
+		void   QueryAABB(const AABB& box, std::function<void(Entity e)> visiter);
+		void   QuerySphere(const Sphere& sphere, std::function<void(Entity e)> visiter);
+		void   QueryFrustum(const Frustum& frustum, std::function<void(Entity e)> visiter);
+		// the entity whose bounds the ray enters first, the distance is written to hitDistance if it is hit
+		Entity Raycast(const Ray& ray, float maxDistance = FLT_MAX, float* hitDistance = nullptr);
+		void   RaycastAll(const Ray& ray, float maxDistance, std::function<void(Entity e, float distance)> visiter);
+		const DynamicAABBTree& GetSpatialIndex() { return m_SpatialIndex; }
+
+		// the changes since the last ClearChanges, the render world collects and clears them on every extraction.
+		// world transforms are compared against their local transforms by UpdateWorldTransforms, a new or
+		// reparented transform marks its subtree. the other components are tracked through registry
+		// signals, change them with Entity::PatchComponent or AddOrReplaceComponent instead of writing them
+		const SceneChangeSet& GetChanges(SceneChangeType type);
+		void				  ClearChanges();
+
+		template<typename... Components, typename Func>
+		void IterateAllEntitiesWith(Func&& visiter)
 		{
 			for (auto e : m_Registry.view<Components...>())
 			{
@@ -43,15 +112,197 @@ namespace kbs
 			}
 		}
 
+		// calls func(Entity, Components&...) for every entity holding all of the components.
+		// components listed as const are passed as const references
+		template<typename... Components, typename Func>
+		void ForEach(Func&& func)
+		{
+			m_Registry.view<Components...>().each(
+				[&](entt::entity e, auto&... components)
+				{
+					func(Entity(e, this), components...);
+				}
+			);
+		}
+
+		// ForEach split into chunks of the component storage executed by the job system, the calling thread
+		// takes part and returns after every entity has been visited. while the iteration runs:
+		//   - const components may be read for any entity
+		//   - non-const components may only be written for the entity being visited
+		//   - components not listed must not be written
+		//   - entities and components must not be created or removed, this is asserted
+		// grainSize = 0 picks a chunk size by thread count
+		template<typename... Components, typename Func>
+		void ParallelForEach(Func&& func, uint32_t grainSize = 0)
+		{
+			auto view = m_Registry.view<Components...>();
+			std::pair<const entt::entity*, uint32_t> storage = GetLeadingStorage<Components...>(view);
+			const entt::entity* entities = storage.first;
+			ParallelIterationScope scope(this);
+			Singleton::GetInstance<JobSystem>()->ParallelFor(0, storage.second, grainSize,
+				[&](uint32_t first, uint32_t last)
+				{
+					VisitStorageRange<Components...>(view, entities, first, last, func);
+				}
+			);
+		}
+
+		// map(Entity, Components&...) returns the value of an entity, reduce(T, T) combines two values.
+		// the storage is cut into chunks of grainSize entities which are reduced from identity on their own,
+		// the chunk results are then combined in storage order. the result only depends on the contents of
+		// the storage and the grain size, not on the number of threads or on how the chunks were scheduled
+		template<typename... Components, typename T, typename Map, typename Reduce>
+		T ParallelReduce(T identity, Map&& map, Reduce&& reduce, uint32_t grainSize = parallelReduceGrainSize)
+		{
+			KBS_ASSERT(grainSize != 0, "the grain size of a reduction must not be 0");
+			auto view = m_Registry.view<Components...>();
+			std::pair<const entt::entity*, uint32_t> storage = GetLeadingStorage<Components...>(view);
+			const entt::entity* entities = storage.first;
+			uint32_t count = storage.second;
+			uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+			std::vector<T> chunkResults(chunkCount, identity);
+
+			ParallelIterationScope scope(this);
+			Singleton::GetInstance<JobSystem>()->ParallelForEach(0, chunkCount,
+				[&](uint32_t chunk)
+				{
+					T result = identity;
+					VisitStorageRange<Components...>(view, entities, chunk * grainSize, std::min((chunk + 1) * grainSize, count),
+						[&](auto e, auto&... components) { result = reduce(std::move(result), map(e, components...)); });
+					chunkResults[chunk] = std::move(result);
+				}, 1
+			);
+
+			T result = identity;
+			for (T& chunkResult : chunkResults)
+			{
+				result = reduce(std::move(result), std::move(chunkResult));
+			}
+			return result;
+		}
+
+		static constexpr uint32_t parallelReduceGrainSize = 4096;
+
+		// true while a ParallelForEach or ParallelReduce runs, the scene must not be changed structurally
+		bool IsIteratingInParallel() const { return m_ParallelIterations.load(std::memory_order_relaxed) != 0; }
+
 	private:
+		struct TransformHierarchyNode
+		{
+			entt::entity entity;
+			entt::entity parentEntity;
+			UUID		 parent;
+			// index of the parent node, invalidNodeIndex for children of the root
+			uint32_t	 parentIndex;
+		};
+		static constexpr uint32_t invalidNodeIndex = 0xffffffff;
+
+		void OnTransformHierarchyChanged(entt::registry&, entt::entity) { m_TransformHierarchyDirty = true; }
+		void OnNameConstructed(entt::registry&, entt::entity e);
+		void OnNameUpdated(entt::registry&, entt::entity e);
+		void OnNameDestroyed(entt::registry&, entt::entity e);
+		void OnTagsConstructed(entt::registry&, entt::entity e);
+		void OnTagsUpdated(entt::registry&, entt::entity e);
+		void OnTagsDestroyed(entt::registry&, entt::entity e);
+		void OnBoundsChanged(entt::registry&, entt::entity e) { m_ChangedBounds.push_back(e); }
+		void OnBoundsDestroyed(entt::registry&, entt::entity e);
+		template<SceneChangeType type>
+		void OnTrackedComponentDestroyed(entt::registry&, entt::entity e);
+
+		struct ParallelIterationScope
+		{
+			ParallelIterationScope(Scene* scene) : scene(scene) { scene->m_ParallelIterations++; }
+			~ParallelIterationScope() { scene->m_ParallelIterations--; }
+			Scene* scene;
+		};
+
+		// the smallest storage of the components leads the iteration, the others are checked per entity
+		template<typename... Components, typename View>
+		static std::pair<const entt::entity*, uint32_t> GetLeadingStorage(const View& view)
+		{
+			if constexpr (sizeof...(Components) == 1)
+			{
+				return { view.data(), (uint32_t)view.size() };
+			}
+			else
+			{
+				std::pair<const entt::entity*, uint32_t> leading{ nullptr, 0xffffffff };
+				auto select = [&](const entt::entity* data, uint32_t size) { if (size < leading.second) leading = { data, size }; };
+				(select(view.template data<Components>(), (uint32_t)view.template size<Components>()), ...);
+				return leading;
+			}
+		}
+
+		template<typename... Components, typename View, typename Func>
+		void VisitStorageRange(const View& view, const entt::entity* entities, uint32_t first, uint32_t last, Func&& func)
+		{
+			if constexpr (sizeof...(Components) == 1)
+			{
+				// entities and components of a single storage share their indices
+				auto* components = view.raw();
+				for (uint32_t i = first; i < last; i++)
+				{
+					func(Entity(entities[i], this), components[i]);
+				}
+			}
+			else
+			{
+				for (uint32_t i = first; i < last; i++)
+				{
+					entt::entity e = entities[i];
+					if (view.contains(e))
+					{
+						func(Entity(e, this), view.template get<Components>(e)...);
+					}
+				}
+			}
+		}
+
+		void AddTag(entt::entity e, InternedString tag);
+		void RemoveTag(entt::entity e, InternedString tag);
+		bool HasTag(entt::entity e, InternedString tag);
+		void RebuildTransformHierarchy();
+		void UpdateWorldMatrices();
+		void UpdateSpatialIndex();
+		void UpdateSpatialProxy(entt::entity e);
+
 		entt::registry	m_Registry;
 		std::unordered_map<UUID, entt::entity> m_EntityMap;
 		UUID m_Root;
 		opt<UUID> m_MainCamera ;
 
+		// name hash -> entity, m_IndexedNameHashes keeps the hash each entity is indexed by
+		std::unordered_multimap<uint64_t, entt::entity> m_NameIndex;
+		std::vector<uint64_t>							m_IndexedNameHashes;
+		std::unordered_map<InternedString, entt::sparse_set<entt::entity>> m_TagGroups;
+
+		// entities with TransformComponent in breadth first order from the root
+		std::vector<TransformHierarchyNode> m_TransformHierarchy;
+		std::vector<uint8_t>				m_TransformChanged;
+		bool								m_TransformHierarchyDirty = true;
+		// scratch buffers of UpdateWorldTransforms
+		std::vector<uint32_t>				m_ChangedTransforms;
+		TransformSoA						m_ChangedLocals;
+		AffineMatrixSoA						m_ChangedMatrices;
+		AffineMatrixSoA						m_ChangedInverses;
+
+		// world bounds of the entities with a BoundsComponent, m_SpatialProxies maps entity indices to proxies
+		DynamicAABBTree						m_SpatialIndex;
+		std::vector<uint32_t>				m_SpatialProxies;
+		// entities whose bounds were added or changed since the last update
+		std::vector<entt::entity>			m_ChangedBounds;
+
+		std::atomic<uint32_t>				m_ParallelIterations{ 0 };
+
+		// renderable, light and ray tracing geometry changes, indexed by SceneChangeType - 1
+		entt::observer						m_ChangeObservers[(uint32_t)SceneChangeType::Count - 1];
+		entt::sparse_set<entt::entity>		m_ChangedWorldTransforms;
+		SceneChangeSet						m_Changes[(uint32_t)SceneChangeType::Count];
+
 		friend class Entity;
 		friend class SceneSerializer;
 		friend class SceneHierarchyPanel;
+		friend class RenderWorld;
 	};
 
 }
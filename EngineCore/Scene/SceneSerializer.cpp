@@ -0,0 +1,1226 @@
+#include "Scene/SceneSerializer.h"
+#include "Scene/Entity.h"
+#include "Core/VirtualFileSystem.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
+#include "json.hpp"
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+namespace kbs
+{
+	using json = nlohmann::json;
+
+	// components stored as they are in the binary format
+	static_assert(std::is_trivially_copyable_v<TransformComponent>, "transform component must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<RenderableComponent>, "renderable component must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<CameraComponent>, "camera component must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<RayTracingGeometryComponent>, "ray tracing geometry component must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<LightComponent>, "light component must be trivially copyable");
+	static_assert(std::is_trivially_copyable_v<BoundsComponent>, "bounds component must be trivially copyable");
+
+	// the block each copiable component is saved in, a component without one would be dropped silently
+	template<typename T>
+	struct SceneComponentBlock { static constexpr bool saved = false; };
+	template<SceneBlockType block>
+	struct SceneSavedComponent { static constexpr bool saved = true; };
+	template<> struct SceneComponentBlock<TransformComponent> : SceneSavedComponent<SceneBlockType::Transform> {};
+	template<> struct SceneComponentBlock<RenderableComponent> : SceneSavedComponent<SceneBlockType::Renderable> {};
+	template<> struct SceneComponentBlock<CameraComponent> : SceneSavedComponent<SceneBlockType::Camera> {};
+	template<> struct SceneComponentBlock<CustomScriptCompoent> : SceneSavedComponent<SceneBlockType::CustomScript> {};
+	template<> struct SceneComponentBlock<RayTracingGeometryComponent> : SceneSavedComponent<SceneBlockType::RayTracingGeometry> {};
+	template<> struct SceneComponentBlock<LightComponent> : SceneSavedComponent<SceneBlockType::Light> {};
+	template<> struct SceneComponentBlock<TagComponent> : SceneSavedComponent<SceneBlockType::Tag> {};
+	template<> struct SceneComponentBlock<BoundsComponent> : SceneSavedComponent<SceneBlockType::Bounds> {};
+	template<> struct SceneComponentBlock<OccluderComponent> : SceneSavedComponent<SceneBlockType::Occluder> {};
+
+	template<typename... Components>
+	static constexpr bool AreComponentsSaved(ComponentGroup<Components...>)
+	{
+		return (SceneComponentBlock<Components>::saved && ...);
+	}
+	static_assert(AreComponentsSaved(AllCopiableComponents{}), "every copiable component must be saved in a block of the scene file");
+
+	// a string or blob in the string table
+	struct SceneStringRef
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	// elements [first, first + count) of the array following the ranges of a block
+	struct SceneRange
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	struct SceneScriptRecord
+	{
+		SceneStringRef name;
+		SceneStringRef data;
+	};
+
+	struct SceneAssetRecord
+	{
+		SceneAssetType type;
+		SceneStringRef name;
+		UUID		   id;
+	};
+
+	// the occluder block stores the mesh of each entity as an index into its mesh table,
+	// meshes shared by instances are saved once
+	struct SceneOccluderTable
+	{
+		uint32_t meshCount;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+	};
+
+	struct SceneOccluderRecord
+	{
+		SceneRange vertices;
+		SceneRange indices;
+	};
+
+	static constexpr uint64_t sceneBlockAlignment = 16;
+	static constexpr uint32_t sceneBlockCount = (uint32_t)SceneBlockType::Occluder + 1;
+	static constexpr uint32_t invalidEntityIndex = 0xffffffff;
+
+	static uint64_t AlignBlockOffset(uint64_t offset)
+	{
+		return (offset + sceneBlockAlignment - 1) / sceneBlockAlignment * sceneBlockAlignment;
+	}
+
+	static uint32_t GetEntityIndex(entt::entity e)
+	{
+		return (uint32_t)(entt::to_integral(e) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask);
+	}
+
+	static const char* GetAssetTypeName(SceneAssetType type)
+	{
+		switch (type)
+		{
+		case SceneAssetType::Mesh:
+			return "mesh";
+		case SceneAssetType::Material:
+			return "material";
+		default:
+			return "ray tracing material";
+		}
+	}
+
+	// the names of the assets a scene refers to, collected while it is saved
+	class SceneAssetNames
+	{
+	public:
+		struct Name
+		{
+			SceneAssetType type;
+			UUID		   id;
+			std::string	   name;
+		};
+
+		SceneAssetNames(SceneAssetResolver* resolver, entt::registry& registry)
+			: m_Resolver(resolver)
+		{
+			if (m_Resolver == nullptr) return;
+			for (auto e : registry.view<RenderableComponent>())
+			{
+				const RenderableComponent& render = registry.get<RenderableComponent>(e);
+				Add(SceneAssetType::Mesh, render.targetMesh);
+				for (uint32_t i = 0; i < render.passCount; i++)
+				{
+					Add(SceneAssetType::Material, render.targetMaterials[i]);
+				}
+			}
+			for (auto e : registry.view<RayTracingGeometryComponent>())
+			{
+				Add(SceneAssetType::RTMaterial, registry.get<RayTracingGeometryComponent>(e).rayTracingMaterial);
+			}
+		}
+
+		const std::vector<Name>& GetNames() { return m_Names; }
+
+	private:
+		void Add(SceneAssetType type, UUID id)
+		{
+			if (id == UUID::Invalid() || !m_Visited[(uint32_t)type].insert(id).second) return;
+			std::string name = m_Resolver->GetAssetName(type, id);
+			if (!name.empty())
+			{
+				m_Names.push_back(Name{ type, id, std::move(name) });
+			}
+		}
+
+		SceneAssetResolver*		 m_Resolver;
+		std::unordered_set<UUID> m_Visited[(uint32_t)SceneAssetType::Count];
+		std::vector<Name>		 m_Names;
+	};
+
+	// maps the saved ids of the named assets to their ids in the loading process
+	class SceneAssetRemap
+	{
+	public:
+		SceneAssetRemap(SceneAssetResolver* resolver) : m_Resolver(resolver) {}
+
+		// names which aren't found keep their saved id
+		void Add(SceneAssetType type, UUID id, std::string_view name)
+		{
+			if (m_Resolver == nullptr) return;
+			if (opt<UUID> found = m_Resolver->FindAsset(type, name); found.has_value())
+			{
+				m_Ids[(uint32_t)type][id] = found.value();
+				return;
+			}
+			KBS_WARN("{} {} referenced by the scene file can't be found", GetAssetTypeName(type), std::string(name).c_str());
+		}
+
+		void Apply(entt::registry& registry)
+		{
+			for (auto e : registry.view<RenderableComponent>())
+			{
+				RenderableComponent& render = registry.get<RenderableComponent>(e);
+				render.targetMesh = Get(SceneAssetType::Mesh, render.targetMesh);
+				for (uint32_t i = 0; i < render.passCount; i++)
+				{
+					render.targetMaterials[i] = Get(SceneAssetType::Material, render.targetMaterials[i]);
+				}
+			}
+			for (auto e : registry.view<RayTracingGeometryComponent>())
+			{
+				RayTracingGeometryComponent& geometry = registry.get<RayTracingGeometryComponent>(e);
+				geometry.rayTracingMaterial = Get(SceneAssetType::RTMaterial, geometry.rayTracingMaterial);
+			}
+		}
+
+	private:
+		UUID Get(SceneAssetType type, UUID id)
+		{
+			auto& ids = m_Ids[(uint32_t)type];
+			auto iter = ids.find(id);
+			return iter == ids.end() ? id : iter->second;
+		}
+
+		SceneAssetResolver*			   m_Resolver;
+		std::unordered_map<UUID, UUID> m_Ids[(uint32_t)SceneAssetType::Count];
+	};
+
+	// the triangles of an occluder mesh must only use its own vertices
+	static bool IsValidOccluderMesh(uint64_t vertexCount, const uint32_t* indices, uint64_t indexCount)
+	{
+		for (uint64_t i = 0; i < indexCount; i++)
+		{
+			if (indices[i] >= vertexCount) return false;
+		}
+		return true;
+	}
+
+	static entt::entity FindRootEntity(entt::registry& registry, UUID root)
+	{
+		for (auto e : registry.view<IDComponent>())
+		{
+			if (registry.get<IDComponent>(e).ID == root)
+			{
+				return e;
+			}
+		}
+		return entt::null;
+	}
+
+	class SceneBinaryWriter
+	{
+	public:
+		SceneBinaryWriter(std::vector<uint8_t>& data) : m_Data(data) {}
+
+		void BeginBlock(SceneBlockType type, uint32_t count)
+		{
+			m_Blocks.push_back(SceneBlock{ type, count, AlignBlockOffset(m_Data.size()), 0 });
+		}
+
+		void EndBlock()
+		{
+			m_Blocks.back().size = m_Data.size() - m_Blocks.back().offset;
+		}
+
+		// arrays of a block start at aligned offsets
+		template<typename T>
+		void WriteArray(const T* values, uint64_t count)
+		{
+			m_Data.resize(AlignBlockOffset(m_Data.size()));
+			const uint8_t* bytes = (const uint8_t*)values;
+			m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T) * count);
+		}
+
+		template<typename T>
+		void WriteArray(const std::vector<T>& values)
+		{
+			WriteArray(values.data(), values.size());
+		}
+
+		SceneStringRef AddString(std::string_view str)
+		{
+			SceneStringRef ref{ (uint32_t)m_Strings.size(), (uint32_t)str.size() };
+			m_Strings.append(str);
+			return ref;
+		}
+
+		std::vector<SceneBlock>& GetBlocks() { return m_Blocks; }
+		const std::string&		 GetStrings() { return m_Strings; }
+
+	private:
+		std::vector<uint8_t>&	m_Data;
+		std::vector<SceneBlock> m_Blocks;
+		std::string				m_Strings;
+	};
+
+	class SceneBlockReader
+	{
+	public:
+		SceneBlockReader(const uint8_t* data, const SceneBlock& block)
+			: m_Data(data), m_Cursor(block.offset), m_End(block.offset + block.size) {}
+
+		// nullptr if the array doesn't fit in the block
+		template<typename T>
+		const T* ReadArray(uint64_t count)
+		{
+			uint64_t offset = AlignBlockOffset(m_Cursor);
+			if (offset > m_End || count > (m_End - offset) / sizeof(T))
+			{
+				return nullptr;
+			}
+			m_Cursor = offset + sizeof(T) * count;
+			return (const T*)(m_Data + offset);
+		}
+
+		// number of T left in the block
+		template<typename T>
+		uint64_t GetRemainCount()
+		{
+			uint64_t offset = AlignBlockOffset(m_Cursor);
+			return offset > m_End ? 0 : (m_End - offset) / sizeof(T);
+		}
+
+	private:
+		const uint8_t* m_Data;
+		uint64_t	   m_Cursor;
+		uint64_t	   m_End;
+	};
+
+	struct SceneBlockView
+	{
+		const SceneBlock* block = nullptr;
+		SceneBlockReader  reader = SceneBlockReader(nullptr, SceneBlock{});
+		const uint32_t*	  indices = nullptr;
+	};
+
+	// one array per entity of the block following its entity indices, nullptr if the block is missing or truncated
+	template<typename T>
+	static const T* ReadBlockComponents(SceneBlockView& view)
+	{
+		return view.block == nullptr ? nullptr : view.reader.ReadArray<T>(view.block->count);
+	}
+
+	// the entities of a component block, written in the order of the component array
+	template<typename T>
+	static std::vector<entt::entity> CollectBlockEntities(entt::registry& registry, const std::vector<uint32_t>& entityIndices,
+		std::vector<uint32_t>& indices)
+	{
+		std::vector<entt::entity> entities;
+		for (auto e : registry.view<T>())
+		{
+			uint32_t index = GetEntityIndex(e);
+			// the root is not serialized
+			if (index >= entityIndices.size() || entityIndices[index] == invalidEntityIndex) continue;
+			indices.push_back(entityIndices[index]);
+			entities.push_back(e);
+		}
+		return entities;
+	}
+
+	template<typename T>
+	static void WriteComponentBlock(SceneBinaryWriter& writer, SceneBlockType type, entt::registry& registry, const std::vector<uint32_t>& entityIndices)
+	{
+		std::vector<uint32_t> indices;
+		std::vector<entt::entity> entities = CollectBlockEntities<T>(registry, entityIndices, indices);
+		std::vector<T> components;
+		components.reserve(entities.size());
+		for (auto e : entities)
+		{
+			components.push_back(registry.get<T>(e));
+		}
+
+		writer.BeginBlock(type, (uint32_t)indices.size());
+		writer.WriteArray(indices);
+		writer.WriteArray(components);
+		writer.EndBlock();
+	}
+
+	std::vector<uint8_t> SceneSerializer::SerializeBinary()
+	{
+		KBS_PROFILE_FUNCTION();
+		Scene& scene = *m_Scene;
+		entt::registry& registry = scene.m_Registry;
+
+		std::vector<UUID> ids;
+		std::vector<uint32_t> entityIndices;
+		for (auto e : registry.view<IDComponent>())
+		{
+			UUID id = registry.get<IDComponent>(e).ID;
+			if (id == scene.m_Root) continue;
+
+			uint32_t index = GetEntityIndex(e);
+			if (index >= entityIndices.size())
+			{
+				entityIndices.resize(std::max<size_t>(index + 1, entityIndices.size() * 2), invalidEntityIndex);
+			}
+			entityIndices[index] = (uint32_t)ids.size();
+			ids.push_back(id);
+		}
+
+		std::vector<uint8_t> data(sizeof(SceneFileHeader) + sizeof(SceneBlock) * sceneBlockCount);
+		SceneBinaryWriter writer(data);
+
+		writer.BeginBlock(SceneBlockType::Entity, (uint32_t)ids.size());
+		writer.WriteArray(ids);
+		writer.EndBlock();
+
+		{
+			std::vector<uint32_t> indices;
+			std::vector<entt::entity> entities = CollectBlockEntities<NameComponent>(registry, entityIndices, indices);
+			std::vector<SceneStringRef> names;
+			names.reserve(entities.size());
+			for (auto e : entities)
+			{
+				names.push_back(writer.AddString(registry.get<NameComponent>(e).name));
+			}
+			writer.BeginBlock(SceneBlockType::Name, (uint32_t)indices.size());
+			writer.WriteArray(indices);
+			writer.WriteArray(names);
+			writer.EndBlock();
+		}
+
+		WriteComponentBlock<TransformComponent>(writer, SceneBlockType::Transform, registry, entityIndices);
+		WriteComponentBlock<RenderableComponent>(writer, SceneBlockType::Renderable, registry, entityIndices);
+		WriteComponentBlock<CameraComponent>(writer, SceneBlockType::Camera, registry, entityIndices);
+
+		{
+			std::vector<uint32_t> indices;
+			std::vector<entt::entity> entities = CollectBlockEntities<CustomScriptCompoent>(registry, entityIndices, indices);
+			std::vector<SceneRange> ranges;
+			std::vector<SceneScriptRecord> scripts;
+			for (auto e : entities)
+			{
+				auto& component = registry.get<CustomScriptCompoent>(e);
+				ranges.push_back(SceneRange{ (uint32_t)scripts.size(), (uint32_t)component.scripts.size() });
+				for (auto& script : component.scripts)
+				{
+					scripts.push_back(SceneScriptRecord{ writer.AddString(script.name),
+						writer.AddString(std::string_view((const char*)script.data.data(), script.data.size())) });
+				}
+			}
+			writer.BeginBlock(SceneBlockType::CustomScript, (uint32_t)indices.size());
+			writer.WriteArray(indices);
+			writer.WriteArray(ranges);
+			writer.WriteArray(scripts);
+			writer.EndBlock();
+		}
+
+		WriteComponentBlock<RayTracingGeometryComponent>(writer, SceneBlockType::RayTracingGeometry, registry, entityIndices);
+		WriteComponentBlock<LightComponent>(writer, SceneBlockType::Light, registry, entityIndices);
+
+		{
+			std::vector<uint32_t> indices;
+			std::vector<entt::entity> entities = CollectBlockEntities<TagComponent>(registry, entityIndices, indices);
+			std::vector<SceneRange> ranges;
+			std::vector<SceneStringRef> tags;
+			for (auto e : entities)
+			{
+				auto& component = registry.get<TagComponent>(e);
+				ranges.push_back(SceneRange{ (uint32_t)tags.size(), (uint32_t)component.tags.size() });
+				for (auto tag : component.tags)
+				{
+					tags.push_back(writer.AddString(tag.GetString()));
+				}
+			}
+			writer.BeginBlock(SceneBlockType::Tag, (uint32_t)indices.size());
+			writer.WriteArray(indices);
+			writer.WriteArray(ranges);
+			writer.WriteArray(tags);
+			writer.EndBlock();
+		}
+
+		WriteComponentBlock<BoundsComponent>(writer, SceneBlockType::Bounds, registry, entityIndices);
+
+		{
+			SceneAssetNames assetNames(m_Resolver.get(), registry);
+			std::vector<SceneAssetRecord> assets;
+			for (auto& asset : assetNames.GetNames())
+			{
+				assets.push_back(SceneAssetRecord{ asset.type, writer.AddString(asset.name), asset.id });
+			}
+			writer.BeginBlock(SceneBlockType::Asset, (uint32_t)assets.size());
+			writer.WriteArray(assets);
+			writer.EndBlock();
+		}
+
+		{
+			std::vector<uint32_t> indices;
+			std::vector<entt::entity> entities = CollectBlockEntities<OccluderComponent>(registry, entityIndices, indices);
+			std::unordered_map<const OccluderMesh*, uint32_t> meshIndices;
+			std::vector<uint32_t> entityMeshes;
+			std::vector<SceneOccluderRecord> meshes;
+			std::vector<vec3> vertices;
+			std::vector<uint32_t> triangles;
+			for (auto e : entities)
+			{
+				const OccluderMesh* mesh = registry.get<OccluderComponent>(e).mesh.get();
+				auto [iter, inserted] = meshIndices.try_emplace(mesh, (uint32_t)meshes.size());
+				if (inserted)
+				{
+					// an occluder without a mesh is saved with an empty one
+					SceneOccluderRecord record{ { (uint32_t)vertices.size(), 0 }, { (uint32_t)triangles.size(), 0 } };
+					if (mesh != nullptr)
+					{
+						record.vertices.count = (uint32_t)mesh->vertices.size();
+						record.indices.count = (uint32_t)mesh->indices.size();
+						vertices.insert(vertices.end(), mesh->vertices.begin(), mesh->vertices.end());
+						triangles.insert(triangles.end(), mesh->indices.begin(), mesh->indices.end());
+					}
+					meshes.push_back(record);
+				}
+				entityMeshes.push_back(iter->second);
+			}
+			SceneOccluderTable table{ (uint32_t)meshes.size(), (uint32_t)vertices.size(), (uint32_t)triangles.size() };
+
+			writer.BeginBlock(SceneBlockType::Occluder, (uint32_t)indices.size());
+			writer.WriteArray(indices);
+			writer.WriteArray(entityMeshes);
+			writer.WriteArray(&table, 1);
+			writer.WriteArray(meshes);
+			writer.WriteArray(vertices);
+			writer.WriteArray(triangles);
+			writer.EndBlock();
+		}
+
+		SceneFileHeader header{};
+		header.fileMagic = SceneFileHeader::magic;
+		header.version = SceneFileHeader::currentVersion;
+		header.entityCount = (uint32_t)ids.size();
+		header.blockCount = sceneBlockCount;
+		header.root = scene.m_Root;
+		header.mainCamera = scene.m_MainCamera.value_or(UUID::Invalid());
+		header.stringOffset = AlignBlockOffset(data.size());
+		header.stringSize = writer.GetStrings().size();
+		writer.WriteArray(writer.GetStrings().data(), writer.GetStrings().size());
+
+		memcpy(data.data(), &header, sizeof(header));
+		memcpy(data.data() + sizeof(header), writer.GetBlocks().data(), sizeof(SceneBlock) * sceneBlockCount);
+
+		return data;
+	}
+
+	bool SceneSerializer::DeserializeBinary(const uint8_t* data, uint64_t size)
+	{
+		KBS_PROFILE_FUNCTION();
+		KBS_MEMORY_TAG(Scene);
+		Scene& scene = *m_Scene;
+		entt::registry& registry = scene.m_Registry;
+		KBS_ASSERT(scene.m_EntityMap.empty(), "scenes can only be deserialized into a scene holding nothing but its root");
+
+		if (size < sizeof(SceneFileHeader))
+		{
+			KBS_WARN("scene file is too small");
+			return false;
+		}
+		const SceneFileHeader* header = (const SceneFileHeader*)data;
+		if (header->fileMagic != SceneFileHeader::magic)
+		{
+			KBS_WARN("scene file has an invalid magic number");
+			return false;
+		}
+		if (header->version != SceneFileHeader::currentVersion)
+		{
+			KBS_WARN("scene file version {} is not supported, current version is {}", header->version, SceneFileHeader::currentVersion);
+			return false;
+		}
+		if (header->blockCount > (size - sizeof(SceneFileHeader)) / sizeof(SceneBlock) ||
+			header->stringOffset > size || header->stringSize > size - header->stringOffset)
+		{
+			KBS_WARN("scene file is truncated");
+			return false;
+		}
+
+		// validate everything before the scene is modified
+		const SceneBlock* blocks = (const SceneBlock*)(data + sizeof(SceneFileHeader));
+		const SceneBlock* typedBlocks[sceneBlockCount] = {};
+		for (uint32_t i = 0; i < header->blockCount; i++)
+		{
+			if (blocks[i].offset > size || blocks[i].size > size - blocks[i].offset)
+			{
+				KBS_WARN("block {} of the scene file is out of range", i);
+				return false;
+			}
+			// blocks added by later versions are skipped
+			if ((uint32_t)blocks[i].type < sceneBlockCount)
+			{
+				typedBlocks[(uint32_t)blocks[i].type] = &blocks[i];
+			}
+		}
+		if (typedBlocks[(uint32_t)SceneBlockType::Entity] == nullptr || typedBlocks[(uint32_t)SceneBlockType::Entity]->count != header->entityCount)
+		{
+			KBS_WARN("scene file has no valid entity block");
+			return false;
+		}
+
+		const char* strings = (const char*)(data + header->stringOffset);
+		auto validString = [&](SceneStringRef ref) { return ref.offset <= header->stringSize && ref.length <= header->stringSize - ref.offset; };
+		auto getString = [&](SceneStringRef ref) { return std::string_view(strings + ref.offset, ref.length); };
+
+		SceneBlockView views[sceneBlockCount];
+		// an entity holds a component once, the stamp of the block marks the entities it already listed
+		std::vector<uint32_t> listedBy(header->entityCount, 0);
+		for (uint32_t i = 0; i < sceneBlockCount; i++)
+		{
+			if (typedBlocks[i] == nullptr || i == (uint32_t)SceneBlockType::Entity || i == (uint32_t)SceneBlockType::Asset) continue;
+			views[i].block = typedBlocks[i];
+			views[i].reader = SceneBlockReader(data, *typedBlocks[i]);
+			views[i].indices = views[i].reader.ReadArray<uint32_t>(typedBlocks[i]->count);
+			bool valid = views[i].indices != nullptr;
+			for (uint32_t k = 0; valid && k < typedBlocks[i]->count; k++)
+			{
+				uint32_t index = views[i].indices[k];
+				valid = index < header->entityCount && listedBy[index] != i + 1;
+				if (valid)
+				{
+					listedBy[index] = i + 1;
+				}
+			}
+			if (!valid)
+			{
+				KBS_WARN("block {} of the scene file has invalid entity indices", i);
+				return false;
+			}
+		}
+
+		SceneBlockReader entityReader(data, *typedBlocks[(uint32_t)SceneBlockType::Entity]);
+		const UUID* ids = entityReader.ReadArray<UUID>(header->entityCount);
+		if (ids == nullptr)
+		{
+			KBS_WARN("entity block of the scene file is truncated");
+			return false;
+		}
+		std::unordered_set<UUID> uniqueIds;
+		uniqueIds.reserve(header->entityCount + 1);
+		uniqueIds.insert(header->root);
+		for (uint32_t i = 0; i < header->entityCount; i++)
+		{
+			if (!uniqueIds.insert(ids[i]).second)
+			{
+				KBS_WARN("entity {} of the scene file has a duplicated id", i);
+				return false;
+			}
+		}
+
+		// component arrays of the trivially copyable components, straight from the file
+		auto transforms = ReadBlockComponents<TransformComponent>(views[(uint32_t)SceneBlockType::Transform]);
+		auto renderables = ReadBlockComponents<RenderableComponent>(views[(uint32_t)SceneBlockType::Renderable]);
+		auto cameras = ReadBlockComponents<CameraComponent>(views[(uint32_t)SceneBlockType::Camera]);
+		auto geometries = ReadBlockComponents<RayTracingGeometryComponent>(views[(uint32_t)SceneBlockType::RayTracingGeometry]);
+		auto lights = ReadBlockComponents<LightComponent>(views[(uint32_t)SceneBlockType::Light]);
+		auto bounds = ReadBlockComponents<BoundsComponent>(views[(uint32_t)SceneBlockType::Bounds]);
+
+		auto names = ReadBlockComponents<SceneStringRef>(views[(uint32_t)SceneBlockType::Name]);
+		auto scriptRanges = ReadBlockComponents<SceneRange>(views[(uint32_t)SceneBlockType::CustomScript]);
+		auto tagRanges = ReadBlockComponents<SceneRange>(views[(uint32_t)SceneBlockType::Tag]);
+		auto occluderMeshIndices = ReadBlockComponents<uint32_t>(views[(uint32_t)SceneBlockType::Occluder]);
+		const SceneScriptRecord* scripts = nullptr;
+		const SceneStringRef* tags = nullptr;
+		uint64_t scriptCount = 0, tagCount = 0;
+		if (scriptRanges != nullptr)
+		{
+			scriptCount = views[(uint32_t)SceneBlockType::CustomScript].reader.GetRemainCount<SceneScriptRecord>();
+			scripts = views[(uint32_t)SceneBlockType::CustomScript].reader.ReadArray<SceneScriptRecord>(scriptCount);
+		}
+		if (tagRanges != nullptr)
+		{
+			tagCount = views[(uint32_t)SceneBlockType::Tag].reader.GetRemainCount<SceneStringRef>();
+			tags = views[(uint32_t)SceneBlockType::Tag].reader.ReadArray<SceneStringRef>(tagCount);
+		}
+
+		const SceneAssetRecord* assets = nullptr;
+		if (const SceneBlock* assetBlock = typedBlocks[(uint32_t)SceneBlockType::Asset])
+		{
+			SceneBlockReader assetReader(data, *assetBlock);
+			assets = assetReader.ReadArray<SceneAssetRecord>(assetBlock->count);
+		}
+
+		const SceneOccluderTable* occluderTable = nullptr;
+		const SceneOccluderRecord* occluderMeshes = nullptr;
+		const vec3* occluderVertices = nullptr;
+		const uint32_t* occluderIndices = nullptr;
+		if (occluderMeshIndices != nullptr)
+		{
+			SceneBlockReader& reader = views[(uint32_t)SceneBlockType::Occluder].reader;
+			occluderTable = reader.ReadArray<SceneOccluderTable>(1);
+			if (occluderTable != nullptr)
+			{
+				occluderMeshes = reader.ReadArray<SceneOccluderRecord>(occluderTable->meshCount);
+				occluderVertices = reader.ReadArray<vec3>(occluderTable->vertexCount);
+				occluderIndices = reader.ReadArray<uint32_t>(occluderTable->indexCount);
+			}
+		}
+
+		bool valid = true;
+		auto checkBlock = [&](SceneBlockType type, const void* array)
+		{
+			valid = valid && (views[(uint32_t)type].block == nullptr || array != nullptr);
+		};
+		checkBlock(SceneBlockType::Transform, transforms);
+		checkBlock(SceneBlockType::Renderable, renderables);
+		checkBlock(SceneBlockType::Camera, cameras);
+		checkBlock(SceneBlockType::RayTracingGeometry, geometries);
+		checkBlock(SceneBlockType::Light, lights);
+		checkBlock(SceneBlockType::Bounds, bounds);
+		checkBlock(SceneBlockType::Name, names);
+		checkBlock(SceneBlockType::CustomScript, scriptRanges);
+		checkBlock(SceneBlockType::Tag, tagRanges);
+		valid = valid && (typedBlocks[(uint32_t)SceneBlockType::Asset] == nullptr || assets != nullptr);
+		checkBlock(SceneBlockType::Occluder, occluderIndices);
+		for (uint32_t i = 0; valid && renderables != nullptr && i < views[(uint32_t)SceneBlockType::Renderable].block->count; i++)
+		{
+			valid = renderables[i].passCount <= RenderableComponent::maxPassCount;
+		}
+		for (uint32_t i = 0; valid && names != nullptr && i < views[(uint32_t)SceneBlockType::Name].block->count; i++)
+		{
+			valid = validString(names[i]);
+		}
+		for (uint32_t i = 0; valid && scriptRanges != nullptr && i < views[(uint32_t)SceneBlockType::CustomScript].block->count; i++)
+		{
+			valid = scriptRanges[i].first <= scriptCount && scriptRanges[i].count <= scriptCount - scriptRanges[i].first;
+		}
+		for (uint64_t i = 0; valid && i < scriptCount; i++)
+		{
+			valid = validString(scripts[i].name) && validString(scripts[i].data);
+		}
+		for (uint32_t i = 0; valid && tagRanges != nullptr && i < views[(uint32_t)SceneBlockType::Tag].block->count; i++)
+		{
+			valid = tagRanges[i].first <= tagCount && tagRanges[i].count <= tagCount - tagRanges[i].first;
+		}
+		for (uint64_t i = 0; valid && i < tagCount; i++)
+		{
+			valid = validString(tags[i]);
+		}
+		for (uint32_t i = 0; valid && assets != nullptr && i < typedBlocks[(uint32_t)SceneBlockType::Asset]->count; i++)
+		{
+			valid = assets[i].type < SceneAssetType::Count && validString(assets[i].name);
+		}
+		for (uint32_t i = 0; valid && occluderIndices != nullptr && i < views[(uint32_t)SceneBlockType::Occluder].block->count; i++)
+		{
+			valid = occluderMeshIndices[i] < occluderTable->meshCount;
+		}
+		for (uint32_t i = 0; valid && occluderIndices != nullptr && i < occluderTable->meshCount; i++)
+		{
+			const SceneOccluderRecord& mesh = occluderMeshes[i];
+			valid = mesh.vertices.first <= occluderTable->vertexCount && mesh.vertices.count <= occluderTable->vertexCount - mesh.vertices.first &&
+				mesh.indices.first <= occluderTable->indexCount && mesh.indices.count <= occluderTable->indexCount - mesh.indices.first &&
+				IsValidOccluderMesh(mesh.vertices.count, occluderIndices + mesh.indices.first, mesh.indices.count);
+		}
+		if (!valid)
+		{
+			KBS_WARN("scene file has corrupted component blocks");
+			return false;
+		}
+
+		// the scene takes over the id of the serialized root
+		entt::entity root = FindRootEntity(registry, scene.m_Root);
+		registry.get<IDComponent>(root).ID = header->root;
+		registry.get<TransformComponent>(root).parent = header->root;
+		scene.m_Root = header->root;
+		if (header->mainCamera != UUID::Invalid())
+		{
+			scene.m_MainCamera = header->mainCamera;
+		}
+
+		std::vector<entt::entity> entities(header->entityCount);
+		registry.create(entities.begin(), entities.end());
+		{
+			std::vector<IDComponent> idComponents(header->entityCount);
+			scene.m_EntityMap.reserve(header->entityCount);
+			for (uint32_t i = 0; i < header->entityCount; i++)
+			{
+				idComponents[i].ID = ids[i];
+				scene.m_EntityMap[ids[i]] = entities[i];
+			}
+			registry.insert<IDComponent>(entities.begin(), entities.end(), idComponents.begin(), idComponents.end());
+		}
+
+		std::vector<entt::entity> blockEntities;
+		auto gatherBlockEntities = [&](SceneBlockType type)
+		{
+			SceneBlockView& view = views[(uint32_t)type];
+			blockEntities.resize(view.block->count);
+			for (uint32_t i = 0; i < view.block->count; i++)
+			{
+				blockEntities[i] = entities[view.indices[i]];
+			}
+		};
+		auto insertComponents = [&](SceneBlockType type, auto* components)
+		{
+			using T = std::remove_const_t<std::remove_pointer_t<decltype(components)>>;
+			if (components == nullptr) return;
+			gatherBlockEntities(type);
+			registry.insert<T>(blockEntities.begin(), blockEntities.end(), components, components + blockEntities.size());
+		};
+
+		if (names != nullptr)
+		{
+			gatherBlockEntities(SceneBlockType::Name);
+			std::vector<NameComponent> nameComponents(blockEntities.size());
+			for (uint32_t i = 0; i < blockEntities.size(); i++)
+			{
+				nameComponents[i].name = getString(names[i]);
+			}
+			registry.insert<NameComponent>(blockEntities.begin(), blockEntities.end(), nameComponents.begin(), nameComponents.end());
+		}
+
+		insertComponents(SceneBlockType::Transform, transforms);
+		insertComponents(SceneBlockType::Renderable, renderables);
+		insertComponents(SceneBlockType::Camera, cameras);
+		insertComponents(SceneBlockType::RayTracingGeometry, geometries);
+		insertComponents(SceneBlockType::Light, lights);
+		insertComponents(SceneBlockType::Bounds, bounds);
+
+		if (scriptRanges != nullptr)
+		{
+			gatherBlockEntities(SceneBlockType::CustomScript);
+			std::vector<CustomScriptCompoent> scriptComponents(blockEntities.size());
+			for (uint32_t i = 0; i < blockEntities.size(); i++)
+			{
+				for (uint32_t k = 0; k < scriptRanges[i].count; k++)
+				{
+					const SceneScriptRecord& record = scripts[scriptRanges[i].first + k];
+					std::string_view scriptData = getString(record.data);
+					CustomScript script;
+					script.name = getString(record.name);
+					script.data.assign((const uint8_t*)scriptData.data(), (const uint8_t*)scriptData.data() + scriptData.size());
+					scriptComponents[i].scripts.push_back(std::move(script));
+				}
+			}
+			registry.insert<CustomScriptCompoent>(blockEntities.begin(), blockEntities.end(), scriptComponents.begin(), scriptComponents.end());
+		}
+
+		if (tagRanges != nullptr)
+		{
+			gatherBlockEntities(SceneBlockType::Tag);
+			std::vector<TagComponent> tagComponents(blockEntities.size());
+			StringInterner* interner = Singleton::GetInstance<StringInterner>();
+			for (uint32_t i = 0; i < blockEntities.size(); i++)
+			{
+				for (uint32_t k = 0; k < tagRanges[i].count; k++)
+				{
+					tagComponents[i].tags.push_back(interner->Intern(getString(tags[tagRanges[i].first + k])));
+				}
+			}
+			registry.insert<TagComponent>(blockEntities.begin(), blockEntities.end(), tagComponents.begin(), tagComponents.end());
+		}
+
+		if (occluderIndices != nullptr)
+		{
+			std::vector<ptr<const OccluderMesh>> meshes(occluderTable->meshCount);
+			for (uint32_t i = 0; i < occluderTable->meshCount; i++)
+			{
+				const SceneOccluderRecord& record = occluderMeshes[i];
+				auto mesh = std::make_shared<OccluderMesh>();
+				mesh->vertices.assign(occluderVertices + record.vertices.first, occluderVertices + record.vertices.first + record.vertices.count);
+				mesh->indices.assign(occluderIndices + record.indices.first, occluderIndices + record.indices.first + record.indices.count);
+				meshes[i] = mesh;
+			}
+			gatherBlockEntities(SceneBlockType::Occluder);
+			std::vector<OccluderComponent> occluders(blockEntities.size());
+			for (uint32_t i = 0; i < blockEntities.size(); i++)
+			{
+				occluders[i].mesh = meshes[occluderMeshIndices[i]];
+			}
+			registry.insert<OccluderComponent>(blockEntities.begin(), blockEntities.end(), occluders.begin(), occluders.end());
+		}
+
+		if (assets != nullptr)
+		{
+			SceneAssetRemap remap(m_Resolver.get());
+			for (uint32_t i = 0; i < typedBlocks[(uint32_t)SceneBlockType::Asset]->count; i++)
+			{
+				remap.Add(assets[i].type, assets[i].id, getString(assets[i].name));
+			}
+			remap.Apply(registry);
+		}
+
+		return true;
+	}
+
+	bool SceneSerializer::SerializeBinary(const std::string& path)
+	{
+		std::vector<uint8_t> data = SerializeBinary();
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			KBS_WARN("fail to open scene file {}", path.c_str());
+			return false;
+		}
+		file.write((const char*)data.data(), data.size());
+		return file.good();
+	}
+
+	bool SceneSerializer::DeserializeBinary(const std::string& path)
+	{
+		std::string absolutePath = std::filesystem::absolute(path).string();
+		opt<FileBlob> blob = Singleton::GetInstance<VirtualFileSystem>()->Open(absolutePath);
+		if (!blob.has_value())
+		{
+			KBS_WARN("fail to open scene file {}", path.c_str());
+			return false;
+		}
+		return DeserializeBinary(blob->data, blob->size);
+	}
+
+	static json ToJson(const vec3& v)
+	{
+		return json::array({ v.x, v.y, v.z });
+	}
+
+	static json ToJson(const quat& q)
+	{
+		return json::array({ q.w, q.x, q.y, q.z });
+	}
+
+	static vec3 ToVec3(const json& j)
+	{
+		return vec3(j.at(0).get<float>(), j.at(1).get<float>(), j.at(2).get<float>());
+	}
+
+	static quat ToQuat(const json& j)
+	{
+		return quat(j.at(0).get<float>(), j.at(1).get<float>(), j.at(2).get<float>(), j.at(3).get<float>());
+	}
+
+	std::string SceneSerializer::SerializeText()
+	{
+		KBS_PROFILE_FUNCTION();
+		Scene& scene = *m_Scene;
+		entt::registry& registry = scene.m_Registry;
+
+		json sceneJson;
+		sceneJson["version"] = SceneFileHeader::currentVersion;
+		sceneJson["root"] = (uint64_t)scene.m_Root;
+		sceneJson["mainCamera"] = scene.m_MainCamera.has_value() ? json((uint64_t)scene.m_MainCamera.value()) : json();
+		json& entities = sceneJson["entities"] = json::array();
+
+		json& assets = sceneJson["assets"] = json::array();
+		SceneAssetNames assetNames(m_Resolver.get(), registry);
+		for (auto& asset : assetNames.GetNames())
+		{
+			assets.push_back({ { "type", (uint32_t)asset.type }, { "id", (uint64_t)asset.id }, { "name", asset.name } });
+		}
+
+		// meshes shared by instances are saved once, the occluders of the entities are indices into them
+		json& occluderMeshes = sceneJson["occluders"] = json::array();
+		std::unordered_map<const OccluderMesh*, uint32_t> occluderIndices;
+
+		for (auto e : registry.view<IDComponent>())
+		{
+			UUID id = registry.get<IDComponent>(e).ID;
+			if (id == scene.m_Root) continue;
+
+			json entity;
+			entity["id"] = (uint64_t)id;
+			if (auto name = registry.try_get<NameComponent>(e))
+			{
+				entity["name"] = name->name;
+			}
+			if (auto trans = registry.try_get<TransformComponent>(e))
+			{
+				entity["transform"] = { { "parent", (uint64_t)trans->parent }, { "position", ToJson(trans->position) },
+					{ "rotation", ToJson(trans->rotation) }, { "scale", ToJson(trans->scale) } };
+			}
+			if (auto render = registry.try_get<RenderableComponent>(e))
+			{
+				json passes = json::array();
+				for (uint32_t i = 0; i < render->passCount; i++)
+				{
+					passes.push_back({ { "material", (uint64_t)render->targetMaterials[i] }, { "flags", render->renderOptionFlags[i] } });
+				}
+				entity["renderable"] = { { "mesh", (uint64_t)render->targetMesh }, { "passes", passes } };
+			}
+			if (auto camera = registry.try_get<CameraComponent>(e))
+			{
+				entity["camera"] = { { "type", (uint32_t)camera->m_Type }, { "far", camera->m_Far }, { "near", camera->m_Near },
+					{ "aspectRatio", camera->m_AspectRatio }, { "width", camera->m_Width }, { "fov", camera->m_Fov }, { "height", camera->m_Height } };
+			}
+			if (auto component = registry.try_get<CustomScriptCompoent>(e))
+			{
+				json scripts = json::array();
+				for (auto& script : component->scripts)
+				{
+					scripts.push_back({ { "name", script.name }, { "data", script.data } });
+				}
+				entity["scripts"] = scripts;
+			}
+			if (auto geometry = registry.try_get<RayTracingGeometryComponent>(e))
+			{
+				entity["rayTracingGeometry"] = { { "opaque", geometry->opaque }, { "material", (uint64_t)geometry->rayTracingMaterial } };
+			}
+			if (auto light = registry.try_get<LightComponent>(e))
+			{
+				json lightJson = { { "type", (uint32_t)light->type }, { "intensity", ToJson(light->intensity) } };
+				if (light->type == LightComponent::Sphere)
+				{
+					lightJson["radius"] = light->sphere.radius;
+				}
+				else if (light->type == LightComponent::Area)
+				{
+					lightJson["u"] = ToJson(light->area.u);
+					lightJson["v"] = ToJson(light->area.v);
+					lightJson["area"] = light->area.area;
+				}
+				lightJson["shadowCaster"] = { { "castShadow", light->shadowCaster.castShadow }, { "distance", light->shadowCaster.distance },
+					{ "bias", light->shadowCaster.bias }, { "windowWidth", light->shadowCaster.windowWidth }, { "windowHeight", light->shadowCaster.windowHeight } };
+				entity["light"] = lightJson;
+			}
+			if (auto component = registry.try_get<TagComponent>(e))
+			{
+				json tags = json::array();
+				for (auto tag : component->tags)
+				{
+					tags.push_back(tag.GetString());
+				}
+				entity["tags"] = tags;
+			}
+			if (auto bounds = registry.try_get<BoundsComponent>(e))
+			{
+				entity["bounds"] = { { "lower", ToJson(bounds->local.lower) }, { "upper", ToJson(bounds->local.upper) } };
+			}
+			if (auto occluder = registry.try_get<OccluderComponent>(e))
+			{
+				const OccluderMesh* mesh = occluder->mesh.get();
+				auto [iter, inserted] = occluderIndices.try_emplace(mesh, (uint32_t)occluderMeshes.size());
+				if (inserted)
+				{
+					json vertices = json::array(), indices = json::array();
+					if (mesh != nullptr)
+					{
+						for (const vec3& v : mesh->vertices)
+						{
+							vertices.push_back(ToJson(v));
+						}
+						indices = mesh->indices;
+					}
+					occluderMeshes.push_back({ { "vertices", vertices }, { "indices", indices } });
+				}
+				entity["occluder"] = iter->second;
+			}
+			entities.push_back(std::move(entity));
+		}
+
+		return sceneJson.dump(1, '\t');
+	}
+
+	bool SceneSerializer::DeserializeText(std::string_view text)
+	{
+		KBS_PROFILE_FUNCTION();
+		KBS_MEMORY_TAG(Scene);
+		Scene& scene = *m_Scene;
+		entt::registry& registry = scene.m_Registry;
+		KBS_ASSERT(scene.m_EntityMap.empty(), "scenes can only be deserialized into a scene holding nothing but its root");
+
+		json sceneJson = json::parse(text.begin(), text.end(), nullptr, false);
+		if (sceneJson.is_discarded())
+		{
+			KBS_WARN("scene file is not a valid json file");
+			return false;
+		}
+
+		try
+		{
+			uint32_t version = sceneJson.at("version").get<uint32_t>();
+			if (version != SceneFileHeader::currentVersion)
+			{
+				KBS_WARN("scene file version {} is not supported, current version is {}", version, SceneFileHeader::currentVersion);
+				return false;
+			}
+
+			UUID rootID = sceneJson.at("root").get<uint64_t>();
+			entt::entity root = FindRootEntity(registry, scene.m_Root);
+			registry.get<IDComponent>(root).ID = rootID;
+			registry.get<TransformComponent>(root).parent = rootID;
+			scene.m_Root = rootID;
+			if (!sceneJson.at("mainCamera").is_null())
+			{
+				scene.m_MainCamera = sceneJson.at("mainCamera").get<uint64_t>();
+			}
+
+			std::vector<ptr<const OccluderMesh>> occluderMeshes;
+			if (auto iter = sceneJson.find("occluders"); iter != sceneJson.end())
+			{
+				for (const json& meshJson : *iter)
+				{
+					auto mesh = std::make_shared<OccluderMesh>();
+					for (const json& v : meshJson.at("vertices"))
+					{
+						mesh->vertices.push_back(ToVec3(v));
+					}
+					mesh->indices = meshJson.at("indices").get<std::vector<uint32_t>>();
+					if (!IsValidOccluderMesh(mesh->vertices.size(), mesh->indices.data(), mesh->indices.size()))
+					{
+						KBS_WARN("occluder {} of the scene file has indices out of range", (uint32_t)occluderMeshes.size());
+						return false;
+					}
+					occluderMeshes.push_back(mesh);
+				}
+			}
+
+			for (const json& entityJson : sceneJson.at("entities"))
+			{
+				Entity entity = scene.CreateEntityWithUUID(entityJson.at("id").get<uint64_t>(), entityJson.value("name", std::string()));
+
+				if (auto iter = entityJson.find("transform"); iter != entityJson.end())
+				{
+					TransformComponent trans(ToVec3(iter->at("position")), ToQuat(iter->at("rotation")), ToVec3(iter->at("scale")));
+					trans.parent = iter->at("parent").get<uint64_t>();
+					entity.AddComponent<TransformComponent>(trans);
+				}
+				if (auto iter = entityJson.find("renderable"); iter != entityJson.end())
+				{
+					RenderableComponent render;
+					render.targetMesh = iter->at("mesh").get<uint64_t>();
+					for (const json& pass : iter->at("passes"))
+					{
+						render.AddRenderablePass(pass.at("material").get<uint64_t>(), pass.at("flags").get<uint64_t>());
+					}
+					entity.AddComponent<RenderableComponent>(render);
+				}
+				if (auto iter = entityJson.find("camera"); iter != entityJson.end())
+				{
+					CameraComponent camera;
+					camera.m_Type = (CameraComponent::CameraType)iter->at("type").get<uint32_t>();
+					camera.m_Far = iter->at("far").get<float>();
+					camera.m_Near = iter->at("near").get<float>();
+					camera.m_AspectRatio = iter->at("aspectRatio").get<float>();
+					camera.m_Width = iter->at("width").get<float>();
+					camera.m_Fov = iter->at("fov").get<float>();
+					camera.m_Height = iter->at("height").get<float>();
+					entity.AddComponent<CameraComponent>(camera);
+				}
+				if (auto iter = entityJson.find("scripts"); iter != entityJson.end())
+				{
+					CustomScriptCompoent& component = entity.AddComponent<CustomScriptCompoent>();
+					for (const json& scriptJson : *iter)
+					{
+						CustomScript script;
+						script.name = scriptJson.at("name").get<std::string>();
+						script.data = scriptJson.at("data").get<std::vector<uint8_t>>();
+						component.scripts.push_back(std::move(script));
+					}
+				}
+				if (auto iter = entityJson.find("rayTracingGeometry"); iter != entityJson.end())
+				{
+					RayTracingGeometryComponent geometry;
+					geometry.opaque = iter->at("opaque").get<bool>();
+					geometry.rayTracingMaterial = iter->at("material").get<uint64_t>();
+					entity.AddComponent<RayTracingGeometryComponent>(geometry);
+				}
+				if (auto iter = entityJson.find("light"); iter != entityJson.end())
+				{
+					LightComponent light{};
+					light.type = (LightComponent::LightType)iter->at("type").get<uint32_t>();
+					light.intensity = ToVec3(iter->at("intensity"));
+					if (light.type == LightComponent::Sphere)
+					{
+						light.sphere.radius = iter->at("radius").get<float>();
+					}
+					else if (light.type == LightComponent::Area)
+					{
+						light.area.u = ToVec3(iter->at("u"));
+						light.area.v = ToVec3(iter->at("v"));
+						light.area.area = iter->at("area").get<float>();
+					}
+					const json& shadowCaster = iter->at("shadowCaster");
+					light.shadowCaster.castShadow = shadowCaster.at("castShadow").get<bool>();
+					light.shadowCaster.distance = shadowCaster.at("distance").get<float>();
+					light.shadowCaster.bias = shadowCaster.at("bias").get<float>();
+					light.shadowCaster.windowWidth = shadowCaster.at("windowWidth").get<float>();
+					light.shadowCaster.windowHeight = shadowCaster.at("windowHeight").get<float>();
+					entity.AddComponent<LightComponent>(light);
+				}
+				if (auto iter = entityJson.find("tags"); iter != entityJson.end())
+				{
+					for (const json& tag : *iter)
+					{
+						entity.AddTag(InternedString(tag.get<std::string>()));
+					}
+				}
+				if (auto iter = entityJson.find("bounds"); iter != entityJson.end())
+				{
+					entity.AddComponent<BoundsComponent>(AABB(ToVec3(iter->at("lower")), ToVec3(iter->at("upper"))));
+				}
+				if (auto iter = entityJson.find("occluder"); iter != entityJson.end())
+				{
+					uint32_t mesh = iter->get<uint32_t>();
+					if (mesh >= occluderMeshes.size())
+					{
+						KBS_WARN("occluder of entity {} is out of range", (uint64_t)entity.GetUUID());
+						return false;
+					}
+					entity.AddComponent<OccluderComponent>(occluderMeshes[mesh]);
+				}
+			}
+
+			if (auto iter = sceneJson.find("assets"); iter != sceneJson.end())
+			{
+				SceneAssetRemap remap(m_Resolver.get());
+				for (const json& asset : *iter)
+				{
+					uint32_t type = asset.at("type").get<uint32_t>();
+					if (type >= (uint32_t)SceneAssetType::Count)
+					{
+						KBS_WARN("asset type {} of the scene file is invalid", type);
+						return false;
+					}
+					remap.Add((SceneAssetType)type, asset.at("id").get<uint64_t>(), asset.at("name").get<std::string>());
+				}
+				remap.Apply(registry);
+			}
+		}
+		catch (const json::exception& e)
+		{
+			KBS_WARN("fail to deserialize scene : {}", e.what());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SceneSerializer::Serialize(const std::string& path)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+		{
+			KBS_WARN("fail to open scene file {}", path.c_str());
+			return false;
+		}
+		file << SerializeText();
+		return file.good();
+	}
+
+	bool SceneSerializer::Deserialize(const std::string& path)
+	{
+		std::string absolutePath = std::filesystem::absolute(path).string();
+		opt<FileBlob> blob = Singleton::GetInstance<VirtualFileSystem>()->Open(absolutePath);
+		if (!blob.has_value())
+		{
+			KBS_WARN("fail to open scene file {}", path.c_str());
+			return false;
+		}
+		return DeserializeText(blob->AsString());
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "Common.h"
+#include "Scene/Scene.h"
+#include <string_view>
+
+namespace kbs
+{
+	// binary scene layout:
+	//   SceneFileHeader | SceneBlock[blockCount] | block contents (16 bytes aligned) | string table
+	// the entity block holds the uuids of all entities except the root, the asset block the names of the
+	// referenced assets. every other block stores one component type: the indices of its entities into the
+	// entity block followed by the component array, trivially copyable components are inserted into the
+	// registry straight from the mapped file
+	struct SceneFileHeader
+	{
+		static constexpr uint32_t magic = 0x53534B42; // "KBSS"
+		static constexpr uint32_t currentVersion = 1;
+
+		uint32_t fileMagic;
+		uint32_t version;
+		uint32_t entityCount;
+		uint32_t blockCount;
+		uint64_t root;
+		// UUID::Invalid if the scene has no main camera
+		uint64_t mainCamera;
+		uint64_t stringOffset;
+		uint64_t stringSize;
+	};
+
+	enum class SceneBlockType : uint32_t
+	{
+		Entity,
+		Name,
+		Transform,
+		Renderable,
+		Camera,
+		CustomScript,
+		RayTracingGeometry,
+		Light,
+		Tag,
+		Bounds,
+		Asset,
+		Occluder
+	};
+
+	// assets components refer to by id
+	enum class SceneAssetType : uint32_t
+	{
+		Mesh,
+		Material,
+		RTMaterial,
+		Count
+	};
+
+	// mesh and material ids are generated by the asset managers of the running process, a scene holding nothing
+	// but them only loads correctly into the process which saved it. a resolver names the referenced assets by
+	// something stable, like the path of a model with the index of a primitive or the name of a material. the
+	// names are saved next to the ids and resolved to the ids of the loading process, the ids of the assets
+	// without a name are kept as they are. occluder meshes are saved with the scene
+	class SceneAssetResolver
+	{
+	public:
+		virtual ~SceneAssetResolver() = default;
+
+		// empty if the asset has no stable name
+		virtual std::string GetAssetName(SceneAssetType type, UUID id) = 0;
+		virtual opt<UUID>	FindAsset(SceneAssetType type, std::string_view name) = 0;
+	};
+
+	struct SceneBlock
+	{
+		SceneBlockType type;
+		uint32_t	   count;
+		uint64_t	   offset;
+		uint64_t	   size;
+	};
+
+	// copied mostly from hazel, the text format is json meant for diffing and editing scenes by hand.
+	// scenes are deserialized into a scene which holds nothing but its root, the loaded scene takes over
+	// the uuid of the serialized root. script callbacks are not serialized. without a resolver mesh and
+	// material references are saved as runtime ids, see SceneAssetResolver
+	class KBS_API SceneSerializer
+	{
+	public:
+		SceneSerializer(ptr<Scene> scene, ptr<SceneAssetResolver> resolver = nullptr) : m_Scene(scene), m_Resolver(resolver) {}
+
+		bool Serialize(const std::string& path);
+		bool Deserialize(const std::string& path);
+
+		std::string SerializeText();
+		bool		DeserializeText(std::string_view text);
+
+		// the file is memory mapped, see VirtualFileSystem::Open
+		bool SerializeBinary(const std::string& path);
+		bool DeserializeBinary(const std::string& path);
+
+		std::vector<uint8_t> SerializeBinary();
+		bool				 DeserializeBinary(const uint8_t* data, uint64_t size);
+
+	private:
+		ptr<Scene>				m_Scene;
+		ptr<SceneAssetResolver> m_Resolver;
+	};
+}
@@ -12,14 +12,11 @@ namespace kbs
 
     vec3 kbs::Transform::GetPosition() 
     {
-        vec3 position = m_Trans.position;
-        TranverseParentTransform(
-            [&](TransformComponent& parentTrans)
-           {
-                position = parentTrans.rotation * (parentTrans.scale * position) + parentTrans.position;
-            }
-        );
-        return position;
+        if (const WorldTransformComponent* world = GetCachedWorldTransform())
+        {
+            return vec3(world->world[3]);
+        }
+        return vec3(GetParentMatrix() * vec4(m_Trans.position, 1.f));
     }
 
     vec3 Transform::GetLocalPosition() 
@@ -29,14 +26,7 @@ namespace kbs
 
     vec3 kbs::Transform::GetFront() 
     {
-        vec3 front = GetLocalFront();
-        TranverseParentTransform(
-            [&](TransformComponent& parentTrans)
-            {
-                front = vec3(math::quat2mat(m_Trans.rotation) * vec4(front, 0.f));
-            }
-        );
-        return front;
+        return GetRotation() * vec3(0, 0, 1);
     }
 
     vec3 Transform::GetLocalFront() 
@@ -47,14 +37,7 @@ namespace kbs
 
     vec3 Transform::GetRight() 
     {
-        vec3 right = GetLocalRight();
-        TranverseParentTransform(
-            [&](TransformComponent& parentTrans)
-            {
-                right = vec3(math::quat2mat(m_Trans.rotation) * vec4(right, 0.f));
-            }
-        );
-        return right;
+        return GetRotation() * vec3(1, 0, 0);
     }
 
     vec3 Transform::GetLocalRight() 
@@ -65,14 +48,11 @@ namespace kbs
 
     quat kbs::Transform::GetRotation() 
     {
-        quat rot = GetLocalRotation();
-        TranverseParentTransform(
-            [&](TransformComponent& parentTrans)
-            {
-                rot = parentTrans.rotation * rot;
-            }
-        );
-        return rot;
+        if (const WorldTransformComponent* world = GetCachedWorldTransform())
+        {
+            return world->rotation;
+        }
+        return GetParentRotation() * m_Trans.rotation;
     }
 
     quat Transform::GetLocalRotation() 
@@ -129,14 +109,7 @@ namespace kbs
 
     void kbs::Transform::SetPosition(vec3 pos)
     {
-        mat4 model = math::position(vec3(0, 0, 0));
-        TranverseParentTransform(
-            [&](TransformComponent& comp)
-            {
-                model = math::position(comp.position) * math::quat2mat(m_Trans.rotation) * math::scale(m_Trans.scale) * model;
-            }
-        );
-        vec4 newPos = glm::inverse(model) * vec4(pos,1);
+        vec4 newPos = glm::inverse(GetParentMatrix()) * vec4(pos,1);
         m_Trans.position = vec3(newPos.x, newPos.y, newPos.z);
     }
 
@@ -147,8 +120,7 @@ namespace kbs
 
     void kbs::Transform::SetRotation(quat q)
     {
-        quat worldQ = GetRotation();
-        m_Trans.rotation = glm::inverse(worldQ) * q;
+        m_Trans.rotation = glm::inverse(GetParentRotation()) * q;
     }
 
     void Transform::SetLocalRotation(quat q)
@@ -158,13 +130,11 @@ namespace kbs
 
     ObjectUBO kbs::Transform::GetObjectUBO()
     {
-        mat4 model = math::position(m_Trans.position)* math::quat2mat(m_Trans.rotation)* math::scale(m_Trans.scale);
-        TranverseParentTransform(
-            [&](TransformComponent& comp)
-            {
-                model = math::position(comp.position) * math::quat2mat(comp.rotation) * math::scale(comp.scale) * model;
-            }
-        );
+        if (const WorldTransformComponent* world = GetCachedWorldTransform())
+        {
+            return ObjectUBO{ world->world, world->invTransWorld };
+        }
+        mat4 model = GetParentMatrix() * m_Trans.GetLocalMatrix();
         mat4 invTransModel = math::transpose(math::inverse(model));
 
         return ObjectUBO{model, invTransModel};
@@ -176,18 +146,43 @@ namespace kbs
     }
 
 
-    void Transform::TranverseParentTransform(std::function<void(TransformComponent&)> op)
+    const WorldTransformComponent* Transform::GetCachedWorldTransform()
     {
-        Scene* scene = m_Entity.GetScene();
-        UUID   currentComp = m_Trans.parent;
-
-        while (currentComp != scene->GetRootID())
+        if (m_Entity.GetScene() == nullptr || !m_Entity)
         {
-            TransformComponent trans = scene->GetEntityByUUID(currentComp).GetComponent<TransformComponent>();
-            op(trans);
-            currentComp = trans.parent;
+            return nullptr;
         }
+        return m_Entity.GetScene()->GetCachedWorldTransform(m_Entity, m_Trans);
     }
-}
 
+    mat4 Transform::GetParentMatrix()
+    {
+        Scene* scene = m_Entity.GetScene();
+        if (scene == nullptr || m_Trans.parent == scene->GetRootID())
+        {
+            return mat4(1.f);
+        }
+        Entity parent = scene->GetEntityByUUID(m_Trans.parent);
+        if (!parent)
+        {
+            return mat4(1.f);
+        }
+        // falls back to walking up the parents if the scene is not updated yet
+        return Transform(parent).GetObjectUBO().model;
+    }
 
+    quat Transform::GetParentRotation()
+    {
+        Scene* scene = m_Entity.GetScene();
+        if (scene == nullptr || m_Trans.parent == scene->GetRootID())
+        {
+            return quat(1, 0, 0, 0);
+        }
+        Entity parent = scene->GetEntityByUUID(m_Trans.parent);
+        if (!parent)
+        {
+            return quat(1, 0, 0, 0);
+        }
+        return Transform(parent).GetRotation();
+    }
+}
\ No newline at end of file
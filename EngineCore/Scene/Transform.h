@@ -39,7 +39,10 @@ namespace kbs
 		ObjectUBO			GetObjectUBO();
 		TransformComponent	GetComponent();
 	private:
-		void TranverseParentTransform(std::function<void(TransformComponent&)>);
+		// world transform cached by Scene::UpdateWorldTransforms if it was computed from m_Trans and the ancestors didn't move since
+		const WorldTransformComponent* GetCachedWorldTransform();
+		mat4 GetParentMatrix();
+		quat GetParentRotation();
 
 		TransformComponent m_Trans;
 		Entity			   m_Entity;
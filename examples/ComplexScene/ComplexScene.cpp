@@ -179,7 +179,7 @@ bool ComplexSceneRenderer::InitRenderGraph(ptr<kbs::Window> window, ptr<vkrg::Re
 
 	vkrg::ResourceInfo info;
 	info.format = renderer->GetBackBufferFormat();
-	renderGraph->AddGraphResource(backBuffer, info, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	renderGraph->AddGraphResource(backBuffer, info, true, GetBackBufferFinalLayout());
 	info.format = VK_FORMAT_D24_UNORM_S8_UINT;
 	renderGraph->AddGraphResource(depthBuffer, info, false, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
@@ -206,7 +206,7 @@ bool ComplexSceneRenderer::InitRenderGraph(ptr<kbs::Window> window, ptr<vkrg::Re
 		return false;
 	}
 
-	auto backBuffers = m_Context->GetBackBuffers();
+	auto backBuffers = GetBackBuffers();
 	auto extData = renderGraph->GetExternalDataFrame();
 	for (uint32_t i = 0;i < backBuffers.size();i++)
 	{
@@ -153,9 +153,9 @@ void DeferredApplication::OnUpdate()
 
 		EventManager* eventManager = Singleton::GetInstance<EventManager>();
 
-		if (m_Window->GetGvkWindow()->MouseMove() && m_Window->GetGvkWindow()->KeyHold(GVK_MOUSE_1))
+		if (m_Window->MouseMove() && m_Window->KeyHold(GVK_MOUSE_1))
 		{
-			auto dmouse = m_Window->GetGvkWindow()->GetMouseOffset();
+			auto dmouse = m_Window->GetMouseOffset();
 			phi += dmouse.x * 0.3;
 			theta += dmouse.y * 0.3;
 
@@ -173,12 +173,12 @@ void DeferredApplication::OnUpdate()
 			//eventManager->BoardcastEvent(PTAccumulationUpdateEvent());
 		}
 
-		if (m_Window->GetGvkWindow()->KeyHold(GVK_KEY_D))
+		if (m_Window->KeyHold(GVK_KEY_D))
 		{
 			angle.radius += m_Timer->DeltaTime();
 		}
 
-		else if (m_Window->GetGvkWindow()->KeyHold(GVK_KEY_A))
+		else if (m_Window->KeyHold(GVK_KEY_A))
 		{
 			angle.radius -= m_Timer->DeltaTime();
 		}
@@ -132,9 +132,9 @@ void GIBSApplication::OnUpdate()
 		kbs::vec3 dir = kbs::vec3(sinTheta * cosPhi, cosTheta, sinTheta * sinPhi);
 		// cameraTrans.FaceDirection(dir);
 
-		if (m_Window->GetGvkWindow()->MouseMove() && m_Window->GetGvkWindow()->KeyHold(GVK_MOUSE_1))
+		if (m_Window->MouseMove() && m_Window->KeyHold(GVK_MOUSE_1))
 		{
-			auto dmouse = m_Window->GetGvkWindow()->GetMouseOffset();
+			auto dmouse = m_Window->GetMouseOffset();
 			phi   += dmouse.x * 0.3;
 			theta += dmouse.y * 0.3;
 
@@ -150,22 +150,22 @@ void GIBSApplication::OnUpdate()
 			theta = glm::clamp(theta, 1e-4f, 180.0f - 1e-4f);
 		}
 
-		if (m_Window->GetGvkWindow()->KeyHold(GVK_KEY_D))
+		if (m_Window->KeyHold(GVK_KEY_D))
 		{
 			angle.radius += m_Timer->DeltaTime();
 		}
-		else if(m_Window->GetGvkWindow()->KeyHold(GVK_KEY_A))
+		else if(m_Window->KeyHold(GVK_KEY_A))
 		{
 			angle.radius -= m_Timer->DeltaTime();
 		}
 
 		/*static float d = 0;
-		if (m_Window->GetGvkWindow()->KeyHold(GVK_KEY_W))
+		if (m_Window->KeyHold(GVK_KEY_W))
 		{
 			d += 4.0 * m_Timer->DeltaTime();
 		}
 		
-		if(m_Window->GetGvkWindow()->KeyHold(GVK_KEY_S))
+		if(m_Window->KeyHold(GVK_KEY_S))
 		{
 			d -= 4.0 * m_Timer->DeltaTime();
 		}*/
@@ -32,42 +32,32 @@ namespace kbs
 		float radius;
 	};
 
-	void TNNAODeferredShadingPass::AttachScene(ptr<Scene> scene, opt<Entity> mainLight, opt<kbs::mat4> mainLightMVP)
+	void TNNAODeferredShadingPass::AttachRenderWorld(const RenderWorld& world, opt<UUID> mainLight, opt<kbs::mat4> mainLightMVP)
 	{
-		bool mainLightFounded = false;
 		RenderAPI api = GetRenderAPI();
 
 		std::vector<TNNAODeferredPassLight> lights;
-		scene->IterateAllEntitiesWith<LightComponent>(
-			[&](Entity e)
-			{
-				LightComponent lc = e.GetComponent<LightComponent>();
-		Transform lTrans(e);
-
-		TNNAODeferredPassLight lightData;
-		lightData.emission = lc.intensity;
-		lightData.lightType = lc.type;
-		lightData.shadowBias = 1e-4;
-		lightData.mainLightFlag = false;
-
-		if (lc.type == LightComponent::Directional)
+		for (const RenderWorldLight& light : world.lights)
 		{
-			lightData.position = -lTrans.GetFront();
+			TNNAODeferredPassLight lightData;
+			lightData.emission = light.light.intensity;
+			lightData.lightType = light.light.type;
+			lightData.shadowBias = 1e-4;
+			lightData.mainLightFlag = false;
 
-			if (mainLight.has_value())
+			if (light.light.type == LightComponent::Directional)
 			{
-				if (e.GetUUID() == mainLight.value().GetUUID())
+				lightData.position = -light.front;
+
+				if (mainLight.has_value() && light.id == mainLight.value())
 				{
 					lightData.mainLightFlag = true;
-					ObjectUBO objectUBO = lTrans.GetObjectUBO();
 					lightData.lightVP = mainLightMVP.value();
 				}
 			}
-		}
 
-		lights.push_back(lightData);
-			}
-		);
+			lights.push_back(lightData);
+		}
 
 		uint32_t deferredPassLightBufferSize = lights.size() * sizeof(TNNAODeferredPassLight);
 
@@ -79,7 +69,9 @@ namespace kbs
 				deferredPassLightBufferSize, 0);
 		}
 
-		RenderCamera renderCamera(scene->GetMainCamera());
+		const RenderWorldCamera* mainCamera = world.GetMainCamera();
+		KBS_ASSERT(mainCamera != nullptr, "main camera must be created");
+		RenderCamera renderCamera(mainCamera->camera, mainCamera->GetTransform());
 		CameraUBO cameraUBO = renderCamera.GetCameraUBO();
 
 		TNNAODeferredPassUniform uniformData;
@@ -332,7 +324,7 @@ namespace kbs
 		renderGraph->AddGraphResource("ao", info, false);
 
 		info.format = GetBackBufferFormat();
-		renderGraph->AddGraphResource("backBuffer", info, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		renderGraph->AddGraphResource("backBuffer", info, true, GetBackBufferFinalLayout());
 
 		info.format = VK_FORMAT_D24_UNORM_S8_UINT;
 		renderGraph->AddGraphResource("depth", info, false);
@@ -440,7 +432,7 @@ namespace kbs
 			return false;
 		}
 
-		auto backBuffers = m_Context->GetBackBuffers();
+		auto backBuffers = GetBackBuffers();
 		auto extData = renderGraph->GetExternalDataFrame();
 		for (uint32_t i = 0; i < backBuffers.size(); i++)
 		{
@@ -460,7 +452,9 @@ namespace kbs
 
 	void TNNAORenderer::OnSceneRender(ptr<Scene> scene)
 	{
-		Entity mainCamera = scene->GetMainCamera();
+		const RenderWorldCamera* worldCamera = GetRenderWorld().GetMainCamera();
+		KBS_ASSERT(worldCamera != nullptr, "main camera must be created");
+		RenderCamera mainCamera(worldCamera->camera, worldCamera->GetTransform());
 
 
 		m_DeferredPass->SetTargetCamera(mainCamera);
@@ -469,7 +463,7 @@ namespace kbs
 		m_ShadowPass->SetTargetScene(scene);
 		m_ShadowPass->SetTargetCamera(mainCamera);
 
-		m_DeferredShadingPass->AttachScene(scene, m_ShadowPass->GetShadowCaster(), m_ShadowPass->GetLightVP());
+		m_DeferredShadingPass->AttachRenderWorld(GetRenderWorld(), m_ShadowPass->GetShadowCaster(), m_ShadowPass->GetLightVP());
 
 		if (GetCurrentFrameIdx() == 0)
 		{
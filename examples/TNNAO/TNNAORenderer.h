@@ -36,7 +36,7 @@ namespace kbs
 	{
 	public:
 
-		void AttachScene(ptr<Scene> scene, opt<Entity> mainLight, opt<kbs::mat4> mainLightMVP);
+		void AttachRenderWorld(const RenderWorld& world, opt<UUID> mainLight, opt<kbs::mat4> mainLightMVP);
 		void ResizeScreen(uint32_t width, uint32_t height);
 
 		ptr<RenderBuffer>	GetUniformBuffer();
@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+
+using namespace kbs;
+
+// the components Model::Instantiate creates for one primitive of a model
+static RenderableComponent CreateRenderable(uint32_t primitive)
+{
+	RenderableComponent render;
+	render.targetMesh = UUID(primitive + 1);
+	render.AddRenderablePass(UUID(100 + primitive), 0);
+	return render;
+}
+
+TEST(BulkInstantiate, CreateEntities)
+{
+	Scene scene;
+	Entity single = scene.CreateEntity("single");
+	std::vector<Entity> entities = scene.CreateEntities(100, "bulk");
+	ASSERT_EQ(entities.size(), 100);
+
+	std::unordered_set<uint64_t> ids{ (uint64_t)single.GetUUID() };
+	for (Entity e : entities)
+	{
+		ASSERT_TRUE(ids.insert((uint64_t)e.GetUUID()).second);
+		ASSERT_EQ(scene.GetEntityByUUID(e.GetUUID()), e);
+		ASSERT_EQ(e.GetName(), "bulk");
+	}
+	ASSERT_EQ(scene.FindEntitiesByName("bulk").size(), 100);
+	ASSERT_EQ(scene.FindEntityByName("single"), single);
+	ASSERT_EQ(scene.CreateEntities(3)[0].GetName(), "Entity");
+}
+
+TEST(BulkInstantiate, AddComponents)
+{
+	Scene scene;
+	std::vector<Entity> roots = scene.CreateEntities(10, "model");
+	std::vector<TransformComponent> rootTransforms;
+	for (uint32_t i = 0; i < roots.size(); i++)
+	{
+		rootTransforms.push_back(TransformComponent(vec3(i, 0, 0), quat(1, 0, 0, 0), vec3(1)));
+		rootTransforms.back().parent = scene.GetRootID();
+	}
+	scene.AddComponents(roots, rootTransforms.data());
+
+	std::vector<Entity> children = scene.CreateEntities(10, "model_mesh_0");
+	std::vector<TransformComponent> transforms(children.size(), TransformComponent(vec3(0, 1, 0), quat(1, 0, 0, 0), vec3(1)));
+	for (uint32_t i = 0; i < children.size(); i++)
+	{
+		transforms[i].parent = roots[i].GetUUID();
+	}
+	std::vector<RenderableComponent> renderables(children.size(), CreateRenderable(0));
+	std::vector<BoundsComponent> bounds(children.size(), BoundsComponent(AABB(vec3(-1), vec3(1))));
+	scene.AddComponents(children, transforms.data());
+	scene.AddComponents(children, renderables.data());
+	scene.AddComponents(children, bounds.data());
+
+	// bulk inserted components are registered in the hierarchy, the spatial index and the change sets
+	scene.UpdateWorldTransforms();
+	ASSERT_EQ(scene.GetChanges(SceneChangeType::Renderable).changed.size(), children.size());
+	for (uint32_t i = 0; i < children.size(); i++)
+	{
+		ASSERT_EQ(children[i].GetComponent<RenderableComponent>().targetMesh, UUID(1));
+		ASSERT_EQ(children[i].GetComponent<BoundsComponent>().local.GetCenter(), vec3(0));
+		vec3 worldPosition = vec3(children[i].GetComponent<WorldTransformComponent>().world[3]);
+		ASSERT_EQ(worldPosition, vec3(i, 1, 0));
+	}
+	std::vector<Entity> found;
+	// the bounds of the children at x = 2, 3 and 4 overlap the box
+	scene.QueryAABB(AABB(vec3(2.5f, 0, -1), vec3(3.5f, 2, 1)), [&](Entity e) { found.push_back(e); });
+	ASSERT_EQ(found.size(), 3);
+}
+
+TEST(BulkInstantiate, InstantiateBenchmark)
+{
+	constexpr uint32_t instanceCount = 10000;
+	constexpr uint32_t primitiveCount = 8;
+
+	std::vector<TransformComponent> rootTransforms;
+	for (uint32_t i = 0; i < instanceCount; i++)
+	{
+		rootTransforms.push_back(TransformComponent(vec3(i % 100, 0, i / 100), quat(1, 0, 0, 0), vec3(1)));
+	}
+	const AABB primitiveBounds(vec3(-.5f), vec3(.5f));
+	auto ms = [](auto&& func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	// what Model::Instantiate did for every instance
+	Scene perEntityScene, bulkScene;
+	for (auto& trans : rootTransforms)
+	{
+		trans.parent = perEntityScene.GetRootID();
+	}
+	double perEntityTime = ms([&]()
+		{
+			for (uint32_t i = 0; i < instanceCount; i++)
+			{
+				Entity root = perEntityScene.CreateEntity("model");
+				root.AddComponent<TransformComponent>(rootTransforms[i]);
+				for (uint32_t p = 0; p < primitiveCount; p++)
+				{
+					TransformComponent trans(vec3(0), quat(1, 0, 0, 0), vec3(1));
+					trans.parent = root.GetUUID();
+					Entity primitive = perEntityScene.CreateEntity("model_mesh_" + std::to_string(p));
+					primitive.AddComponent<TransformComponent>(trans);
+					primitive.AddComponent<RenderableComponent>(CreateRenderable(p));
+					primitive.AddComponent<BoundsComponent>(primitiveBounds);
+				}
+			}
+		}
+	);
+
+	for (auto& trans : rootTransforms)
+	{
+		trans.parent = bulkScene.GetRootID();
+	}
+	double bulkTime = ms([&]()
+		{
+			std::vector<Entity> roots = bulkScene.CreateEntities(instanceCount, "model");
+			bulkScene.AddComponents(roots, rootTransforms.data());
+			std::vector<TransformComponent> transforms(instanceCount, TransformComponent(vec3(0), quat(1, 0, 0, 0), vec3(1)));
+			for (uint32_t i = 0; i < instanceCount; i++)
+			{
+				transforms[i].parent = roots[i].GetUUID();
+			}
+			std::vector<RenderableComponent> renderables;
+			std::vector<BoundsComponent> bounds(instanceCount, BoundsComponent(primitiveBounds));
+			for (uint32_t p = 0; p < primitiveCount; p++)
+			{
+				renderables.assign(instanceCount, CreateRenderable(p));
+				std::vector<Entity> primitives = bulkScene.CreateEntities(instanceCount, "model_mesh_" + std::to_string(p));
+				bulkScene.AddComponents(primitives, transforms.data());
+				bulkScene.AddComponents(primitives, renderables.data());
+				bulkScene.AddComponents(primitives, bounds.data());
+			}
+		}
+	);
+
+	ASSERT_EQ(bulkScene.FindEntitiesByName("model_mesh_0").size(), instanceCount);
+
+	std::cout << "[ BulkInstantiate ] " << instanceCount << " instances of a model with " << primitiveCount << " primitives, per entity : "
+		<< perEntityTime << " ms, bulk : " << bulkTime << " ms" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "Renderer/DrawSort.h"
+#include "Scene/UUID.h"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace kbs;
+
+TEST(DrawSort, KeysOrderPassStateAndDepth)
+{
+	// opaque draws come first and are grouped by pipeline, material and mesh before depth
+	ASSERT_LT(PackDrawSortKey(false, 9, 9, 9, 1e6f), PackDrawSortKey(true, 0, 0, 0, 1.f));
+	ASSERT_LT(PackDrawSortKey(false, 0, 9, 9, 1e6f), PackDrawSortKey(false, 1, 0, 0, 1.f));
+	ASSERT_LT(PackDrawSortKey(false, 1, 0, 9, 1e6f), PackDrawSortKey(false, 1, 1, 0, 1.f));
+	ASSERT_LT(PackDrawSortKey(false, 1, 1, 0, 1e6f), PackDrawSortKey(false, 1, 1, 1, 1.f));
+	// front to back
+	ASSERT_LT(PackDrawSortKey(false, 1, 1, 1, 4.f), PackDrawSortKey(false, 1, 1, 1, 9.f));
+	ASSERT_LT(PackDrawSortKey(false, 1, 1, 1, 0.f), PackDrawSortKey(false, 1, 1, 1, 1e-3f));
+	ASSERT_EQ(PackDrawSortKey(false, 1, 1, 1, -1.f), PackDrawSortKey(false, 1, 1, 1, 0.f));
+
+	// transparent draws are back to front whatever their state is
+	ASSERT_LT(PackDrawSortKey(true, 9, 9, 9, 100.f), PackDrawSortKey(true, 0, 0, 0, 50.f));
+	ASSERT_LT(PackDrawSortKey(true, 0, 0, 1, 100.f), PackDrawSortKey(true, 0, 1, 0, 100.f));
+
+	// the depth keeps its order over the whole range
+	uint16_t previous = 0;
+	for (float distance2 = 1e-4f; distance2 < 1e8f; distance2 *= 1.1f)
+	{
+		uint16_t depth = QuantizeDrawDepth(distance2);
+		ASSERT_GE(depth, previous);
+		previous = depth;
+	}
+	ASSERT_LT(QuantizeDrawDepth(100.f), QuantizeDrawDepth(101.f));
+}
+
+TEST(DrawSort, RadixSortIsStable)
+{
+	std::mt19937_64 rng(3);
+	for (uint32_t count : { 0u, 1u, 2u, 1000u, 100000u })
+	{
+		std::vector<DrawSortItem> items(count), scratch(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			// few distinct keys and wide keys both happen in a frame
+			uint64_t key = i % 2 ? rng() : (rng() % 64) << 40;
+			items[i] = DrawSortItem{ key, i };
+		}
+		std::vector<DrawSortItem> expected = items;
+		std::stable_sort(expected.begin(), expected.end(), [](const DrawSortItem& lhs, const DrawSortItem& rhs) { return lhs.key < rhs.key; });
+
+		RadixSortDrawItems(items.data(), scratch.data(), count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			ASSERT_EQ(items[i].key, expected[i].key);
+			ASSERT_EQ(items[i].index, expected[i].index);
+		}
+	}
+}
+
+// a collected draw, the state is known by id like RenderableObject
+struct SortedDraw
+{
+	UUID	 id;
+	UUID	 material;
+	UUID	 mesh;
+	uint32_t materialIndex;
+	uint32_t meshIndex;
+	float	 distance2;
+};
+
+TEST(DrawSort, SortBenchmark)
+{
+	constexpr uint32_t shaderCount = 8, materialCount = 256, meshCount = 1024;
+	std::mt19937 rng(7);
+
+	// the state the comparator of the previous sorter looked up for every comparison
+	std::vector<UUID> materials(materialCount), meshes(meshCount);
+	std::unordered_map<UUID, UUID> materialShaders, meshGroups;
+	std::vector<uint32_t> materialPipelines(materialCount);
+	for (uint32_t i = 0; i < materialCount; i++)
+	{
+		materialPipelines[i] = i % shaderCount;
+		materialShaders[materials[i]] = UUID(1 + materialPipelines[i]);
+	}
+	for (uint32_t i = 0; i < meshCount; i++)
+	{
+		meshGroups[meshes[i]] = UUID(1 + i / 64);
+	}
+
+	for (uint32_t count : { 10000u, 100000u, 1000000u })
+	{
+		std::uniform_int_distribution<uint32_t> material(0, materialCount - 1), mesh(0, meshCount - 1);
+		std::uniform_real_distribution<float> distance2(0.f, 1e8f);
+		std::vector<SortedDraw> draws(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t m = material(rng), n = mesh(rng);
+			draws[i] = SortedDraw{ UUID(i), materials[m], meshes[n], m, n, distance2(rng) };
+		}
+
+		std::vector<SortedDraw> compared = draws;
+		std::function<bool(const SortedDraw&, const SortedDraw&)> comparator = [&](const SortedDraw& lhs, const SortedDraw& rhs)
+		{
+			UUID lhsShader = materialShaders[lhs.material], rhsShader = materialShaders[rhs.material];
+			if (lhsShader != rhsShader) return lhsShader < rhsShader;
+			if (lhs.material != rhs.material) return lhs.material < rhs.material;
+			UUID lhsGroup = meshGroups[lhs.mesh], rhsGroup = meshGroups[rhs.mesh];
+			if (lhsGroup != rhsGroup) return lhsGroup < rhsGroup;
+			if (lhs.mesh != rhs.mesh) return lhs.mesh < rhs.mesh;
+			return lhs.id < rhs.id;
+		};
+		auto begin = std::chrono::high_resolution_clock::now();
+		std::sort(compared.begin(), compared.end(), comparator);
+		double comparedTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+
+		// what Renderer::SortRenderableObjects does
+		begin = std::chrono::high_resolution_clock::now();
+		std::vector<DrawSortItem> items(count), scratch(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const SortedDraw& draw = draws[i];
+			items[i] = DrawSortItem{ PackDrawSortKey(false, materialPipelines[draw.materialIndex], draw.materialIndex, draw.meshIndex, draw.distance2), i };
+		}
+		RadixSortDrawItems(items.data(), scratch.data(), count);
+		std::vector<SortedDraw> sorted;
+		sorted.reserve(count);
+		for (const DrawSortItem& item : items)
+		{
+			sorted.push_back(draws[item.index]);
+		}
+		double radixTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+
+		// both sorters break the list into the same number of state runs
+		auto countRuns = [](const std::vector<SortedDraw>& list)
+		{
+			uint32_t runs = 0;
+			for (uint32_t i = 0; i < list.size(); i++)
+			{
+				runs += i == 0 || list[i].material != list[i - 1].material || list[i].mesh != list[i - 1].mesh;
+			}
+			return runs;
+		};
+		ASSERT_EQ(countRuns(sorted), countRuns(compared));
+		for (uint32_t i = 1; i < count; i++)
+		{
+			if (sorted[i].material == sorted[i - 1].material && sorted[i].mesh == sorted[i - 1].mesh)
+			{
+				ASSERT_LE(QuantizeDrawDepth(sorted[i - 1].distance2), QuantizeDrawDepth(sorted[i].distance2));
+			}
+		}
+
+		std::cout << "[ DrawSort ] " << count << " draws : std::sort with lookups " << comparedTime << " ms, packed keys with radix sort "
+			<< radixTime << " ms, " << comparedTime / radixTime << "x" << std::endl;
+	}
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
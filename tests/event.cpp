@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include "Core/Event.h"
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <cstdlib>
+
+static std::atomic<uint64_t> g_AllocationCount = 0;
+
+void* operator new(size_t size)
+{
+	g_AllocationCount++;
+	if (void* p = std::malloc(size)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+
+// the string keyed event manager used before type indexed dispatch, kept for the benchmark
+class StringKeyedEventManager
+{
+public:
+	using EventCallback = std::function<void(const kbs::Event&)>;
+
+	template<typename T>
+	void AddListener(std::function<void(const T&)> eventCallback)
+	{
+		auto wapper = [eventCallback](const kbs::Event& e)
+		{
+			eventCallback(static_cast<const T&>(e));
+		};
+		m_CallbackTable[T::GetName()].push_back(wapper);
+	}
+
+	template<typename T>
+	void BoardcastEvent(const T& e)
+	{
+		if (m_CallbackTable.count(e.GetName()))
+		{
+			for (auto& callback : m_CallbackTable[e.GetName()])
+			{
+				callback(e);
+			}
+		}
+	}
+
+private:
+	std::unordered_map<std::string, std::vector<EventCallback>> m_CallbackTable;
+};
+
+TEST(Event, BroadcastReachesOnlyMatchingListeners)
+{
+	kbs::EventManager manager;
+
+	uint32_t resizeCount = 0, closeCount = 0;
+	manager.AddListener<kbs::WindowResizeEvent>([&](const kbs::WindowResizeEvent& e) { resizeCount += e.GetWidth(); });
+	manager.AddListener<kbs::WindowCloseEvent>([&](const kbs::WindowCloseEvent& e) { closeCount++; });
+
+	manager.BoardcastEvent(kbs::WindowResizeEvent(3, 4));
+	manager.BoardcastEvent(kbs::WindowResizeEvent(5, 4));
+	manager.BoardcastEvent(kbs::AppTickEvent());
+
+	ASSERT_EQ(resizeCount, 8);
+	ASSERT_EQ(closeCount, 0);
+}
+
+TEST(Event, QueuedEventsAreDispatchedInOrder)
+{
+	kbs::EventManager manager;
+
+	std::vector<float> received;
+	manager.AddListener<kbs::MouseMovedEvent>([&](const kbs::MouseMovedEvent& e) { received.push_back(e.GetX()); });
+	manager.AddListener<kbs::WindowResizeEvent>([&](const kbs::WindowResizeEvent& e) { received.push_back(-(float)e.GetWidth()); });
+
+	manager.QueueEvent<kbs::MouseMovedEvent>(1.f, 0.f);
+	manager.QueueEvent<kbs::WindowResizeEvent>(2u, 2u);
+	manager.QueueEvent<kbs::MouseMovedEvent>(3.f, 0.f);
+	ASSERT_TRUE(received.empty());
+	ASSERT_EQ(manager.GetQueuedEventCount(), 3);
+
+	manager.DispatchQueuedEvents();
+	ASSERT_EQ(received, std::vector<float>({ 1.f, -2.f, 3.f }));
+	ASSERT_EQ(manager.GetQueuedEventCount(), 0);
+}
+
+TEST(Event, EventsQueuedByListenersWaitForNextDispatch)
+{
+	kbs::EventManager manager;
+
+	uint32_t ticks = 0;
+	manager.AddListener<kbs::AppTickEvent>([&](const kbs::AppTickEvent&)
+		{
+			ticks++;
+			manager.QueueEvent<kbs::AppTickEvent>();
+		});
+
+	manager.QueueEvent<kbs::AppTickEvent>();
+	manager.DispatchQueuedEvents();
+	ASSERT_EQ(ticks, 1);
+	manager.DispatchQueuedEvents();
+	ASSERT_EQ(ticks, 2);
+}
+
+TEST(Event, QueueDoesNotAllocateAfterWarmUp)
+{
+	kbs::EventManager manager;
+	float sum = 0;
+	manager.AddListener<kbs::MouseMovedEvent>([&](const kbs::MouseMovedEvent& e) { sum += e.GetX(); });
+
+	auto frame = [&]()
+	{
+		for (uint32_t i = 0; i < 4096; i++)
+		{
+			manager.QueueEvent<kbs::MouseMovedEvent>(1.f, 1.f);
+		}
+		manager.DispatchQueuedEvents();
+	};
+
+	// first frames allocate queue blocks
+	frame();
+	frame();
+
+	uint64_t allocations = g_AllocationCount;
+	for (uint32_t i = 0; i < 16; i++) frame();
+	ASSERT_EQ(g_AllocationCount.load(), allocations);
+	ASSERT_EQ(sum, 18.f * 4096.f);
+}
+
+TEST(Event, DispatchBenchmark)
+{
+	const uint32_t eventCount = 1000000;
+	const uint32_t listenerCount = 4;
+
+	float legacySum = 0, sum = 0, queuedSum = 0;
+
+	StringKeyedEventManager legacy;
+	kbs::EventManager manager;
+	for (uint32_t i = 0; i < listenerCount; i++)
+	{
+		legacy.AddListener<kbs::MouseMovedEvent>([&](const kbs::MouseMovedEvent& e) { legacySum += e.GetX(); });
+		manager.AddListener<kbs::MouseMovedEvent>([&](const kbs::MouseMovedEvent& e) { sum += e.GetX(); });
+	}
+
+	auto measure = [](auto&& func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	uint64_t allocations = g_AllocationCount;
+	double legacyTime = measure([&]() { for (uint32_t i = 0; i < eventCount; i++) legacy.BoardcastEvent(kbs::MouseMovedEvent(1.f, 0.f)); });
+	uint64_t legacyAllocations = g_AllocationCount - allocations;
+
+	allocations = g_AllocationCount;
+	double time = measure([&]() { for (uint32_t i = 0; i < eventCount; i++) manager.BoardcastEvent(kbs::MouseMovedEvent(1.f, 0.f)); });
+	uint64_t immediateAllocations = g_AllocationCount - allocations;
+
+	manager.AddListener<kbs::AppTickEvent>([&](const kbs::AppTickEvent&) { queuedSum += 1.f; });
+	double queuedTime = measure([&]()
+		{
+			for (uint32_t i = 0; i < eventCount; i++) manager.QueueEvent<kbs::AppTickEvent>();
+			manager.DispatchQueuedEvents();
+		});
+
+	ASSERT_EQ(legacySum, sum);
+	ASSERT_EQ(immediateAllocations, 0);
+	ASSERT_EQ(queuedSum, (float)eventCount);
+
+	std::cout << "[ Event ] string keyed dispatch : " << legacyTime / eventCount << " ns/event, " << legacyAllocations << " allocations" << std::endl;
+	std::cout << "[ Event ] type indexed dispatch : " << time / eventCount << " ns/event, " << immediateAllocations << " allocations" << std::endl;
+	std::cout << "[ Event ] queued dispatch       : " << queuedTime / eventCount << " ns/event" << std::endl;
+}
+
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,174 @@
+#include "gtest/gtest.h"
+#include "Core/FrameAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static std::atomic<uint64_t> g_AllocationCount = 0;
+
+void* operator new(size_t size)
+{
+	g_AllocationCount++;
+	if (void* p = std::malloc(size)) return p;
+	throw std::bad_alloc();
+}
+
+// both operators go through malloc and free, gcc pairs its builtin operator new with the inlined free
+// and warns about a mismatch that isn't there
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+struct TestObject
+{
+	uint64_t id;
+	float	 distance;
+	float	 matrix[16];
+};
+
+TEST(FrameAllocator, AllocationsAreAligned)
+{
+	kbs::LinearArena arena(256);
+	for (uint64_t alignment = 1; alignment <= 256; alignment *= 2)
+	{
+		arena.Allocate(3);
+		void* p = arena.Allocate(17, alignment);
+		ASSERT_EQ((uintptr_t)p % alignment, 0);
+	}
+}
+
+TEST(FrameAllocator, OverflowIsMergedOnReset)
+{
+	kbs::LinearArena arena(1024);
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		memset(arena.Allocate(100), 0xcd, 100);
+	}
+	ASSERT_GT(arena.GetBlockCount(), 1);
+	uint64_t capacity = arena.GetCapacity();
+
+	arena.Reset();
+	ASSERT_EQ(arena.GetBlockCount(), 1);
+	ASSERT_EQ(arena.GetCapacity(), capacity);
+	ASSERT_EQ(arena.GetUsedSize(), 0);
+
+	// the same amount of memory fits into the merged block
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		arena.Allocate(100);
+	}
+	ASSERT_EQ(arena.GetBlockCount(), 1);
+}
+
+TEST(FrameAllocator, FramesInFlightKeepTheirMemory)
+{
+	kbs::FrameAllocator* allocator = kbs::Singleton::GetInstance<kbs::FrameAllocator>();
+
+	allocator->BeginFrame(0);
+	uint32_t* first = allocator->GetArena().AllocateArray<uint32_t>(1);
+	*first = 0xdeadbeef;
+
+	for (uint64_t frame = 1; frame < kbs::FrameAllocator::frameCount; frame++)
+	{
+		allocator->BeginFrame(frame);
+		uint32_t* other = allocator->GetArena().AllocateArray<uint32_t>(1);
+		*other = 0;
+		ASSERT_NE(other, first);
+	}
+	ASSERT_EQ(*first, 0xdeadbeef);
+}
+
+// the per frame pattern of the renderer: collect, sort and transform into frame vectors
+static uint64_t SimulateFrame(uint32_t objectCount)
+{
+	kbs::FrameVector<TestObject> objects;
+	objects.reserve(64);
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		objects.push_back(TestObject{ i, (float)((i * 7919) % objectCount), {} });
+	}
+	std::sort(objects.begin(), objects.end(), [](const TestObject& lhs, const TestObject& rhs) { return lhs.distance < rhs.distance; });
+
+	kbs::FrameVector<float> distances(objects.size());
+	for (uint32_t i = 0; i < objects.size(); i++) distances[i] = objects[i].distance;
+	return objects.size() + distances.size();
+}
+
+TEST(FrameAllocator, SteadyStateFramesDontAllocate)
+{
+	kbs::FrameAllocator* allocator = kbs::Singleton::GetInstance<kbs::FrameAllocator>();
+
+	// warm up, arenas grow to the working set of a frame
+	for (uint64_t frame = 0; frame < 2 * kbs::FrameAllocator::frameCount; frame++)
+	{
+		allocator->BeginFrame(frame);
+		SimulateFrame(5000);
+	}
+
+	uint64_t allocations = g_AllocationCount;
+	for (uint64_t frame = 2 * kbs::FrameAllocator::frameCount; frame < 100; frame++)
+	{
+		allocator->BeginFrame(frame);
+		SimulateFrame(5000);
+	}
+	ASSERT_EQ(g_AllocationCount.load(), allocations);
+}
+
+TEST(FrameAllocator, FrameVectorBenchmark)
+{
+	const uint32_t frames = 200, objectCount = 5000;
+	kbs::FrameAllocator* allocator = kbs::Singleton::GetInstance<kbs::FrameAllocator>();
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t heapAllocations = g_AllocationCount;
+	for (uint32_t frame = 0; frame < frames; frame++)
+	{
+		std::vector<TestObject> objects;
+		for (uint32_t i = 0; i < objectCount; i++) objects.push_back(TestObject{ i, (float)i, {} });
+		std::vector<float> distances(objects.size());
+	}
+	heapAllocations = g_AllocationCount - heapAllocations;
+	auto middle = std::chrono::steady_clock::now();
+
+	uint64_t arenaAllocations = g_AllocationCount;
+	size_t highWater = 0;
+	for (uint32_t frame = 0; frame < frames; frame++)
+	{
+		allocator->BeginFrame(frame);
+		kbs::FrameVector<TestObject> objects;
+		// the renderer reserves its lists from the largest frame so far, a growing arena vector leaves its old copies behind
+		objects.reserve(highWater);
+		for (uint32_t i = 0; i < objectCount; i++) objects.push_back(TestObject{ i, (float)i, {} });
+		kbs::FrameVector<float> distances(objects.size());
+		highWater = std::max(highWater, objects.size());
+	}
+	arenaAllocations = g_AllocationCount - arenaAllocations;
+	auto end = std::chrono::steady_clock::now();
+
+	std::cout << "[ FrameAllocator ] std::vector " << std::chrono::duration<double, std::milli>(middle - start).count() / frames
+		<< "ms/frame " << heapAllocations / frames << " allocations/frame, FrameVector "
+		<< std::chrono::duration<double, std::milli>(end - middle).count() / frames << "ms/frame "
+		<< arenaAllocations / frames << " allocations/frame" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "Core/FrameStatistics.h"
+#include <fstream>
+#include <sstream>
+
+TEST(FrameStatistics, PercentilesOfKnownFrames)
+{
+	kbs::FrameTimeRecorder recorder;
+	// frames of 1ms, 2ms ... 100ms in shuffled order
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		recorder.AddFrame((double)((i * 37) % 100 + 1));
+	}
+
+	kbs::FrameTimeReport report = recorder.BuildReport();
+	ASSERT_EQ(report.frameCount, 100);
+	ASSERT_DOUBLE_EQ(report.minMs, 1.0);
+	ASSERT_DOUBLE_EQ(report.maxMs, 100.0);
+	ASSERT_DOUBLE_EQ(report.meanMs, 50.5);
+	ASSERT_DOUBLE_EQ(report.p50Ms, 50.0);
+	ASSERT_DOUBLE_EQ(report.p95Ms, 95.0);
+	ASSERT_DOUBLE_EQ(report.p99Ms, 99.0);
+}
+
+TEST(FrameStatistics, WarmupFramesAreExcluded)
+{
+	kbs::FrameTimeRecorder recorder;
+	recorder.AddFrame(500.0);
+	recorder.AddFrame(300.0);
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		recorder.AddFrame(16.0);
+	}
+
+	kbs::FrameTimeReport report = recorder.BuildReport(2);
+	ASSERT_EQ(report.frameCount, 10);
+	ASSERT_DOUBLE_EQ(report.maxMs, 16.0);
+	ASSERT_DOUBLE_EQ(report.p99Ms, 16.0);
+
+	// every frame is a warmup frame
+	ASSERT_EQ(recorder.BuildReport(100).frameCount, 0);
+}
+
+TEST(FrameStatistics, JsonReportIsWritten)
+{
+	kbs::FrameTimeRecorder recorder;
+	recorder.AddFrame(4.0);
+	recorder.AddFrame(8.0);
+
+	std::string path = "frame_statistics_test.json";
+	ASSERT_TRUE(recorder.WriteJson(path));
+
+	std::ifstream file(path);
+	std::stringstream content;
+	content << file.rdbuf();
+	std::string json = content.str();
+
+	ASSERT_NE(json.find("\"frames\": 2"), std::string::npos);
+	ASSERT_NE(json.find("\"mean_ms\": 6"), std::string::npos);
+	ASSERT_NE(json.find("\"p50_ms\": 4"), std::string::npos);
+	ASSERT_NE(json.find("\"p99_ms\": 8"), std::string::npos);
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
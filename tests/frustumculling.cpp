@@ -0,0 +1,223 @@
+#include "gtest/gtest.h"
+#include "Math/FrustumCulling.h"
+#include "Renderer/RenderCamera.h"
+#include "Renderer/Flags.h"
+#include "Scene/Entity.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace kbs;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+static const char* s_LevelNames[] = { "scalar", "sse", "avx2" };
+
+static Frustum CreateFrustum(vec3 position, vec3 target)
+{
+	mat4 projection = glm::perspectiveLH_ZO(1.f, 16.f / 9.f, .1f, 200.f);
+	mat4 view = glm::lookAtLH(position, target, vec3(0, 1, 0));
+	return Frustum::FromMatrix(projection * view);
+}
+
+static void FillRandomBounds(BoundsSoA& bounds, uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-200.f, 200.f), extent(.1f, 10.f);
+	bounds.Resize(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		vec3 center(position(rng), position(rng), position(rng));
+		if (i % 3 == 0)
+		{
+			bounds.Set(i, Sphere{ center, extent(rng) });
+		}
+		else
+		{
+			bounds.Set(i, AABB::FromCenterExtent(center, vec3(extent(rng), extent(rng), extent(rng))));
+		}
+	}
+}
+
+// smallest signed distance of the bounds to the planes, the bounds are culled if it is negative
+static float ReferenceDistance(const Frustum& frustum, const BoundsSoA& bounds, uint32_t i, CullingShape shape)
+{
+	vec3 center(bounds.center[0][i], bounds.center[1][i], bounds.center[2][i]);
+	vec3 extent(bounds.extent[0][i], bounds.extent[1][i], bounds.extent[2][i]);
+	float distance = FLT_MAX;
+	for (const vec4& plane : frustum.planes)
+	{
+		vec3 normal(plane);
+		float radius = shape == CullingShape::Sphere ? bounds.radius[i] : math::dot(glm::abs(normal), extent);
+		distance = std::min(distance, math::dot(normal, center) + plane.w + radius);
+	}
+	return distance;
+}
+
+// the simd paths may fuse multiplies and adds, results only differ for bounds touching a plane
+static void ExpectMatchesReference(const Frustum& frustum, const BoundsSoA& bounds, uint32_t begin, uint32_t end,
+	const std::vector<uint32_t>& visible, CullingShape shape)
+{
+	uint32_t v = 0;
+	for (uint32_t i = begin; i < end; i++)
+	{
+		float distance = ReferenceDistance(frustum, bounds, i, shape);
+		bool culled = v == visible.size() || visible[v] != i;
+		if (!culled) v++;
+		if (std::abs(distance) > 1e-3f)
+		{
+			ASSERT_EQ(culled, distance < 0.f) << "bounds " << i;
+		}
+	}
+	ASSERT_EQ(v, visible.size());
+}
+
+TEST(FrustumCulling, MatchesScalarReference)
+{
+	constexpr uint32_t count = 10001;
+	BoundsSoA bounds;
+	FillRandomBounds(bounds, count, 7);
+	Frustum frustum = CreateFrustum(vec3(10, 20, -150), vec3(0, 0, 0));
+
+	for (uint32_t level = 0; level < 3; level++)
+	{
+		if (s_Levels[level] > math::GetSupportedSimdLevel()) continue;
+		math::SetSimdLevel(s_Levels[level]);
+		for (CullingShape shape : { CullingShape::Box, CullingShape::Sphere })
+		{
+			std::vector<uint32_t> visible(count);
+			visible.resize(math::CullFrustum(frustum, bounds, 0, count, visible.data(), shape));
+			ExpectMatchesReference(frustum, bounds, 0, count, visible, shape);
+			ASSERT_GT(visible.size(), 0);
+			ASSERT_LT(visible.size(), count);
+
+			// ranges start at multiples of the alignment and may end anywhere
+			std::vector<uint32_t> rangeVisible(count);
+			rangeVisible.resize(math::CullFrustum(frustum, bounds, 16, 1005, rangeVisible.data(), shape));
+			ExpectMatchesReference(frustum, bounds, 16, 1005, rangeVisible, shape);
+		}
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+TEST(FrustumCulling, BoxesAreTighterThanSpheres)
+{
+	BoundsSoA bounds;
+	bounds.Resize(3);
+	// behind the near plane but inside the bounding sphere of the box
+	Frustum frustum = CreateFrustum(vec3(0, 0, 0), vec3(0, 0, 1));
+	bounds.Set(0, AABB(vec3(-10, -10, -2), vec3(10, 10, -.5f)));
+	bounds.Set(1, Sphere{ vec3(0, 0, 100), 1.f });
+	bounds.SetUnbounded(2);
+
+	std::vector<uint32_t> visible(3);
+	visible.resize(math::CullFrustum(frustum, bounds, 0, 3, visible.data(), CullingShape::Box));
+	ASSERT_EQ(visible, std::vector<uint32_t>({ 1, 2 }));
+	visible.resize(3);
+	visible.resize(math::CullFrustum(frustum, bounds, 0, 3, visible.data(), CullingShape::Sphere));
+	ASSERT_EQ(visible, std::vector<uint32_t>({ 0, 1, 2 }));
+}
+
+TEST(FrustumCulling, RenderCameraCullsRenderWorld)
+{
+	Singleton::GetInstance<JobSystem>()->Initialize(3);
+	Scene scene;
+	auto createObject = [&](vec3 position, bool bounded, RenderOptionFlags flags)
+	{
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(scene.CreateTransform({}, position, quat(1, 0, 0, 0), vec3(1)));
+		RenderableComponent render;
+		render.targetMesh = UUID(1);
+		render.AddRenderablePass(UUID(2), flags);
+		e.AddComponent<RenderableComponent>(render);
+		if (bounded)
+		{
+			e.AddComponent<BoundsComponent>(AABB(vec3(-1), vec3(1)));
+		}
+		return e.GetUUID();
+	};
+
+	RenderCamera camera(CameraComponent(100.f, .1f, 1.f, 1.f), Transform(TransformComponent(vec3(0), quat(1, 0, 0, 0), vec3(1)), Entity()));
+	vec3 front = camera.GetCameraTransform().GetFront();
+	UUID inFront = createObject(front * 10.f, true, 0);
+	UUID behind = createObject(front * -10.f, true, 0);
+	UUID unbounded = createObject(front * -10.f, false, 0);
+	UUID notCulled = createObject(front * -10.f, true, RenderOption_DontCullByDistance);
+	// enough objects for several culling jobs
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> position(-150.f, 150.f);
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		createObject(vec3(position(rng), position(rng), position(rng)), true, 0);
+	}
+
+	RenderWorld world;
+	world.Extract(scene);
+	RenderCameraCullingResult result;
+	ASSERT_FALSE(result.IsValid());
+	camera.Cull(world, result);
+	ASSERT_TRUE(result.IsValid());
+
+	std::vector<UUID> visibleIDs;
+	for (uint32_t i : result.GetVisibleObjects())
+	{
+		visibleIDs.push_back(world.objects[i].id);
+	}
+	auto isVisible = [&](UUID id) { return std::find(visibleIDs.begin(), visibleIDs.end(), id) != visibleIDs.end(); };
+	ASSERT_TRUE(isVisible(inFront));
+	ASSERT_FALSE(isVisible(behind));
+	ASSERT_TRUE(isVisible(unbounded));
+	ASSERT_TRUE(isVisible(notCulled));
+
+	std::vector<uint32_t> expected(world.bounds.Size());
+	expected.resize(math::CullFrustum(camera.GetCullingFrustum(), world.bounds, 0, world.bounds.Size(), expected.data()));
+	ASSERT_EQ(result.GetVisibleObjects(), expected);
+	ASSERT_LT(expected.size(), world.objects.size() / 2);
+}
+
+TEST(FrustumCulling, CullingBenchmark)
+{
+	constexpr uint32_t count = 1000000;
+	BoundsSoA bounds;
+	FillRandomBounds(bounds, count, 11);
+	Frustum frustum = CreateFrustum(vec3(0, 0, -250), vec3(0, 0, 0));
+	std::vector<uint32_t> visible(count);
+
+	auto ms = [](auto&& func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	for (uint32_t level = 0; level < 3; level++)
+	{
+		if (s_Levels[level] > math::GetSupportedSimdLevel()) continue;
+		math::SetSimdLevel(s_Levels[level]);
+		for (CullingShape shape : { CullingShape::Box, CullingShape::Sphere })
+		{
+			uint32_t visibleCount = 0;
+			double time = ms([&]() { visibleCount = math::CullFrustum(frustum, bounds, 0, count, visible.data(), shape); });
+			std::cout << "[ FrustumCulling ] " << s_LevelNames[level] << (shape == CullingShape::Box ? " boxes : " : " spheres : ")
+				<< count / time << " objects/ms, " << visibleCount << " of " << count << " visible" << std::endl;
+		}
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+
+	// the same objects culled through a render camera on the job system threads
+	Singleton::GetInstance<JobSystem>()->Initialize();
+	RenderWorld world;
+	world.bounds = bounds;
+	RenderCamera camera(CameraComponent(200.f, .1f, 1.f, 1.f), Transform(TransformComponent(vec3(0, 0, -250), quat(1, 0, 0, 0), vec3(1)), Entity()));
+	RenderCameraCullingResult result;
+	camera.Cull(world, result);
+	double time = ms([&]() { camera.Cull(world, result); });
+	std::cout << "[ FrustumCulling ] RenderCamera::Cull (" << Singleton::GetInstance<JobSystem>()->GetThreadCount() << " threads) : "
+		<< count / time << " objects/ms, " << result.GetVisibleObjects().size() << " visible" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -2,6 +2,9 @@
 #include "gvk.h"
 #include "Core/Hasher.h"
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 
 TEST(Hasher, SamplerCreateInfo)
 {
@@ -43,8 +46,110 @@ TEST(Hasher, SamplerCreateInfo)
 }
 
 
+static std::vector<uint8_t> MakeTestData(uint32_t size)
+{
+	std::vector<uint8_t> data(size);
+	uint64_t state = 0x1234567;
+	for (auto& b : data)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		b = (uint8_t)(state >> 56);
+	}
+	return data;
+}
+
+TEST(Hasher, StreamingMatchesOneShot)
+{
+	std::vector<uint8_t> data = MakeTestData(1024);
+	uint32_t pieceSizes[] = { 1, 3, 7, 16, 17, 47, 48, 49, 100 };
+
+	for (uint32_t size = 0; size <= data.size(); size++)
+	{
+		uint64_t expected = kbs::Hasher::HashMemoryContent(data.data(), size);
+		kbs::Hash128 expected128 = kbs::Hasher::HashMemoryContent128(data.data(), size);
+
+		for (uint32_t p = 0; p < _countof(pieceSizes); p++)
+		{
+			kbs::HashStream stream;
+			for (uint32_t offset = 0; offset < size; offset += pieceSizes[p])
+			{
+				stream.Update(data.data() + offset, std::min(pieceSizes[p], size - offset));
+			}
+			ASSERT_EQ(stream.Finalize(), expected) << "size " << size << " piece " << pieceSizes[p];
+			ASSERT_EQ(stream.Finalize128(), expected128);
+		}
+	}
+}
+
+TEST(Hasher, ConstexprMatchesRuntime)
+{
+	constexpr uint64_t compileTimeHash = kbs::Hasher::HashConstexpr("standard_vertex.vert");
+	static_assert(compileTimeHash != 0, "hash must be usable in constant expressions");
+
+	std::string name = "standard_vertex.vert";
+	ASSERT_EQ(compileTimeHash, kbs::Hasher::HashMemoryContent(name.data(), name.size()));
+
+	std::vector<uint8_t> data = MakeTestData(300);
+	for (uint32_t size = 0; size <= data.size(); size++)
+	{
+		ASSERT_EQ(kbs::Hasher::HashConstexpr((const char*)data.data(), size), kbs::Hasher::HashMemoryContent(data.data(), size));
+	}
+}
+
+TEST(Hasher, VisiterMatchesMemory)
+{
+	std::vector<uint8_t> data = MakeTestData(1000);
+	uint64_t visited = kbs::Hasher::HashContent([&](uint64_t offset) { return (char)data[offset]; }, data.size());
+	ASSERT_EQ(visited, kbs::Hasher::HashMemoryContent(data.data(), data.size()));
+}
+
+TEST(Hasher, SeedAndLengthChangeHash)
+{
+	std::vector<uint8_t> data(64, 0);
+	std::vector<uint64_t> hashes;
+	for (uint32_t size = 0; size <= data.size(); size++)
+	{
+		hashes.push_back(kbs::Hasher::HashMemoryContent(data.data(), size));
+		hashes.push_back(kbs::Hasher::HashMemoryContent(data.data(), size, 42));
+	}
+	std::sort(hashes.begin(), hashes.end());
+	ASSERT_EQ(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+TEST(Hasher, Throughput)
+{
+	uint32_t sizes[] = { 64, 4096, 1 << 20, 64 << 20 };
+	for (uint32_t s = 0; s < _countof(sizes); s++)
+	{
+		std::vector<uint8_t> data = MakeTestData(sizes[s]);
+		uint64_t iterations = std::max<uint64_t>(1, (256ull << 20) / sizes[s]);
+
+		uint64_t sink = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint64_t i = 0; i < iterations; i++)
+		{
+			sink += kbs::Hasher::HashMemoryContent(data.data(), data.size(), i);
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		kbs::HashStream stream;
+		auto streamStart = std::chrono::high_resolution_clock::now();
+		for (uint64_t i = 0; i < iterations; i++)
+		{
+			stream.Update(data.data(), data.size());
+		}
+		sink += stream.Finalize();
+		double streamSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - streamStart).count();
+
+		double bytes = (double)sizes[s] * iterations;
+		std::cout << "[ Hasher ] " << sizes[s] << " bytes : one shot " << bytes / seconds / 1e9 << " GB/s, stream "
+			<< bytes / streamSeconds / 1e9 << " GB/s (" << sink % 2 << ")" << std::endl;
+	}
+}
+
+
 int main() 
 {
 	testing::InitGoogleTest();
-	RUN_ALL_TESTS();
+	return RUN_ALL_TESTS();
 }
\ No newline at end of file
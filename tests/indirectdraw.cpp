@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include "Renderer/IndirectDraw.h"
+#include "Renderer/RenderCamera.h"
+#include "Renderer/Flags.h"
+#include "Scene/Entity.h"
+#include "Core/JobSystem.h"
+#include <iostream>
+#include <random>
+#include <set>
+
+using namespace kbs;
+
+static IndirectDrawSource CreateSource(uint64_t shader, uint64_t material, uint64_t meshGroup, uint32_t objectIndex)
+{
+	return IndirectDrawSource{ UUID(shader), UUID(material), UUID(meshGroup), objectIndex, 36 + objectIndex, objectIndex * 3 };
+}
+
+TEST(IndirectDraw, BuildGroupsSourcesIntoBatches)
+{
+	std::vector<IndirectDrawSource> sources = {
+		CreateSource(2, 10, 100, 0),
+		CreateSource(1, 11, 100, 1),
+		CreateSource(2, 10, 100, 2),
+		CreateSource(1, 11, 101, 3),
+		CreateSource(1, 11, 100, 4),
+		CreateSource(2, 10, 100, 5),
+	};
+	std::vector<IndirectDrawRecord> records;
+	std::vector<IndirectDrawBatch> batches;
+	BuildIndirectDraws(sources, records, batches);
+
+	ASSERT_EQ(records.size(), 6);
+	ASSERT_EQ(batches.size(), 3);
+	uint32_t command = 0;
+	for (uint32_t b = 0; b < batches.size(); b++)
+	{
+		ASSERT_EQ(batches[b].firstCommand, command);
+		for (uint32_t i = command; i < command + batches[b].maxCommandCount; i++)
+		{
+			ASSERT_EQ(records[i].batch, b);
+			ASSERT_EQ(records[i].commandBase, batches[b].firstCommand);
+			ASSERT_EQ((uint64_t)sources[i].shader, (uint64_t)batches[b].shader);
+			ASSERT_EQ((uint64_t)sources[i].material, (uint64_t)batches[b].material);
+			ASSERT_EQ((uint64_t)sources[i].meshGroup, (uint64_t)batches[b].meshGroup);
+			ASSERT_EQ(records[i].objectIndex, sources[i].objectIndex);
+			ASSERT_EQ(records[i].indexCount, 36 + sources[i].objectIndex);
+			ASSERT_EQ(records[i].firstIndex, sources[i].objectIndex * 3);
+			if (i > command)
+			{
+				ASSERT_LT(records[i - 1].objectIndex, records[i].objectIndex);
+			}
+		}
+		command += batches[b].maxCommandCount;
+	}
+	ASSERT_EQ(command, records.size());
+	ASSERT_EQ(batches[0].maxCommandCount, 2);
+	ASSERT_EQ(batches[1].maxCommandCount, 1);
+	ASSERT_EQ(batches[2].maxCommandCount, 3);
+
+	sources.clear();
+	BuildIndirectDraws(sources, records, batches);
+	ASSERT_TRUE(records.empty());
+	ASSERT_TRUE(batches.empty());
+}
+
+TEST(IndirectDraw, VisibleDrawsMatchCPUPath)
+{
+	Singleton::GetInstance<JobSystem>()->Initialize(3);
+	Scene scene;
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> position(-150.f, 150.f);
+	std::uniform_int_distribution<uint32_t> material(0, 7), passes(1, 3);
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(scene.CreateTransform({}, vec3(position(rng), position(rng), position(rng)), quat(1, 0, 0, 0), vec3(1)));
+		RenderableComponent render;
+		render.targetMesh = UUID(1 + i % 5);
+		uint32_t passCount = passes(rng);
+		for (uint32_t p = 0; p < passCount; p++)
+		{
+			render.AddRenderablePass(UUID(100 + material(rng)), i % 97 == 0 ? RenderOption_DontCullByDistance : 0);
+		}
+		e.AddComponent<RenderableComponent>(render);
+		if (i % 211 != 0)
+		{
+			e.AddComponent<BoundsComponent>(AABB(vec3(-2), vec3(2)));
+		}
+	}
+
+	RenderWorld world;
+	world.Extract(scene);
+	RenderCamera camera(CameraComponent(100.f, .1f, 1.f, 1.f), Transform(TransformComponent(vec3(0), quat(1, 0, 0, 0), vec3(1)), Entity()));
+
+	// every pass becomes a draw, materials are drawn by two shaders and the meshes live in two groups
+	std::vector<IndirectDrawSource> sources;
+	for (uint32_t objectIndex = 0; objectIndex < world.objects.size(); objectIndex++)
+	{
+		const RenderWorldObject& object = world.objects[objectIndex];
+		for (uint32_t p = 0; p < object.passCount; p++)
+		{
+			uint64_t material = world.passes[object.firstPass + p].material;
+			sources.push_back(CreateSource(material % 2, material, (uint64_t)object.mesh % 2, objectIndex));
+		}
+	}
+	std::vector<IndirectDrawRecord> records;
+	std::vector<IndirectDrawBatch> batches;
+	BuildIndirectDraws(sources, records, batches);
+	ASSERT_EQ(batches.size(), 16);
+
+	RenderCameraCullingResult result;
+	camera.Cull(world, result);
+	uint32_t cpuDraws = 0;
+	for (uint32_t objectIndex : result.GetVisibleObjects())
+	{
+		cpuDraws += world.objects[objectIndex].passCount;
+	}
+
+	std::vector<uint32_t> counts;
+	CountVisibleIndirectDraws(records, world.bounds, camera.GetCullingFrustum(), counts);
+	ASSERT_EQ(counts.size(), batches.size());
+	uint32_t indirectDraws = 0;
+	for (uint32_t b = 0; b < batches.size(); b++)
+	{
+		ASSERT_LE(counts[b], batches[b].maxCommandCount);
+		indirectDraws += counts[b];
+	}
+	ASSERT_EQ(indirectDraws, cpuDraws);
+	ASSERT_LT(indirectDraws, records.size() / 2);
+	std::cout << "[ IndirectDraw ] " << records.size() << " draws in " << batches.size() << " indirect draws, "
+		<< indirectDraws << " visible" << std::endl;
+
+	// emulates shader/Indirect/cull.comp, the commands compacted behind the first command of a batch draw every visible pass once
+	std::set<uint32_t> visibleObjects(result.GetVisibleObjects().begin(), result.GetVisibleObjects().end());
+	std::vector<uint32_t> written(batches.size(), 0);
+	std::multiset<std::pair<uint32_t, uint32_t>> drawn, expected;
+	std::vector<uint32_t> commandObjects(records.size(), UINT32_MAX);
+	const Frustum frustum = camera.GetCullingFrustum();
+	for (const IndirectDrawRecord& record : records)
+	{
+		vec3 center(world.bounds.center[0][record.objectIndex], world.bounds.center[1][record.objectIndex], world.bounds.center[2][record.objectIndex]);
+		vec3 extent(world.bounds.extent[0][record.objectIndex], world.bounds.extent[1][record.objectIndex], world.bounds.extent[2][record.objectIndex]);
+		bool culled = false;
+		for (const vec4& plane : frustum.planes)
+		{
+			culled |= math::dot(vec3(plane), center) + plane.w + math::dot(glm::abs(vec3(plane)), extent) < 0.f;
+		}
+		if (culled) continue;
+		uint32_t slot = written[record.batch]++;
+		commandObjects[record.commandBase + slot] = record.objectIndex;
+		drawn.insert({ record.batch, record.objectIndex });
+	}
+	for (const IndirectDrawRecord& record : records)
+	{
+		if (visibleObjects.count(record.objectIndex)) expected.insert({ record.batch, record.objectIndex });
+	}
+	ASSERT_EQ(written, counts);
+	ASSERT_EQ(drawn, expected);
+	for (uint32_t b = 0; b < batches.size(); b++)
+	{
+		for (uint32_t i = 0; i < batches[b].maxCommandCount; i++)
+		{
+			ASSERT_EQ(commandObjects[batches[b].firstCommand + i] != UINT32_MAX, i < counts[b]);
+		}
+	}
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+#include "Renderer/Instancing.h"
+#include "Renderer/RenderCamera.h"
+#include "Scene/Entity.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+
+using namespace kbs;
+
+// the state of a draw RenderSceneByCamera compares to instance it
+struct ForestDraw
+{
+	UUID	 id;
+	UUID	 material;
+	UUID	 mesh;
+	uint32_t objectIndex;
+};
+
+static bool operator==(const ForestDraw& lhs, const ForestDraw& rhs)
+{
+	return lhs.id == rhs.id && lhs.material == rhs.material && lhs.mesh == rhs.mesh && lhs.objectIndex == rhs.objectIndex;
+}
+
+static std::vector<InstancedDraw> Instance(const std::vector<ForestDraw>& draws)
+{
+	std::vector<InstancedDraw> instancedDraws;
+	BuildInstancedDraws((uint32_t)draws.size(), [&](uint32_t first, uint32_t i)
+		{
+			return draws[first].material == draws[i].material && draws[first].mesh == draws[i].mesh;
+		}, instancedDraws);
+	return instancedDraws;
+}
+
+// the draws the instanced draws record, instance k of a draw reads the object of draw firstDraw + k
+static std::vector<ForestDraw> Expand(const std::vector<ForestDraw>& draws, const std::vector<InstancedDraw>& instancedDraws)
+{
+	std::vector<ForestDraw> expanded;
+	for (const InstancedDraw& draw : instancedDraws)
+	{
+		for (uint32_t k = 0; k < draw.instanceCount; k++)
+		{
+			ForestDraw instance = draws[draw.firstDraw];
+			instance.id = draws[draw.firstDraw + k].id;
+			instance.objectIndex = draws[draw.firstDraw + k].objectIndex;
+			expanded.push_back(instance);
+		}
+	}
+	return expanded;
+}
+
+TEST(Instancing, RunsShareTheirState)
+{
+	std::vector<ForestDraw> draws = {
+		{ UUID(1), UUID(10), UUID(100), 0 },
+		{ UUID(2), UUID(10), UUID(100), 1 },
+		{ UUID(3), UUID(10), UUID(101), 2 },
+		{ UUID(4), UUID(11), UUID(101), 3 },
+		{ UUID(5), UUID(11), UUID(101), 4 },
+		{ UUID(6), UUID(11), UUID(101), 5 },
+		{ UUID(7), UUID(10), UUID(100), 6 },
+	};
+	std::vector<InstancedDraw> instancedDraws = Instance(draws);
+	ASSERT_EQ(instancedDraws.size(), 4);
+	uint32_t expectedCounts[] = { 2, 1, 3, 1 };
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(instancedDraws[i].instanceCount, expectedCounts[i]);
+	}
+	ASSERT_EQ(Expand(draws, instancedDraws), draws);
+
+	draws.clear();
+	ASSERT_TRUE(Instance(draws).empty());
+}
+
+class ForestScene
+{
+public:
+	static constexpr uint32_t treeCount = 10000;
+	static constexpr uint32_t variantCount = 3;
+
+	ForestScene()
+	{
+		Singleton::GetInstance<JobSystem>()->Initialize(3);
+		// every tree is a trunk and a crown, each with a few mesh variants
+		std::mt19937 rng(11);
+		std::uniform_real_distribution<float> position(-500.f, 500.f);
+		std::uniform_int_distribution<uint32_t> variant(0, variantCount - 1);
+		for (uint32_t i = 0; i < treeCount; i++)
+		{
+			vec3 root(position(rng), 0.f, position(rng));
+			uint32_t v = variant(rng);
+			CreatePart(root, UUID(10 + v), UUID(100), AABB(vec3(-.5f, 0, -.5f), vec3(.5f, 6, .5f)));
+			CreatePart(root + vec3(0, 6, 0), UUID(20 + v), UUID(101), AABB(vec3(-3, -2, -3), vec3(3, 4, 3)));
+		}
+		world.Extract(scene);
+	}
+
+	// what RenderSceneByCamera collects and sorts for the camera
+	std::vector<ForestDraw> CollectDraws(RenderCamera& camera)
+	{
+		RenderCameraCullingResult result;
+		camera.Cull(world, result);
+		std::vector<ForestDraw> draws;
+		for (uint32_t objectIndex : result.GetVisibleObjects())
+		{
+			const RenderWorldObject& object = world.objects[objectIndex];
+			for (uint32_t p = 0; p < object.passCount; p++)
+			{
+				draws.push_back(ForestDraw{ object.id, world.passes[object.firstPass + p].material, object.mesh, objectIndex });
+			}
+		}
+		std::sort(draws.begin(), draws.end(), [](const ForestDraw& lhs, const ForestDraw& rhs)
+			{
+				return std::make_tuple((uint64_t)lhs.material, (uint64_t)lhs.mesh, (uint64_t)lhs.id)
+					< std::make_tuple((uint64_t)rhs.material, (uint64_t)rhs.mesh, (uint64_t)rhs.id);
+			});
+		return draws;
+	}
+
+	Scene		scene;
+	RenderWorld world;
+
+private:
+	void CreatePart(vec3 position, UUID mesh, UUID material, AABB bounds)
+	{
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(scene.CreateTransform({}, position, quat(1, 0, 0, 0), vec3(1)));
+		RenderableComponent render;
+		render.targetMesh = mesh;
+		render.AddRenderablePass(material, 0);
+		e.AddComponent<RenderableComponent>(render);
+		e.AddComponent<BoundsComponent>(bounds);
+	}
+};
+
+TEST(Instancing, ForestDrawsEveryObjectOnce)
+{
+	ForestScene forest;
+	RenderCamera camera(CameraComponent(300.f, .1f, 1.f, 1.f), Transform(TransformComponent(vec3(0, 20, -520), quat(1, 0, 0, 0), vec3(1)), Entity()));
+	std::vector<ForestDraw> draws = forest.CollectDraws(camera);
+	ASSERT_GT(draws.size(), 500);
+
+	std::vector<InstancedDraw> instancedDraws = Instance(draws);
+	// the instances draw the same objects with the same state in the same order
+	ASSERT_EQ(Expand(draws, instancedDraws), draws);
+	std::set<std::pair<uint64_t, uint64_t>> states;
+	for (uint32_t i = 0; i < instancedDraws.size(); i++)
+	{
+		const ForestDraw& first = draws[instancedDraws[i].firstDraw];
+		ASSERT_TRUE(states.insert({ first.material, first.mesh }).second) << "a state is split into several draws";
+	}
+	ASSERT_EQ(instancedDraws.size(), 2 * ForestScene::variantCount);
+}
+
+TEST(Instancing, ForestBenchmark)
+{
+	ForestScene forest;
+	// the whole forest is visible from above
+	RenderCamera camera(CameraComponent(2000.f, .1f, 1.f, 1.5f), Transform(TransformComponent(vec3(0, 800, 0), glm::angleAxis(glm::radians(90.f), vec3(1, 0, 0)), vec3(1)), Entity()));
+	std::vector<ForestDraw> draws = forest.CollectDraws(camera);
+	ASSERT_EQ(draws.size(), 2 * ForestScene::treeCount);
+
+	std::vector<InstancedDraw> instancedDraws;
+	constexpr uint32_t iterations = 100;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		instancedDraws = Instance(draws);
+	}
+	double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count() / iterations;
+
+	ASSERT_EQ(Expand(draws, instancedDraws), draws);
+	ASSERT_EQ(instancedDraws.size(), 2 * ForestScene::variantCount);
+	std::cout << "[ Instancing ] " << ForestScene::treeCount << " trees : " << draws.size() << " draw calls -> "
+		<< instancedDraws.size() << " instanced draw calls, " << time << " ms to build the runs" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <iostream>
+
+TEST(JobSystem, ParallelForVisitsEveryElementOnce)
+{
+	kbs::JobSystem jobSystem;
+	jobSystem.Initialize(3);
+
+	std::vector<std::atomic<uint32_t>> visits(100000);
+	jobSystem.ParallelFor(0, (uint32_t)visits.size(), 0,
+		[&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t i = first; i < last; i++) visits[i]++;
+		}
+	);
+
+	for (auto& v : visits)
+	{
+		ASSERT_EQ(v.load(), 1);
+	}
+}
+
+TEST(JobSystem, DependencyRunsAfterCounter)
+{
+	kbs::JobSystem jobSystem;
+	jobSystem.Initialize(3);
+
+	std::atomic<uint32_t> finished = 0;
+	std::atomic<bool> orderViolated = false;
+
+	kbs::JobCounter first, second;
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		jobSystem.Submit([&]() { finished++; }, &first);
+	}
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		jobSystem.Submit([&]() { if (finished.load() != 64) orderViolated = true; }, &second, &first);
+	}
+	jobSystem.Wait(second);
+
+	ASSERT_TRUE(first.IsDone());
+	ASSERT_FALSE(orderViolated.load());
+}
+
+TEST(JobSystem, NestedParallelFor)
+{
+	kbs::JobSystem jobSystem;
+	jobSystem.Initialize(3);
+
+	std::atomic<uint64_t> sum = 0;
+	jobSystem.ParallelForEach(0, 64,
+		[&](uint32_t)
+		{
+			jobSystem.ParallelForEach(0, 1000, [&](uint32_t j) { sum += j; }, 100);
+		}, 1
+	);
+	ASSERT_EQ(sum.load(), 64ull * (999ull * 1000ull / 2));
+}
+
+TEST(JobSystem, SubmitRangeOutlivesCaller)
+{
+	kbs::JobSystem jobSystem;
+	jobSystem.Initialize(2);
+
+	std::vector<uint32_t> values(4096, 0);
+	kbs::JobCounter counter;
+	{
+		auto job = [&](uint32_t first, uint32_t last) { for (uint32_t i = first; i < last; i++) values[i] = i; };
+		jobSystem.SubmitRange(0, (uint32_t)values.size(), 64, job, &counter);
+	}
+	jobSystem.Wait(counter);
+
+	for (uint32_t i = 0; i < values.size(); i++)
+	{
+		ASSERT_EQ(values[i], i);
+	}
+}
+
+// not a correctness test, prints the scaling of a cpu bound parallel loop
+TEST(JobSystem, ScalingBenchmark)
+{
+	const uint32_t elementCount = 1 << 20;
+	std::vector<float> data(elementCount);
+	std::iota(data.begin(), data.end(), 0.f);
+
+	uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	double singleThreadTime = 0;
+	for (uint32_t threads = 1; threads <= maxThreads; threads++)
+	{
+		kbs::JobSystem jobSystem;
+		jobSystem.Initialize(threads - 1);
+
+		std::vector<float> result(elementCount);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t iter = 0; iter < 8; iter++)
+		{
+			jobSystem.ParallelForEach(0, elementCount,
+				[&](uint32_t i)
+				{
+					float v = data[i];
+					for (uint32_t k = 0; k < 16; k++) v = std::sqrt(v * v + 1.f);
+					result[i] = v;
+				}
+			);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		if (threads == 1) singleThreadTime = ms;
+
+		std::cout << "[ JobSystem ] threads " << threads << " : " << ms << " ms, speed up " << singleThreadTime / ms << std::endl;
+	}
+}
+
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "Core/Log.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include <chrono>
+#include <ctime>
+#include <sstream>
+#include <thread>
+#include <iostream>
+
+TEST(Log, AsyncRecordsAreWrittenInOrder)
+{
+	std::ostringstream stream;
+	auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(stream);
+	kbs::Logger logger("log-test", { sink });
+	logger.EnableAsync(kbs::LogOverflowPolicy::Block, 16);
+
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		logger.info("record {}", i);
+	}
+	logger.flush();
+
+	std::string output = stream.str();
+	size_t position = 0;
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		std::string record = "record " + std::to_string(i) + "\n";
+		position = output.find(record, position);
+		ASSERT_NE(position, std::string::npos) << record;
+	}
+	ASSERT_EQ(logger.GetDroppedCount(), 0);
+}
+
+TEST(Log, LongRecordsAreTruncated)
+{
+	std::ostringstream stream;
+	auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(stream);
+	kbs::Logger logger("log-test", { sink });
+	logger.EnableAsync();
+
+	std::string longMessage(1000, 'x');
+	logger.warn("{}", longMessage.c_str());
+	logger.flush();
+
+	std::string output = stream.str();
+	ASSERT_NE(output.find("xxx..."), std::string::npos);
+	ASSERT_EQ(output.find(longMessage), std::string::npos);
+}
+
+TEST(Log, DropPolicyCountsLostRecords)
+{
+	std::ostringstream stream;
+	auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(stream);
+	kbs::Logger logger("log-test", { sink });
+	logger.EnableAsync(kbs::LogOverflowPolicy::DropAndCount, 4);
+
+	for (uint32_t i = 0; i < 10000; i++)
+	{
+		logger.info("record {}", i);
+	}
+	logger.flush();
+	uint64_t dropped = logger.GetDroppedCount();
+	logger.DisableAsync();
+
+	// every record is either written or counted as dropped
+	std::string output = stream.str();
+	uint64_t written = 0;
+	for (size_t p = output.find("record "); p != std::string::npos; p = output.find("record ", p + 1)) written++;
+	ASSERT_EQ(written + dropped, 10000);
+	if (dropped != 0)
+	{
+		ASSERT_NE(output.find("log records dropped"), std::string::npos);
+	}
+}
+
+TEST(Log, IdleConsumerSleepsUntilARecordIsPushed)
+{
+	std::ostringstream stream;
+	auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(stream);
+	kbs::Logger logger("log-test", { sink });
+	logger.EnableAsync();
+
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		logger.info("record {}", i);
+		logger.flush();
+		// long enough for the consumer to run out of spins and wait for the next record
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	// the waiting consumer doesn't poll, the process barely uses any cpu time while the queue is empty
+	std::clock_t begin = std::clock();
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	double idleTime = 1000.0 * (std::clock() - begin) / CLOCKS_PER_SEC;
+	ASSERT_LT(idleTime, 20.0);
+
+	logger.info("after idle");
+	logger.flush();
+	std::string output = stream.str();
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		ASSERT_NE(output.find("record " + std::to_string(i) + "\n"), std::string::npos);
+	}
+	ASSERT_NE(output.find("after idle"), std::string::npos);
+}
+
+// prints the average latency of a log call seen by the producer threads
+TEST(Log, ProducerLatencyBenchmark)
+{
+	const uint32_t recordsPerThread = 20000;
+	uint32_t producerCounts[] = { 1, 4, 16 };
+
+	struct Mode
+	{
+		const char* name;
+		bool async;
+		kbs::LogOverflowPolicy policy;
+	};
+	Mode modes[] = {
+		{ "sync", false, kbs::LogOverflowPolicy::Block },
+		{ "async block", true, kbs::LogOverflowPolicy::Block },
+		{ "async drop", true, kbs::LogOverflowPolicy::Drop },
+	};
+
+	for (auto& mode : modes)
+	{
+		for (uint32_t producers : producerCounts)
+		{
+			auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/log_benchmark.txt", true);
+			kbs::Logger logger("log-benchmark", { sink });
+			if (mode.async) logger.EnableAsync(mode.policy);
+
+			std::atomic<uint64_t> totalNs = 0;
+			std::vector<std::thread> threads;
+			for (uint32_t t = 0; t < producers; t++)
+			{
+				threads.emplace_back([&, t]()
+					{
+						auto start = std::chrono::high_resolution_clock::now();
+						for (uint32_t i = 0; i < recordsPerThread; i++)
+						{
+							logger.warn("warning from file {} line {}: producer {} record {} value {}", __FILE__, __LINE__, t, i, i * 0.5f);
+						}
+						auto end = std::chrono::high_resolution_clock::now();
+						totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+					});
+			}
+			for (auto& t : threads) t.join();
+			logger.flush();
+
+			double nsPerCall = (double)totalNs / ((double)producers * recordsPerThread);
+			std::cout << "[ Log ] " << mode.name << " producers " << producers << " : " << nsPerCall << " ns/call, dropped "
+				<< logger.GetDroppedCount() << std::endl;
+		}
+	}
+}
+
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
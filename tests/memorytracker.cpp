@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+#include "Core/MemoryTracker.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef KBS_ENABLE_MEMORY_TRACKING
+
+// keeps the compiler from eliding unused new/delete pairs
+static void* volatile s_Escape = nullptr;
+
+static kbs::MemoryTagStatistics Statistics(kbs::MemoryTag tag)
+{
+	return kbs::Singleton::GetInstance<kbs::MemoryTracker>()->GetStatistics(tag);
+}
+
+TEST(MemoryTracker, AllocationsAreChargedToTheCurrentTag)
+{
+	kbs::MemoryTagStatistics before = Statistics(kbs::MemoryTag::Asset);
+
+	std::vector<char>* buffer = nullptr;
+	{
+		KBS_MEMORY_TAG(Asset);
+		buffer = new std::vector<char>(1 << 20);
+	}
+	kbs::MemoryTagStatistics loaded = Statistics(kbs::MemoryTag::Asset);
+	ASSERT_GE(loaded.liveBytes - before.liveBytes, 1 << 20);
+	ASSERT_EQ(loaded.liveAllocations - before.liveAllocations, 2);
+	ASSERT_GE(loaded.peakBytes, loaded.liveBytes);
+
+	// freed outside of the scope, the bytes still go back to the asset tag
+	delete buffer;
+	kbs::MemoryTagStatistics freed = Statistics(kbs::MemoryTag::Asset);
+	ASSERT_EQ(freed.liveBytes, before.liveBytes);
+	ASSERT_EQ(freed.liveAllocations, before.liveAllocations);
+	ASSERT_EQ(freed.totalAllocations - before.totalAllocations, 2);
+}
+
+TEST(MemoryTracker, InnermostScopeWins)
+{
+	KBS_MEMORY_TAG(Scene);
+	uint64_t sceneBefore = Statistics(kbs::MemoryTag::Scene).liveBytes;
+	uint64_t shaderBefore = Statistics(kbs::MemoryTag::Shader).liveBytes;
+
+	std::unique_ptr<char[]> shaderMemory;
+	{
+		KBS_MEMORY_TAG(Shader);
+		shaderMemory.reset(new char[4096]);
+	}
+	std::unique_ptr<char[]> sceneMemory(new char[1024]);
+	s_Escape = shaderMemory.get();
+	s_Escape = sceneMemory.get();
+
+	ASSERT_EQ(Statistics(kbs::MemoryTag::Shader).liveBytes - shaderBefore, 4096);
+	ASSERT_EQ(Statistics(kbs::MemoryTag::Scene).liveBytes - sceneBefore, 1024);
+	ASSERT_EQ(kbs::MemoryTracker::GetCurrentTag(), kbs::MemoryTag::Scene);
+}
+
+TEST(MemoryTracker, AlignedAndCAllocations)
+{
+	KBS_MEMORY_TAG(Renderer);
+	uint64_t before = Statistics(kbs::MemoryTag::Renderer).liveBytes;
+
+	struct alignas(128) Aligned { char data[256]; };
+	Aligned* aligned = new Aligned();
+	ASSERT_EQ((uintptr_t)aligned % 128, 0);
+
+	char* pixels = (char*)kbs::MemoryTracker::Malloc(100);
+	memset(pixels, 7, 100);
+	pixels = (char*)kbs::MemoryTracker::Realloc(pixels, 1000);
+	ASSERT_EQ(pixels[99], 7);
+	ASSERT_EQ(Statistics(kbs::MemoryTag::Renderer).liveBytes - before, sizeof(Aligned) + 1000);
+
+	delete aligned;
+	kbs::MemoryTracker::Free(pixels);
+	ASSERT_EQ(Statistics(kbs::MemoryTag::Renderer).liveBytes, before);
+}
+
+TEST(MemoryTracker, FrameDumpAndPeaks)
+{
+	kbs::MemoryTracker* tracker = kbs::Singleton::GetInstance<kbs::MemoryTracker>();
+	std::string path = "memory_tracker_test.csv";
+	ASSERT_TRUE(tracker->SetFrameDumpPath(path));
+
+	tracker->EndFrame(0);
+	{
+		// a loading spike that is released within the frame
+		KBS_MEMORY_TAG(Asset);
+		std::vector<char> spike(8 << 20);
+		s_Escape = spike.data();
+	}
+	ASSERT_GE(Statistics(kbs::MemoryTag::Asset).framePeakBytes, 8 << 20);
+	tracker->EndFrame(1);
+	ASSERT_LT(Statistics(kbs::MemoryTag::Asset).framePeakBytes, 8 << 20);
+	ASSERT_GE(Statistics(kbs::MemoryTag::Asset).peakBytes, 8 << 20);
+
+	tracker->SetFrameDumpPath("memory_tracker_test_other.csv");
+	std::ifstream file(path);
+	std::stringstream content;
+	content << file.rdbuf();
+	std::string csv = content.str();
+	ASSERT_EQ(csv.find("frame,General live"), 0);
+	ASSERT_NE(csv.find("\n0,"), std::string::npos);
+	ASSERT_NE(csv.find("\n1,"), std::string::npos);
+}
+
+TEST(MemoryTracker, AllocationOverhead)
+{
+	const uint32_t count = 1000000, threadCount = 4;
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t t = 0; t < threadCount; t++)
+	{
+		threads.emplace_back([&]()
+			{
+				KBS_MEMORY_TAG(Scene);
+				for (uint32_t i = 0; i < count / threadCount; i++)
+				{
+					uint64_t* value = new uint64_t(i);
+					s_Escape = value;
+					delete value;
+				}
+			});
+	}
+	for (auto& t : threads) t.join();
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "[ MemoryTracker ] " << std::chrono::duration<double, std::nano>(end - start).count() / count
+		<< " ns per tracked new/delete pair" << std::endl;
+	kbs::Singleton::GetInstance<kbs::MemoryTracker>()->LogSummary();
+}
+
+#else
+
+TEST(MemoryTracker, CompiledOut)
+{
+	ASSERT_FALSE(kbs::MemoryTracker::IsEnabled());
+	ASSERT_EQ(kbs::Singleton::GetInstance<kbs::MemoryTracker>()->GetStatistics(kbs::MemoryTag::Asset).liveBytes, 0);
+}
+
+#endif
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include <chrono>
+#include <iostream>
+
+using namespace kbs;
+
+TEST(NameIndex, FindByName)
+{
+	Scene scene;
+	Entity a = scene.CreateEntity("a");
+	Entity b = scene.CreateEntity("b");
+	Entity b2 = scene.CreateEntity("b");
+
+	ASSERT_EQ(scene.FindEntityByName("a"), a);
+	ASSERT_FALSE(scene.FindEntityByName("c"));
+	ASSERT_EQ(scene.FindEntitiesByName("b").size(), 2);
+
+	// renaming re-indexes the entity
+	b2.SetName("c");
+	ASSERT_EQ(scene.FindEntityByName("b"), b);
+	ASSERT_EQ(scene.FindEntityByName("c"), b2);
+	ASSERT_EQ(b2.GetName(), "c");
+
+	scene.DestroyEntity(a);
+	ASSERT_FALSE(scene.FindEntityByName("a"));
+
+	// a recycled entity gets indexed with its new name
+	Entity d = scene.CreateEntity("d");
+	ASSERT_EQ(scene.FindEntityByName("d"), d);
+	ASSERT_FALSE(scene.FindEntityByName("a"));
+}
+
+TEST(NameIndex, Tags)
+{
+	ptr<Scene> scenePtr = std::make_shared<Scene>();
+	Scene& scene = *scenePtr;
+	InternedString enemy("enemy"), player("player");
+	ASSERT_EQ(enemy, InternedString("enemy"));
+	ASSERT_EQ(enemy.GetString(), "enemy");
+
+	Entity p = scene.CreateEntity("player");
+	p.AddTag(player);
+	std::vector<Entity> enemies;
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		Entity e = scene.CreateEntity("enemy");
+		e.AddTag(enemy);
+		e.AddTag(enemy);
+		enemies.push_back(e);
+	}
+
+	ASSERT_EQ(scene.FindEntityWithTag(player), p);
+	ASSERT_TRUE(p.HasTag(player));
+	ASSERT_FALSE(p.HasTag(enemy));
+	ASSERT_EQ(scene.GetEntityCountWithTag(enemy), 10);
+	ASSERT_EQ(enemies[0].GetComponent<TagComponent>().tags.size(), 1);
+
+	enemies[0].RemoveTag(enemy);
+	scene.DestroyEntity(enemies[1]);
+	ASSERT_EQ(scene.GetEntityCountWithTag(enemy), 8);
+
+	uint32_t visited = 0;
+	scene.IterateEntitiesWithTag(enemy, [&](Entity e)
+		{
+			ASSERT_TRUE(e.HasTag(enemy));
+			visited++;
+		});
+	ASSERT_EQ(visited, 8);
+
+	// tags and names survive copying the scene
+	ptr<Scene> copy = Scene::Copy(scenePtr);
+	ASSERT_EQ(copy->GetEntityCountWithTag(enemy), 8);
+	ASSERT_TRUE(copy->FindEntityByName("player").HasTag(player));
+	ASSERT_EQ(copy->FindEntitiesByName("enemy").size(), 9);
+}
+
+TEST(NameIndex, LookupBenchmark)
+{
+	constexpr uint32_t entityCount = 1000000;
+	constexpr uint32_t lookupCount = 100;
+
+	Scene scene;
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		scene.CreateEntity("entity" + std::to_string(i));
+	}
+	std::vector<std::string> names;
+	for (uint32_t i = 0; i < lookupCount; i++)
+	{
+		names.push_back("entity" + std::to_string((uint64_t)i * 7919 % entityCount));
+	}
+
+	// the linear scan FindEntityByName did before the index
+	auto scan = [&](const std::string& name)
+	{
+		Entity found;
+		scene.IterateAllEntitiesWith<NameComponent>([&](Entity e)
+			{
+				if (!found && e.GetName() == name) found = e;
+			});
+		return found;
+	};
+
+	std::vector<Entity> scanned, indexed;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (auto& name : names) scanned.push_back(scan(name));
+	auto mid = std::chrono::high_resolution_clock::now();
+	for (auto& name : names) indexed.push_back(scene.FindEntityByName(name));
+	auto end = std::chrono::high_resolution_clock::now();
+	ASSERT_EQ(scanned, indexed);
+
+	std::cout << "[ NameIndex ] " << lookupCount << " lookups in " << entityCount << " entities, scan : "
+		<< std::chrono::duration<double, std::milli>(mid - start).count() << " ms, index : "
+		<< std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
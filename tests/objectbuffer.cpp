@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Scene/Transform.h"
+#include "Scene/RenderWorld.h"
+#include "Renderer/DrawSort.h"
+#include "Renderer/Instancing.h"
+#include <iostream>
+#include <set>
+
+using namespace kbs;
+
+static bool Equal(const mat4& lhs, const mat4& rhs)
+{
+	return memcmp(&lhs, &rhs, sizeof(mat4)) == 0;
+}
+
+// 100k objects drawn by 64 materials of 4 pipelines and 16 meshes
+class ObjectBufferScene
+{
+public:
+	static constexpr uint32_t objectCount = 100000;
+	static constexpr uint32_t materialCount = 64;
+	static constexpr uint32_t pipelineCount = 4;
+	static constexpr uint32_t meshCount = 16;
+
+	ObjectBufferScene()
+	{
+		for (uint32_t i = 0; i < materialCount; i++)
+		{
+			materials.push_back(UUID(100 + i));
+		}
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			Entity e = scene.CreateEntity();
+			e.AddComponent<TransformComponent>(scene.CreateTransform({}, vec3(i % 317, i / 317, -(float)(i % 7)),
+				math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(i % 360)), vec3(1, 1 + i % 3, 1)));
+			RenderableComponent render;
+			render.targetMesh = UUID(10 + i % meshCount);
+			for (uint32_t p = 0; p < 1 + i % 2; p++)
+			{
+				render.AddRenderablePass(materials[(i * 7 + p * 13) % materialCount], 0);
+			}
+			e.AddComponent<RenderableComponent>(render);
+		}
+		world.Extract(scene);
+	}
+
+	uint32_t MaterialIndex(UUID material) { return (uint32_t)((uint64_t)material - 100); }
+
+	Scene			  scene;
+	RenderWorld		  world;
+	std::vector<UUID> materials;
+};
+
+TEST(ObjectBuffer, UploadMatchesScene)
+{
+	ObjectBufferScene objects;
+	const RenderWorld& world = objects.world;
+	ASSERT_EQ(world.objects.size(), ObjectBufferScene::objectCount);
+
+	// what Renderer::UploadRenderWorldObjects writes to the object buffer
+	std::vector<ObjectUBO> objectBuffer(world.objects.size());
+	world.GatherObjectUBOs(objectBuffer.data());
+
+	for (uint32_t i = 0; i < world.objects.size(); i++)
+	{
+		Entity e = objects.scene.GetEntityByUUID(world.objects[i].id);
+		ASSERT_TRUE(e);
+		ObjectUBO ubo = Transform(e).GetObjectUBO();
+		ASSERT_TRUE(Equal(objectBuffer[i].model, ubo.model));
+		ASSERT_TRUE(Equal(objectBuffer[i].invTransModel, ubo.invTransModel));
+	}
+}
+
+// a draw collected by RenderSceneByCamera
+struct CollectedDraw
+{
+	uint32_t objectIndex;
+	uint32_t material;
+};
+
+TEST(ObjectBuffer, InstancesReadTheirObjects)
+{
+	ObjectBufferScene objects;
+	const RenderWorld& world = objects.world;
+	std::vector<ObjectUBO> objectBuffer(world.objects.size());
+	world.GatherObjectUBOs(objectBuffer.data());
+
+	// collected, sorted and instanced like RenderSceneByCamera does
+	std::vector<CollectedDraw> draws;
+	for (uint32_t objectIndex = 0; objectIndex < world.objects.size(); objectIndex++)
+	{
+		const RenderWorldObject& object = world.objects[objectIndex];
+		for (uint32_t p = 0; p < object.passCount; p++)
+		{
+			draws.push_back(CollectedDraw{ objectIndex, objects.MaterialIndex(world.passes[object.firstPass + p].material) });
+		}
+	}
+	auto pipelineOf = [](uint32_t material) { return material % ObjectBufferScene::pipelineCount; };
+	auto meshOf = [&](const CollectedDraw& draw) { return (uint32_t)((uint64_t)world.objects[draw.objectIndex].mesh - 10); };
+
+	std::vector<DrawSortItem> items(draws.size()), scratch(draws.size());
+	for (uint32_t i = 0; i < draws.size(); i++)
+	{
+		items[i] = DrawSortItem{ PackDrawSortKey(false, pipelineOf(draws[i].material), draws[i].material, meshOf(draws[i]), 0.f), i };
+	}
+	RadixSortDrawItems(items.data(), scratch.data(), (uint32_t)items.size());
+	std::vector<CollectedDraw> sorted;
+	for (const DrawSortItem& item : items)
+	{
+		sorted.push_back(draws[item.index]);
+	}
+
+	std::vector<InstancedDraw> instancedDraws;
+	BuildInstancedDraws((uint32_t)sorted.size(), [&](uint32_t first, uint32_t i)
+		{
+			return sorted[first].material == sorted[i].material && meshOf(sorted[first]) == meshOf(sorted[i]);
+		}, instancedDraws);
+
+	// the instance buffer holds the object index of every sorted draw, instance k of a draw is firstDraw + k
+	std::vector<uint32_t> objectIndices(sorted.size());
+	for (uint32_t i = 0; i < sorted.size(); i++)
+	{
+		objectIndices[i] = sorted[i].objectIndex;
+	}
+
+	// emulates standard_vertex.vert, objects[objectIndices[gl_InstanceIndex]], and counts the binds of the draw loop
+	std::multiset<std::pair<uint32_t, uint32_t>> drawn, expected;
+	uint32_t binds = 0, boundPipeline = UINT32_MAX, boundMaterial = UINT32_MAX;
+	for (const InstancedDraw& draw : instancedDraws)
+	{
+		const CollectedDraw& first = sorted[draw.firstDraw];
+		if (pipelineOf(first.material) != boundPipeline)
+		{
+			// camera set and object set
+			boundPipeline = pipelineOf(first.material);
+			binds += 2;
+		}
+		if (first.material != boundMaterial)
+		{
+			boundMaterial = first.material;
+			binds++;
+		}
+		for (uint32_t k = 0; k < draw.instanceCount; k++)
+		{
+			uint32_t objectIndex = objectIndices[draw.firstDraw + k];
+			ASSERT_LT(objectIndex, objectBuffer.size());
+			ASSERT_TRUE(Equal(objectBuffer[objectIndex].model, world.objects[objectIndex].transform.model));
+			ASSERT_EQ(meshOf(CollectedDraw{ objectIndex, 0 }), meshOf(first));
+			drawn.insert({ objectIndex, first.material });
+		}
+	}
+	for (const CollectedDraw& draw : draws)
+	{
+		expected.insert({ draw.objectIndex, draw.material });
+	}
+	ASSERT_EQ(drawn, expected);
+
+	// descriptor binds grow with the materials, not with the objects
+	ASSERT_EQ(binds, 2 * ObjectBufferScene::pipelineCount + ObjectBufferScene::materialCount);
+	std::cout << "[ ObjectBuffer ] " << world.objects.size() << " objects : " << draws.size() << " draws, "
+		<< instancedDraws.size() << " instanced draws, " << binds << " descriptor set binds" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,441 @@
+#include "gtest/gtest.h"
+#include "Math/OcclusionBuffer.h"
+#include "Renderer/RenderCamera.h"
+#include "Scene/Entity.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace kbs;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+static const char* s_LevelNames[] = { "scalar", "sse", "avx2" };
+
+static mat4 CreateViewProjection(vec3 position, vec3 target, float aspect)
+{
+	mat4 projection = glm::perspectiveLH_ZO(1.f, aspect, .1f, 200.f);
+	mat4 view = glm::lookAtLH(position, target, vec3(0, 1, 0));
+	return projection * view;
+}
+
+// brute force rasterizer testing the pixel centers against every triangle, keeps the nearest depth of every pixel
+class ReferenceDepthBuffer
+{
+public:
+	ReferenceDepthBuffer(uint32_t width, uint32_t height, const mat4& viewProjection)
+		: m_Width(width), m_Height(height), m_ViewProjection(viewProjection), m_Depth(width * height, 1.f) {}
+
+	void RenderOccluder(const OccluderMesh& mesh, const mat4& model)
+	{
+		mat4 modelViewProjection = m_ViewProjection * model;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			vec3 v[3];
+			bool clipped = false;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				vec4 clip = modelViewProjection * vec4(mesh.vertices[mesh.indices[i + k]], 1.f);
+				v[k] = vec3((clip.x / clip.w * .5f + .5f) * m_Width, (clip.y / clip.w * .5f + .5f) * m_Height, clip.z / clip.w);
+				clipped = clipped || !(clip.w > 0.f) || v[k].z < 0.f;
+			}
+			if (!clipped)
+			{
+				RasterizeTriangle(v[0], v[1], v[2]);
+			}
+		}
+	}
+
+	// the same screen rectangle as the occlusion buffer, hidden if every pixel of it is in front of the box
+	bool IsVisible(const AABB& box) const
+	{
+		vec2 lower(FLT_MAX), upper(-FLT_MAX);
+		float nearest = FLT_MAX;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			vec3 corner((i & 1) ? box.upper.x : box.lower.x, (i & 2) ? box.upper.y : box.lower.y, (i & 4) ? box.upper.z : box.lower.z);
+			vec4 clip = m_ViewProjection * vec4(corner, 1.f);
+			if (!(clip.w > 0.f) || clip.z < 0.f) return true;
+			vec3 ndc = vec3(clip) / clip.w;
+			vec2 screen((ndc.x * .5f + .5f) * (float)m_Width, (ndc.y * .5f + .5f) * (float)m_Height);
+			lower = glm::min(lower, screen);
+			upper = glm::max(upper, screen);
+			nearest = std::min(nearest, ndc.z);
+		}
+		int32_t x0 = std::max(0, (int32_t)std::floor(lower.x)), x1 = std::min((int32_t)m_Width - 1, (int32_t)std::floor(upper.x));
+		int32_t y0 = std::max(0, (int32_t)std::floor(lower.y)), y1 = std::min((int32_t)m_Height - 1, (int32_t)std::floor(upper.y));
+		if (x0 > x1 || y0 > y1) return true;
+		for (int32_t y = y0; y <= y1; y++)
+		{
+			for (int32_t x = x0; x <= x1; x++)
+			{
+				if (!(nearest > GetDepth(x, y))) return true;
+			}
+		}
+		return false;
+	}
+
+	float GetDepth(uint32_t x, uint32_t y) const { return m_Depth[y * m_Width + x]; }
+
+private:
+	void RasterizeTriangle(vec3 v0, vec3 v1, vec3 v2)
+	{
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+		if (!(std::abs(area) > 1e-6f)) return;
+		if (area < 0.f)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+		// every pixel of the bounding box is tested
+		vec3 lower = glm::min(v0, glm::min(v1, v2)), upper = glm::max(v0, glm::max(v1, v2));
+		int32_t x0 = (int32_t)glm::clamp(lower.x - 1.f, 0.f, (float)m_Width), x1 = (int32_t)glm::clamp(upper.x + 1.f, 0.f, (float)m_Width);
+		int32_t y0 = (int32_t)glm::clamp(lower.y - 1.f, 0.f, (float)m_Height), y1 = (int32_t)glm::clamp(upper.y + 1.f, 0.f, (float)m_Height);
+		for (int32_t y = y0; y < y1; y++)
+		{
+			for (int32_t x = x0; x < x1; x++)
+			{
+				vec2 p((float)x + .5f, (float)y + .5f);
+				float w0 = (v2.x - v1.x) * (p.y - v1.y) - (v2.y - v1.y) * (p.x - v1.x);
+				float w1 = (v0.x - v2.x) * (p.y - v2.y) - (v0.y - v2.y) * (p.x - v2.x);
+				float w2 = (v1.x - v0.x) * (p.y - v0.y) - (v1.y - v0.y) * (p.x - v0.x);
+				if (w0 < 0.f || w1 < 0.f || w2 < 0.f) continue;
+				float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+				m_Depth[y * m_Width + x] = std::min(m_Depth[y * m_Width + x], depth);
+			}
+		}
+	}
+
+	uint32_t		   m_Width;
+	uint32_t		   m_Height;
+	mat4			   m_ViewProjection;
+	std::vector<float> m_Depth;
+};
+
+static void AddQuad(OccluderMesh& mesh, vec3 origin, vec3 u, vec3 v)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+	mesh.vertices.insert(mesh.vertices.end(), { origin, origin + u, origin + u + v, origin + v });
+	mesh.indices.insert(mesh.indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+}
+
+// a quad split into countU x countV cells of two triangles each
+static void AddGrid(OccluderMesh& mesh, vec3 origin, vec3 u, vec3 v, uint32_t countU, uint32_t countV)
+{
+	for (uint32_t i = 0; i < countU; i++)
+	{
+		for (uint32_t j = 0; j < countV; j++)
+		{
+			AddQuad(mesh, origin + u * ((float)i / countU) + v * ((float)j / countV), u / (float)countU, v / (float)countV);
+		}
+	}
+}
+
+static void AddBox(OccluderMesh& mesh, vec3 lower, vec3 upper)
+{
+	vec3 size = upper - lower;
+	vec3 x(size.x, 0, 0), y(0, size.y, 0), z(0, 0, size.z);
+	AddQuad(mesh, lower, x, y);
+	AddQuad(mesh, lower + z, x, y);
+	AddQuad(mesh, lower, z, y);
+	AddQuad(mesh, lower + x, z, y);
+	AddQuad(mesh, lower, x, z);
+	AddQuad(mesh, lower + y, x, z);
+}
+
+// randomly placed and rotated quads in front of a camera at the origin looking along z
+static OccluderMesh CreateRandomOccluders(uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-30.f, 30.f), depth(5.f, 80.f), size(1.f, 15.f), angle(-1.5f, 1.5f);
+	OccluderMesh mesh;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		quat rotation = quat(vec3(angle(rng), angle(rng), angle(rng)));
+		vec3 u = rotation * vec3(size(rng), 0, 0), v = rotation * vec3(0, size(rng), 0);
+		vec3 center(position(rng), position(rng) * .5f, depth(rng));
+		AddQuad(mesh, center - (u + v) * .5f, u, v);
+	}
+	return mesh;
+}
+
+static std::vector<AABB> CreateRandomOccludees(uint32_t count, vec3 lower, vec3 upper, float maxExtent, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> x(lower.x, upper.x), y(lower.y, upper.y), z(lower.z, upper.z), extent(.05f, maxExtent);
+	std::vector<AABB> boxes(count);
+	for (AABB& box : boxes)
+	{
+		box = AABB::FromCenterExtent(vec3(x(rng), y(rng), z(rng)), vec3(extent(rng), extent(rng), extent(rng)));
+	}
+	return boxes;
+}
+
+TEST(OcclusionCulling, FullScreenOccluder)
+{
+	OcclusionBuffer buffer(100, 50);
+	ASSERT_EQ(buffer.GetWidth(), 128);
+	ASSERT_EQ(buffer.GetHeight(), 56);
+
+	mat4 viewProjection = CreateViewProjection(vec3(0), vec3(0, 0, 1), 1.f);
+	buffer.Clear(viewProjection);
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-1, -1, 50), vec3(1, 1, 52))));
+
+	OccluderMesh wall;
+	AddQuad(wall, vec3(-100, -100, 10), vec3(200, 0, 0), vec3(0, 200, 0));
+	buffer.RenderOccluder(wall, mat4(1.f));
+
+	vec4 clip = viewProjection * vec4(0, 0, 10, 1);
+	for (uint32_t y = 0; y < buffer.GetHeight(); y++)
+	{
+		for (uint32_t x = 0; x < buffer.GetWidth(); x++)
+		{
+			ASSERT_NEAR(buffer.GetDepth(x, y), clip.z / clip.w, 1e-5f);
+		}
+	}
+
+	ASSERT_FALSE(buffer.IsVisible(AABB(vec3(-1, -1, 50), vec3(1, 1, 52))));
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-1, -1, 5), vec3(1, 1, 7))));
+	// reaching through the wall
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-1, -1, 9), vec3(1, 1, 52))));
+	// crossing the near plane
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-1, -1, -1), vec3(1, 1, 52))));
+	// partially on the screen, the part outside is left to frustum culling
+	ASSERT_FALSE(buffer.IsVisible(AABB(vec3(-500, -1, 50), vec3(1, 1, 52))));
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-FLT_MAX), vec3(FLT_MAX))));
+
+	// the same wall moved into the box is drawn behind the first one
+	buffer.RenderOccluder(wall, glm::translate(mat4(1.f), vec3(0, 0, 45)));
+	ASSERT_NEAR(buffer.GetDepth(0, 0), clip.z / clip.w, 1e-5f);
+	buffer.Clear(viewProjection);
+	buffer.RenderOccluder(wall, glm::translate(mat4(1.f), vec3(0, 0, 45)));
+	ASSERT_TRUE(buffer.IsVisible(AABB(vec3(-1, -1, 50), vec3(1, 1, 60))));
+	ASSERT_FALSE(buffer.IsVisible(AABB(vec3(-1, -1, 56), vec3(1, 1, 60))));
+}
+
+TEST(OcclusionCulling, MatchesReferenceRasterizer)
+{
+	constexpr uint32_t width = 320, height = 192;
+	mat4 viewProjection = CreateViewProjection(vec3(0), vec3(0, 0, 1), (float)width / height);
+	OccluderMesh occluders = CreateRandomOccluders(300, 5);
+	// some of the quads are cut by the near plane
+	AddQuad(occluders, vec3(-2, -2, -1), vec3(4, 0, 0), vec3(0, 0, 3));
+	std::vector<AABB> occludees = CreateRandomOccludees(20000, vec3(-40, -20, 1), vec3(40, 20, 120), 3.f, 6);
+
+	ReferenceDepthBuffer reference(width, height, viewProjection);
+	reference.RenderOccluder(occluders, mat4(1.f));
+	uint32_t referenceHidden = 0;
+	for (const AABB& box : occludees)
+	{
+		referenceHidden += !reference.IsVisible(box);
+	}
+	ASSERT_GT(referenceHidden, occludees.size() / 10);
+
+	for (uint32_t level = 0; level < 3; level++)
+	{
+		if (s_Levels[level] > math::GetSupportedSimdLevel()) continue;
+		math::SetSimdLevel(s_Levels[level]);
+
+		OcclusionBuffer buffer(width, height);
+		buffer.Clear(viewProjection);
+		buffer.RenderOccluder(occluders, mat4(1.f));
+
+		// the buffer is never in front of the exact depth. the projections round differently, so pixel centers
+		// right on an edge may be covered by one rasterizer only
+		uint32_t closer = 0;
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				closer += buffer.GetDepth(x, y) < reference.GetDepth(x, y) - 1e-5f;
+			}
+		}
+		ASSERT_LE(closer, width * height / 1000) << s_LevelNames[level];
+
+		// every occludee the buffer hides is hidden by the exact depth as well
+		uint32_t hidden = 0, wrong = 0;
+		for (const AABB& box : occludees)
+		{
+			if (!buffer.IsVisible(box))
+			{
+				hidden++;
+				wrong += reference.IsVisible(box);
+			}
+		}
+		ASSERT_LE(wrong, occludees.size() / 10000) << s_LevelNames[level];
+		// the coarse tile depths still hide most of what the exact depth does
+		ASSERT_GT(hidden, referenceHidden / 2) << s_LevelNames[level];
+		std::cout << "[ OcclusionCulling ] " << s_LevelNames[level] << " : " << hidden << " of " << referenceHidden
+			<< " hidden occludees found, " << closer << " pixels closer than the reference" << std::endl;
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+TEST(OcclusionCulling, RenderCameraCullsOccludedObjects)
+{
+	Singleton::GetInstance<JobSystem>()->Initialize(3);
+	Scene scene;
+	auto createObject = [&](vec3 position)
+	{
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(scene.CreateTransform({}, position, quat(1, 0, 0, 0), vec3(1)));
+		RenderableComponent render;
+		render.targetMesh = UUID(1);
+		render.AddRenderablePass(UUID(2), 0);
+		e.AddComponent<RenderableComponent>(render);
+		e.AddComponent<BoundsComponent>(AABB(vec3(-1), vec3(1)));
+		return e;
+	};
+
+	RenderCamera camera(CameraComponent(100.f, .1f, 1.f, 1.f), Transform(TransformComponent(vec3(0), quat(1, 0, 0, 0), vec3(1)), Entity()));
+	vec3 front = camera.GetCameraTransform().GetFront();
+	Entity inFront = createObject(front * 5.f);
+	Entity behind = createObject(front * 40.f);
+
+	// a wall between the objects, it is a renderable itself and not hidden by its own occluder
+	ptr<OccluderMesh> wallMesh = std::make_shared<OccluderMesh>();
+	AddBox(*wallMesh, vec3(-50, -50, -.5f), vec3(50, 50, .5f));
+	Entity wall = createObject(front * 20.f);
+	wall.AddComponent<OccluderComponent>(wallMesh);
+	wall.GetComponent<BoundsComponent>() = BoundsComponent(AABB(vec3(-50, -50, -.5f), vec3(50, 50, .5f)));
+
+	RenderWorld world;
+	world.Extract(scene);
+	ASSERT_EQ(world.occluders.size(), 1);
+
+	auto getVisible = [&](const RenderCameraCullingResult& result)
+	{
+		std::vector<UUID> visible;
+		for (uint32_t i : result.GetVisibleObjects())
+		{
+			visible.push_back(world.objects[i].id);
+		}
+		std::sort(visible.begin(), visible.end());
+		return visible;
+	};
+
+	auto sorted = [](std::vector<UUID> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	};
+
+	RenderCameraCullingResult result;
+	camera.Cull(world, result);
+	ASSERT_EQ(getVisible(result), sorted({ inFront.GetUUID(), behind.GetUUID(), wall.GetUUID() }));
+
+	OcclusionBuffer buffer;
+	camera.Cull(world, result, CullingShape::Box, &buffer);
+	ASSERT_EQ(getVisible(result), sorted({ inFront.GetUUID(), wall.GetUUID() }));
+}
+
+// a procedural stand in for the sponza atrium: a long nave between two colonnades with galleries above them,
+// aisles behind the colonnades and rooms behind the outer walls. the walls are finely tessellated like
+// the meshes of the original model are
+static OccluderMesh CreateAtrium()
+{
+	OccluderMesh atrium;
+	// floor, roofs of the aisles and the end walls
+	AddGrid(atrium, vec3(-30, 0, -10), vec3(60, 0, 0), vec3(0, 0, 20), 120, 40);
+	AddGrid(atrium, vec3(-30, 8, -10), vec3(60, 0, 0), vec3(0, 0, 4), 120, 8);
+	AddGrid(atrium, vec3(-30, 8, 6), vec3(60, 0, 0), vec3(0, 0, 4), 120, 8);
+	AddGrid(atrium, vec3(30, 0, -10), vec3(0, 0, 20), vec3(0, 20, 0), 40, 40);
+	AddGrid(atrium, vec3(-30, 0, -10), vec3(0, 0, 20), vec3(0, 20, 0), 40, 40);
+	for (float side : { -1.f, 1.f })
+	{
+		// outer walls
+		AddGrid(atrium, vec3(-30, 0, 10 * side), vec3(60, 0, 0), vec3(0, 20, 0), 120, 40);
+		// gallery walls above the colonnades with a window every four meters
+		for (float x = -30.f; x < 30.f; x += 4.f)
+		{
+			AddGrid(atrium, vec3(x, 8, 6 * side), vec3(3, 0, 0), vec3(0, 12, 0), 6, 24);
+			AddGrid(atrium, vec3(x + 3, 8, 6 * side), vec3(1, 0, 0), vec3(0, 4, 0), 2, 8);
+			AddGrid(atrium, vec3(x + 3, 14, 6 * side), vec3(1, 0, 0), vec3(0, 6, 0), 2, 12);
+		}
+	}
+	return atrium;
+}
+
+TEST(OcclusionCulling, AtriumBenchmark)
+{
+	constexpr uint32_t width = 320, height = 192;
+	OccluderMesh atrium = CreateAtrium();
+	OccluderMesh pillar;
+	AddBox(pillar, vec3(-.5f, 0, -.5f), vec3(.5f, 8, .5f));
+	std::vector<mat4> pillars;
+	for (float x = -28.f; x < 30.f; x += 4.f)
+	{
+		pillars.push_back(glm::translate(mat4(1.f), vec3(x, 0, -6)));
+		pillars.push_back(glm::translate(mat4(1.f), vec3(x, 0, 6)));
+	}
+	uint32_t triangleCount = (uint32_t)(atrium.indices.size() + pillar.indices.size() * pillars.size()) / 3;
+
+	// props in the nave and the aisles, objects in the galleries and in the rooms behind the walls
+	std::vector<AABB> occludees = CreateRandomOccludees(100000, vec3(-29, 0, -9.5f), vec3(29, 19, 9.5f), .5f, 9);
+	std::vector<AABB> rooms = CreateRandomOccludees(100000, vec3(-29, 0, -25), vec3(29, 19, 25), 1.f, 10);
+	occludees.insert(occludees.end(), rooms.begin(), rooms.end());
+
+	mat4 viewProjection = CreateViewProjection(vec3(-27, 2, -1), vec3(30, 6, 2), (float)width / height);
+	auto ms = [](auto&& func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	auto renderOccluders = [&](auto& buffer)
+	{
+		buffer.RenderOccluder(atrium, mat4(1.f));
+		for (const mat4& model : pillars)
+		{
+			buffer.RenderOccluder(pillar, model);
+		}
+	};
+
+	ReferenceDepthBuffer reference(width, height, viewProjection);
+	double referenceTime = ms([&]() { renderOccluders(reference); });
+	uint32_t referenceHidden = 0;
+	for (const AABB& box : occludees)
+	{
+		referenceHidden += !reference.IsVisible(box);
+	}
+	std::cout << "[ OcclusionCulling ] reference rasterizer : " << triangleCount / referenceTime << " triangles/ms, "
+		<< referenceHidden << " of " << occludees.size() << " occludees hidden" << std::endl;
+
+	for (uint32_t level = 0; level < 3; level++)
+	{
+		if (s_Levels[level] > math::GetSupportedSimdLevel()) continue;
+		math::SetSimdLevel(s_Levels[level]);
+
+		OcclusionBuffer buffer(width, height);
+		buffer.Clear(viewProjection);
+		renderOccluders(buffer);
+		buffer.Clear(viewProjection);
+		double renderTime = ms([&]() { renderOccluders(buffer); });
+
+		uint32_t hidden = 0, wrong = 0;
+		double testTime = ms([&]()
+			{
+				for (const AABB& box : occludees)
+				{
+					hidden += !buffer.IsVisible(box);
+				}
+			});
+		for (const AABB& box : occludees)
+		{
+			wrong += !buffer.IsVisible(box) && reference.IsVisible(box);
+		}
+		ASSERT_LE(wrong, occludees.size() / 10000);
+		ASSERT_GT(hidden, referenceHidden / 2);
+
+		std::cout << "[ OcclusionCulling ] " << s_LevelNames[level] << " : " << triangleCount << " triangles in " << renderTime << " ms ("
+			<< triangleCount / renderTime << " triangles/ms), " << occludees.size() / testTime << " occludees/ms, "
+			<< hidden << " hidden" << std::endl;
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include "Core/Profiler.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <iostream>
+
+#ifdef KBS_ENABLE_PROFILER
+
+static const kbs::ProfileZoneSummary* FindZone(const char* name)
+{
+	for (auto& zone : kbs::Singleton::GetInstance<kbs::Profiler>()->GetLastFrameSummary())
+	{
+		if (std::string(zone.name) == name) return &zone;
+	}
+	return nullptr;
+}
+
+TEST(Profiler, NestedZonesAreSummarized)
+{
+	KBS_PROFILE_BEGIN_FRAME();
+	{
+		KBS_PROFILE_SCOPE("Outer");
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			KBS_PROFILE_SCOPE("Inner");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	KBS_PROFILE_END_FRAME();
+
+	const kbs::ProfileZoneSummary* outer = FindZone("Outer");
+	const kbs::ProfileZoneSummary* inner = FindZone("Inner");
+	ASSERT_NE(outer, nullptr);
+	ASSERT_NE(inner, nullptr);
+	ASSERT_EQ(outer->callCount, 1);
+	ASSERT_EQ(inner->callCount, 3);
+	ASSERT_EQ(inner->depth, outer->depth + 1);
+	ASSERT_GE(outer->totalMs, inner->totalMs);
+	ASSERT_GE(inner->totalMs, 2.5);
+
+	// zones of the previous frame don't leak into the next summary
+	KBS_PROFILE_BEGIN_FRAME();
+	KBS_PROFILE_END_FRAME();
+	ASSERT_EQ(FindZone("Inner"), nullptr);
+}
+
+TEST(Profiler, ZonesFromWorkerThreads)
+{
+	KBS_PROFILE_BEGIN_FRAME();
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < 4; t++)
+	{
+		threads.emplace_back([]()
+			{
+				for (uint32_t i = 0; i < 100; i++)
+				{
+					KBS_PROFILE_SCOPE("WorkerZone");
+				}
+			});
+	}
+	for (auto& t : threads) t.join();
+	KBS_PROFILE_END_FRAME();
+
+	const kbs::ProfileZoneSummary* zone = FindZone("WorkerZone");
+	ASSERT_NE(zone, nullptr);
+	ASSERT_EQ(zone->callCount, 400);
+}
+
+TEST(Profiler, ChromeTraceIsWritten)
+{
+	{
+		KBS_PROFILE_SCOPE("TraceZone \"quoted\"");
+	}
+	std::string path = "profiler_test_trace.json";
+	ASSERT_TRUE(kbs::Singleton::GetInstance<kbs::Profiler>()->DumpChromeTrace(path));
+
+	std::ifstream file(path);
+	std::stringstream content;
+	content << file.rdbuf();
+	std::string json = content.str();
+
+	ASSERT_NE(json.find("\"traceEvents\""), std::string::npos);
+	ASSERT_NE(json.find("\"TraceZone \\\"quoted\\\"\""), std::string::npos);
+	ASSERT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+}
+
+TEST(Profiler, ZoneOverhead)
+{
+	const uint32_t zoneCount = 1000000;
+	kbs::Profiler* profiler = kbs::Singleton::GetInstance<kbs::Profiler>();
+
+	KBS_PROFILE_BEGIN_FRAME();
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < zoneCount; i++)
+	{
+		KBS_PROFILE_SCOPE("OverheadZone");
+	}
+	auto end = std::chrono::steady_clock::now();
+	KBS_PROFILE_END_FRAME();
+
+	double nsPerZone = std::chrono::duration<double, std::nano>(end - start).count() / zoneCount;
+	std::cout << "[ Profiler ] " << nsPerZone << " ns per zone" << std::endl;
+	profiler->LogLastFrameSummary();
+
+	// catches regressions only, a zone costs about 50ns on release builds and most of it are the two timestamp reads
+	EXPECT_LT(nsPerZone, 500.0);
+}
+
+#endif
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,212 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Scene/Transform.h"
+#include "Scene/RenderWorld.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace kbs;
+
+static bool Equal(const mat4& lhs, const mat4& rhs)
+{
+	return memcmp(&lhs, &rhs, sizeof(mat4)) == 0;
+}
+
+static void BuildScene(Scene& scene, uint32_t renderableCount)
+{
+	std::vector<Entity> entities;
+	for (uint32_t i = 0; i < renderableCount; i++)
+	{
+		// every 16th entity starts a new chain, the others are children of the previous one
+		opt<Entity> parent = i % 16 == 0 ? opt<Entity>() : opt<Entity>(entities.back());
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(scene.CreateTransform(parent, vec3(i * 0.1f, 1, -2),
+			math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(i % 360)), vec3(1, 1 + i % 3, 1)));
+
+		RenderableComponent render;
+		render.targetMesh = UUID(1000 + i);
+		for (uint32_t p = 0; p < 1 + i % 3; p++)
+		{
+			render.AddRenderablePass(UUID(10 * i + p + 1), p);
+		}
+		e.AddComponent<RenderableComponent>(render);
+		entities.push_back(e);
+	}
+
+	Entity light = scene.CreateEntity("light");
+	light.AddComponent<TransformComponent>(scene.CreateTransform({}, vec3(0, 10, 0), math::axisAngle(vec3(1, 0, 0), Angle::FromDegree(60)), vec3(1)));
+	LightComponent lightComp{};
+	lightComp.type = LightComponent::Directional;
+	lightComp.intensity = vec3(1, 2, 3);
+	light.AddComponent<LightComponent>(lightComp);
+
+	scene.CreateMainCamera(scene.CreateTransform(entities.front(), vec3(0, 0, -5), quat(1, 0, 0, 0), vec3(1)),
+		CameraComponent(100.f, 0.1f, 1.f, 60.f));
+}
+
+TEST(RenderWorld, SnapshotMatchesScene)
+{
+	Scene scene;
+	BuildScene(scene, 100);
+
+	RenderWorld world;
+	world.Extract(scene);
+
+	uint32_t renderableCount = 0;
+	scene.IterateAllEntitiesWith<RenderableComponent>([&](Entity) { renderableCount++; });
+	ASSERT_EQ(world.objects.size(), renderableCount);
+
+	for (const RenderWorldObject& object : world.objects)
+	{
+		Entity e = scene.GetEntityByUUID(object.id);
+		ASSERT_TRUE(e);
+		RenderableComponent render = e.GetComponent<RenderableComponent>();
+		ASSERT_EQ(object.mesh, render.targetMesh);
+		ASSERT_EQ(object.passCount, render.passCount);
+		for (uint32_t p = 0; p < object.passCount; p++)
+		{
+			ASSERT_EQ(world.passes[object.firstPass + p].material, render.targetMaterials[p]);
+			ASSERT_EQ(world.passes[object.firstPass + p].renderOptionFlags, render.renderOptionFlags[p]);
+		}
+
+		ObjectUBO ubo = Transform(e).GetObjectUBO();
+		ASSERT_TRUE(Equal(object.transform.model, ubo.model));
+		ASSERT_TRUE(Equal(object.transform.invTransModel, ubo.invTransModel));
+		ASSERT_EQ(object.position, Transform(e).GetPosition());
+	}
+
+	ASSERT_EQ(world.lights.size(), 1);
+	Entity light = scene.FindEntityByName("light");
+	ASSERT_EQ(world.lights[0].id, light.GetUUID());
+	ASSERT_EQ(world.lights[0].light.intensity, vec3(1, 2, 3));
+	vec3 front = Transform(light).GetFront();
+	ASSERT_NEAR(math::length(world.lights[0].front - front), 0.f, 1e-5f);
+
+	// the camera transform doesn't reference the scene but gives the same world space results
+	const RenderWorldCamera* camera = world.GetMainCamera();
+	ASSERT_NE(camera, nullptr);
+	ASSERT_EQ(camera->id, scene.GetMainCamera().GetUUID());
+	ASSERT_EQ(world.FindCamera(camera->id), camera);
+	vec3 cameraPosition = Transform(scene.GetMainCamera()).GetPosition();
+	ASSERT_NEAR(math::length(camera->GetTransform().GetPosition() - cameraPosition), 0.f, 1e-4f);
+	vec3 cameraFront = Transform(scene.GetMainCamera()).GetFront();
+	ASSERT_NEAR(math::length(camera->GetTransform().GetFront() - cameraFront), 0.f, 1e-5f);
+
+	// extraction is deterministic
+	RenderWorld again;
+	again.Extract(scene);
+	ASSERT_EQ(again.objects.size(), world.objects.size());
+	ASSERT_EQ(memcmp(again.objects.data(), world.objects.data(), sizeof(RenderWorldObject) * world.objects.size()), 0);
+	ASSERT_EQ(memcmp(again.passes.data(), world.passes.data(), sizeof(RenderWorldPass) * world.passes.size()), 0);
+}
+
+static const RenderWorldObject* FindObjectWithMesh(const RenderWorld& world, UUID mesh)
+{
+	for (const RenderWorldObject& object : world.objects)
+	{
+		if (object.mesh == mesh) return &object;
+	}
+	return nullptr;
+}
+
+TEST(RenderWorld, DoubleBuffering)
+{
+	Scene scene;
+	BuildScene(scene, 10);
+
+	RenderWorldBuffer buffer;
+	buffer.Extract(scene);
+	buffer.Swap();
+	const RenderWorld& front = buffer.GetFront();
+	ASSERT_EQ(front.objects.size(), 10);
+	// the first renderable is the root of the chain, the last one is its deepest child
+	const RenderWorldObject* root = FindObjectWithMesh(front, UUID(1000));
+	const RenderWorldObject* leaf = FindObjectWithMesh(front, UUID(1009));
+	ASSERT_NE(root, nullptr);
+	ASSERT_NE(leaf, nullptr);
+	vec3 position = root->position;
+
+	// the scene moves on and is extracted into the back world, the front world is untouched
+	scene.GetEntityByUUID(root->id).GetComponent<TransformComponent>().position += vec3(5, 0, 0);
+	scene.DestroyEntity(scene.GetEntityByUUID(leaf->id));
+	buffer.Extract(scene);
+	ASSERT_EQ(&buffer.GetFront(), &front);
+	ASSERT_EQ(front.objects.size(), 10);
+	ASSERT_EQ(root->position, position);
+	ASSERT_EQ(buffer.GetBack().objects.size(), 9);
+
+	buffer.Swap();
+	ASSERT_EQ(buffer.GetFront().objects.size(), 9);
+	ASSERT_EQ(FindObjectWithMesh(buffer.GetFront(), UUID(1009)), nullptr);
+	ASSERT_NEAR(FindObjectWithMesh(buffer.GetFront(), UUID(1000))->position.x - position.x, 5.f, 1e-4f);
+}
+
+TEST(RenderWorld, HandoffBetweenThreads)
+{
+	constexpr uint32_t frameCount = 50;
+
+	Scene scene;
+	BuildScene(scene, 10);
+	UUID rootObject;
+	{
+		RenderWorld world;
+		world.Extract(scene);
+		rootObject = FindObjectWithMesh(world, UUID(1000))->id;
+	}
+
+	RenderWorldBuffer buffer;
+	// the scene thread is at most one frame ahead, every extracted frame reaches the render thread with its changes
+	std::thread sceneThread([&]()
+		{
+			for (uint32_t frame = 1; frame <= frameCount; frame++)
+			{
+				scene.GetEntityByUUID(rootObject).GetComponent<TransformComponent>().position.x = (float)frame;
+				buffer.Extract(scene);
+			}
+		});
+
+	for (uint32_t frame = 1; frame <= frameCount; frame++)
+	{
+		// no asserts in the loop, the scene thread has to be released before the test returns
+		EXPECT_TRUE(buffer.Swap(true));
+		const RenderWorld& front = buffer.GetFront();
+		EXPECT_EQ(FindObjectWithMesh(front, UUID(1000))->position.x, (float)frame);
+		const std::vector<UUID>& moved = front.changes.GetChanged(SceneChangeType::Transform);
+		EXPECT_NE(std::find(moved.begin(), moved.end(), rootObject), moved.end());
+	}
+	sceneThread.join();
+	ASSERT_FALSE(buffer.Swap());
+}
+
+TEST(RenderWorld, ExtractionBenchmark)
+{
+	constexpr uint32_t renderableCount = 100000;
+	constexpr uint32_t frameCount = 10;
+
+	Scene scene;
+	BuildScene(scene, renderableCount);
+	RenderWorldBuffer buffer;
+	// the first extraction computes all world transforms and grows the arrays
+	buffer.Extract(scene);
+	buffer.Swap();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		buffer.Extract(scene);
+		buffer.Swap();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	ASSERT_EQ(buffer.GetFront().objects.size(), renderableCount);
+
+	std::cout << "[ RenderWorld ] extracting " << renderableCount << " renderables : "
+		<< std::chrono::duration<double, std::milli>(end - start).count() / frameCount << " ms" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
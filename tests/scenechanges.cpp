@@ -0,0 +1,193 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Scene/RenderWorld.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace kbs;
+
+static std::vector<UUID> GetChangedIDs(Scene& scene, SceneChangeType type)
+{
+	std::vector<UUID> ids;
+	for (entt::entity e : scene.GetChanges(type).changed)
+	{
+		ids.push_back(Entity(e, &scene).GetUUID());
+	}
+	std::sort(ids.begin(), ids.end(), [](UUID lhs, UUID rhs) { return (uint64_t)lhs < (uint64_t)rhs; });
+	return ids;
+}
+
+static std::vector<UUID> Sorted(std::vector<UUID> ids)
+{
+	std::sort(ids.begin(), ids.end(), [](UUID lhs, UUID rhs) { return (uint64_t)lhs < (uint64_t)rhs; });
+	return ids;
+}
+
+static Entity CreateObject(Scene& scene, opt<Entity> parent, const vec3& position)
+{
+	Entity e = scene.CreateEntity();
+	e.AddComponent<TransformComponent>(scene.CreateTransform(parent, position, quat(1, 0, 0, 0), vec3(1)));
+	RenderableComponent render;
+	render.targetMesh = UUID(1);
+	render.AddRenderablePass(UUID(2), 0);
+	e.AddComponent<RenderableComponent>(render);
+	return e;
+}
+
+TEST(SceneChanges, DirtySets)
+{
+	Scene scene;
+	Entity parent = CreateObject(scene, {}, vec3(0, 0, 0));
+	Entity child = CreateObject(scene, parent, vec3(1, 0, 0));
+	Entity other = CreateObject(scene, {}, vec3(5, 0, 0));
+	LightComponent light{};
+	light.type = LightComponent::Sphere;
+	other.AddComponent<LightComponent>(light);
+	child.AddComponent<RayTracingGeometryComponent>().opaque = true;
+
+	// new components are reported as changed, world transforms once they are computed
+	ASSERT_TRUE(scene.GetChanges(SceneChangeType::Transform).changed.empty());
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Renderable), Sorted({ parent.GetUUID(), child.GetUUID(), other.GetUUID() }));
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Light), std::vector<UUID>({ other.GetUUID() }));
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::RayTracingGeometry), std::vector<UUID>({ child.GetUUID() }));
+	scene.UpdateWorldTransforms();
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Transform), Sorted({ parent.GetUUID(), child.GetUUID(), other.GetUUID() }));
+
+	scene.ClearChanges();
+	scene.UpdateWorldTransforms();
+	for (uint32_t type = 0; type < (uint32_t)SceneChangeType::Count; type++)
+	{
+		ASSERT_TRUE(scene.GetChanges((SceneChangeType)type).changed.empty());
+		ASSERT_TRUE(scene.GetChanges((SceneChangeType)type).removed.empty());
+	}
+
+	// moving a parent changes the world transform of its children
+	parent.GetComponent<TransformComponent>().position = vec3(0, 1, 0);
+	scene.UpdateWorldTransforms();
+	scene.UpdateWorldTransforms();
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Transform), Sorted({ parent.GetUUID(), child.GetUUID() }));
+
+	// patched components are tracked, components written in place are not
+	other.PatchComponent<LightComponent>([](LightComponent& l) { l.intensity = vec3(2); });
+	other.PatchComponent<LightComponent>([](LightComponent& l) { l.intensity = vec3(3); });
+	parent.GetComponent<RenderableComponent>().targetMesh = UUID(3);
+	child.AddOrReplaceComponent<RenderableComponent>(child.GetComponent<RenderableComponent>());
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Light), std::vector<UUID>({ other.GetUUID() }));
+	ASSERT_EQ(GetChangedIDs(scene, SceneChangeType::Renderable), std::vector<UUID>({ child.GetUUID() }));
+	scene.ClearChanges();
+
+	// removed components and destroyed entities are reported by id
+	UUID childID = child.GetUUID();
+	other.RemoveComponent<LightComponent>();
+	scene.DestroyEntity(child);
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(scene.GetChanges(SceneChangeType::Light).changed.empty());
+	ASSERT_EQ(scene.GetChanges(SceneChangeType::Light).removed, std::vector<UUID>({ other.GetUUID() }));
+	ASSERT_EQ(scene.GetChanges(SceneChangeType::Renderable).removed, std::vector<UUID>({ childID }));
+	ASSERT_EQ(scene.GetChanges(SceneChangeType::RayTracingGeometry).removed, std::vector<UUID>({ childID }));
+	ASSERT_EQ(scene.GetChanges(SceneChangeType::Transform).removed, std::vector<UUID>({ childID }));
+	for (entt::entity e : scene.GetChanges(SceneChangeType::Transform).changed)
+	{
+		ASSERT_NE(e, (entt::entity)child);
+	}
+}
+
+TEST(SceneChanges, RenderWorldCollectsChanges)
+{
+	Scene scene;
+	Entity a = CreateObject(scene, {}, vec3(0, 0, 0));
+	Entity b = CreateObject(scene, {}, vec3(1, 0, 0));
+
+	RenderWorld world;
+	world.Extract(scene);
+	ASSERT_EQ(Sorted(world.changes.GetChanged(SceneChangeType::Renderable)), Sorted({ a.GetUUID(), b.GetUUID() }));
+
+	world.Extract(scene);
+	ASSERT_TRUE(world.changes.GetChanged(SceneChangeType::Renderable).empty());
+	ASSERT_TRUE(world.changes.GetChanged(SceneChangeType::Transform).empty());
+
+	b.GetComponent<TransformComponent>().position = vec3(2, 0, 0);
+	UUID aID = a.GetUUID();
+	scene.DestroyEntity(a);
+	world.Extract(scene);
+	ASSERT_EQ(world.changes.GetChanged(SceneChangeType::Transform), std::vector<UUID>({ b.GetUUID() }));
+	ASSERT_EQ(world.changes.GetRemoved(SceneChangeType::Renderable), std::vector<UUID>({ aID }));
+}
+
+TEST(SceneChanges, PatchBenchmark)
+{
+	constexpr uint32_t objectCount = 100000;
+	constexpr uint32_t lightCount = 10000;
+
+	Scene scene;
+	std::vector<Entity> objects;
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		objects.push_back(CreateObject(scene, {}, vec3(i * .01f, 0, 0)));
+		if (i % (objectCount / lightCount) == 0)
+		{
+			objects.back().AddComponent<LightComponent>(LightComponent{});
+		}
+	}
+	scene.UpdateWorldTransforms();
+	scene.ClearChanges();
+
+	// stand ins for gpu buffers, indexed by entity
+	std::vector<ObjectUBO> objectBuffer(objectCount + 1);
+	std::vector<vec3> lightBuffer(objectCount + 1);
+	auto slot = [](entt::entity e) { return entt::to_integral(e) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask; };
+	auto ms = [](auto start) { return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(); };
+
+	for (uint32_t changedCount : { 10u, 1000u, 100000u })
+	{
+		auto move = [&](float offset)
+		{
+			for (uint32_t i = 0; i < changedCount; i++)
+			{
+				Entity e = objects[i * (objectCount / changedCount)];
+				e.GetComponent<TransformComponent>().position.y += offset;
+				if (e.HasComponent<LightComponent>())
+				{
+					e.PatchComponent<LightComponent>([&](LightComponent& light) { light.intensity += vec3(offset); });
+				}
+			}
+		};
+
+		// both sides need the world transforms, the comparison of the local transforms isn't timed
+		move(1.f);
+		scene.UpdateWorldTransforms();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (entt::entity e : scene.GetChanges(SceneChangeType::Transform).changed)
+		{
+			const WorldTransformComponent& world = Entity(e, &scene).GetComponent<WorldTransformComponent>();
+			objectBuffer[slot(e)] = ObjectUBO{ world.world, world.invTransWorld };
+		}
+		for (entt::entity e : scene.GetChanges(SceneChangeType::Light).changed)
+		{
+			lightBuffer[slot(e)] = Entity(e, &scene).GetComponent<LightComponent>().intensity;
+		}
+		scene.ClearChanges();
+		double patchTime = ms(start);
+
+		move(-1.f);
+		scene.UpdateWorldTransforms();
+		start = std::chrono::high_resolution_clock::now();
+		scene.ForEach<const WorldTransformComponent>(
+			[&](Entity e, const WorldTransformComponent& world) { objectBuffer[slot(e)] = ObjectUBO{ world.world, world.invTransWorld }; }
+		);
+		scene.ForEach<const LightComponent>([&](Entity e, const LightComponent& light) { lightBuffer[slot(e)] = light.intensity; });
+		scene.ClearChanges();
+		double rebuildTime = ms(start);
+
+		std::cout << "[ SceneChanges ] " << changedCount << " of " << objectCount << " objects changed, patching : " << patchTime
+			<< " ms, rebuilding : " << rebuildTime << " ms" << std::endl;
+	}
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include <chrono>
+#include <iostream>
+
+using namespace kbs;
+
+static void BuildScene(Scene& scene, uint32_t entityCount)
+{
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		Entity e = scene.CreateEntity();
+		e.AddComponent<TransformComponent>(vec3(i * .001f, 0, 0), quat(1, 0, 0, 0), vec3(1));
+		if (i % 3 == 0)
+		{
+			LightComponent light{};
+			light.intensity = vec3(i);
+			e.AddComponent<LightComponent>(light);
+		}
+	}
+}
+
+TEST(SceneIteration, ForEachMatchesView)
+{
+	Scene scene;
+	BuildScene(scene, 1000);
+
+	uint32_t count = 0;
+	scene.ForEach<TransformComponent, const LightComponent>(
+		[&](Entity e, TransformComponent& trans, const LightComponent& light)
+		{
+			ASSERT_EQ(&trans, &e.GetComponent<TransformComponent>());
+			ASSERT_EQ(&light, &e.GetComponent<LightComponent>());
+			trans.position.y = light.intensity.x;
+			count++;
+		}
+	);
+	ASSERT_EQ(count, 334);
+
+	uint32_t viewCount = 0;
+	scene.IterateAllEntitiesWith<LightComponent>(
+		[&](Entity e)
+		{
+			ASSERT_EQ(e.GetComponent<TransformComponent>().position.y, e.GetComponent<LightComponent>().intensity.x);
+			viewCount++;
+		}
+	);
+	ASSERT_EQ(viewCount, count);
+}
+
+TEST(SceneIteration, ParallelForEachVisitsEveryEntityOnce)
+{
+	Singleton::GetInstance<JobSystem>()->Initialize(3);
+	Scene scene;
+	BuildScene(scene, 100000);
+
+	scene.ParallelForEach<TransformComponent>(
+		[&](Entity, TransformComponent& trans)
+		{
+			ASSERT_TRUE(scene.IsIteratingInParallel());
+			trans.position.y += 1.f;
+		}
+	);
+	// the light storage is smaller and leads the iteration
+	std::atomic<uint32_t> lightCount{ 0 };
+	scene.ParallelForEach<TransformComponent, const LightComponent>(
+		[&](Entity, TransformComponent& trans, const LightComponent& light)
+		{
+			trans.position.z = light.intensity.x;
+			lightCount++;
+		}, 64
+	);
+	ASSERT_FALSE(scene.IsIteratingInParallel());
+	ASSERT_EQ(lightCount.load(), 33334);
+
+	uint32_t count = 0;
+	scene.ForEach<const TransformComponent>(
+		[&](Entity e, const TransformComponent& trans)
+		{
+			ASSERT_EQ(trans.position.y, 1.f);
+			if (e.HasComponent<LightComponent>())
+			{
+				ASSERT_EQ(trans.position.z, e.GetComponent<LightComponent>().intensity.x);
+			}
+			else
+			{
+				ASSERT_EQ(trans.position.z, 0.f);
+			}
+			count++;
+		}
+	);
+	// the root has a transform as well
+	ASSERT_EQ(count, 100001);
+}
+
+TEST(SceneIteration, ReductionIsDeterministic)
+{
+	Scene scene;
+	BuildScene(scene, 100000);
+
+	auto sum = [&]()
+	{
+		return scene.ParallelReduce<const TransformComponent>(0.f,
+			[](Entity, const TransformComponent& trans) { return trans.position.x; },
+			[](float lhs, float rhs) { return lhs + rhs; }, 1000
+		);
+	};
+
+	// the same chunks summed serially in storage order
+	float expected = 0.f, chunk = 0.f;
+	uint32_t index = 0;
+	scene.ForEach<const TransformComponent>(
+		[&](Entity, const TransformComponent& trans)
+		{
+			chunk += trans.position.x;
+			if (++index % 1000 == 0)
+			{
+				expected += chunk;
+				chunk = 0.f;
+			}
+		}
+	);
+	expected += chunk;
+
+	for (uint32_t threadCount : { 1u, 2u, 4u })
+	{
+		Singleton::GetInstance<JobSystem>()->Initialize(threadCount - 1);
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			ASSERT_EQ(sum(), expected);
+		}
+	}
+
+	uint32_t lightCount = scene.ParallelReduce<const TransformComponent, const LightComponent>(0u,
+		[](Entity, const TransformComponent&, const LightComponent&) { return 1u; },
+		[](uint32_t lhs, uint32_t rhs) { return lhs + rhs; }
+	);
+	ASSERT_EQ(lightCount, 33334);
+}
+
+TEST(SceneIteration, IterationBenchmark)
+{
+	constexpr uint32_t entityCount = 1000000;
+	Singleton::GetInstance<JobSystem>()->Initialize();
+	Scene scene;
+	BuildScene(scene, entityCount);
+
+	auto ms = [](auto&& func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	const vec3 velocity(.001f, .002f, .003f);
+
+	double visiterTime = ms([&]()
+		{
+			scene.IterateAllEntitiesWith<TransformComponent>(
+				std::function<void(Entity)>([&](Entity e) { e.GetComponent<TransformComponent>().position += velocity; })
+			);
+		}
+	);
+	double forEachTime = ms([&]()
+		{
+			scene.ForEach<TransformComponent>([&](Entity, TransformComponent& trans) { trans.position += velocity; });
+		}
+	);
+	double parallelTime = ms([&]()
+		{
+			scene.ParallelForEach<TransformComponent>([&](Entity, TransformComponent& trans) { trans.position += velocity; });
+		}
+	);
+	vec3 sum = vec3(0.f);
+	double reduceTime = ms([&]()
+		{
+			sum = scene.ParallelReduce<const TransformComponent>(vec3(0.f),
+				[](Entity, const TransformComponent& trans) { return trans.position; },
+				[](const vec3& lhs, const vec3& rhs) { return lhs + rhs; }
+			);
+		}
+	);
+
+	std::cout << "[ SceneIteration ] updating " << entityCount << " transforms, std::function + GetComponent : " << visiterTime
+		<< " ms, ForEach : " << forEachTime << " ms, ParallelForEach (" << Singleton::GetInstance<JobSystem>()->GetThreadCount()
+		<< " threads) : " << parallelTime << " ms, ParallelReduce : " << reduceTime << " ms" << std::endl;
+	std::cout << "[ SceneIteration ] checksum " << sum.x + sum.y + sum.z << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
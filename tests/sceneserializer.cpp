@@ -0,0 +1,462 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Scene/Transform.h"
+#include "Scene/SceneSerializer.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+using namespace kbs;
+
+static void BuildScene(ptr<Scene> scene, uint32_t entityCount)
+{
+	InternedString dynamicTag("Dynamic"), staticTag("Static");
+	// two occluder meshes shared by the instances of a model
+	auto quad = std::make_shared<OccluderMesh>(OccluderMesh{ { vec3(-1, -1, 0), vec3(1, -1, 0), vec3(1, 1, 0), vec3(-1, 1, 0) }, { 0, 1, 2, 0, 2, 3 } });
+	auto triangle = std::make_shared<OccluderMesh>(OccluderMesh{ { vec3(0, 0, 0), vec3(2, 0, 0), vec3(0, 3, 1) }, { 0, 1, 2 } });
+	std::vector<Entity> entities;
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		opt<Entity> parent = i % 8 == 0 ? opt<Entity>() : opt<Entity>(entities[i - 1]);
+		Entity e = scene->CreateEntity("entity" + std::to_string(i));
+		e.AddComponent<TransformComponent>(scene->CreateTransform(parent, vec3(i, 1, -2),
+			math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(i % 360)), vec3(1, 1 + i % 3, 1)));
+		entities.push_back(e);
+
+		if (i % 2 == 0)
+		{
+			RenderableComponent render;
+			render.targetMesh = UUID(1000 + i);
+			for (uint32_t p = 0; p < 1 + i % 3; p++)
+			{
+				render.AddRenderablePass(UUID(10 * i + p + 1), p + 1);
+			}
+			e.AddComponent<RenderableComponent>(render);
+		}
+		if (i % 3 == 0)
+		{
+			RayTracingGeometryComponent geometry;
+			geometry.opaque = i % 2 == 0;
+			geometry.rayTracingMaterial = UUID(5000 + i);
+			e.AddComponent<RayTracingGeometryComponent>(geometry);
+		}
+		if (i % 5 == 0)
+		{
+			e.AddTag(i % 10 == 0 ? staticTag : dynamicTag);
+		}
+		if (i % 7 == 0)
+		{
+			e.AddTag(InternedString("Group" + std::to_string(i % 3)));
+		}
+		if (i % 4 == 0)
+		{
+			e.SetBounds(AABB(vec3(-1, -1, -1), vec3(1, 2, 3 + i % 5)));
+		}
+		if (i % 6 == 0)
+		{
+			e.AddComponent<OccluderComponent>(i % 12 == 0 ? quad : triangle);
+		}
+		if (i % 11 == 0)
+		{
+			CustomScript script;
+			script.name = "script" + std::to_string(i);
+			script.data = { (uint8_t)i, 1, 2, 3 };
+			e.AddComponent<CustomScriptCompoent>().scripts.push_back(script);
+		}
+	}
+
+	LightComponent light{};
+	light.type = LightComponent::Directional;
+	light.intensity = vec3(1, 2, 3);
+	light.shadowCaster.castShadow = true;
+	light.shadowCaster.distance = 50.f;
+	light.shadowCaster.bias = 1e-3f;
+	light.shadowCaster.windowWidth = 20.f;
+	light.shadowCaster.windowHeight = 30.f;
+	scene->CreateEntity("sun").AddComponent<LightComponent>(light);
+
+	light = LightComponent{};
+	light.type = LightComponent::Sphere;
+	light.intensity = vec3(4, 5, 6);
+	light.sphere.radius = 2.5f;
+	scene->CreateEntity("sphere").AddComponent<LightComponent>(light);
+
+	light = LightComponent{};
+	light.type = LightComponent::Area;
+	light.intensity = vec3(7, 8, 9);
+	light.area.u = vec3(1, 0, 0);
+	light.area.v = vec3(0, 0, 2);
+	light.area.area = 2.f;
+	scene->CreateEntity("area").AddComponent<LightComponent>(light);
+
+	scene->CreateMainCamera(scene->CreateTransform(entities.front(), vec3(0, 0, -5), quat(1, 0, 0, 0), vec3(1)),
+		CameraComponent(100.f, 0.1f, 1.5f, 60.f));
+	scene->CreateEntity("ortho").AddComponent<CameraComponent>(CameraComponent::OrthogonalCamera(10.f, 0.5f, 8.f, 6.f));
+}
+
+static void ExpectEqualLights(const LightComponent& lhs, const LightComponent& rhs)
+{
+	ASSERT_EQ(lhs.type, rhs.type);
+	ASSERT_EQ(lhs.intensity, rhs.intensity);
+	if (lhs.type == LightComponent::Sphere)
+	{
+		ASSERT_EQ(lhs.sphere.radius, rhs.sphere.radius);
+	}
+	if (lhs.type == LightComponent::Area)
+	{
+		ASSERT_EQ(lhs.area.u, rhs.area.u);
+		ASSERT_EQ(lhs.area.v, rhs.area.v);
+		ASSERT_EQ(lhs.area.area, rhs.area.area);
+	}
+	ASSERT_EQ(lhs.shadowCaster.castShadow, rhs.shadowCaster.castShadow);
+	ASSERT_EQ(lhs.shadowCaster.distance, rhs.shadowCaster.distance);
+	ASSERT_EQ(lhs.shadowCaster.bias, rhs.shadowCaster.bias);
+	ASSERT_EQ(lhs.shadowCaster.windowWidth, rhs.shadowCaster.windowWidth);
+	ASSERT_EQ(lhs.shadowCaster.windowHeight, rhs.shadowCaster.windowHeight);
+}
+
+static void ExpectEqualScenes(ptr<Scene> src, ptr<Scene> dst)
+{
+	ASSERT_EQ(src->GetRootID(), dst->GetRootID());
+	ASSERT_EQ(src->GetMainCamera().GetUUID(), dst->GetMainCamera().GetUUID());
+
+	uint32_t srcCount = 0, dstCount = 0;
+	src->IterateAllEntitiesWith<IDComponent>([&](Entity) { srcCount++; });
+	dst->IterateAllEntitiesWith<IDComponent>([&](Entity) { dstCount++; });
+	ASSERT_EQ(srcCount, dstCount);
+
+	src->UpdateWorldTransforms();
+	dst->UpdateWorldTransforms();
+
+	src->IterateAllEntitiesWith<NameComponent>(
+		[&](Entity s)
+		{
+			Entity d = dst->GetEntityByUUID(s.GetUUID());
+			ASSERT_TRUE(d);
+			ASSERT_EQ(s.GetName(), d.GetName());
+			// names are indexed by the loaded scene
+			ASSERT_TRUE(dst->FindEntityByName(s.GetName()));
+
+			ASSERT_EQ(s.HasComponent<TransformComponent>(), d.HasComponent<TransformComponent>());
+			if (s.HasComponent<TransformComponent>())
+			{
+				auto& st = s.GetComponent<TransformComponent>();
+				auto& dt = d.GetComponent<TransformComponent>();
+				ASSERT_EQ(st.parent, dt.parent);
+				ASSERT_EQ(st.position, dt.position);
+				ASSERT_EQ(st.rotation, dt.rotation);
+				ASSERT_EQ(st.scale, dt.scale);
+				ASSERT_EQ(Transform(s).GetPosition(), Transform(d).GetPosition());
+			}
+
+			ASSERT_EQ(s.HasComponent<RenderableComponent>(), d.HasComponent<RenderableComponent>());
+			if (s.HasComponent<RenderableComponent>())
+			{
+				auto& sr = s.GetComponent<RenderableComponent>();
+				auto& dr = d.GetComponent<RenderableComponent>();
+				ASSERT_EQ(sr.targetMesh, dr.targetMesh);
+				ASSERT_EQ(sr.passCount, dr.passCount);
+				for (uint32_t p = 0; p < sr.passCount; p++)
+				{
+					ASSERT_EQ(sr.targetMaterials[p], dr.targetMaterials[p]);
+					ASSERT_EQ(sr.renderOptionFlags[p], dr.renderOptionFlags[p]);
+				}
+			}
+
+			ASSERT_EQ(s.HasComponent<CameraComponent>(), d.HasComponent<CameraComponent>());
+			if (s.HasComponent<CameraComponent>())
+			{
+				auto& sc = s.GetComponent<CameraComponent>();
+				auto& dc = d.GetComponent<CameraComponent>();
+				ASSERT_EQ(sc.m_Type, dc.m_Type);
+				ASSERT_EQ(sc.m_Far, dc.m_Far);
+				ASSERT_EQ(sc.m_Near, dc.m_Near);
+				ASSERT_EQ(sc.m_AspectRatio, dc.m_AspectRatio);
+				ASSERT_EQ(sc.m_Width, dc.m_Width);
+				ASSERT_EQ(sc.m_Fov, dc.m_Fov);
+				ASSERT_EQ(sc.m_Height, dc.m_Height);
+			}
+
+			ASSERT_EQ(s.HasComponent<LightComponent>(), d.HasComponent<LightComponent>());
+			if (s.HasComponent<LightComponent>())
+			{
+				ExpectEqualLights(s.GetComponent<LightComponent>(), d.GetComponent<LightComponent>());
+			}
+
+			ASSERT_EQ(s.HasComponent<RayTracingGeometryComponent>(), d.HasComponent<RayTracingGeometryComponent>());
+			if (s.HasComponent<RayTracingGeometryComponent>())
+			{
+				ASSERT_EQ(s.GetComponent<RayTracingGeometryComponent>().opaque, d.GetComponent<RayTracingGeometryComponent>().opaque);
+				ASSERT_EQ(s.GetComponent<RayTracingGeometryComponent>().rayTracingMaterial, d.GetComponent<RayTracingGeometryComponent>().rayTracingMaterial);
+			}
+
+			ASSERT_EQ(s.HasComponent<CustomScriptCompoent>(), d.HasComponent<CustomScriptCompoent>());
+			if (s.HasComponent<CustomScriptCompoent>())
+			{
+				auto& ss = s.GetComponent<CustomScriptCompoent>().scripts;
+				auto& ds = d.GetComponent<CustomScriptCompoent>().scripts;
+				ASSERT_EQ(ss.size(), ds.size());
+				for (uint32_t k = 0; k < ss.size(); k++)
+				{
+					ASSERT_EQ(ss[k].name, ds[k].name);
+					ASSERT_EQ(ss[k].data, ds[k].data);
+				}
+			}
+
+			ASSERT_EQ(s.HasComponent<BoundsComponent>(), d.HasComponent<BoundsComponent>());
+			if (s.HasComponent<BoundsComponent>())
+			{
+				ASSERT_EQ(s.GetComponent<BoundsComponent>().local.lower, d.GetComponent<BoundsComponent>().local.lower);
+				ASSERT_EQ(s.GetComponent<BoundsComponent>().local.upper, d.GetComponent<BoundsComponent>().local.upper);
+			}
+
+			ASSERT_EQ(s.HasComponent<OccluderComponent>(), d.HasComponent<OccluderComponent>());
+			if (s.HasComponent<OccluderComponent>())
+			{
+				const OccluderMesh& sm = *s.GetComponent<OccluderComponent>().mesh;
+				const OccluderMesh& dm = *d.GetComponent<OccluderComponent>().mesh;
+				ASSERT_EQ(sm.vertices, dm.vertices);
+				ASSERT_EQ(sm.indices, dm.indices);
+			}
+
+			ASSERT_EQ(s.HasComponent<TagComponent>(), d.HasComponent<TagComponent>());
+			if (s.HasComponent<TagComponent>())
+			{
+				ASSERT_EQ(s.GetComponent<TagComponent>().tags, d.GetComponent<TagComponent>().tags);
+			}
+		}
+	);
+
+	// tag groups are rebuilt by the loaded scene
+	for (const char* tag : { "Dynamic", "Static", "Group0", "Group1", "Group2" })
+	{
+		ASSERT_EQ(src->GetEntityCountWithTag(InternedString(tag)), dst->GetEntityCountWithTag(InternedString(tag)));
+	}
+}
+
+TEST(SceneSerializer, BinaryRoundTrip)
+{
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, 200);
+
+	std::vector<uint8_t> data = SceneSerializer(src).SerializeBinary();
+	ptr<Scene> dst = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(dst).DeserializeBinary(data.data(), data.size()));
+	ExpectEqualScenes(src, dst);
+
+	// the loaded scene keeps working as a normal scene
+	Entity e = dst->CreateEntity("new");
+	ASSERT_NE(e.GetUUID(), dst->GetRootID());
+	ASSERT_EQ(dst->FindEntityByName("new"), e);
+}
+
+TEST(SceneSerializer, TextRoundTrip)
+{
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, 200);
+
+	std::string text = SceneSerializer(src).SerializeText();
+	ptr<Scene> dst = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(dst).DeserializeText(text));
+	ExpectEqualScenes(src, dst);
+}
+
+TEST(SceneSerializer, FileRoundTrip)
+{
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, 50);
+
+	auto directory = std::filesystem::temp_directory_path();
+	std::string binaryPath = (directory / "kbs_scene_test.kscene").string();
+	std::string textPath = (directory / "kbs_scene_test.json").string();
+	ASSERT_TRUE(SceneSerializer(src).SerializeBinary(binaryPath));
+	ASSERT_TRUE(SceneSerializer(src).Serialize(textPath));
+
+	ptr<Scene> binaryScene = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(binaryScene).DeserializeBinary(binaryPath));
+	ExpectEqualScenes(src, binaryScene);
+
+	ptr<Scene> textScene = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(textScene).Deserialize(textPath));
+	ExpectEqualScenes(src, textScene);
+
+	std::filesystem::remove(binaryPath);
+	std::filesystem::remove(textPath);
+}
+
+TEST(SceneSerializer, RejectInvalidFiles)
+{
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, 20);
+	std::vector<uint8_t> data = SceneSerializer(src).SerializeBinary();
+
+	std::vector<uint8_t> truncated(data.begin(), data.begin() + data.size() / 2);
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(truncated.data(), truncated.size()));
+
+	std::vector<uint8_t> newerVersion = data;
+	((SceneFileHeader*)newerVersion.data())->version = SceneFileHeader::currentVersion + 1;
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(newerVersion.data(), newerVersion.size()));
+
+	std::vector<uint8_t> badMagic = data;
+	((SceneFileHeader*)badMagic.data())->fileMagic = 0;
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(badMagic.data(), badMagic.size()));
+
+	// contents of a block: the entity indices then the components, 16 bytes aligned
+	auto findBlock = [](std::vector<uint8_t>& file, SceneBlockType type)
+	{
+		const SceneFileHeader* header = (const SceneFileHeader*)file.data();
+		SceneBlock* blocks = (SceneBlock*)(file.data() + sizeof(SceneFileHeader));
+		for (uint32_t i = 0; i < header->blockCount; i++)
+		{
+			if (blocks[i].type == type) return &blocks[i];
+		}
+		return (SceneBlock*)nullptr;
+	};
+	auto alignOffset = [](uint64_t offset) { return (offset + 15) & ~(uint64_t)15; };
+
+	std::vector<uint8_t> tooManyPasses = data;
+	SceneBlock* renderables = findBlock(tooManyPasses, SceneBlockType::Renderable);
+	ASSERT_NE(renderables, nullptr);
+	RenderableComponent* render = (RenderableComponent*)(tooManyPasses.data() + alignOffset(renderables->offset + sizeof(uint32_t) * renderables->count));
+	render[renderables->count - 1].passCount = RenderableComponent::maxPassCount + 1;
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(tooManyPasses.data(), tooManyPasses.size()));
+
+	std::vector<uint8_t> duplicatedIndex = data;
+	SceneBlock* transforms = findBlock(duplicatedIndex, SceneBlockType::Transform);
+	ASSERT_NE(transforms, nullptr);
+	uint32_t* indices = (uint32_t*)(duplicatedIndex.data() + transforms->offset);
+	indices[1] = indices[0];
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(duplicatedIndex.data(), duplicatedIndex.size()));
+
+	std::vector<uint8_t> duplicatedId = data;
+	UUID* ids = (UUID*)(duplicatedId.data() + findBlock(duplicatedId, SceneBlockType::Entity)->offset);
+	ids[3] = ids[7];
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(duplicatedId.data(), duplicatedId.size()));
+
+	std::vector<uint8_t> rootId = data;
+	ids = (UUID*)(rootId.data() + findBlock(rootId, SceneBlockType::Entity)->offset);
+	ids[0] = UUID(((SceneFileHeader*)rootId.data())->root);
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(rootId.data(), rootId.size()));
+
+	std::vector<uint8_t> badOccluder = data;
+	SceneBlock* occluders = findBlock(badOccluder, SceneBlockType::Occluder);
+	ASSERT_NE(occluders, nullptr);
+	uint64_t tableOffset = alignOffset(alignOffset(occluders->offset + sizeof(uint32_t) * occluders->count) + sizeof(uint32_t) * occluders->count);
+	uint32_t* table = (uint32_t*)(badOccluder.data() + tableOffset);
+	uint32_t* triangles = (uint32_t*)(badOccluder.data() + occluders->offset + occluders->size) - table[2];
+	triangles[0] = table[1];
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeBinary(badOccluder.data(), badOccluder.size()));
+
+	ASSERT_FALSE(SceneSerializer(std::make_shared<Scene>()).DeserializeText("{ \"version\" : "));
+}
+
+// names the assets by their id, the loading process finds them under other ids
+class TestAssetResolver : public SceneAssetResolver
+{
+public:
+	std::string GetAssetName(SceneAssetType type, UUID id) override
+	{
+		// one material has no stable name and keeps its id
+		if (type == SceneAssetType::Material && (uint64_t)id == 41) return "";
+		return std::to_string((uint32_t)type) + "/" + std::to_string((uint64_t)id);
+	}
+
+	opt<UUID> FindAsset(SceneAssetType type, std::string_view name) override
+	{
+		std::string prefix = std::to_string((uint32_t)type) + "/";
+		if (name.substr(0, prefix.size()) != prefix) return std::nullopt;
+		uint64_t id = std::stoull(std::string(name.substr(prefix.size())));
+		// a mesh which isn't loaded anymore
+		if (type == SceneAssetType::Mesh && id == 1004) return std::nullopt;
+		return UUID(id + 100000);
+	}
+};
+
+TEST(SceneSerializer, AssetReferencesAreResolvedByName)
+{
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, 20);
+	auto resolver = std::make_shared<TestAssetResolver>();
+
+	auto expectRemapped = [&](ptr<Scene> dst)
+	{
+		src->IterateAllEntitiesWith<RenderableComponent>(
+			[&](Entity s)
+			{
+				auto& sr = s.GetComponent<RenderableComponent>();
+				auto& dr = dst->GetEntityByUUID(s.GetUUID()).GetComponent<RenderableComponent>();
+				uint64_t mesh = (uint64_t)sr.targetMesh;
+				ASSERT_EQ((uint64_t)dr.targetMesh, mesh == 1004 ? mesh : mesh + 100000);
+				for (uint32_t p = 0; p < sr.passCount; p++)
+				{
+					uint64_t material = (uint64_t)sr.targetMaterials[p];
+					ASSERT_EQ((uint64_t)dr.targetMaterials[p], material == 41 ? material : material + 100000);
+				}
+			}
+		);
+		src->IterateAllEntitiesWith<RayTracingGeometryComponent>(
+			[&](Entity s)
+			{
+				auto& sg = s.GetComponent<RayTracingGeometryComponent>();
+				auto& dg = dst->GetEntityByUUID(s.GetUUID()).GetComponent<RayTracingGeometryComponent>();
+				ASSERT_EQ((uint64_t)dg.rayTracingMaterial, (uint64_t)sg.rayTracingMaterial + 100000);
+			}
+		);
+	};
+
+	std::vector<uint8_t> data = SceneSerializer(src, resolver).SerializeBinary();
+	ptr<Scene> binaryScene = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(binaryScene, resolver).DeserializeBinary(data.data(), data.size()));
+	expectRemapped(binaryScene);
+
+	std::string text = SceneSerializer(src, resolver).SerializeText();
+	ptr<Scene> textScene = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(textScene, resolver).DeserializeText(text));
+	expectRemapped(textScene);
+
+	// without a resolver the saved ids are loaded as they are
+	ptr<Scene> unresolved = std::make_shared<Scene>();
+	ASSERT_TRUE(SceneSerializer(unresolved).DeserializeBinary(data.data(), data.size()));
+	ExpectEqualScenes(src, unresolved);
+}
+
+TEST(SceneSerializer, LoadBenchmark)
+{
+	constexpr uint32_t entityCount = 100000;
+
+	ptr<Scene> src = std::make_shared<Scene>();
+	BuildScene(src, entityCount);
+
+	auto directory = std::filesystem::temp_directory_path();
+	std::string binaryPath = (directory / "kbs_scene_benchmark.kscene").string();
+	std::string textPath = (directory / "kbs_scene_benchmark.json").string();
+	ASSERT_TRUE(SceneSerializer(src).SerializeBinary(binaryPath));
+	ASSERT_TRUE(SceneSerializer(src).Serialize(textPath));
+
+	ptr<Scene> binaryScene = std::make_shared<Scene>();
+	ptr<Scene> textScene = std::make_shared<Scene>();
+	auto start = std::chrono::high_resolution_clock::now();
+	ASSERT_TRUE(SceneSerializer(binaryScene).DeserializeBinary(binaryPath));
+	auto mid = std::chrono::high_resolution_clock::now();
+	ASSERT_TRUE(SceneSerializer(textScene).Deserialize(textPath));
+	auto end = std::chrono::high_resolution_clock::now();
+
+	ASSERT_TRUE(binaryScene->FindEntityByName("entity" + std::to_string(entityCount - 1)));
+	ASSERT_TRUE(textScene->FindEntityByName("entity" + std::to_string(entityCount - 1)));
+
+	std::cout << "[ SceneSerializer ] loading " << entityCount << " entities, binary ("
+		<< std::filesystem::file_size(binaryPath) / 1024 << " KB) : "
+		<< std::chrono::duration<double, std::milli>(mid - start).count() << " ms, json ("
+		<< std::filesystem::file_size(textPath) / 1024 << " KB) : "
+		<< std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+
+	std::filesystem::remove(binaryPath);
+	std::filesystem::remove(textPath);
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
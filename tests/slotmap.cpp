@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+#include "Core/SlotMap.h"
+#include "Scene/UUID.h"
+#include <chrono>
+#include <iostream>
+
+using namespace kbs;
+
+struct Resource
+{
+	uint32_t value;
+};
+
+TEST(SlotMap, InsertGetRemove)
+{
+	SlotMap<Resource> map;
+	auto a = map.Insert({ 1 });
+	auto b = map.Insert({ 2 });
+	auto c = map.Insert({ 3 });
+	ASSERT_EQ(map.Size(), 3);
+	ASSERT_EQ(map.Get(b)->value, 2);
+	ASSERT_EQ(map.Get(SlotHandle<Resource>{}), nullptr);
+
+	// removing swaps the last value into the hole, the other handles stay valid
+	ASSERT_TRUE(map.Remove(a));
+	ASSERT_FALSE(map.Remove(a));
+	ASSERT_EQ(map.Get(a), nullptr);
+	ASSERT_EQ(map.Get(b)->value, 2);
+	ASSERT_EQ(map.Get(c)->value, 3);
+	ASSERT_EQ(map.Size(), 2);
+
+	// the freed slot is reused with a new generation, the stale handle is rejected
+	auto d = map.Insert({ 4 });
+	ASSERT_EQ(d.index, a.index);
+	ASSERT_NE(d, a);
+	ASSERT_EQ(map.Get(a), nullptr);
+	ASSERT_EQ(map.Get(d)->value, 4);
+
+	uint32_t sum = 0;
+	for (auto& r : map) sum += r.value;
+	ASSERT_EQ(sum, 9);
+	for (uint32_t i = 0; i < map.Size(); i++)
+	{
+		ASSERT_EQ(map.Get(map.GetHandle(i)), &map.GetValues()[i]);
+	}
+
+	map.Clear();
+	ASSERT_TRUE(map.Empty());
+	ASSERT_FALSE(map.Contains(b));
+	ASSERT_FALSE(map.Contains(d));
+}
+
+TEST(SlotMap, LookupBenchmark)
+{
+	constexpr uint32_t resourceCount = 100000;
+	constexpr uint32_t lookupCount = 10000000;
+
+	// the managers stored resources as shared pointers keyed by random uuids
+	std::unordered_map<UUID, ptr<Resource>> idMap;
+	SlotMap<ptr<Resource>> slotMap;
+	std::vector<UUID> ids;
+	std::vector<SlotHandle<ptr<Resource>>> handles;
+	for (uint32_t i = 0; i < resourceCount; i++)
+	{
+		auto resource = std::make_shared<Resource>(Resource{ i });
+		UUID id = UUID::GenerateUncollidedID(idMap);
+		idMap[id] = resource;
+		ids.push_back(id);
+		handles.push_back(slotMap.Insert(resource));
+	}
+
+	// random access pattern, like draws visiting resources in sorted order
+	std::vector<uint32_t> order(lookupCount);
+	uint32_t state = 1;
+	for (auto& idx : order)
+	{
+		state = state * 1664525u + 1013904223u;
+		idx = state % resourceCount;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	uint64_t mapSum = 0;
+	for (uint32_t idx : order)
+	{
+		auto iter = idMap.find(ids[idx]);
+		if (iter != idMap.end()) mapSum += iter->second->value;
+	}
+	auto mid = std::chrono::high_resolution_clock::now();
+	uint64_t slotSum = 0;
+	for (uint32_t idx : order)
+	{
+		if (auto resource = slotMap.Get(handles[idx])) slotSum += (*resource)->value;
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	ASSERT_EQ(mapSum, slotSum);
+
+	double mapNs = std::chrono::duration<double, std::nano>(mid - start).count() / lookupCount;
+	double slotNs = std::chrono::duration<double, std::nano>(end - mid).count() / lookupCount;
+	std::cout << "[ SlotMap ] " << resourceCount << " resources, unordered_map : " << mapNs << " ns/lookup, slot map : " << slotNs << " ns/lookup" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
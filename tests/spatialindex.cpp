@@ -0,0 +1,250 @@
+#include "gtest/gtest.h"
+#include "Math/DynamicAABBTree.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include <chrono>
+#include <iostream>
+#include <set>
+
+using namespace kbs;
+
+class Random
+{
+public:
+	float Next(float lower, float upper)
+	{
+		m_State = m_State * 1664525u + 1013904223u;
+		return lower + (upper - lower) * (float)(m_State >> 8) / (float)(1 << 24);
+	}
+
+	vec3 NextVec3(float lower, float upper) { return vec3(Next(lower, upper), Next(lower, upper), Next(lower, upper)); }
+
+private:
+	uint32_t m_State = 1;
+};
+
+static AABB RandomBox(Random& random, float worldSize)
+{
+	return AABB::FromCenterExtent(random.NextVec3(-worldSize, worldSize), random.NextVec3(.1f, 2.f));
+}
+
+static Frustum TestFrustum()
+{
+	mat4 view = glm::lookAtLH(vec3(0, 0, -120), vec3(10, 5, 0), vec3(0, 1, 0));
+	mat4 proj = glm::perspectiveLH_ZO(glm::radians(45.f), 1.5f, 1.f, 150.f);
+	return Frustum::FromMatrix(proj * view);
+}
+
+TEST(SpatialIndex, TreeMatchesBruteForce)
+{
+	constexpr uint32_t boxCount = 2000;
+	constexpr float worldSize = 100.f;
+
+	Random random;
+	DynamicAABBTree tree;
+	std::vector<AABB> boxes(boxCount);
+	std::vector<uint32_t> proxies(boxCount);
+	std::vector<bool> alive(boxCount, true);
+	for (uint32_t i = 0; i < boxCount; i++)
+	{
+		boxes[i] = RandomBox(random, worldSize);
+		proxies[i] = tree.CreateProxy(boxes[i], i);
+	}
+	ASSERT_TRUE(tree.Validate());
+	ASSERT_EQ(tree.GetProxyCount(), boxCount);
+
+	// small moves stay inside the fattened bounds, large ones are reinserted
+	for (uint32_t i = 0; i < boxCount; i++)
+	{
+		vec3 offset = i % 3 == 0 ? random.NextVec3(-20.f, 20.f) : random.NextVec3(-.05f, .05f);
+		boxes[i] = AABB(boxes[i].lower + offset, boxes[i].upper + offset);
+		tree.MoveProxy(proxies[i], boxes[i]);
+	}
+	for (uint32_t i = 0; i < boxCount; i += 7)
+	{
+		tree.DestroyProxy(proxies[i]);
+		alive[i] = false;
+	}
+	ASSERT_TRUE(tree.Validate());
+
+	auto expectSame = [&](auto&& test, auto&& query)
+	{
+		std::set<uint32_t> expected, result;
+		for (uint32_t i = 0; i < boxCount; i++)
+		{
+			if (alive[i] && test(boxes[i])) expected.insert(i);
+		}
+		query([&](uint32_t i) { ASSERT_TRUE(result.insert(i).second); });
+		ASSERT_EQ(expected, result);
+	};
+
+	for (uint32_t q = 0; q < 50; q++)
+	{
+		AABB box = AABB::FromCenterExtent(random.NextVec3(-worldSize, worldSize), random.NextVec3(1.f, 30.f));
+		expectSame([&](const AABB& b) { return b.Overlaps(box); }, [&](auto&& f) { tree.QueryAABB(box, f); });
+
+		Sphere sphere{ random.NextVec3(-worldSize, worldSize), random.Next(1.f, 30.f) };
+		expectSame([&](const AABB& b) { return sphere.Overlaps(b); }, [&](auto&& f) { tree.QuerySphere(sphere, f); });
+	}
+
+	Frustum frustum = TestFrustum();
+	expectSame([&](const AABB& b) { return frustum.Overlaps(b); }, [&](auto&& f) { tree.QueryFrustum(frustum, f); });
+
+	for (uint32_t q = 0; q < 50; q++)
+	{
+		Ray ray{ random.NextVec3(-worldSize, worldSize), random.NextVec3(-1.f, 1.f) };
+		RaySlab slab(ray);
+		opt<float> closest;
+		std::set<uint32_t> expected;
+		for (uint32_t i = 0; i < boxCount; i++)
+		{
+			if (!alive[i]) continue;
+			if (auto t = slab.Intersect(boxes[i], 1000.f); t.has_value())
+			{
+				expected.insert(i);
+				closest = std::min(closest.value_or(FLT_MAX), t.value());
+			}
+		}
+
+		std::set<uint32_t> all;
+		tree.Raycast(ray, 1000.f, [&](uint32_t i, float) { all.insert(i); return 1000.f; });
+		ASSERT_EQ(expected, all);
+
+		opt<float> hit;
+		tree.Raycast(ray, 1000.f, [&](uint32_t, float t) { hit = t; return t; });
+		ASSERT_EQ(hit, closest);
+	}
+
+	for (uint32_t i = 0; i < boxCount; i++)
+	{
+		if (alive[i]) tree.DestroyProxy(proxies[i]);
+	}
+	ASSERT_EQ(tree.GetProxyCount(), 0);
+	ASSERT_TRUE(tree.Validate());
+}
+
+TEST(SpatialIndex, SceneBounds)
+{
+	Scene scene;
+	Entity parent = scene.CreateEntity("parent");
+	parent.AddComponent<TransformComponent>(scene.CreateTransform({}, vec3(10, 0, 0), quat(1, 0, 0, 0), vec3(1)));
+	parent.SetBounds(AABB(vec3(-1), vec3(1)));
+
+	Entity child = scene.CreateEntity("child");
+	child.AddComponent<TransformComponent>(scene.CreateTransform(parent, vec3(0, 5, 0), quat(1, 0, 0, 0), vec3(2)));
+	child.SetBounds(AABB(vec3(-1), vec3(1)));
+
+	Entity far = scene.CreateEntity("far");
+	far.AddComponent<TransformComponent>(scene.CreateTransform({}, vec3(-50, 0, 0), quat(1, 0, 0, 0), vec3(1)));
+	far.SetBounds(AABB(vec3(-1), vec3(1)));
+	scene.UpdateWorldTransforms();
+
+	auto query = [&](const AABB& box)
+	{
+		std::set<std::string> names;
+		scene.QueryAABB(box, [&](Entity e) { names.insert(e.GetName()); });
+		return names;
+	};
+	// the child is scaled and offset by its parent: [8, 12] x [3, 7] x [-2, 2]
+	ASSERT_EQ(query(AABB(vec3(9, 3.5f, 0), vec3(9.5f, 4, 1))), std::set<std::string>({ "child" }));
+	ASSERT_EQ(query(AABB(vec3(0, -10, -10), vec3(20, 10, 10))), std::set<std::string>({ "parent", "child" }));
+
+	// moving the parent moves the bounds of its child
+	parent.GetComponent<TransformComponent>().position = vec3(-50, 0, 0);
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(query(AABB(vec3(0, -10, -10), vec3(20, 10, 10))).empty());
+	ASSERT_EQ(query(AABB(vec3(-52, 3.5f, 0), vec3(-51, 4, 1))), std::set<std::string>({ "child" }));
+
+	float distance = 0.f;
+	Entity hit = scene.Raycast(Ray{ vec3(-100, 0, 0), vec3(1, 0, 0) }, FLT_MAX, &distance);
+	ASSERT_TRUE(hit);
+	ASSERT_TRUE(hit.GetName() == "far" || hit.GetName() == "parent");
+	ASSERT_NEAR(distance, 49.f, 1e-4f);
+	ASSERT_FALSE(scene.Raycast(Ray{ vec3(-100, 100, 0), vec3(1, 0, 0) }));
+
+	uint32_t sphereCount = 0;
+	scene.QuerySphere(Sphere{ vec3(-50, 4, 0), 1.f }, [&](Entity) { sphereCount++; });
+	ASSERT_EQ(sphereCount, 1);
+
+	// changed bounds and destroyed entities are picked up by the next update
+	child.SetBounds(AABB(vec3(-1, -1, -1), vec3(1, 1, 100)));
+	scene.DestroyEntity(far);
+	scene.UpdateWorldTransforms();
+	ASSERT_EQ(query(AABB(vec3(-60, -1, 150), vec3(-40, 10, 160))), std::set<std::string>({ "child" }));
+	uint32_t rayCount = 0;
+	scene.RaycastAll(Ray{ vec3(-100, 0, 0), vec3(1, 0, 0) }, FLT_MAX, [&](Entity, float) { rayCount++; });
+	ASSERT_EQ(rayCount, 1);
+	ASSERT_EQ(scene.GetSpatialIndex().GetProxyCount(), 2);
+
+	child.RemoveComponent<BoundsComponent>();
+	ASSERT_EQ(scene.GetSpatialIndex().GetProxyCount(), 1);
+}
+
+TEST(SpatialIndex, MovingObjectsBenchmark)
+{
+	constexpr uint32_t objectCount = 100000;
+	constexpr uint32_t frameCount = 10;
+	constexpr uint32_t queryCount = 1000;
+	constexpr float worldSize = 500.f;
+
+	Random random;
+	DynamicAABBTree tree;
+	std::vector<AABB> boxes(objectCount);
+	std::vector<vec3> velocities(objectCount);
+	std::vector<uint32_t> proxies(objectCount);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		boxes[i] = RandomBox(random, worldSize);
+		velocities[i] = random.NextVec3(-.05f, .05f);
+		proxies[i] = tree.CreateProxy(boxes[i], i);
+	}
+	auto built = std::chrono::high_resolution_clock::now();
+
+	// every object moves every frame, 3 units per second at 60 fps
+	uint32_t reinserted = 0;
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			boxes[i] = AABB(boxes[i].lower + velocities[i], boxes[i].upper + velocities[i]);
+			reinserted += tree.MoveProxy(proxies[i], boxes[i]);
+		}
+	}
+	auto moved = std::chrono::high_resolution_clock::now();
+	ASSERT_TRUE(tree.Validate());
+
+	std::vector<AABB> queries(queryCount);
+	for (auto& q : queries)
+	{
+		q = AABB::FromCenterExtent(random.NextVec3(-worldSize, worldSize), vec3(10.f));
+	}
+	uint64_t treeHits = 0;
+	auto queryStart = std::chrono::high_resolution_clock::now();
+	for (auto& q : queries)
+	{
+		tree.QueryAABB(q, [&](uint32_t) { treeHits++; });
+	}
+	auto queryEnd = std::chrono::high_resolution_clock::now();
+	uint64_t bruteHits = 0;
+	for (auto& q : queries)
+	{
+		for (auto& b : boxes) bruteHits += b.Overlaps(q);
+	}
+	auto bruteEnd = std::chrono::high_resolution_clock::now();
+	ASSERT_EQ(treeHits, bruteHits);
+
+	auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+	std::cout << "[ SpatialIndex ] " << objectCount << " objects, build : " << ms(start, built) << " ms, move all : "
+		<< ms(built, moved) / frameCount << " ms/frame (" << reinserted / frameCount << " reinserted), height : " << tree.GetHeight()
+		<< ", area ratio : " << tree.GetAreaRatio() << std::endl;
+	std::cout << "[ SpatialIndex ] " << queryCount << " box queries, tree : " << ms(queryStart, queryEnd) << " ms, brute force : "
+		<< ms(queryEnd, bruteEnd) << " ms" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
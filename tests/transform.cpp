@@ -0,0 +1,217 @@
+#include "gtest/gtest.h"
+#include "Scene/Scene.h"
+#include "Scene/Entity.h"
+#include "Scene/Transform.h"
+#include <chrono>
+#include <iostream>
+
+using namespace kbs;
+
+static bool NearlyEqual(const mat4& lhs, const mat4& rhs)
+{
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		for (uint32_t r = 0; r < 4; r++)
+		{
+			if (std::abs(lhs[c][r] - rhs[c][r]) > 1e-3f) return false;
+		}
+	}
+	return true;
+}
+
+static Entity CreateNode(Scene& scene, opt<Entity> parent, vec3 position, quat rotation, vec3 scale)
+{
+	Entity e = scene.CreateEntity();
+	e.AddComponent<TransformComponent>(scene.CreateTransform(parent, position, rotation, scale));
+	return e;
+}
+
+// the world matrix computed by walking the parent chain, as Transform did before the cache
+static mat4 WalkParents(Scene& scene, Entity e)
+{
+	TransformComponent trans = e.GetComponent<TransformComponent>();
+	mat4 model = trans.GetLocalMatrix();
+	while (trans.parent != scene.GetRootID())
+	{
+		trans = scene.GetEntityByUUID(trans.parent).GetComponent<TransformComponent>();
+		model = trans.GetLocalMatrix() * model;
+	}
+	return model;
+}
+
+TEST(Transform, WorldTransformsFollowTheHierarchy)
+{
+	Scene scene;
+	Entity a = CreateNode(scene, {}, vec3(1, 2, 3), math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(90)), vec3(2, 2, 2));
+	Entity b = CreateNode(scene, a, vec3(0, 1, 0), math::axisAngle(vec3(1, 0, 0), Angle::FromDegree(30)), vec3(1, 1, 1));
+	Entity c = CreateNode(scene, b, vec3(0, 0, 5), quat(1, 0, 0, 0), vec3(1, 3, 1));
+	scene.UpdateWorldTransforms();
+
+	for (Entity e : { a, b, c })
+	{
+		ASSERT_TRUE(NearlyEqual(e.GetComponent<WorldTransformComponent>().world, WalkParents(scene, e)));
+		ASSERT_TRUE(NearlyEqual(Transform(e).GetObjectUBO().model, WalkParents(scene, e)));
+	}
+	vec3 position = Transform(c).GetPosition();
+	vec4 expected = WalkParents(scene, c)[3];
+	ASSERT_NEAR(position.x, expected.x, 1e-3f);
+	ASSERT_NEAR(position.y, expected.y, 1e-3f);
+	ASSERT_NEAR(position.z, expected.z, 1e-3f);
+
+	// moving the parent moves its descendants on the next update
+	a.GetComponent<TransformComponent>().position = vec3(-4, 0, 0);
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(NearlyEqual(c.GetComponent<WorldTransformComponent>().world, WalkParents(scene, c)));
+
+	// a modified copy of the component is not served from the cache
+	Transform moved(c);
+	moved.SetLocalPosition(vec3(0, 0, 6));
+	ASSERT_FALSE(NearlyEqual(moved.GetObjectUBO().model, c.GetComponent<WorldTransformComponent>().world));
+
+	// a world space position set on a child is kept after the update
+	Transform child(c);
+	child.SetPosition(vec3(10, 20, 30));
+	c.GetComponent<TransformComponent>() = child.GetComponent();
+	scene.UpdateWorldTransforms();
+	vec3 world = Transform(c).GetPosition();
+	ASSERT_NEAR(world.x, 10, 1e-3f);
+	ASSERT_NEAR(world.y, 20, 1e-3f);
+	ASSERT_NEAR(world.z, 30, 1e-3f);
+}
+
+TEST(Transform, ReparentingAndDestroying)
+{
+	Scene scene;
+	Entity a = CreateNode(scene, {}, vec3(1, 0, 0), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	Entity b = CreateNode(scene, {}, vec3(0, 1, 0), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	Entity c = CreateNode(scene, a, vec3(0, 0, 1), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(NearlyEqual(c.GetComponent<WorldTransformComponent>().world, math::position(vec3(1, 0, 1))));
+
+	// a parent that was created after its child
+	c.GetComponent<TransformComponent>().parent = b.GetUUID();
+	Entity d = CreateNode(scene, {}, vec3(0, 0, 2), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	b.GetComponent<TransformComponent>().parent = d.GetUUID();
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(NearlyEqual(c.GetComponent<WorldTransformComponent>().world, math::position(vec3(0, 1, 3))));
+
+	scene.DestroyEntity(a);
+	c.RemoveComponent<TransformComponent>();
+	scene.UpdateWorldTransforms();
+	ASSERT_FALSE(c.HasComponent<WorldTransformComponent>());
+	ASSERT_TRUE(NearlyEqual(b.GetComponent<WorldTransformComponent>().world, math::position(vec3(0, 1, 2))));
+}
+
+TEST(Transform, MovedAncestorsAreNotServedFromTheCache)
+{
+	Scene scene;
+	Entity a = CreateNode(scene, {}, vec3(1, 0, 0), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	Entity b = CreateNode(scene, a, vec3(0, 1, 0), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	Entity c = CreateNode(scene, b, vec3(0, 0, 1), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	scene.UpdateWorldTransforms();
+
+	// the grandparent moved, the cached world transforms of its subtree are stale until the next update
+	a.GetComponent<TransformComponent>().position = vec3(5, 0, 0);
+	a.GetComponent<TransformComponent>().rotation = math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(90));
+	vec3 position = Transform(c).GetPosition();
+	vec4 expected = WalkParents(scene, c)[3];
+	ASSERT_NEAR(position.x, expected.x, 1e-3f);
+	ASSERT_NEAR(position.y, expected.y, 1e-3f);
+	ASSERT_NEAR(position.z, expected.z, 1e-3f);
+	ASSERT_TRUE(NearlyEqual(Transform(c).GetObjectUBO().model, WalkParents(scene, c)));
+	vec3 front = Transform(c).GetFront();
+	ASSERT_NEAR(front.x, 1, 1e-3f);
+	ASSERT_NEAR(front.z, 0, 1e-3f);
+}
+
+TEST(Transform, SpawningUpdatesOnlyTheNewEntities)
+{
+	Scene scene;
+	std::vector<Entity> entities;
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		entities.push_back(CreateNode(scene, i % 10 ? opt<Entity>(entities[i - i % 10]) : opt<Entity>(), vec3((float)i, 0, 0), quat(1, 0, 0, 0), vec3(1, 1, 1)));
+	}
+	scene.UpdateWorldTransforms();
+	scene.ClearChanges();
+
+	// a spawned entity and a reparented subtree are the only transforms computed again
+	Entity spawned = CreateNode(scene, entities[0], vec3(0, 0, 1), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	entities[15].GetComponent<TransformComponent>().parent = entities[0].GetUUID();
+	Entity grandchild = CreateNode(scene, entities[15], vec3(0, 0, 2), quat(1, 0, 0, 0), vec3(1, 1, 1));
+	scene.UpdateWorldTransforms();
+	std::vector<entt::entity> changed = scene.GetChanges(SceneChangeType::Transform).changed;
+	ASSERT_EQ(changed.size(), 3);
+	for (Entity e : { spawned, entities[15], grandchild })
+	{
+		ASSERT_NE(std::find(changed.begin(), changed.end(), (entt::entity)e), changed.end());
+		ASSERT_TRUE(NearlyEqual(e.GetComponent<WorldTransformComponent>().world, WalkParents(scene, e)));
+	}
+	scene.ClearChanges();
+
+	// so does removing a transform
+	entities[99].RemoveComponent<TransformComponent>();
+	scene.UpdateWorldTransforms();
+	ASSERT_TRUE(scene.GetChanges(SceneChangeType::Transform).changed.empty());
+	for (uint32_t i = 0; i < 99; i++)
+	{
+		ASSERT_TRUE(NearlyEqual(entities[i].GetComponent<WorldTransformComponent>().world, WalkParents(scene, entities[i])));
+	}
+}
+
+// 1000 chains of 100 nodes
+TEST(Transform, DeepHierarchyBenchmark)
+{
+	const uint32_t chainCount = 1000, depth = 100;
+	Scene scene;
+	std::vector<Entity> entities;
+	std::vector<Entity> chainRoots;
+	entities.reserve(chainCount * depth);
+	for (uint32_t c = 0; c < chainCount; c++)
+	{
+		opt<Entity> parent;
+		for (uint32_t d = 0; d < depth; d++)
+		{
+			Entity e = CreateNode(scene, parent, vec3(0.01f * d, 0.1f, 0), math::axisAngle(vec3(0, 1, 0), Angle::FromDegree(1)), vec3(1, 1, 1));
+			if (d == 0) chainRoots.push_back(e);
+			entities.push_back(e);
+			parent = e;
+		}
+	}
+
+	auto measure = [](const char* name, auto&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+		std::cout << "[ Transform ] " << name << " : " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+	};
+
+	float sum = 0;
+	measure("parent walk per object", [&]()
+		{
+			for (auto e : entities) sum += WalkParents(scene, e)[3][0];
+		});
+	measure("first update (hierarchy build)", [&]() { scene.UpdateWorldTransforms(); });
+	measure("update without changes", [&]() { scene.UpdateWorldTransforms(); });
+	chainRoots[0].GetComponent<TransformComponent>().position.x += 1;
+	measure("update with one chain moved", [&]() { scene.UpdateWorldTransforms(); });
+	for (auto e : chainRoots) e.GetComponent<TransformComponent>().position.x += 1;
+	measure("update with every node moved", [&]() { scene.UpdateWorldTransforms(); });
+	measure("GetObjectUBO per object", [&]()
+		{
+			for (auto e : entities) sum += Transform(e).GetObjectUBO().model[3][0];
+		});
+	std::cout << "[ Transform ] checksum " << sum << std::endl;
+
+	for (uint32_t i = 0; i < entities.size(); i += 997)
+	{
+		ASSERT_TRUE(NearlyEqual(entities[i].GetComponent<WorldTransformComponent>().world, WalkParents(scene, entities[i])));
+	}
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "Math/TransformBatch.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace kbs;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+static const char* s_LevelNames[] = { "scalar", "sse", "avx2" };
+
+static void FillRandomTransforms(TransformSoA& transforms, uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-100.f, 100.f), axis(-1.f, 1.f), angle(0.f, 6.28f), scale(0.2f, 5.f);
+	transforms.Resize(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		vec3 a(axis(rng), axis(rng), axis(rng) + 2.f);
+		transforms.Set(i, vec3(position(rng), position(rng), position(rng)), math::axisAngle(a, angle(rng)), vec3(scale(rng), scale(rng), scale(rng)));
+	}
+}
+
+static float MaxRelativeError(const mat4& lhs, const mat4& rhs)
+{
+	float error = 0;
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		for (uint32_t r = 0; r < 4; r++)
+		{
+			error = std::max(error, std::abs(lhs[c][r] - rhs[c][r]) / std::max(1.f, std::abs(rhs[c][r])));
+		}
+	}
+	return error;
+}
+
+static mat4 ReferenceMatrix(const TransformSoA& transforms, uint32_t i)
+{
+	vec3 p(transforms.position[0][i], transforms.position[1][i], transforms.position[2][i]);
+	quat q(transforms.rotation[3][i], transforms.rotation[0][i], transforms.rotation[1][i], transforms.rotation[2][i]);
+	vec3 s(transforms.scale[0][i], transforms.scale[1][i], transforms.scale[2][i]);
+	return math::position(p) * math::quat2mat(q) * math::scale(s);
+}
+
+TEST(TransformBatch, MatchesGlm)
+{
+	// not a multiple of the batch width
+	const uint32_t count = 1003;
+	TransformSoA transforms;
+	FillRandomTransforms(transforms, count, 7);
+
+	for (uint32_t level = 0; level <= (uint32_t)math::GetSupportedSimdLevel(); level++)
+	{
+		math::SetSimdLevel(s_Levels[level]);
+		AffineMatrixSoA world, inverse, generalInverse;
+		math::ComposeTRS(transforms, world, &inverse);
+		math::InverseAffine(world, generalInverse);
+
+		std::vector<mat4> normals(count), generalNormals(count);
+		math::StoreMatrices(inverse, 0, count, normals.data(), true);
+		math::StoreMatrices(generalInverse, 0, count, generalNormals.data(), true);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			mat4 reference = ReferenceMatrix(transforms, i);
+			mat4 referenceNormal = math::transpose(math::inverse(reference));
+			ASSERT_LT(MaxRelativeError(world.Get(i), reference), 1e-5f) << s_LevelNames[level] << " " << i;
+			ASSERT_LT(MaxRelativeError(normals[i], referenceNormal), 1e-4f) << s_LevelNames[level] << " " << i;
+			ASSERT_LT(MaxRelativeError(generalNormals[i], referenceNormal), 1e-4f) << s_LevelNames[level] << " " << i;
+		}
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+TEST(TransformBatch, InverseOfShearedMatrices)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> value(-2.f, 2.f);
+	const uint32_t count = 64;
+	AffineMatrixSoA matrices;
+	matrices.Resize(count);
+	std::vector<mat4> references(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		mat4 m(1.f);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			for (uint32_t r = 0; r < 3; r++)
+			{
+				m[c][r] = value(rng) + (c == r ? 3.f : 0.f);
+			}
+		}
+		matrices.Set(i, m);
+		references[i] = math::inverse(m);
+	}
+
+	for (uint32_t level = 0; level <= (uint32_t)math::GetSupportedSimdLevel(); level++)
+	{
+		math::SetSimdLevel(s_Levels[level]);
+		AffineMatrixSoA inverse;
+		math::InverseAffine(matrices, inverse);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			ASSERT_LT(MaxRelativeError(inverse.Get(i), references[i]), 1e-4f) << s_LevelNames[level] << " " << i;
+		}
+	}
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+TEST(TransformBatch, MillionTransformsBenchmark)
+{
+	const uint32_t count = 1000000;
+	TransformSoA transforms;
+	FillRandomTransforms(transforms, count, 11);
+	std::vector<mat4> models(count), normals(count);
+
+	auto measure = [](const std::string& name, auto&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+		std::cout << "[ TransformBatch ] " << name << " : " << std::chrono::duration<double, std::milli>(end - start).count() << " ms per million" << std::endl;
+	};
+
+	measure("glm compose + inverse + transpose", [&]()
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				models[i] = ReferenceMatrix(transforms, i);
+				normals[i] = math::transpose(math::inverse(models[i]));
+			}
+		});
+
+	// touch the output pages before measuring
+	AffineMatrixSoA world, inverse;
+	math::ComposeTRS(transforms, world, &inverse);
+	for (uint32_t level = 0; level <= (uint32_t)math::GetSupportedSimdLevel(); level++)
+	{
+		math::SetSimdLevel(s_Levels[level]);
+		std::string name = s_LevelNames[level];
+		measure(name + " compose trs + closed form inverse", [&]() { math::ComposeTRS(transforms, world, &inverse); });
+		measure(name + " general affine inverse", [&]() { math::InverseAffine(world, inverse); });
+	}
+	measure("store models + normal matrices", [&]()
+		{
+			math::StoreMatrices(world, 0, count, models.data());
+			math::StoreMatrices(inverse, 0, count, normals.data(), true);
+		});
+	math::SetSimdLevel(math::GetSupportedSimdLevel());
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,214 @@
+#include "gtest/gtest.h"
+#include "Core/FileSystem.h"
+#include "Core/VirtualFileSystem.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+static std::string WriteFile(const fs::path& path, const std::string& content)
+{
+	fs::create_directories(path.parent_path());
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << content;
+	return content;
+}
+
+static std::string MakeTestDirectory(const std::string& name)
+{
+	fs::path directory = fs::absolute(fs::path("vfs_test") / name);
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+	return directory.string();
+}
+
+TEST(VirtualFileSystem, PackedFilesAreFoundUnderMountDirectory)
+{
+	std::string source = MakeTestDirectory("pack_source");
+	std::string a = WriteFile(fs::path(source) / "a.txt", "content of a");
+	std::string b = WriteFile(fs::path(source) / "models" / "b.gltf", std::string(1000, 'b'));
+	WriteFile(fs::path(source) / "empty.bin", "");
+
+	std::string packPath = (fs::path(MakeTestDirectory("pack")) / "assets.pack").string();
+	ASSERT_TRUE(kbs::PackArchive::BuildFromDirectory(source, packPath));
+	fs::remove_all(source);
+
+	kbs::VirtualFileSystem vfs;
+	ASSERT_TRUE(vfs.Mount(packPath, source));
+
+	auto blobA = vfs.Open((fs::path(source) / "a.txt").string());
+	ASSERT_TRUE(blobA.has_value());
+	ASSERT_EQ(blobA.value().AsString(), a);
+	// blobs are aligned views into the mapped pack
+	ASSERT_EQ((uintptr_t)blobA.value().data % 16, 0);
+
+	auto blobB = vfs.Open(source + "/models/../models/./b.gltf");
+	ASSERT_TRUE(blobB.has_value());
+	ASSERT_EQ(blobB.value().AsString(), b);
+
+	auto empty = vfs.Open((fs::path(source) / "empty.bin").string());
+	ASSERT_TRUE(empty.has_value());
+	ASSERT_EQ(empty.value().size, 0);
+
+	ASSERT_TRUE(vfs.Contains((fs::path(source) / "models" / "b.gltf").string()));
+	ASSERT_FALSE(vfs.Contains((fs::path(source) / "missing.txt").string()));
+	ASSERT_FALSE(vfs.Open((fs::path(source) / "missing.txt").string()).has_value());
+
+	// the blob keeps the mapping alive after unmounting
+	vfs.UnmountAll();
+	ASSERT_EQ(blobB.value().AsString(), b);
+}
+
+TEST(VirtualFileSystem, LooseFilesAreMapped)
+{
+	std::string directory = MakeTestDirectory("loose");
+	std::string content = WriteFile(fs::path(directory) / "shader.glsl", "void main() {}\n");
+
+	kbs::VirtualFileSystem vfs;
+	auto blob = vfs.Open((fs::path(directory) / "shader.glsl").string());
+	ASSERT_TRUE(blob.has_value());
+	ASSERT_EQ(blob.value().AsString(), content);
+}
+
+TEST(VirtualFileSystem, InvalidPackIsRejected)
+{
+	std::string directory = MakeTestDirectory("invalid");
+	std::string packPath = (fs::path(directory) / "invalid.pack").string();
+	WriteFile(packPath, std::string(256, 'x'));
+
+	kbs::VirtualFileSystem vfs;
+	ASSERT_FALSE(vfs.Mount(packPath));
+
+	// entries pointing out of the file or out of the string table
+	std::string source = MakeTestDirectory("invalid_source");
+	WriteFile(fs::path(source) / "a.txt", "content of a");
+	WriteFile(fs::path(source) / "b.txt", "content of b");
+	std::string validPath = (fs::path(directory) / "valid.pack").string();
+	ASSERT_TRUE(kbs::PackArchive::BuildFromDirectory(source, validPath));
+	std::ifstream valid(validPath, std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(valid)), std::istreambuf_iterator<char>());
+	const kbs::PackHeader* header = (const kbs::PackHeader*)content.data();
+	ASSERT_EQ(header->entryCount, 2u);
+
+	auto corrupt = [&](const std::string& name, auto modify)
+	{
+		std::string corrupted = content;
+		modify(*(kbs::PackEntry*)(corrupted.data() + header->entryOffset + sizeof(kbs::PackEntry)));
+		std::string corruptedPath = (fs::path(directory) / name).string();
+		WriteFile(corruptedPath, corrupted);
+		return vfs.Mount(corruptedPath, source);
+	};
+	ASSERT_FALSE(corrupt("content.pack", [&](kbs::PackEntry& e) { e.size = content.size(); }));
+	ASSERT_FALSE(corrupt("offset.pack", [&](kbs::PackEntry& e) { e.offset = ~0ull; }));
+	ASSERT_FALSE(corrupt("path.pack", [&](kbs::PackEntry& e) { e.pathLength = 1000; }));
+	ASSERT_FALSE(corrupt("order.pack", [&](kbs::PackEntry& e) { e.pathHash = 0; }));
+	ASSERT_TRUE(corrupt("unchanged.pack", [&](kbs::PackEntry& e) {}));
+}
+
+struct VfsTestFiles {};
+
+TEST(VirtualFileSystem, FileSystemResolvesPackedFiles)
+{
+	std::string source = MakeTestDirectory("search_source");
+	WriteFile(fs::path(source) / "textures" / "albedo.png", "png");
+	std::string packPath = (fs::path(source) / "search.pack").string();
+	ASSERT_TRUE(kbs::PackArchive::BuildFromDirectory(source, packPath));
+	fs::remove_all(fs::path(source) / "textures");
+
+	auto* fileSystem = kbs::Singleton::GetInstance<kbs::FileSystem<VfsTestFiles>>();
+	fileSystem->AddSearchPath(source);
+	ASSERT_FALSE(fileSystem->FindAbsolutePath("textures/albedo.png").has_value());
+
+	ASSERT_TRUE(kbs::Singleton::GetInstance<kbs::VirtualFileSystem>()->Mount(packPath));
+	auto resolved = fileSystem->FindAbsolutePath("textures/albedo.png");
+	ASSERT_TRUE(resolved.has_value());
+
+	auto blob = fileSystem->ReadFile("textures/albedo.png");
+	ASSERT_TRUE(blob.has_value());
+	ASSERT_EQ(blob.value().AsString(), "png");
+	kbs::Singleton::GetInstance<kbs::VirtualFileSystem>()->UnmountAll();
+}
+
+struct BenchmarkFiles {};
+
+// prints the cost of resolving and reading a set of small asset files
+TEST(VirtualFileSystem, LoadBenchmark)
+{
+	const uint32_t fileCount = 2000;
+	std::string source = MakeTestDirectory("benchmark");
+	std::vector<std::string> names;
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		names.push_back("dir" + std::to_string(i % 16) + "/file" + std::to_string(i) + ".bin");
+		WriteFile(fs::path(source) / names.back(), std::string(4096 + i, (char)i));
+	}
+	std::string packPath = (fs::path(MakeTestDirectory("benchmark_pack")) / "benchmark.pack").string();
+	ASSERT_TRUE(kbs::PackArchive::BuildFromDirectory(source, packPath));
+
+	// the search path list of an example, the assets live in the last one
+	std::vector<std::string> searchPathes = { MakeTestDirectory("empty0"), MakeTestDirectory("empty1"), source };
+
+	auto measure = [](auto&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		uint64_t bytes = func();
+		auto end = std::chrono::steady_clock::now();
+		EXPECT_GT(bytes, 0);
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+
+	// uncached search followed by a stream read, the previous loading path
+	double streamMs = measure([&]()
+		{
+			uint64_t bytes = 0;
+			for (auto& name : names)
+			{
+				for (auto& s : searchPathes)
+				{
+					fs::path p = fs::path(s) / name;
+					if (!fs::exists(p)) continue;
+					std::ifstream file(p, std::ios::binary);
+					file.seekg(0, std::ios::end);
+					std::string content((size_t)file.tellg(), ' ');
+					file.seekg(0, std::ios::beg);
+					file.read(content.data(), content.size());
+					bytes += content.size();
+					break;
+				}
+			}
+			return bytes;
+		});
+
+	auto* fileSystem = kbs::Singleton::GetInstance<kbs::FileSystem<BenchmarkFiles>>();
+	for (auto& s : searchPathes) fileSystem->AddSearchPath(s);
+	for (auto& name : names) fileSystem->FindAbsolutePath(name);
+
+	double mappedMs = measure([&]()
+		{
+			uint64_t bytes = 0;
+			for (auto& name : names) bytes += fileSystem->ReadFile(name).value().size;
+			return bytes;
+		});
+
+	auto* vfs = kbs::Singleton::GetInstance<kbs::VirtualFileSystem>();
+	ASSERT_TRUE(vfs->Mount(packPath, source));
+	double packMs = measure([&]()
+		{
+			uint64_t bytes = 0;
+			for (auto& name : names) bytes += fileSystem->ReadFile(name).value().size;
+			return bytes;
+		});
+	vfs->UnmountAll();
+
+	std::cout << "[ VirtualFileSystem ] " << fileCount << " files, search + ifstream " << streamMs << "ms, cached path + mapped file "
+		<< mappedMs << "ms, cached path + pack " << packMs << "ms" << std::endl;
+}
+
+int main()
+{
+	testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}